@@ -0,0 +1,5 @@
+/*
+ * The same json parser as the kernel, so the binary tree holds exactly
+ * what probe_device would have parsed
+ */
+#include "../../src/external/json-parser-1.1.0/json.c"
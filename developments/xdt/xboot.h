@@ -0,0 +1,12 @@
+#ifndef __XBOOT_H__
+#define __XBOOT_H__
+
+/*
+ * The json parser of the kernel includes xboot.h, on the host it only
+ * needs the c library
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#endif /* __XBOOT_H__ */
@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+#include "../../src/external/json-parser-1.1.0/json.h"
+
+/*
+ * Converts a json device tree into the binary form read by dt_binary_parse
+ * in kernel/core/dtree.c, see there for the layout.
+ */
+#define XDT_MAGIC		(0x31544458)
+
+struct xdt_t {
+	uint8_t * record;
+	uint32_t nvalue, nentry, nelement;
+	char * strings;
+	uint32_t strsize, strmax;
+	uint32_t * shared;
+	uint32_t nshared, maxshared;
+};
+
+static void usage(void)
+{
+	printf("usage:\r\n");
+	printf("    xdt <input.json> <output.xdt>\r\n");
+}
+
+static void put32(uint8_t * p, uint32_t v)
+{
+	p[0] = (v >> 0) & 0xff;
+	p[1] = (v >> 8) & 0xff;
+	p[2] = (v >> 16) & 0xff;
+	p[3] = (v >> 24) & 0xff;
+}
+
+static uint32_t xdt_count(json_value * v)
+{
+	uint32_t count = 1;
+	int i;
+
+	if(v->type == json_object)
+	{
+		for(i = 0; i < v->u.object.length; i++)
+			count += xdt_count(v->u.object.values[i].value);
+	}
+	else if(v->type == json_array)
+	{
+		for(i = 0; i < v->u.array.length; i++)
+			count += xdt_count(v->u.array.values[i]);
+	}
+	return count;
+}
+
+static void * xdt_grow(void * p, uint32_t * max, uint32_t need, uint32_t unit)
+{
+	while(need > *max)
+		*max = *max ? *max * 2 : 1024;
+	p = realloc(p, *max * unit);
+	if(!p)
+	{
+		printf("out of memory\r\n");
+		exit(-1);
+	}
+	return p;
+}
+
+/*
+ * Strings are shared, except the names of the root members which the
+ * kernel splits at the '@' in place
+ */
+static uint32_t xdt_string(struct xdt_t * x, const char * s, int len, int shared)
+{
+	uint32_t i, o;
+
+	if(shared)
+	{
+		for(i = 0; i < x->nshared; i++)
+		{
+			o = x->shared[i];
+			if((strlen(&x->strings[o]) == len) && (memcmp(&x->strings[o], s, len) == 0))
+				return o;
+		}
+	}
+	x->strings = xdt_grow(x->strings, &x->strmax, x->strsize + len + 1, 1);
+	o = x->strsize;
+	memcpy(&x->strings[o], s, len);
+	x->strings[o + len] = '\0';
+	x->strsize += len + 1;
+	if(shared)
+	{
+		x->shared = xdt_grow(x->shared, &x->maxshared, x->nshared + 1, sizeof(uint32_t));
+		x->shared[x->nshared++] = o;
+	}
+	return o;
+}
+
+static void xdt_value(struct xdt_t * x, json_value * v, uint32_t name)
+{
+	uint8_t * r = x->record + x->nvalue++ * 16;
+	uint64_t d;
+	int i;
+
+	put32(r + 0, v->type);
+	put32(r + 4, name);
+	put32(r + 8, 0);
+	put32(r + 12, 0);
+
+	switch(v->type)
+	{
+	case json_object:
+		put32(r + 8, v->u.object.length);
+		x->nentry += v->u.object.length;
+		for(i = 0; i < v->u.object.length; i++)
+		{
+			name = xdt_string(x, v->u.object.values[i].name, v->u.object.values[i].name_length, v->parent != NULL);
+			xdt_value(x, v->u.object.values[i].value, name);
+		}
+		break;
+	case json_array:
+		put32(r + 8, v->u.array.length);
+		x->nelement += v->u.array.length;
+		for(i = 0; i < v->u.array.length; i++)
+			xdt_value(x, v->u.array.values[i], 0xffffffff);
+		break;
+	case json_integer:
+		put32(r + 8, (uint64_t)v->u.integer & 0xffffffff);
+		put32(r + 12, (uint64_t)v->u.integer >> 32);
+		break;
+	case json_double:
+		memcpy(&d, &v->u.dbl, sizeof(double));
+		put32(r + 8, d & 0xffffffff);
+		put32(r + 12, d >> 32);
+		break;
+	case json_string:
+		put32(r + 8, xdt_string(x, v->u.string.ptr, v->u.string.length, 1));
+		put32(r + 12, v->u.string.length);
+		break;
+	case json_boolean:
+		put32(r + 8, v->u.boolean ? 1 : 0);
+		break;
+	default:
+		break;
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	struct xdt_t x;
+	json_value * v;
+	uint8_t head[28];
+	char * buf;
+	FILE * in, * out;
+	long len;
+
+	if(argc != 3)
+	{
+		usage();
+		return -1;
+	}
+
+	in = fopen(argv[1], "rb");
+	if(!in)
+	{
+		printf("can't open '%s'\r\n", argv[1]);
+		return -1;
+	}
+	fseek(in, 0, SEEK_END);
+	len = ftell(in);
+	fseek(in, 0, SEEK_SET);
+	buf = malloc(len + 1);
+	if(!buf || (fread(buf, 1, len, in) != len))
+	{
+		printf("can't read '%s'\r\n", argv[1]);
+		fclose(in);
+		return -1;
+	}
+	fclose(in);
+
+	v = json_parse(buf, len);
+	if(!v || (v->type != json_object))
+	{
+		printf("'%s' is not a json object\r\n", argv[1]);
+		return -1;
+	}
+
+	memset(&x, 0, sizeof(struct xdt_t));
+	x.record = malloc(xdt_count(v) * 16);
+	if(!x.record)
+	{
+		printf("out of memory\r\n");
+		return -1;
+	}
+	xdt_string(&x, "", 0, 1);
+	xdt_value(&x, v, 0xffffffff);
+
+	put32(head + 0, XDT_MAGIC);
+	put32(head + 4, x.nvalue);
+	put32(head + 8, x.nentry);
+	put32(head + 12, x.nelement);
+	put32(head + 16, x.strsize);
+	put32(head + 20, crc32(crc32(0, x.record, x.nvalue * 16), (const Bytef *)x.strings, x.strsize));
+	put32(head + 24, crc32(0, (const Bytef *)buf, len));
+
+	out = fopen(argv[2], "wb");
+	if(!out)
+	{
+		printf("can't create '%s'\r\n", argv[2]);
+		return -1;
+	}
+	if((fwrite(head, 1, 28, out) != 28) || (fwrite(x.record, 16, x.nvalue, out) != x.nvalue) || (fwrite(x.strings, 1, x.strsize, out) != x.strsize))
+	{
+		printf("can't write '%s'\r\n", argv[2]);
+		fclose(out);
+		remove(argv[2]);
+		return -1;
+	}
+	fclose(out);
+
+	json_value_free(v);
+	free(x.record);
+	free(x.strings);
+	free(x.shared);
+	free(buf);
+
+	return 0;
+}
@@ -0,0 +1,21 @@
+#include <zlib.h>
+#include <compress.h>
+
+/*
+ * Kept apart from crc32.h, whose crc32 has the name but not the prototype
+ * of the zlib one
+ */
+size_t compress_bound(size_t len)
+{
+	return compressBound(len);
+}
+
+int compress_block(uint8_t * dst, size_t * dlen, const uint8_t * src, size_t slen)
+{
+	uLongf len = *dlen;
+
+	if(compress2(dst, &len, src, slen, Z_DEFAULT_COMPRESSION) != Z_OK)
+		return -1;
+	*dlen = len;
+	return 0;
+}
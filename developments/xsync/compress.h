@@ -0,0 +1,10 @@
+#ifndef __COMPRESS_H__
+#define __COMPRESS_H__
+
+#include <stdint.h>
+#include <string.h>
+
+size_t compress_bound(size_t len);
+int compress_block(uint8_t * dst, size_t * dlen, const uint8_t * src, size_t slen);
+
+#endif /* __COMPRESS_H__ */
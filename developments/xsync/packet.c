@@ -20,6 +20,24 @@ struct packet_get_ctx_t {
 	int index;
 };
 
+/*
+ * The receiver keeps its state between calls, with a window of packets in
+ * flight a read may end in the middle of one answer or hold several
+ */
+static struct {
+	struct packet_t packet;
+	struct packet_get_ctx_t ctx;
+	uint8_t buf[4096];
+	int len;
+	int pos;
+} receiver = {
+	.ctx = {
+		.packet = &receiver.packet,
+		.state = PACKET_STATE_HEADER0,
+		.index = 0,
+	},
+};
+
 static inline uint64_t time_now(void)
 {
 	struct timeval time;
@@ -32,7 +50,7 @@ static inline uint16_t packet_length(struct packet_t * packet)
 	return ((packet->length[0] << 8) | (packet->length[1] << 0));
 }
 
-static inline uint16_t packet_dsize(struct packet_t * packet)
+uint16_t packet_dsize(struct packet_t * packet)
 {
 	return packet_length(packet) - 5;
 }
@@ -53,13 +71,18 @@ static inline uint32_t packet_crc(struct packet_t * packet)
 
 static void packet_put(struct interface_t * iface, struct packet_t * packet)
 {
-	uint16_t dsize = packet_dsize(packet);
+	uint8_t * p = &(packet->header[0]);
+	ssize_t len = 5 + packet_dsize(packet);
+	ssize_t n;
 
-	interface_write(iface, &(packet->header), 2);
-	interface_write(iface, &(packet->length), 2);
-	interface_write(iface, &(packet->command), 1);
-	if(dsize)
-		interface_write(iface, &(packet->data[0]), dsize);
+	while(len > 0)
+	{
+		n = interface_write(iface, p, len);
+		if(n <= 0)
+			return;
+		p += n;
+		len -= n;
+	}
 	interface_write(iface, &(packet->crc), 4);
 }
 
@@ -102,7 +125,16 @@ static int packet_get_byte(struct packet_get_ctx_t * ctx, uint8_t c)
 		break;
 
 	case PACKET_STATE_LENGTH1:
-		ctx->state = PACKET_STATE_COMMAND;
+		length = (p[2] << 8) | (p[3] << 0);
+		if((length < 5) || (length > 5 + PACKET_SIZE_MAX))
+		{
+			ctx->index = 0;
+			ctx->state = PACKET_STATE_HEADER0;
+		}
+		else
+		{
+			ctx->state = PACKET_STATE_COMMAND;
+		}
 		break;
 
 	case PACKET_STATE_COMMAND:
@@ -156,23 +188,25 @@ static int packet_get_byte(struct packet_get_ctx_t * ctx, uint8_t c)
 
 static int packet_get(struct interface_t * iface, struct packet_t * packet, int timeout)
 {
-	struct packet_get_ctx_t ctx;
-	uint64_t time, end;
-	uint8_t c;
-	int ret = -1;
-
-	ctx.packet = packet;
-	ctx.state = PACKET_STATE_HEADER0;
-	ctx.index = 0;
+	uint64_t end = time_now() + timeout;
+	ssize_t n;
 
-	end = time_now() + timeout;
 	do {
-		if(interface_read(iface, &c, 1) == 1)
-			ret = packet_get_byte(&ctx, c);
-		time = time_now();
-	} while((ret < 0) && (time <= end));
+		while(receiver.pos < receiver.len)
+		{
+			if(packet_get_byte(&receiver.ctx, receiver.buf[receiver.pos++]) == 0)
+			{
+				memcpy(packet, &receiver.packet, 5 + packet_dsize(&receiver.packet));
+				memcpy(&(packet->crc[0]), &(receiver.packet.crc[0]), 4);
+				return 0;
+			}
+		}
+		n = interface_read(iface, receiver.buf, sizeof(receiver.buf));
+		receiver.len = (n > 0) ? n : 0;
+		receiver.pos = 0;
+	} while(time_now() <= end);
 
-	return ret;
+	return -1;
 }
 
 void packet_init(struct packet_t * packet, uint8_t command, uint8_t * data, size_t size)
@@ -195,6 +229,16 @@ void packet_init(struct packet_t * packet, uint8_t command, uint8_t * data, size
 	packet->crc[3] = (crc >>  0) & 0xff;
 }
 
+void packet_send(struct interface_t * iface, struct packet_t * packet)
+{
+	packet_put(iface, packet);
+}
+
+int packet_receive(struct interface_t * iface, struct packet_t * packet, int timeout)
+{
+	return packet_get(iface, packet, timeout);
+}
+
 int packet_transfer(struct interface_t * iface, struct packet_t * request, struct packet_t * response, int timeout)
 {
 	packet_put(iface, request);
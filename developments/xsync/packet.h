@@ -6,16 +6,20 @@
 #include <interface.h>
 
 #define PACKET_DATA_MAX		(1024)
+#define PACKET_SIZE_MAX		(65530)
 
 struct packet_t {
 	uint8_t header[2];
 	uint8_t length[2];
 	uint8_t command;
-	uint8_t data[PACKET_DATA_MAX];
+	uint8_t data[PACKET_SIZE_MAX];
 	uint8_t crc[4];
 };
 
 void packet_init(struct packet_t * packet, uint8_t command, uint8_t * data, size_t size);
+uint16_t packet_dsize(struct packet_t * packet);
+void packet_send(struct interface_t * iface, struct packet_t * packet);
+int packet_receive(struct interface_t * iface, struct packet_t * packet, int timeout);
 int packet_transfer(struct interface_t * iface, struct packet_t * request, struct packet_t * response, int timeout);
 
 #endif /* __PACKET_H__ */
@@ -3,7 +3,7 @@
 static void usage(void)
 {
 	printf("usage:\r\n");
-	printf("    xsync [-d device] [-b baud] <path>\r\n");
+	printf("    xsync [-d device] [-b baud] [-p size] [-w window] [-z] [-r] [-i] <path>\r\n");
 }
 
 static void xsync_show_progress(const char * filename, int percent)
@@ -130,9 +130,362 @@ static void xsync_transfer_file(struct interface_t * iface, const char * filenam
     return;
 }
 
+struct xsync_option_t {
+	int flags;
+	int window;
+	int size;
+};
+
+struct xsync_slot_t {
+	int used;
+	int later;
+	int retry;
+	uint32_t seq;
+	uint32_t order;
+	uint64_t time;
+	struct packet_t packet;
+};
+
+static uint32_t xsync_order = 0;
+
+static inline uint64_t xsync_time(void)
+{
+	struct timeval time;
+	gettimeofday(&time, 0);
+	return (uint64_t)(time.tv_sec * 1000 + time.tv_usec / 1000);
+}
+
+static inline uint32_t xsync_read32(const uint8_t * p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | ((uint32_t)p[3] << 0);
+}
+
+static inline void xsync_write32(uint8_t * p, uint32_t v)
+{
+	p[0] = (v >> 24) & 0xff;
+	p[1] = (v >> 16) & 0xff;
+	p[2] = (v >>  8) & 0xff;
+	p[3] = (v >>  0) & 0xff;
+}
+
+static int xsync_request(struct interface_t * iface, struct packet_t * request, struct packet_t * response)
+{
+	int result, retry = 0;
+
+	do {
+		result = packet_transfer(iface, request, response, 1000);
+	} while(((result < 0) || (response->command != request->command)) && (++retry < 3));
+	if((result < 0) || (response->command != request->command))
+		return -1;
+	return 0;
+}
+
+/*
+ * Ask for the windowed protocol, an older target answers with unknown and
+ * the transfer falls back to stop and wait
+ */
+static int xsync_config(struct interface_t * iface, struct xsync_option_t * opt)
+{
+	struct packet_t * request, * response;
+	uint8_t buf[8];
+	int result = -1;
+
+	request = malloc(sizeof(struct packet_t));
+	response = malloc(sizeof(struct packet_t));
+	if(request && response)
+	{
+		buf[0] = 2;
+		buf[1] = opt->flags & XSYNC_FLAG_ZLIB;
+		buf[2] = (opt->window >> 8) & 0xff;
+		buf[3] = (opt->window >> 0) & 0xff;
+		xsync_write32(&buf[4], opt->size);
+		packet_init(request, XSYNC_COMMAND_CONFIG, buf, 8);
+		if((xsync_request(iface, request, response) == 0) && (packet_dsize(response) >= 8) && (response->data[0] >= 2))
+		{
+			opt->flags = (opt->flags & ~XSYNC_FLAG_ZLIB) | (response->data[1] & XSYNC_FLAG_ZLIB);
+			opt->window = (response->data[2] << 8) | response->data[3];
+			opt->size = xsync_read32(&response->data[4]);
+			if((opt->window > 0) && (opt->size > 64))
+				result = 0;
+		}
+	}
+	free(request);
+	free(response);
+	return result;
+}
+
+/*
+ * Block crcs of the file already on the target, blocks which match and lie
+ * within its size are marked to be skipped
+ */
+static int xsync_resume(struct interface_t * iface, struct xsync_option_t * opt, int fd, uint32_t size, uint32_t osize, int bsize, uint8_t * skip)
+{
+	struct packet_t * request, * response;
+	uint8_t * buf;
+	uint32_t first, count, crc, i;
+	uint32_t nblk = (size + bsize - 1) / bsize;
+	int len, n, skipped = 0;
+
+	request = malloc(sizeof(struct packet_t));
+	response = malloc(sizeof(struct packet_t));
+	buf = malloc(bsize);
+	if(!request || !response || !buf)
+		goto out;
+
+	first = 0;
+	while(first < nblk)
+	{
+		if((uint64_t)first * bsize >= osize)
+			break;
+		count = nblk - first;
+		if(count > (opt->size - 6) / 4)
+			count = (opt->size - 6) / 4;
+		xsync_write32(&buf[0], bsize);
+		xsync_write32(&buf[4], first);
+		buf[8] = (count >> 8) & 0xff;
+		buf[9] = (count >> 0) & 0xff;
+		packet_init(request, XSYNC_COMMAND_SUM, buf, 10);
+		if((xsync_request(iface, request, response) < 0) || (packet_dsize(response) < 6))
+			break;
+		count = (response->data[4] << 8) | response->data[5];
+		if((count == 0) || (packet_dsize(response) < 6 + count * 4))
+			break;
+		for(i = 0; i < count; i++)
+		{
+			len = ((uint64_t)(first + i + 1) * bsize > size) ? size - (first + i) * bsize : bsize;
+			if((first + i) * bsize + len > osize)
+				continue;
+			if((len != bsize) && (osize != size))
+				continue;
+			n = pread(fd, buf, len, (off_t)(first + i) * bsize);
+			if(n != len)
+				continue;
+			crc = crc32(0, buf, len);
+			if(crc == xsync_read32(&response->data[6 + i * 4]))
+			{
+				skip[first + i] = 1;
+				skipped++;
+			}
+		}
+		first += count;
+	}
+
+out:
+	free(request);
+	free(response);
+	free(buf);
+	return skipped;
+}
+
+static void xsync_slot_send(struct interface_t * iface, struct xsync_slot_t * slot)
+{
+	packet_send(iface, &slot->packet);
+	slot->order = ++xsync_order;
+	slot->time = xsync_time();
+}
+
+static int xsync_send_block(struct interface_t * iface, struct xsync_option_t * opt, int fd, uint32_t size, int bsize, uint8_t * tmp, struct xsync_slot_t * slot, uint32_t seq)
+{
+	uint8_t * buf = &slot->packet.data[0];
+	uint32_t offset = seq * bsize;
+	size_t clen;
+	int len, n;
+
+	len = (offset + bsize > size) ? size - offset : bsize;
+	n = pread(fd, &buf[13], len, offset);
+	if(n != len)
+		return -1;
+	xsync_write32(&buf[0], seq);
+	xsync_write32(&buf[4], offset);
+	buf[8] = 0;
+	xsync_write32(&buf[9], len);
+	if(opt->flags & XSYNC_FLAG_ZLIB)
+	{
+		clen = compress_bound(bsize);
+		if((compress_block(tmp, &clen, &buf[13], len) == 0) && (clen < len))
+		{
+			memcpy(&buf[13], tmp, clen);
+			buf[8] = XSYNC_FLAG_ZLIB;
+			n = clen;
+		}
+	}
+	packet_init(&slot->packet, XSYNC_COMMAND_DATA, buf, 13 + n);
+	slot->used = 1;
+	slot->later = 0;
+	slot->retry = 0;
+	slot->seq = seq;
+	xsync_slot_send(iface, slot);
+	return 0;
+}
+
+/*
+ * An expanded image takes data only in order. The target answers in the
+ * order it receives, so a refusal of a packet sent after the last copy of
+ * the oldest one means that copy got lost and it is sent again at once. The
+ * refused ones follow one by one as the packets before them get through.
+ */
+static void xsync_resend_oldest(struct interface_t * iface, struct xsync_slot_t * slots, int window, struct xsync_slot_t * refused)
+{
+	struct xsync_slot_t * o = NULL;
+	int i;
+
+	for(i = 0; i < window; i++)
+	{
+		if(slots[i].used && (refused || slots[i].later) && (!o || (slots[i].seq < o->seq)))
+			o = &slots[i];
+	}
+	if(!o || (refused && (o->order > refused->order)))
+		return;
+	if(refused)
+		o->retry++;
+	o->later = 0;
+	xsync_slot_send(iface, o);
+}
+
+/*
+ * Keeps up to window data packets in flight, each one acknowledged on its
+ * own, a packet whose answer does not come in time or reports a failure is
+ * sent again by itself
+ */
+static int xsync_transfer_window(struct interface_t * iface, struct xsync_option_t * opt, const char * filename)
+{
+	struct packet_t * request, * response;
+	struct xsync_slot_t * slots = NULL;
+	uint8_t * buf = NULL, * tmp = NULL, * skip = NULL;
+	uint32_t crc = 0, size, osize, nblk, next, done, seq;
+	int bsize = opt->size - 13;
+	int fd, n, i, inflight;
+	int result = -1;
+	uint64_t now;
+
+	request = malloc(sizeof(struct packet_t));
+	response = malloc(sizeof(struct packet_t));
+	if(!request || !response)
+		goto out;
+
+	fd = open(filename, O_RDONLY);
+	if(fd < 0)
+		goto out;
+	size = lseek(fd, 0, SEEK_END);
+	nblk = (size + bsize - 1) / bsize;
+	buf = malloc(opt->size);
+	tmp = malloc(compress_bound(bsize));
+	skip = calloc(nblk + 1, 1);
+	slots = calloc(opt->window, sizeof(struct xsync_slot_t));
+	if(!buf || !tmp || !skip || !slots)
+		goto close;
+	for(done = 0; (n = pread(fd, buf, opt->size, done)) > 0; done += n)
+		crc = crc32(crc, buf, n);
+
+	buf[0] = opt->flags;
+	xsync_write32(&buf[1], size);
+	xsync_write32(&buf[5], crc);
+	n = snprintf((char *)&buf[9], opt->size - 9, "%s", filename) + 9;
+	packet_init(request, XSYNC_COMMAND_OPEN, buf, n);
+	if((xsync_request(iface, request, response) < 0) || (packet_dsize(response) < 5) || (response->data[0] == 0))
+		goto close;
+	if(response->data[0] == 1)
+	{
+		xsync_show_progress(filename, 100);
+		result = 0;
+		goto close;
+	}
+	osize = xsync_read32(&response->data[1]);
+
+	done = 0;
+	if((opt->flags & XSYNC_FLAG_RESUME) && (osize > 0))
+		done = xsync_resume(iface, opt, fd, size, osize, bsize, skip);
+	xsync_show_progress(filename, nblk ? done * 100 / nblk : 0);
+
+	next = 0;
+	inflight = 0;
+	while(done < nblk)
+	{
+		for(i = 0; (i < opt->window) && (next < nblk); i++)
+		{
+			if(slots[i].used)
+				continue;
+			while((next < nblk) && skip[next])
+				next++;
+			if(next >= nblk)
+				break;
+			if(xsync_send_block(iface, opt, fd, size, bsize, tmp, &slots[i], next++) < 0)
+				goto close;
+			inflight++;
+		}
+		if(inflight == 0)
+			break;
+
+		if(packet_receive(iface, response, 100) == 0)
+		{
+			if((response->command != XSYNC_COMMAND_DATA) || (packet_dsize(response) < 5))
+				continue;
+			seq = xsync_read32(&response->data[0]);
+			for(i = 0; i < opt->window; i++)
+			{
+				if(!slots[i].used || (slots[i].seq != seq))
+					continue;
+				if(response->data[4] == 1)
+				{
+					slots[i].used = 0;
+					inflight--;
+					done++;
+					xsync_show_progress(filename, done * 100 / nblk);
+					xsync_resend_oldest(iface, slots, opt->window, NULL);
+				}
+				else if(response->data[4] == 2)
+				{
+					slots[i].later = 1;
+					slots[i].retry = 0;
+					xsync_resend_oldest(iface, slots, opt->window, &slots[i]);
+				}
+				else
+				{
+					if(++slots[i].retry > 5)
+						goto close;
+					xsync_slot_send(iface, &slots[i]);
+				}
+				break;
+			}
+		}
+
+		now = xsync_time();
+		for(i = 0; i < opt->window; i++)
+		{
+			if(slots[i].used && (now - slots[i].time > 1000))
+			{
+				if(++slots[i].retry > 5)
+					goto close;
+				xsync_slot_send(iface, &slots[i]);
+			}
+		}
+	}
+
+	xsync_write32(&buf[0], size);
+	xsync_write32(&buf[4], crc);
+	packet_init(request, XSYNC_COMMAND_CLOSE, buf, 8);
+	if((xsync_request(iface, request, response) == 0) && (packet_dsize(response) >= 1) && (response->data[0] == 1))
+	{
+		xsync_show_progress(filename, 100);
+		result = 0;
+	}
+
+close:
+	close(fd);
+out:
+	free(slots);
+	free(skip);
+	free(tmp);
+	free(buf);
+	free(request);
+	free(response);
+	return result;
+}
+
 int main(int argc, char * argv[])
 {
 	struct packet_t request, response;
+	struct xsync_option_t opt = { 0, 3, 1024 };
 	struct interface_t * iface;
 	char * path = ".";
 	char * device = "/dev/ttyUSB0";
@@ -152,6 +505,28 @@ int main(int argc, char * argv[])
 			baud = (int)strtoul(argv[i + 1], NULL, 0);
 			i++;
 		}
+		else if( !strcmp(argv[i], "-p") && (argc > i+1) )
+		{
+			opt.size = (int)strtoul(argv[i + 1], NULL, 0);
+			i++;
+		}
+		else if( !strcmp(argv[i], "-w") && (argc > i+1) )
+		{
+			opt.window = (int)strtoul(argv[i + 1], NULL, 0);
+			i++;
+		}
+		else if( !strcmp(argv[i], "-z") )
+		{
+			opt.flags |= XSYNC_FLAG_ZLIB;
+		}
+		else if( !strcmp(argv[i], "-r") )
+		{
+			opt.flags |= XSYNC_FLAG_RESUME;
+		}
+		else if( !strcmp(argv[i], "-i") )
+		{
+			opt.flags |= XSYNC_FLAG_INFLATE;
+		}
 		else
 		{
 			path = argv[i];
@@ -177,7 +552,16 @@ int main(int argc, char * argv[])
 		return -1;
 	}
 
-	xsync_transfer_file(iface, path);
+	if(opt.size > PACKET_SIZE_MAX)
+		opt.size = PACKET_SIZE_MAX;
+	if(opt.flags & XSYNC_FLAG_INFLATE)
+		opt.flags &= ~(XSYNC_FLAG_ZLIB | XSYNC_FLAG_RESUME);
+	if(xsync_config(iface, &opt) == 0)
+		xsync_transfer_window(iface, &opt, path);
+	else if(!(opt.flags & XSYNC_FLAG_INFLATE))
+		xsync_transfer_file(iface, path);
+	else
+		printf("The device can't expand images\r\n");
 	printf("\r\n");
 
 	retry = 0;
@@ -5,6 +5,7 @@
 #include <sha256.h>
 #include <interface.h>
 #include <packet.h>
+#include <compress.h>
 
 enum xsync_command_t {
 	XSYNC_COMMAND_ALIVE		= 0x00,
@@ -12,7 +13,18 @@ enum xsync_command_t {
 	XSYNC_COMMAND_TRANSFER	= 0x02,
 	XSYNC_COMMAND_STOP		= 0x03,
 	XSYNC_COMMAND_SYSTEM	= 0x04,
+	XSYNC_COMMAND_CONFIG	= 0x05,
+	XSYNC_COMMAND_OPEN		= 0x06,
+	XSYNC_COMMAND_SUM		= 0x07,
+	XSYNC_COMMAND_DATA		= 0x08,
+	XSYNC_COMMAND_CLOSE		= 0x09,
 	XSYNC_COMMAND_UNKOWN	= 0xff,
 };
 
+enum xsync_flag_t {
+	XSYNC_FLAG_ZLIB			= (1 << 0),
+	XSYNC_FLAG_RESUME		= (1 << 1),
+	XSYNC_FLAG_INFLATE		= (1 << 2),
+};
+
 #endif /* __XSYNC_H__ */
@@ -0,0 +1,41 @@
+/*
+ * cpu-sampler.c
+ */
+
+#include <xboot.h>
+
+struct arm_regs_t {
+	uint32_t r[13];
+	uint32_t sp;
+	uint32_t lr;
+	uint32_t pc;
+	uint32_t cpsr;
+};
+
+extern unsigned char __stack_start[] __attribute__((weak));
+extern unsigned char __stack_end[] __attribute__((weak));
+
+/*
+ * Walk the arm mode frame pointer chain, the fp register points at the
+ * saved lr and the caller's fp is stored just below it.
+ */
+int cpu_sampler_backtrace(void * regs, virtual_addr_t * pc, int depth)
+{
+	struct arm_regs_t * r = (struct arm_regs_t *)regs;
+	uint32_t fp, next;
+	int n = 0;
+
+	pc[n++] = r->pc;
+	fp = r->r[11];
+	while(n < depth)
+	{
+		if((fp & 0x3) || (fp < (uint32_t)__stack_start + 4) || (fp >= (uint32_t)__stack_end))
+			break;
+		pc[n++] = ((uint32_t *)fp)[0];
+		next = ((uint32_t *)fp)[-1];
+		if(next <= fp)
+			break;
+		fp = next;
+	}
+	return n;
+}
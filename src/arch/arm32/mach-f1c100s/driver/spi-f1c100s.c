@@ -214,6 +214,7 @@ static struct device_t * spi_f1c100s_probe(struct driver_t * drv, struct dtnode_
 
 	spi->name = alloc_device_name(dt_read_name(n), -1);
 	spi->transfer = spi_f1c100s_transfer,
+	spi->transfer_msgs = NULL,
 	spi->select = spi_f1c100s_select,
 	spi->deselect = spi_f1c100s_deselect,
 	spi->priv = pdat;
@@ -214,6 +214,7 @@ static struct device_t * spi_h3_probe(struct driver_t * drv, struct dtnode_t * n
 
 	spi->name = alloc_device_name(dt_read_name(n), -1);
 	spi->transfer = spi_h3_transfer,
+	spi->transfer_msgs = NULL,
 	spi->select = spi_h3_select,
 	spi->deselect = spi_h3_deselect,
 	spi->priv = pdat;
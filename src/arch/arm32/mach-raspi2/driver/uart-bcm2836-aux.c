@@ -229,6 +229,7 @@ static struct device_t * uart_bcm2836_aux_probe(struct driver_t * drv, struct dt
 	uart->get = uart_bcm2836_aux_get;
 	uart->read = uart_bcm2836_aux_read;
 	uart->write = uart_bcm2836_aux_write;
+	uart->poll = NULL;
 	uart->priv = pdat;
 
 	clk_enable(pdat->clk);
@@ -58,6 +58,7 @@ struct fb_pl111_pdata_t {
 	int vsl;
 	int index;
 	void * vram[2];
+	volatile int flipping;
 	struct led_t * backlight;
 	int brightness;
 };
@@ -113,17 +114,53 @@ void fb_destroy(struct framebuffer_t * fb, struct render_t * render)
 	}
 }
 
+static void fb_pl111_flip(void * data)
+{
+	struct fb_pl111_pdata_t * pdat = (struct fb_pl111_pdata_t *)data;
+
+	dma_cache_sync(pdat->vram[pdat->index], pdat->width * pdat->height * (pdat->bpp / 8), DMA_TO_DEVICE);
+	write32(pdat->virt + CLCD_UBAS, ((u32_t)pdat->vram[pdat->index]));
+	write32(pdat->virt + CLCD_LBAS, ((u32_t)pdat->vram[pdat->index] + pdat->width * pdat->height * (pdat->bpp / 8)));
+	pdat->flipping = 0;
+}
+
+/*
+ * Wait for the copy of the last frame, a completion that never comes is
+ * given up after 100ms
+ */
+static void fb_pl111_wait(struct fb_pl111_pdata_t * pdat)
+{
+	ktime_t timeout = ktime_add_ms(ktime_get(), 100);
+
+	while(pdat->flipping)
+	{
+		if(ktime_after(ktime_get(), timeout))
+		{
+			pdat->flipping = 0;
+			break;
+		}
+	}
+}
+
 void fb_present(struct framebuffer_t * fb, struct render_t * render)
 {
 	struct fb_pl111_pdata_t * pdat = (struct fb_pl111_pdata_t *)fb->priv;
 
 	if(render && render->pixels)
 	{
+		/*
+		 * The copy into the back buffer runs on a dma channel when one is
+		 * free, the buffers are flipped from its completion. A render is
+		 * only drawn again after the next present, which waits for the
+		 * copy, as the display alternates two of them. The shared render
+		 * of the framebuffer is drawn right away, so its copy is waited.
+		 */
+		fb_pl111_wait(pdat);
+		pdat->flipping = 1;
 		pdat->index = (pdat->index + 1) & 0x1;
-		memcpy(pdat->vram[pdat->index], render->pixels, render->pixlen);
-		dma_cache_sync(pdat->vram[pdat->index], render->pixlen, DMA_TO_DEVICE);
-		write32(pdat->virt + CLCD_UBAS, ((u32_t)pdat->vram[pdat->index]));
-		write32(pdat->virt + CLCD_LBAS, ((u32_t)pdat->vram[pdat->index] + pdat->width * pdat->height * (pdat->bpp / 8)));
+		dma_memcpy_async(pdat->vram[pdat->index], render->pixels, render->pixlen, fb_pl111_flip, pdat);
+		if(render == fb->alone)
+			fb_pl111_wait(pdat);
 	}
 }
 
@@ -165,6 +202,7 @@ static struct device_t * fb_pl111_probe(struct driver_t * drv, struct dtnode_t *
 	pdat->vbp = dt_read_int(n, "vback-porch", 1);
 	pdat->vsl = dt_read_int(n, "vsync-len", 1);
 	pdat->index = 0;
+	pdat->flipping = 0;
 	pdat->vram[0] = dma_alloc_noncoherent(pdat->width * pdat->height * pdat->bpp / 8);
 	pdat->vram[1] = dma_alloc_noncoherent(pdat->width * pdat->height * pdat->bpp / 8);
 	pdat->backlight = search_led(dt_read_string(n, "backlight", NULL));
@@ -25,6 +25,7 @@
 #include <xboot.h>
 #include <clk/clk.h>
 #include <gpio/gpio.h>
+#include <interrupt/interrupt.h>
 #include <uart/uart.h>
 
 /*
@@ -42,10 +43,12 @@
  * - data-bits: uart data bits, default is 8
  * - parity-bits: uart parity bits, default is 0
  * - stop-bits: uart stop bits, default is 1
+ * - interrupt: uart interrupt, buffered and interrupt driven if present
  *
  * Example:
  *   "uart-pl011@0x10009000": {
  *       "clock-name": "uclk",
+ *       "interrupt": 44,
  *       "txd-gpio": -1,
  *       "txd-gpio-config": -1,
  *       "rxd-gpio": -1,
@@ -85,6 +88,8 @@ struct uart_pl011_pdata_t {
 	int data;
 	int parity;
 	int stop;
+	int irq;
+	spinlock_t lock;
 };
 
 static bool_t uart_pl011_set(struct uart_t * uart, int baud, int data, int parity, int stop)
@@ -217,6 +222,64 @@ static ssize_t uart_pl011_write(struct uart_t * uart, const u8_t * buf, size_t c
 	return i;
 }
 
+/*
+ * Move data between the fifos and the rings, with the interrupt masked
+ */
+static void uart_pl011_service(struct uart_t * uart)
+{
+	struct uart_pl011_pdata_t * pdat = (struct uart_pl011_pdata_t *)uart->priv;
+	u8_t buf[32];
+	u32_t val;
+	int n = 0;
+
+	while(!(read32(pdat->virt + UART_FR) & (0x1 << 4)))
+	{
+		val = read32(pdat->virt + UART_DATA);
+		if(val & (0x1 << 11))
+			uart->overrun++;
+		buf[n++] = val & 0xff;
+		if(n == sizeof(buf))
+		{
+			uart_rx_push(uart, buf, n);
+			n = 0;
+		}
+	}
+	if(n > 0)
+		uart_rx_push(uart, buf, n);
+
+	while(!(read32(pdat->virt + UART_FR) & (0x1 << 5)))
+	{
+		if(uart_tx_pull(uart, buf, 1) != 1)
+		{
+			write32(pdat->virt + UART_IMSC, read32(pdat->virt + UART_IMSC) & ~(0x1 << 5));
+			return;
+		}
+		write32(pdat->virt + UART_DATA, buf[0]);
+	}
+	write32(pdat->virt + UART_IMSC, read32(pdat->virt + UART_IMSC) | (0x1 << 5));
+}
+
+static void uart_pl011_poll(struct uart_t * uart)
+{
+	struct uart_pl011_pdata_t * pdat = (struct uart_pl011_pdata_t *)uart->priv;
+	irq_flags_t flags;
+
+	spin_lock_irqsave(&pdat->lock, flags);
+	uart_pl011_service(uart);
+	spin_unlock_irqrestore(&pdat->lock, flags);
+}
+
+static void uart_pl011_interrupt(void * data)
+{
+	struct uart_t * uart = (struct uart_t *)data;
+	struct uart_pl011_pdata_t * pdat = (struct uart_pl011_pdata_t *)uart->priv;
+
+	spin_lock(&pdat->lock);
+	write32(pdat->virt + UART_ICR, read32(pdat->virt + UART_MIS));
+	uart_pl011_service(uart);
+	spin_unlock(&pdat->lock);
+}
+
 static struct device_t * uart_pl011_probe(struct driver_t * drv, struct dtnode_t * n)
 {
 	struct uart_pl011_pdata_t * pdat;
@@ -256,12 +319,15 @@ static struct device_t * uart_pl011_probe(struct driver_t * drv, struct dtnode_t
 	pdat->data = dt_read_int(n, "data-bits", 8);
 	pdat->parity = dt_read_int(n, "parity-bits", 0);
 	pdat->stop = dt_read_int(n, "stop-bits", 1);
+	pdat->irq = dt_read_int(n, "interrupt", -1);
+	spin_lock_init(&pdat->lock);
 
 	uart->name = alloc_device_name(dt_read_name(n), -1);
 	uart->set = uart_pl011_set;
 	uart->get = uart_pl011_get;
 	uart->read = uart_pl011_read;
 	uart->write = uart_pl011_write;
+	uart->poll = irq_is_valid(pdat->irq) ? uart_pl011_poll : NULL;
 	uart->priv = pdat;
 
 	clk_enable(pdat->clk);
@@ -294,6 +360,17 @@ static struct device_t * uart_pl011_probe(struct driver_t * drv, struct dtnode_t
 	}
 	dev->driver = drv;
 
+	/*
+	 * Half full fifo levels, interrupt on receive, receive timeout and overrun
+	 */
+	if(uart->poll)
+	{
+		request_irq(pdat->irq, uart_pl011_interrupt, IRQ_TYPE_NONE, uart);
+		write32(pdat->virt + UART_IFLS, (0x2 << 3) | (0x2 << 0));
+		write32(pdat->virt + UART_ICR, 0x7ff);
+		write32(pdat->virt + UART_IMSC, (0x1 << 4) | (0x1 << 6) | (0x1 << 10));
+	}
+
 	return dev;
 }
 
@@ -304,6 +381,11 @@ static void uart_pl011_remove(struct device_t * dev)
 
 	if(uart && unregister_uart(uart))
 	{
+		if(uart->poll)
+		{
+			write32(pdat->virt + UART_IMSC, 0x0);
+			free_irq(pdat->irq);
+		}
 		write32(pdat->virt + UART_CR, 0x0);
 		clk_disable(pdat->clk);
 		free(pdat->clk);
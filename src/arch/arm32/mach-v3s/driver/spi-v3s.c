@@ -214,6 +214,7 @@ static struct device_t * spi_v3s_probe(struct driver_t * drv, struct dtnode_t *
 
 	spi->name = alloc_device_name(dt_read_name(n), -1);
 	spi->transfer = spi_v3s_transfer,
+	spi->transfer_msgs = NULL,
 	spi->select = spi_v3s_select,
 	spi->deselect = spi_v3s_deselect,
 	spi->priv = pdat;
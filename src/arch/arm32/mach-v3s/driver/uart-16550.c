@@ -257,6 +257,7 @@ static struct device_t * uart_16550_probe(struct driver_t * drv, struct dtnode_t
 	uart->get = uart_16550_get;
 	uart->read = uart_16550_read;
 	uart->write = uart_16550_write;
+	uart->poll = NULL;
 	uart->priv = pdat;
 
 	clk_enable(pdat->clk);
@@ -274,6 +274,7 @@ static struct device_t * spi_rk3128_probe(struct driver_t * drv, struct dtnode_t
 
 	spi->name = alloc_device_name(dt_read_name(n), -1);
 	spi->transfer = spi_rk3128_transfer,
+	spi->transfer_msgs = NULL,
 	spi->select = spi_rk3128_select,
 	spi->deselect = spi_rk3128_deselect,
 	spi->priv = pdat;
@@ -268,6 +268,7 @@ static struct device_t * uart_8250_probe(struct driver_t * drv, struct dtnode_t
 	uart->get = uart_8250_get;
 	uart->read = uart_8250_read;
 	uart->write = uart_8250_write;
+	uart->poll = NULL;
 	uart->priv = pdat;
 
 	clk_enable(pdat->clk);
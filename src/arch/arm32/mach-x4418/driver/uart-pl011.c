@@ -262,6 +262,7 @@ static struct device_t * uart_pl011_probe(struct driver_t * drv, struct dtnode_t
 	uart->get = uart_pl011_get;
 	uart->read = uart_pl011_read;
 	uart->write = uart_pl011_write;
+	uart->poll = NULL;
 	uart->priv = pdat;
 
 	clk_enable(pdat->clk);
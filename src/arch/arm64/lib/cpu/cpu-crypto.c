@@ -0,0 +1,207 @@
+/*
+ * cpu-crypto.c
+ */
+
+#include <xboot.h>
+#include <arm64.h>
+#include <crc32.h>
+#include <sha256.h>
+#include <aes128.h>
+
+typedef uint32_t v4u32_t __attribute__((vector_size(16)));
+
+enum {
+	ARM64_FEATURE_AES	= (1 << 0),
+	ARM64_FEATURE_SHA2	= (1 << 1),
+	ARM64_FEATURE_CRC32	= (1 << 2),
+};
+
+static const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static int arm64_features = -1;
+
+/*
+ * The crypto extensions are optional on armv8, the instruction set
+ * attribute register tells which of them the core has
+ */
+static int arm64_cpu_features(void)
+{
+	uint64_t isar0;
+	int f = 0;
+
+	if(arm64_features < 0)
+	{
+		isar0 = arm64_read_sysreg(id_aa64isar0_el1);
+		if(((isar0 >> 4) & 0xf) >= 1)
+			f |= ARM64_FEATURE_AES;
+		if(((isar0 >> 12) & 0xf) >= 1)
+			f |= ARM64_FEATURE_SHA2;
+		if(((isar0 >> 16) & 0xf) >= 1)
+			f |= ARM64_FEATURE_CRC32;
+		arm64_features = f;
+	}
+	return arm64_features;
+}
+
+static inline void load128(v4u32_t * v, const uint8_t * p)
+{
+	__builtin_memcpy(v, p, 16);
+}
+
+/*
+ * Bytes up to a doubleword boundary, then eight bytes per instruction, the
+ * tail is left to the table code
+ */
+static __attribute__((target("+crc"))) int crc32_armv8(uint32_t * crc, const uint8_t * buf, int len)
+{
+	const uint8_t * p = buf;
+	uint32_t c = *crc;
+
+	while(((unsigned long)p & 0x7) && (len > 0))
+	{
+		__asm__("crc32b %w0, %w0, %w1" : "+r"(c) : "r"((uint32_t)*p));
+		p++;
+		len--;
+	}
+	while(len >= 8)
+	{
+		__asm__("crc32x %w0, %w0, %x1" : "+r"(c) : "r"(*(const uint64_t *)p));
+		p += 8;
+		len -= 8;
+	}
+	*crc = c;
+
+	return p - buf;
+}
+
+int cpu_crc32_sum(uint32_t * crc, const uint8_t * buf, int len)
+{
+	if(!(arm64_cpu_features() & ARM64_FEATURE_CRC32))
+		return 0;
+	return crc32_armv8(crc, buf, len);
+}
+
+/*
+ * Four rounds per sha256h and sha256h2 pair, the message schedule of the
+ * group four ahead is computed in place with sha256su0 and sha256su1
+ */
+static __attribute__((target("+crypto"))) void sha256_ce(uint32_t * state, const uint8_t * data, int blocks)
+{
+	v4u32_t abcd, efgh, abcd0, efgh0, t, k, m[4];
+	int g;
+
+	__builtin_memcpy(&abcd, &state[0], 16);
+	__builtin_memcpy(&efgh, &state[4], 16);
+
+	while(blocks--)
+	{
+		abcd0 = abcd;
+		efgh0 = efgh;
+		for(g = 0; g < 4; g++)
+		{
+			load128(&m[g], data + g * 16);
+			__asm__("rev32 %0.16b, %0.16b" : "+w"(m[g]));
+		}
+		for(g = 0; g < 16; g++)
+		{
+			__builtin_memcpy(&k, &sha256_k[g * 4], 16);
+			t = m[g & 3] + k;
+			if(g < 12)
+			{
+				__asm__("sha256su0 %0.4s, %1.4s" : "+w"(m[g & 3]) : "w"(m[(g + 1) & 3]));
+				__asm__("sha256su1 %0.4s, %1.4s, %2.4s" : "+w"(m[g & 3]) : "w"(m[(g + 2) & 3]), "w"(m[(g + 3) & 3]));
+			}
+			k = abcd;
+			__asm__("sha256h %q0, %q1, %2.4s" : "+w"(abcd) : "w"(efgh), "w"(t));
+			__asm__("sha256h2 %q0, %q1, %2.4s" : "+w"(efgh) : "w"(k), "w"(t));
+		}
+		abcd += abcd0;
+		efgh += efgh0;
+		data += 64;
+	}
+
+	__builtin_memcpy(&state[0], &abcd, 16);
+	__builtin_memcpy(&state[4], &efgh, 16);
+}
+
+int cpu_sha256_transform(uint32_t * state, const uint8_t * data, int blocks)
+{
+	if(!(arm64_cpu_features() & ARM64_FEATURE_SHA2))
+		return 0;
+	sha256_ce(state, data, blocks);
+	return blocks;
+}
+
+static __attribute__((target("+crypto"))) void aes128_ce_encrypt(const uint8_t * xkey, const uint8_t * in, uint8_t * out, int blks)
+{
+	v4u32_t k[11], x;
+	int i, n;
+
+	for(i = 0; i < 11; i++)
+		load128(&k[i], xkey + i * 16);
+	for(n = 0; n < blks; n++)
+	{
+		load128(&x, in);
+		for(i = 0; i < 9; i++)
+			__asm__("aese %0.16b, %1.16b\n\taesmc %0.16b, %0.16b" : "+w"(x) : "w"(k[i]));
+		__asm__("aese %0.16b, %1.16b" : "+w"(x) : "w"(k[9]));
+		x ^= k[10];
+		__builtin_memcpy(out, &x, 16);
+		in += 16;
+		out += 16;
+	}
+}
+
+/*
+ * The equivalent inverse cipher wants the middle round keys through
+ * inverse mix columns, they are derived here from the encryption key
+ */
+static __attribute__((target("+crypto"))) void aes128_ce_decrypt(const uint8_t * xkey, const uint8_t * in, uint8_t * out, int blks)
+{
+	v4u32_t k[11], x;
+	int i, n;
+
+	load128(&k[0], xkey + 10 * 16);
+	for(i = 1; i < 10; i++)
+	{
+		load128(&x, xkey + (10 - i) * 16);
+		__asm__("aesimc %0.16b, %1.16b" : "=w"(k[i]) : "w"(x));
+	}
+	load128(&k[10], xkey);
+	for(n = 0; n < blks; n++)
+	{
+		load128(&x, in);
+		for(i = 0; i < 9; i++)
+			__asm__("aesd %0.16b, %1.16b\n\taesimc %0.16b, %0.16b" : "+w"(x) : "w"(k[i]));
+		__asm__("aesd %0.16b, %1.16b" : "+w"(x) : "w"(k[9]));
+		x ^= k[10];
+		__builtin_memcpy(out, &x, 16);
+		in += 16;
+		out += 16;
+	}
+}
+
+int cpu_aes128_encrypt(const uint8_t * xkey, const uint8_t * in, uint8_t * out, int blks)
+{
+	if(!(arm64_cpu_features() & ARM64_FEATURE_AES))
+		return 0;
+	aes128_ce_encrypt(xkey, in, out, blks);
+	return blks;
+}
+
+int cpu_aes128_decrypt(const uint8_t * xkey, const uint8_t * in, uint8_t * out, int blks)
+{
+	if(!(arm64_cpu_features() & ARM64_FEATURE_AES))
+		return 0;
+	aes128_ce_decrypt(xkey, in, out, blks);
+	return blks;
+}
@@ -0,0 +1,72 @@
+/*
+ * cpu-profiler.c
+ */
+
+#include <xboot.h>
+#include <pmu.h>
+
+static const uint32_t event_map[PROFILER_EVENT_MAX] = {
+	[PROFILER_EVENT_TIME]			= SW_INCR,
+	[PROFILER_EVENT_CYCLES]			= CPU_CYCLES,
+	[PROFILER_EVENT_INSTRUCTIONS]	= INST_RETIRED,
+	[PROFILER_EVENT_CACHE_MISSES]	= L1D_CACHE_REFILL,
+	[PROFILER_EVENT_BRANCH_MISSES]	= BR_MIS_PRED,
+};
+static uint32_t counter_last[32];
+static uint64_t counter_high[32];
+
+/*
+ * Widen the 32-bit event counters, valid while read once per wrap
+ */
+static uint64_t counter_extend(int counter, uint32_t value)
+{
+	int i = counter & 0x1f;
+
+	if(value < counter_last[i])
+		counter_high[i] += 0x100000000ULL;
+	counter_last[i] = value;
+	return counter_high[i] | value;
+}
+
+int cpu_profiler_counters(void)
+{
+	return pmn_number();
+}
+
+void cpu_profiler_start(int event, int counter)
+{
+	if(counter < 0)
+	{
+		ccnt_enable();
+	}
+	else
+	{
+		pmn_config(counter, event_map[event]);
+		pmn_enable(counter);
+	}
+}
+
+void cpu_profiler_stop(int event, int counter)
+{
+	if(counter < 0)
+		ccnt_disable();
+	else
+		pmn_disable(counter);
+}
+
+uint64_t cpu_profiler_read(int event, int counter)
+{
+	if(counter < 0)
+		return ccnt_read();
+	return counter_extend(counter, pmn_read(counter));
+}
+
+void cpu_profiler_reset(void)
+{
+	memset(counter_last, 0, sizeof(counter_last));
+	memset(counter_high, 0, sizeof(counter_high));
+	pmu_enable();
+	pmn_reset();
+	ccnt_reset();
+	ccnt_divider(0);
+}
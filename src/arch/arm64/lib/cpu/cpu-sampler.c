@@ -0,0 +1,41 @@
+/*
+ * cpu-sampler.c
+ */
+
+#include <xboot.h>
+
+struct arm64_regs_t {
+	uint64_t x[30];
+	uint64_t lr;
+	uint64_t sp;
+	uint64_t pc;
+	uint64_t pstate;
+};
+
+extern unsigned char __stack_start[] __attribute__((weak));
+extern unsigned char __stack_end[] __attribute__((weak));
+
+/*
+ * Walk the aapcs64 frame records, x29 points at the caller's x29 followed
+ * by the return address.
+ */
+int cpu_sampler_backtrace(void * regs, virtual_addr_t * pc, int depth)
+{
+	struct arm64_regs_t * r = (struct arm64_regs_t *)regs;
+	uint64_t fp, next;
+	int n = 0;
+
+	pc[n++] = r->pc;
+	fp = r->x[29];
+	while(n < depth)
+	{
+		if((fp & 0x7) || (fp < (uint64_t)__stack_start) || (fp + 16 > (uint64_t)__stack_end))
+			break;
+		pc[n++] = ((uint64_t *)fp)[1];
+		next = ((uint64_t *)fp)[0];
+		if(next <= fp)
+			break;
+		fp = next;
+	}
+	return n;
+}
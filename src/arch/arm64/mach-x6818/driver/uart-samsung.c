@@ -274,6 +274,7 @@ static struct device_t * uart_samsung_probe(struct driver_t * drv, struct dtnode
 	uart->get = uart_samsung_get;
 	uart->read = uart_samsung_read;
 	uart->write = uart_samsung_write;
+	uart->poll = NULL;
 	uart->priv = pdat;
 
 	clk_enable(pdat->clk);
@@ -0,0 +1,274 @@
+/*
+ * cpu-crypto.c
+ */
+
+#include <xboot.h>
+#include <crc32.h>
+#include <sha256.h>
+#include <aes128.h>
+
+typedef unsigned long long v2u64_t __attribute__((vector_size(16)));
+typedef uint32_t v4u32_t __attribute__((vector_size(16)));
+typedef uint8_t v16u8_t __attribute__((vector_size(16)));
+
+enum {
+	X64_FEATURE_SSSE3	= (1 << 0),
+	X64_FEATURE_SSE41	= (1 << 1),
+	X64_FEATURE_PCLMUL	= (1 << 2),
+	X64_FEATURE_AES		= (1 << 3),
+	X64_FEATURE_SHA		= (1 << 4),
+};
+
+static const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static int x64_features = -1;
+
+static inline void x64_cpuid(uint32_t leaf, uint32_t * r)
+{
+	__asm__ __volatile__("cpuid" : "=a"(r[0]), "=b"(r[1]), "=c"(r[2]), "=d"(r[3]) : "a"(leaf), "c"(0));
+}
+
+static int x64_cpu_features(void)
+{
+	uint32_t r[4];
+	uint32_t max;
+	int f = 0;
+
+	if(x64_features < 0)
+	{
+		x64_cpuid(0, r);
+		max = r[0];
+		x64_cpuid(1, r);
+		if(r[2] & (1 << 9))
+			f |= X64_FEATURE_SSSE3;
+		if(r[2] & (1 << 19))
+			f |= X64_FEATURE_SSE41;
+		if(r[2] & (1 << 1))
+			f |= X64_FEATURE_PCLMUL;
+		if(r[2] & (1 << 25))
+			f |= X64_FEATURE_AES;
+		if(max >= 7)
+		{
+			x64_cpuid(7, r);
+			if(r[1] & (1 << 29))
+				f |= X64_FEATURE_SHA;
+		}
+		x64_features = f;
+	}
+	return x64_features;
+}
+
+#define CLMUL(a, b, imm) ({ \
+	v2u64_t __r = (a); \
+	__asm__("pclmulqdq %2, %1, %0" : "+x"(__r) : "x"(b), "i"(imm)); \
+	__r; })
+
+static inline v2u64_t crc32_fold(v2u64_t x, v2u64_t k)
+{
+	return CLMUL(x, k, 0x00) ^ CLMUL(x, k, 0x11);
+}
+
+static inline v2u64_t load128(const uint8_t * p)
+{
+	v2u64_t v;
+
+	__builtin_memcpy(&v, p, 16);
+	return v;
+}
+
+/*
+ * Carry-less multiply folding of the reflected crc32, four lanes of 128 bits
+ * per 64 bytes, then one lane, reduced to 32 bits with a barrett step. The
+ * constants are x^(n) mod P for the fold distances, as in "Fast CRC
+ * Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+ */
+static int crc32_pclmul(uint32_t * crc, const uint8_t * buf, int len)
+{
+	const v2u64_t k1k2 = { 0x154442bd4ULL, 0x1c6e41596ULL };
+	const v2u64_t k3k4 = { 0x1751997d0ULL, 0x0ccaa009eULL };
+	const v2u64_t k5 = { 0x163cd6124ULL, 0 };
+	const v2u64_t pu = { 0x1db710641ULL, 0x1f7011641ULL };
+	const v2u64_t mask = { 0xffffffffULL, 0 };
+	v2u64_t x0, x1, x2, x3, t;
+	int n = len & ~15;
+
+	x0 = load128(buf + 0) ^ (v2u64_t){ *crc, 0 };
+	x1 = load128(buf + 16);
+	x2 = load128(buf + 32);
+	x3 = load128(buf + 48);
+	buf += 64;
+	len = n - 64;
+
+	while(len >= 64)
+	{
+		x0 = crc32_fold(x0, k1k2) ^ load128(buf + 0);
+		x1 = crc32_fold(x1, k1k2) ^ load128(buf + 16);
+		x2 = crc32_fold(x2, k1k2) ^ load128(buf + 32);
+		x3 = crc32_fold(x3, k1k2) ^ load128(buf + 48);
+		buf += 64;
+		len -= 64;
+	}
+
+	x0 = crc32_fold(x0, k3k4) ^ x1;
+	x0 = crc32_fold(x0, k3k4) ^ x2;
+	x0 = crc32_fold(x0, k3k4) ^ x3;
+	while(len >= 16)
+	{
+		x0 = crc32_fold(x0, k3k4) ^ load128(buf);
+		buf += 16;
+		len -= 16;
+	}
+
+	t = CLMUL(k3k4, x0, 0x01);
+	x0 = (v2u64_t){ x0[1], 0 } ^ t;
+	t = (v2u64_t){ (x0[0] >> 32) | (x0[1] << 32), x0[1] >> 32 };
+	x0 = CLMUL(x0 & mask, k5, 0x00) ^ t;
+	t = x0;
+	x0 = CLMUL(x0 & mask, pu, 0x10);
+	x0 = CLMUL(x0 & mask, pu, 0x00) ^ t;
+	*crc = (uint32_t)(x0[0] >> 32);
+
+	return n;
+}
+
+int cpu_crc32_sum(uint32_t * crc, const uint8_t * buf, int len)
+{
+	if((len < 64) || !(x64_cpu_features() & X64_FEATURE_PCLMUL))
+		return 0;
+	return crc32_pclmul(crc, buf, len);
+}
+
+#define SHA256RNDS2(cdgh, abef, k) \
+	__asm__("sha256rnds2 %2, %1, %0" : "+x"(cdgh) : "x"(abef), "Yz"(k))
+#define SHA256MSG1(a, b) \
+	__asm__("sha256msg1 %1, %0" : "+x"(a) : "x"(b))
+#define SHA256MSG2(a, b) \
+	__asm__("sha256msg2 %1, %0" : "+x"(a) : "x"(b))
+
+/*
+ * The sha extensions keep the state as abef and cdgh, four rounds per
+ * group with the message schedule of the next groups computed alongside
+ */
+static void sha256_ni(uint32_t * state, const uint8_t * data, int blocks)
+{
+	const v16u8_t bswap = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+	v4u32_t s0, s1, t, abef, cdgh, msg, k, m[4];
+	int g;
+
+	__builtin_memcpy(&t, &state[0], 16);
+	__builtin_memcpy(&s1, &state[4], 16);
+	t = __builtin_shuffle(t, (v4u32_t){ 1, 0, 3, 2 });
+	s1 = __builtin_shuffle(s1, (v4u32_t){ 3, 2, 1, 0 });
+	s0 = __builtin_shuffle(s1, t, (v4u32_t){ 2, 3, 4, 5 });
+	s1 = __builtin_shuffle(s1, t, (v4u32_t){ 0, 1, 6, 7 });
+
+	while(blocks--)
+	{
+		abef = s0;
+		cdgh = s1;
+		for(g = 0; g < 16; g++)
+		{
+			if(g < 4)
+			{
+				__builtin_memcpy(&m[g], data + g * 16, 16);
+				m[g] = (v4u32_t)__builtin_shuffle((v16u8_t)m[g], bswap);
+			}
+			__builtin_memcpy(&k, &sha256_k[g * 4], 16);
+			msg = m[g & 3] + k;
+			SHA256RNDS2(s1, s0, msg);
+			if((g >= 3) && (g <= 14))
+			{
+				m[(g + 1) & 3] += __builtin_shuffle(m[(g - 1) & 3], m[g & 3], (v4u32_t){ 1, 2, 3, 4 });
+				SHA256MSG2(m[(g + 1) & 3], m[g & 3]);
+			}
+			msg = __builtin_shuffle(msg, (v4u32_t){ 2, 3, 0, 0 });
+			SHA256RNDS2(s0, s1, msg);
+			if((g >= 1) && (g <= 12))
+				SHA256MSG1(m[(g - 1) & 3], m[g & 3]);
+		}
+		s0 += abef;
+		s1 += cdgh;
+		data += 64;
+	}
+
+	t = __builtin_shuffle(s0, (v4u32_t){ 3, 2, 1, 0 });
+	s1 = __builtin_shuffle(s1, (v4u32_t){ 1, 0, 3, 2 });
+	s0 = __builtin_shuffle(t, s1, (v4u32_t){ 0, 1, 6, 7 });
+	s1 = __builtin_shuffle(t, s1, (v4u32_t){ 2, 3, 4, 5 });
+	__builtin_memcpy(&state[0], &s0, 16);
+	__builtin_memcpy(&state[4], &s1, 16);
+}
+
+int cpu_sha256_transform(uint32_t * state, const uint8_t * data, int blocks)
+{
+	const int need = X64_FEATURE_SHA | X64_FEATURE_SSSE3 | X64_FEATURE_SSE41;
+
+	if((x64_cpu_features() & need) != need)
+		return 0;
+	sha256_ni(state, data, blocks);
+	return blocks;
+}
+
+int cpu_aes128_encrypt(const uint8_t * xkey, const uint8_t * in, uint8_t * out, int blks)
+{
+	v2u64_t k[11], x;
+	int i, n;
+
+	if(!(x64_cpu_features() & X64_FEATURE_AES))
+		return 0;
+
+	for(i = 0; i < 11; i++)
+		k[i] = load128(xkey + i * 16);
+	for(n = 0; n < blks; n++)
+	{
+		x = load128(in) ^ k[0];
+		for(i = 1; i < 10; i++)
+			__asm__("aesenc %1, %0" : "+x"(x) : "x"(k[i]));
+		__asm__("aesenclast %1, %0" : "+x"(x) : "x"(k[10]));
+		__builtin_memcpy(out, &x, 16);
+		in += 16;
+		out += 16;
+	}
+	return blks;
+}
+
+/*
+ * The equivalent inverse cipher wants the middle round keys through
+ * inverse mix columns, they are derived here from the encryption key
+ */
+int cpu_aes128_decrypt(const uint8_t * xkey, const uint8_t * in, uint8_t * out, int blks)
+{
+	v2u64_t k[11], x;
+	int i, n;
+
+	if(!(x64_cpu_features() & X64_FEATURE_AES))
+		return 0;
+
+	k[0] = load128(xkey + 10 * 16);
+	for(i = 1; i < 10; i++)
+	{
+		x = load128(xkey + (10 - i) * 16);
+		__asm__("aesimc %1, %0" : "=x"(k[i]) : "x"(x));
+	}
+	k[10] = load128(xkey);
+	for(n = 0; n < blks; n++)
+	{
+		x = load128(in) ^ k[0];
+		for(i = 1; i < 10; i++)
+			__asm__("aesdec %1, %0" : "+x"(x) : "x"(k[i]));
+		__asm__("aesdeclast %1, %0" : "+x"(x) : "x"(k[10]));
+		__builtin_memcpy(out, &x, 16);
+		in += 16;
+		out += 16;
+	}
+	return blks;
+}
@@ -0,0 +1,74 @@
+/*
+ * cpu-profiler.c
+ */
+
+#include <xboot.h>
+#include <sandbox.h>
+
+/*
+ * The sandbox uses the time stamp counter for cycles and linux perf events
+ * for the others, perf itself multiplexes when the host runs out of counters.
+ */
+#define PERF_COUNTERS	(4)
+
+static const int event_map[PROFILER_EVENT_MAX] = {
+	[PROFILER_EVENT_TIME]			= -1,
+	[PROFILER_EVENT_CYCLES]			= SANDBOX_PERF_CYCLES,
+	[PROFILER_EVENT_INSTRUCTIONS]	= SANDBOX_PERF_INSTRUCTIONS,
+	[PROFILER_EVENT_CACHE_MISSES]	= SANDBOX_PERF_CACHE_MISSES,
+	[PROFILER_EVENT_BRANCH_MISSES]	= SANDBOX_PERF_BRANCH_MISSES,
+};
+static int perf_fd[PERF_COUNTERS] = { -1, -1, -1, -1 };
+
+static inline uint64_t rdtsc(void)
+{
+	uint32_t lo, hi;
+
+	__asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+	return ((uint64_t)hi << 32) | lo;
+}
+
+int cpu_profiler_counters(void)
+{
+	return PERF_COUNTERS;
+}
+
+void cpu_profiler_start(int event, int counter)
+{
+	if((counter >= 0) && (counter < PERF_COUNTERS))
+	{
+		sandbox_perf_close(perf_fd[counter]);
+		perf_fd[counter] = sandbox_perf_open(event_map[event]);
+		sandbox_perf_enable(perf_fd[counter]);
+	}
+}
+
+void cpu_profiler_stop(int event, int counter)
+{
+	if((counter >= 0) && (counter < PERF_COUNTERS))
+	{
+		sandbox_perf_disable(perf_fd[counter]);
+		sandbox_perf_close(perf_fd[counter]);
+		perf_fd[counter] = -1;
+	}
+}
+
+uint64_t cpu_profiler_read(int event, int counter)
+{
+	if(counter < 0)
+		return rdtsc();
+	if(counter < PERF_COUNTERS)
+		return sandbox_perf_read(perf_fd[counter]);
+	return 0;
+}
+
+void cpu_profiler_reset(void)
+{
+	int i;
+
+	for(i = 0; i < PERF_COUNTERS; i++)
+	{
+		sandbox_perf_close(perf_fd[i]);
+		perf_fd[i] = -1;
+	}
+}
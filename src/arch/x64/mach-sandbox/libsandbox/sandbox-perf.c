@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <sandbox.h>
+
+static const uint64_t perf_config[] = {
+	[SANDBOX_PERF_CYCLES]			= PERF_COUNT_HW_CPU_CYCLES,
+	[SANDBOX_PERF_INSTRUCTIONS]		= PERF_COUNT_HW_INSTRUCTIONS,
+	[SANDBOX_PERF_CACHE_MISSES]		= PERF_COUNT_HW_CACHE_MISSES,
+	[SANDBOX_PERF_BRANCH_MISSES]	= PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+int sandbox_perf_open(int type)
+{
+	struct perf_event_attr attr;
+
+	if((type < 0) || (type >= sizeof(perf_config) / sizeof(perf_config[0])))
+		return -1;
+
+	memset(&attr, 0, sizeof(struct perf_event_attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(struct perf_event_attr);
+	attr.config = perf_config[type];
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+void sandbox_perf_close(int fd)
+{
+	if(fd >= 0)
+		close(fd);
+}
+
+void sandbox_perf_enable(int fd)
+{
+	if(fd >= 0)
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+void sandbox_perf_disable(int fd)
+{
+	if(fd >= 0)
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+}
+
+uint64_t sandbox_perf_read(int fd)
+{
+	uint64_t count;
+
+	if((fd < 0) || (read(fd, &count, sizeof(count)) != sizeof(count)))
+		return 0;
+	return count;
+}
@@ -115,6 +115,21 @@ void sandbox_sdl_timer_set_next(int delay, void (*cb)(void *), void * data);
 uint64_t sandbox_get_time_counter(void);
 uint64_t sandbox_get_time_frequency(void);
 
+/*
+ * Perf interface
+ */
+enum {
+	SANDBOX_PERF_CYCLES			= 0,
+	SANDBOX_PERF_INSTRUCTIONS	= 1,
+	SANDBOX_PERF_CACHE_MISSES	= 2,
+	SANDBOX_PERF_BRANCH_MISSES	= 3,
+};
+int sandbox_perf_open(int type);
+void sandbox_perf_close(int fd);
+void sandbox_perf_enable(int fd);
+void sandbox_perf_disable(int fd);
+uint64_t sandbox_perf_read(int fd);
+
 /*
  * Sysfs interface
  */
@@ -119,6 +119,7 @@ NS_MATH		:=	-Dacos=xboot_acos -Dacosf=xboot_acosf \
 				-Dscalbn=xboot_scalbn -Dscalbnf=xboot_scalbnf \
 				-Dscalbln=xboot_scalbln -Dscalblnf=xboot_scalblnf \
 				-Dsin=xboot_sin -Dsinf=xboot_sinf \
+				-Dsincosf=xboot_sincosf \
 				-Dsinh=xboot_sinh -Dsinhf=xboot_sinhf \
 				-Dsqrt=xboot_sqrt -Dsqrtf=xboot_sqrtf \
 				-Dtan=xboot_tan -Dtanf=xboot_tanf \
@@ -23,8 +23,13 @@
  */
 
 #include <xboot.h>
-#include <audio/pool.h>
+#include <audio/mixer.h>
 #include <audio/audio.h>
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 struct audio_t * search_audio(const char * name)
 {
@@ -97,58 +102,176 @@ bool_t unregister_audio(struct audio_t * audio)
 	return TRUE;
 }
 
-static int sound_read(struct sound_t * snd, void * buf, int count)
+/*
+ * Scale samples by a q15 gain below unity, floor rounded as the scalar code
+ */
+static void gain_s16(s16_t * p, int n, s32_t gain)
 {
-	int i, len = 0;
+	int i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for(; i + 8 <= n; i += 8)
+		vst1q_s16(&p[i], vqdmulhq_n_s16(vld1q_s16(&p[i]), (s16_t)gain));
+#elif defined(__SSE2__)
+	__m128i g = _mm_set1_epi16((s16_t)gain);
+	__m128i v, hi, lo;
+	for(; i + 8 <= n; i += 8)
+	{
+		v = _mm_loadu_si128((__m128i *)&p[i]);
+		hi = _mm_mulhi_epi16(v, g);
+		lo = _mm_mullo_epi16(v, g);
+		_mm_storeu_si128((__m128i *)&p[i], _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15)));
+	}
+#endif
+	for(; i < n; i++)
+		p[i] = (p[i] * gain) >> 15;
+}
 
-	if(snd && snd->read)
+/*
+ * The sse2 path has no 32x32 multiply and goes through doubles, rounding toward zero
+ */
+static void gain_s32(s32_t * p, int n, s32_t gain)
+{
+	int i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for(; i + 4 <= n; i += 4)
+		vst1q_s32((int32_t *)&p[i], vqdmulhq_n_s32(vld1q_s32((const int32_t *)&p[i]), gain << 16));
+#elif defined(__SSE2__)
+	__m128d g = _mm_set1_pd((double)gain / 32768.0);
+	__m128i v, hi, lo;
+	for(; i + 4 <= n; i += 4)
 	{
-		len = snd->read(snd, buf, count);
+		v = _mm_loadu_si128((__m128i *)&p[i]);
+		lo = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(v), g));
+		hi = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2))), g));
+		_mm_storeu_si128((__m128i *)&p[i], _mm_unpacklo_epi64(lo, hi));
+	}
+#endif
+	for(; i < n; i++)
+		p[i] = ((s64_t)p[i] * gain) >> 15;
+}
+
+static inline void gain_sample(u8_t * p, int bytes, s32_t gain)
+{
+	s32_t v;
+
+	switch(bytes)
+	{
+	case 1:
+		p[0] = (u8_t)(((((s32_t)p[0] - 128) * gain) >> 15) + 128);
+		break;
+	case 2:
+		*((s16_t *)p) = (*((s16_t *)p) * gain) >> 15;
+		break;
+	case 3:
+		v = (s32_t)(((u32_t)p[0] << 8) | ((u32_t)p[1] << 16) | ((u32_t)p[2] << 24)) >> 8;
+		v = ((s64_t)v * gain) >> 15;
+		p[0] = (v >> 0) & 0xff;
+		p[1] = (v >> 8) & 0xff;
+		p[2] = (v >> 16) & 0xff;
+		break;
+	case 4:
+		*((s32_t *)p) = ((s64_t)(*((s32_t *)p)) * gain) >> 15;
+		break;
+	default:
+		break;
+	}
+}
 
-		if(snd->volume == 100)
+/*
+ * Apply a q15 gain to native pcm, ramping linearly across the frames from one
+ * gain to another so volume changes do not click. 8-bits pcm is unsigned and
+ * 24-bits pcm is packed little endian, as stored in wav files. A buffer too
+ * short to hold a whole frame takes the target gain directly.
+ */
+void sound_gain(void * buf, int len, enum pcm_format_t fmt, int ch, s32_t from, s32_t to)
+{
+	int bytes = fmt >> 3;
+	int fsz = bytes * ch;
+	int frames, i, c;
+	s64_t delta;
+	s32_t g;
+	u8_t * p = buf;
+
+	if(!buf || (len <= 0) || (bytes < 1) || (bytes > 4) || (ch < 1))
+		return;
+
+	frames = len / fsz;
+	if((from != to) && (frames > 0))
+	{
+		delta = (((s64_t)(to - from)) << 16) / frames;
+		for(i = 0; i < frames; i++)
 		{
+			g = from + (s32_t)((delta * (i + 1)) >> 16);
+			for(c = 0; c < ch; c++, p += bytes)
+				gain_sample(p, bytes, g);
 		}
-		else if(snd->volume == 0)
+	}
+	else if(to == (1 << 15))
+	{
+	}
+	else if(to == 0)
+	{
+		memset(buf, (bytes == 1) ? 0x80 : 0, len);
+	}
+	else if(bytes == 2)
+	{
+		gain_s16(buf, len / 2, to);
+	}
+	else if(bytes == 4)
+	{
+		gain_s32(buf, len / 4, to);
+	}
+	else
+	{
+		for(i = 0; i < len / bytes; i++, p += bytes)
+			gain_sample(p, bytes, to);
+	}
+}
+
+int sound_read(struct sound_t * snd, void * buf, int count)
+{
+	s32_t target;
+	int len = 0;
+	int eof;
+
+	if(snd && snd->read)
+	{
+		if(snd->fifo)
 		{
-			memset(buf, 0, len);
+			/*
+			 * Only the prefetched data, an empty ring short of the end is
+			 * an underrun and not the end of the sound
+			 */
+			if(snd->pending >= 0)
+				return -1;
+			eof = snd->eof;
+			smp_rmb();
+			len = fifo_get(snd->fifo, buf, count);
+			if(len <= 0)
+				return eof ? 0 : -1;
 		}
 		else
 		{
-			s8_t * p8; s16_t * p16; s32_t * p32;
-			s32_t v;
-			switch(snd->info.fmt)
+			len = snd->read(snd, buf, count);
+		}
+		if(len > 0)
+		{
+#if (BYTE_ORDER == BIG_ENDIAN)
+			int i;
+			if(snd->info.fmt == PCM_FORMAT_BIT16)
 			{
-			case PCM_FORMAT_BIT8:
-				p8 = buf;
-				for(i = 0; i < len; i++)
-				{
-					v = ((s32_t)(p8[i])) * snd->volume / 100;
-					p8[i] = (s8_t)v;
-				}
-				break;
-
-			case PCM_FORMAT_BIT16:
-				p16 = buf;
 				for(i = 0; i < len / 2; i++)
-				{
-					v = ((s32_t)be16_to_cpu(p16[i])) * snd->volume / 100;
-					p16[i] = cpu_to_be16((s16_t)v);
-				}
-				break;
-
-			case PCM_FORMAT_BIT24:
-			case PCM_FORMAT_BIT32:
-				p32 = buf;
+					((u16_t *)buf)[i] = le16_to_cpu(((u16_t *)buf)[i]);
+			}
+			else if(snd->info.fmt == PCM_FORMAT_BIT32)
+			{
 				for(i = 0; i < len / 4; i++)
-				{
-					v = ((s32_t)be32_to_cpu(p32[i])) * snd->volume / 100;
-					p32[i] = cpu_to_be32(v);
-				}
-				break;
-
-			default:
-				break;
+					((u32_t *)buf)[i] = le32_to_cpu(((u32_t *)buf)[i]);
 			}
+#endif
+			target = (snd->volume << 15) / 100;
+			sound_gain(buf, len, snd->info.fmt, snd->info.channel, snd->gain, target);
+			snd->gain = target;
 		}
 	}
 
@@ -158,61 +281,40 @@ static int sound_read(struct sound_t * snd, void * buf, int count)
 static int audio_playback_callback(void * data, void * buf, int count)
 {
 	struct audio_t * audio = (struct audio_t *)data;
-	struct sound_list_t * sp = &__sound_pool;
-	struct list_head * pos = sp->entry.next;
-	int len = 0;
-
-	if(list_empty_careful(&sp->entry))
-	{
-		if(audio->playback_stop)
-			audio->playback_stop(audio);
-		return 0;
-	}
-
-	if(list_is_last(pos, &sp->entry))
+	struct mixer_t * m = &__audio_mixer;
+	int len;
+
+	if((len = mixer_render(m, buf, count)) > 0)
+		return len;
+
+	/*
+	 * Going idle, unless a command was queued after the render
+	 */
+	m->running = 0;
+	smp_mb();
+	if(mixer_pending(m))
 	{
-		struct sound_list_t * sl = list_entry(pos, struct sound_list_t, entry);
-		struct sound_t * snd = sl->snd;
-		if(snd && (sound_get_status(snd) == SOUND_STATUS_PLAY))
-		{
-			if((len = sound_read(snd, buf, count)) < count)
-			{
-				if(sound_get_position(snd) >= snd->info.length)
-				{
-					sound_stop(snd);
-				}
-			}
-		}
+		m->running = 1;
+		memset(buf, 0, count);
+		return count;
 	}
-
-	return len;
+	if(audio->playback_stop)
+		audio->playback_stop(audio);
+	return 0;
 }
 
 void audio_playback(struct audio_t * audio)
 {
-	struct sound_list_t * sp = &__sound_pool;
-	struct list_head * pos = sp->entry.next;
+	struct mixer_t * m = &__audio_mixer;
 
 	if(!audio)
 		return;
 
-	if(list_empty_careful(&sp->entry))
-		return;
-
-	/* Just one sound */
-	if(list_is_last(pos, &sp->entry))
-	{
-		struct sound_list_t * sl = list_entry(pos, struct sound_list_t, entry);
-		struct sound_t * snd = sl->snd;
-		if(snd)
-		{
-			if(audio->playback_start)
-				audio->playback_start(audio, snd->info.rate, snd->info.fmt, snd->info.channel, audio_playback_callback, audio);
-		}
-	}
-	/* More than one sound */
-	else
+	smp_mb();
+	if(!m->running)
 	{
-
+		m->running = 1;
+		if(audio->playback_start)
+			audio->playback_start(audio, m->rate, MIXER_OUTPUT_FORMAT, MIXER_OUTPUT_CHANNEL, audio_playback_callback, audio);
 	}
 }
@@ -0,0 +1,213 @@
+/*
+ * driver/audio/bank.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <audio/mixer.h>
+#include <audio/bank.h>
+
+static int sound_seek_voice(struct sound_t * snd, int offset)
+{
+	if(offset < 0)
+		offset = 0;
+	if(offset > snd->info.length)
+		offset = snd->info.length;
+	snd->position = offset;
+	return snd->position;
+}
+
+static int sound_read_voice(struct sound_t * snd, void * buf, int count)
+{
+	struct sound_bank_t * bank = (struct sound_bank_t *)snd->priv;
+	int n = snd->info.length - snd->position;
+
+	if(count > n)
+		count = n;
+	if(count <= 0)
+		return 0;
+	memcpy(buf, (u8_t *)bank->pcm + snd->position, count);
+	snd->position += count;
+	return count;
+}
+
+/*
+ * Decode the whole clip up front, the voices then only copy from memory
+ * and never touch the storage, so they need no prefetch ring either
+ */
+struct sound_bank_t * sound_bank_alloc(const char * filename, int voices)
+{
+	struct sound_bank_t * bank;
+	struct sound_t * snd, * v;
+	int len, n, i;
+
+	if(voices <= 0)
+		voices = CONFIG_SOUND_BANK_VOICES;
+
+	snd = sound_alloc(filename);
+	if(!snd)
+		return NULL;
+
+	if((snd->info.length <= 0) || (snd->info.length > CONFIG_SOUND_BANK_MAX_SIZE))
+	{
+		sound_free(snd);
+		return NULL;
+	}
+
+	bank = malloc(sizeof(struct sound_bank_t));
+	if(!bank)
+	{
+		sound_free(snd);
+		return NULL;
+	}
+	memset(bank, 0, sizeof(struct sound_bank_t));
+
+	bank->pcm = malloc(snd->info.length);
+	bank->voice = malloc(sizeof(struct sound_t) * voices);
+	if(!bank->pcm || !bank->voice)
+	{
+		free(bank->pcm);
+		free(bank->voice);
+		free(bank);
+		sound_free(snd);
+		return NULL;
+	}
+
+	for(len = 0; len < snd->info.length; len += n)
+	{
+		n = snd->read(snd, (u8_t *)bank->pcm + len, snd->info.length - len);
+		if(n <= 0)
+			break;
+	}
+	if(len <= 0)
+	{
+		free(bank->pcm);
+		free(bank->voice);
+		free(bank);
+		sound_free(snd);
+		return NULL;
+	}
+
+	memcpy(&bank->info, &snd->info, sizeof(struct sound_info_t));
+	bank->info.title = snd->info.title ? strdup(snd->info.title) : NULL;
+	bank->info.singer = snd->info.singer ? strdup(snd->info.singer) : NULL;
+	bank->info.length = len - (len % ((bank->info.fmt >> 3) * bank->info.channel));
+	bank->nvoice = voices;
+	bank->next = 0;
+	sound_free(snd);
+
+	for(i = 0; i < voices; i++)
+	{
+		v = &bank->voice[i];
+		memset(v, 0, sizeof(struct sound_t));
+		memcpy(&v->info, &bank->info, sizeof(struct sound_info_t));
+		v->status = SOUND_STATUS_STOP;
+		v->volume = 100;
+		v->gain = 1 << 15;
+		v->position = 0;
+		v->fifo = NULL;
+		v->pending = -1;
+		spin_lock_init(&v->lock);
+		v->seek = sound_seek_voice;
+		v->read = sound_read_voice;
+		v->close = NULL;
+		v->priv = bank;
+	}
+
+	return bank;
+}
+
+void sound_bank_free(struct sound_bank_t * bank)
+{
+	if(bank)
+	{
+		sound_bank_stop(bank);
+		mixer_sync(&__audio_mixer);
+		free(bank->info.title);
+		free(bank->info.singer);
+		free(bank->pcm);
+		free(bank->voice);
+		free(bank);
+	}
+}
+
+/*
+ * Start an idle voice, or restart the least recently started one when all
+ * are busy, no allocation happens here
+ */
+struct sound_t * sound_bank_play(struct sound_bank_t * bank, int volume)
+{
+	struct sound_t * v = NULL;
+	int i, n;
+
+	if(!bank)
+		return NULL;
+
+	for(i = 0; i < bank->nvoice; i++)
+	{
+		n = (bank->next + i) % bank->nvoice;
+		if(bank->voice[n].status == SOUND_STATUS_STOP)
+		{
+			v = &bank->voice[n];
+			break;
+		}
+	}
+	if(!v)
+	{
+		n = bank->next;
+		v = &bank->voice[n];
+		sound_stop(v);
+	}
+	bank->next = (n + 1) % bank->nvoice;
+
+	sound_set_volume(v, volume);
+	sound_play(v);
+	return v;
+}
+
+void sound_bank_stop(struct sound_bank_t * bank)
+{
+	int i;
+
+	if(bank)
+	{
+		for(i = 0; i < bank->nvoice; i++)
+		{
+			if(bank->voice[i].status != SOUND_STATUS_STOP)
+				sound_stop(&bank->voice[i]);
+		}
+	}
+}
+
+int sound_bank_playing(struct sound_bank_t * bank)
+{
+	int i, n = 0;
+
+	if(bank)
+	{
+		for(i = 0; i < bank->nvoice; i++)
+		{
+			if(bank->voice[i].status == SOUND_STATUS_PLAY)
+				n++;
+		}
+	}
+	return n;
+}
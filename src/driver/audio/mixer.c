@@ -0,0 +1,439 @@
+/*
+ * driver/audio/mixer.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <xboot.h>
+#include <audio/mixer.h>
+
+struct mixer_t __audio_mixer;
+
+static inline s32_t mixer_sample(const u8_t * p, int bytes)
+{
+	switch(bytes)
+	{
+	case 1:
+		return ((s32_t)p[0] - 128) << 8;
+	case 2:
+		return *((const s16_t *)p);
+	case 3:
+		return (s16_t)(p[1] | (p[2] << 8));
+	case 4:
+		return *((const s32_t *)p) >> 16;
+	default:
+		break;
+	}
+	return 0;
+}
+
+/*
+ * Decode the next block of the sound into native stereo frames, more
+ * channels are folded down by averaging the even and the odd ones.
+ */
+static int mixer_stream_fill(struct mixer_stream_t * s)
+{
+	struct sound_t * snd = s->snd;
+	int bytes = snd->info.fmt >> 3;
+	int ch = snd->info.channel;
+	int fsz = bytes * ch;
+	int len, n, i, c;
+	s32_t l, r;
+	u8_t * p;
+
+	n = sizeof(s->raw) / fsz;
+	if(n > CONFIG_AUDIO_MIXER_FRAMES)
+		n = CONFIG_AUDIO_MIXER_FRAMES;
+	len = sound_read(snd, s->raw, n * fsz);
+	if(len < 0)
+	{
+		memset(s->frame, 0, n * 2 * sizeof(s16_t));
+		s->index = 0;
+		s->count = n;
+		return n;
+	}
+	n = len / fsz;
+
+	for(i = 0, p = (u8_t *)s->raw; i < n; i++)
+	{
+		if(ch == 1)
+		{
+			l = r = mixer_sample(p, bytes);
+			p += bytes;
+		}
+		else
+		{
+			for(c = 0, l = 0, r = 0; c < ch; c++, p += bytes)
+			{
+				if(c & 0x1)
+					r += mixer_sample(p, bytes);
+				else
+					l += mixer_sample(p, bytes);
+			}
+			if(ch > 2)
+			{
+				l /= (ch + 1) >> 1;
+				r /= ch >> 1;
+			}
+		}
+		s->frame[i * 2 + 0] = l;
+		s->frame[i * 2 + 1] = r;
+	}
+	s->index = 0;
+	s->count = n;
+	return n;
+}
+
+/*
+ * Accumulate frames of the stream, returning false at the end of the sound
+ */
+static bool_t mixer_stream_mix(struct mixer_stream_t * s, s32_t * accum, int frames)
+{
+	s16_t * f;
+	s32_t q;
+	int i, n;
+
+	if(s->step == (1 << 16))
+	{
+		while(frames > 0)
+		{
+			if((s->index >= s->count) && (mixer_stream_fill(s) <= 0))
+				return FALSE;
+			n = s->count - s->index;
+			if(n > frames)
+				n = frames;
+			f = &s->frame[s->index * 2];
+			for(i = 0; i < n * 2; i++)
+				accum[i] += f[i];
+			s->index += n;
+			accum += n * 2;
+			frames -= n;
+		}
+		return TRUE;
+	}
+
+	for(i = 0; i < frames; i++)
+	{
+		while(s->phase >= (1 << 16))
+		{
+			if((s->index >= s->count) && (mixer_stream_fill(s) <= 0))
+				return FALSE;
+			f = &s->frame[s->index * 2];
+			s->prev[0] = s->cur[0];
+			s->prev[1] = s->cur[1];
+			s->cur[0] = f[0];
+			s->cur[1] = f[1];
+			s->index++;
+			s->phase -= (1 << 16);
+		}
+		q = s->phase >> 1;
+		accum[i * 2 + 0] += s->prev[0] + (((s->cur[0] - s->prev[0]) * q) >> 15);
+		accum[i * 2 + 1] += s->prev[1] + (((s->cur[1] - s->prev[1]) * q) >> 15);
+		s->phase += s->step;
+	}
+	return TRUE;
+}
+
+static void mixer_stream_stop(struct mixer_stream_t * s)
+{
+	struct sound_t * snd = s->snd;
+
+	s->snd = NULL;
+	snd->status = SOUND_STATUS_STOP;
+	sound_set_position(snd, 0);
+}
+
+static struct mixer_stream_t * mixer_search_stream(struct mixer_t * m, struct sound_t * snd)
+{
+	int i;
+
+	for(i = 0; i < CONFIG_AUDIO_MIXER_STREAMS; i++)
+	{
+		if(m->stream[i].snd == snd)
+			return &m->stream[i];
+	}
+	return NULL;
+}
+
+static void mixer_command_play(struct mixer_t * m, struct sound_t * snd)
+{
+	struct mixer_stream_t * s;
+	int bytes = snd->info.fmt >> 3;
+
+	snd->status = SOUND_STATUS_PLAY;
+	if(mixer_search_stream(m, snd))
+		return;
+
+	s = mixer_search_stream(m, NULL);
+	if(!s || (bytes < 1) || (bytes > 4) || (snd->info.channel < 1) || (snd->info.channel > 8) || (snd->info.rate <= 0))
+	{
+		snd->status = SOUND_STATUS_STOP;
+		return;
+	}
+
+	s->step = (u32_t)(((u64_t)snd->info.rate << 16) / m->rate);
+	s->phase = 1 << 16;
+	s->prev[0] = s->prev[1] = 0;
+	s->cur[0] = s->cur[1] = 0;
+	s->index = 0;
+	s->count = 0;
+	s->snd = snd;
+}
+
+static void mixer_command_stop(struct mixer_t * m, struct sound_t * snd)
+{
+	struct mixer_stream_t * s = mixer_search_stream(m, snd);
+
+	if(s)
+		mixer_stream_stop(s);
+	else
+	{
+		snd->status = SOUND_STATUS_STOP;
+		sound_set_position(snd, 0);
+	}
+}
+
+/*
+ * Consume the command ring, called with the render lock held
+ */
+static void mixer_apply(struct mixer_t * m)
+{
+	struct mixer_command_t * c;
+	unsigned int tail = m->tail;
+
+	while(tail != m->head)
+	{
+		smp_rmb();
+		c = &m->command[tail & (MIXER_COMMAND_SIZE - 1)];
+		switch(c->cmd)
+		{
+		case MIXER_COMMAND_PLAY:
+			mixer_command_play(m, c->snd);
+			break;
+		case MIXER_COMMAND_PAUSE:
+			c->snd->status = SOUND_STATUS_PAUSE;
+			break;
+		case MIXER_COMMAND_STOP:
+			mixer_command_stop(m, c->snd);
+			break;
+		case MIXER_COMMAND_VOLUME:
+			m->gain = (c->arg << 15) / 100;
+			break;
+		default:
+			break;
+		}
+		tail++;
+		smp_mb();
+		m->tail = tail;
+	}
+}
+
+void mixer_init(struct mixer_t * m, enum pcm_rate_t rate)
+{
+	if(!m)
+		return;
+
+	memset(m, 0, sizeof(struct mixer_t));
+	m->rate = (rate > 0) ? rate : CONFIG_AUDIO_MIXER_RATE;
+	m->gain = 1 << 15;
+	m->volume = 100;
+	m->running = 0;
+	m->head = 0;
+	m->tail = 0;
+	spin_lock_init(&m->lock);
+	spin_lock_init(&m->render);
+}
+
+/*
+ * Queue a command for the render side, which never waits on producers
+ */
+bool_t mixer_post(struct mixer_t * m, enum mixer_cmd_t cmd, struct sound_t * snd, int arg)
+{
+	struct mixer_command_t * c;
+	irq_flags_t flags;
+	bool_t ret = FALSE;
+
+	if(!m)
+		return FALSE;
+
+	spin_lock_irqsave(&m->lock, flags);
+	if(m->head - m->tail < MIXER_COMMAND_SIZE)
+	{
+		c = &m->command[m->head & (MIXER_COMMAND_SIZE - 1)];
+		c->cmd = cmd;
+		c->snd = snd;
+		c->arg = arg;
+		smp_wmb();
+		m->head++;
+		ret = TRUE;
+	}
+	spin_unlock_irqrestore(&m->lock, flags);
+
+	if(!ret)
+	{
+		mixer_sync(m);
+		return mixer_post(m, cmd, snd, arg);
+	}
+	return ret;
+}
+
+/*
+ * Refill the prefetch ring of every stream, from main loop context only
+ */
+void mixer_prefetch(struct mixer_t * m)
+{
+	struct sound_t * snd;
+	int i;
+
+	if(m)
+	{
+		for(i = 0; i < CONFIG_AUDIO_MIXER_STREAMS; i++)
+		{
+			snd = m->stream[i].snd;
+			if(snd)
+				sound_prefetch(snd);
+		}
+	}
+}
+
+bool_t mixer_pending(struct mixer_t * m)
+{
+	if(m)
+		return (m->head != m->tail) ? TRUE : FALSE;
+	return FALSE;
+}
+
+/*
+ * Apply the queued commands now, after which no stream refers to a stopped sound
+ */
+void mixer_sync(struct mixer_t * m)
+{
+	irq_flags_t flags;
+
+	if(m)
+	{
+		spin_lock_irqsave(&m->render, flags);
+		mixer_apply(m);
+		spin_unlock_irqrestore(&m->render, flags);
+	}
+}
+
+int mixer_active(struct mixer_t * m)
+{
+	int i, n = 0;
+
+	if(m)
+	{
+		for(i = 0; i < CONFIG_AUDIO_MIXER_STREAMS; i++)
+		{
+			if(m->stream[i].snd && (m->stream[i].snd->status == SOUND_STATUS_PLAY))
+				n++;
+		}
+	}
+	return n;
+}
+
+/*
+ * Render the playing streams into the output buffer, returning zero when idle
+ */
+int mixer_render(struct mixer_t * m, void * buf, int count)
+{
+	struct mixer_stream_t * s;
+	irq_flags_t flags;
+	s16_t * out = buf;
+	s32_t * accum;
+	s32_t gain, v;
+	int frames, n, i, active;
+	int done = 0;
+
+	if(!m || !buf)
+		return 0;
+
+	spin_lock_irqsave(&m->render, flags);
+	mixer_apply(m);
+	accum = m->accum;
+	gain = m->gain;
+	frames = count / (MIXER_OUTPUT_CHANNEL * sizeof(s16_t));
+
+	while(frames > 0)
+	{
+		n = (frames < CONFIG_AUDIO_MIXER_FRAMES) ? frames : CONFIG_AUDIO_MIXER_FRAMES;
+		memset(accum, 0, n * MIXER_OUTPUT_CHANNEL * sizeof(s32_t));
+		for(i = 0, active = 0; i < CONFIG_AUDIO_MIXER_STREAMS; i++)
+		{
+			s = &m->stream[i];
+			if(!s->snd || (s->snd->status != SOUND_STATUS_PLAY))
+				continue;
+			if(!mixer_stream_mix(s, accum, n))
+				mixer_stream_stop(s);
+			active++;
+		}
+		if(active == 0)
+			break;
+
+		if(gain != (1 << 15))
+		{
+			for(i = 0; i < n * MIXER_OUTPUT_CHANNEL; i++)
+				accum[i] = (s32_t)(((s64_t)accum[i] * gain) >> 15);
+		}
+		for(i = 0; i < n * MIXER_OUTPUT_CHANNEL; i++)
+		{
+			v = accum[i];
+			out[i] = (v > 32767) ? 32767 : ((v < -32768) ? -32768 : v);
+		}
+		out += n * MIXER_OUTPUT_CHANNEL;
+		frames -= n;
+		done += n;
+	}
+	spin_unlock_irqrestore(&m->render, flags);
+
+	if(done == 0)
+		return 0;
+	if(frames > 0)
+		memset(out, 0, frames * MIXER_OUTPUT_CHANNEL * sizeof(s16_t));
+	return (done + frames) * MIXER_OUTPUT_CHANNEL * sizeof(s16_t);
+}
+
+void mixer_set_volume(struct mixer_t * m, int percent)
+{
+	if(m)
+	{
+		if(percent < 0)
+			percent = 0;
+		if(percent > 100)
+			percent = 100;
+		m->volume = percent;
+		mixer_post(m, MIXER_COMMAND_VOLUME, NULL, percent);
+	}
+}
+
+int mixer_get_volume(struct mixer_t * m)
+{
+	if(m)
+		return m->volume;
+	return 0;
+}
+
+static __init void audio_mixer_init(void)
+{
+	mixer_init(&__audio_mixer, CONFIG_AUDIO_MIXER_RATE);
+}
+core_initcall(audio_mixer_init);
@@ -0,0 +1,299 @@
+/*
+ * driver/audio/sound-adpcm.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <audio/sound.h>
+#include <audio/wav.h>
+
+struct sound_data_adpcm_t {
+	int fd;
+	u32_t offset;
+	u32_t size;
+	int align;
+	int spb;
+
+	/* Decoded block */
+	s16_t * pcm;
+	int len;
+	int pos;
+
+	/* Next block to decode */
+	int block;
+	u8_t * raw;
+};
+
+static const s8_t ima_index_table[16] = {
+	-1, -1, -1, -1, 2, 4, 6, 8,
+	-1, -1, -1, -1, 2, 4, 6, 8,
+};
+
+static const u16_t ima_step_table[89] = {
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+	19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+	50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+	130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+	337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+	876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+	2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+	5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static inline s16_t ima_expand(s32_t * pred, s32_t * index, u8_t nibble)
+{
+	s32_t step = ima_step_table[*index];
+	s32_t diff = step >> 3;
+
+	if(nibble & 0x4)
+		diff += step;
+	if(nibble & 0x2)
+		diff += step >> 1;
+	if(nibble & 0x1)
+		diff += step >> 2;
+	*pred += (nibble & 0x8) ? -diff : diff;
+	if(*pred > 32767)
+		*pred = 32767;
+	else if(*pred < -32768)
+		*pred = -32768;
+	*index += ima_index_table[nibble];
+	if(*index < 0)
+		*index = 0;
+	else if(*index > 88)
+		*index = 88;
+	return (s16_t)(*pred);
+}
+
+/*
+ * Decode one block into interleaved 16 bits samples, returning the frames.
+ * Each channel has a four bytes header with the initial predictor and step
+ * index, followed by groups of four bytes, eight nibbles, per channel.
+ */
+static int ima_decode_block(const u8_t * raw, int len, int ch, s16_t * pcm)
+{
+	s32_t pred[8], index[8];
+	const u8_t * p;
+	int frames, groups;
+	int c, g, i;
+
+	if((ch < 1) || (ch > 8) || (len < 4 * ch))
+		return 0;
+
+	for(c = 0; c < ch; c++)
+	{
+		p = &raw[c * 4];
+		pred[c] = (s16_t)(p[0] | (p[1] << 8));
+		index[c] = (p[2] > 88) ? 88 : p[2];
+		pcm[c] = pred[c];
+	}
+
+	groups = (len - 4 * ch) / (4 * ch);
+	frames = 1 + groups * 8;
+	p = &raw[4 * ch];
+	for(g = 0; g < groups; g++)
+	{
+		for(c = 0; c < ch; c++)
+		{
+			for(i = 0; i < 4; i++, p++)
+			{
+				pcm[(1 + g * 8 + i * 2 + 0) * ch + c] = ima_expand(&pred[c], &index[c], *p & 0xf);
+				pcm[(1 + g * 8 + i * 2 + 1) * ch + c] = ima_expand(&pred[c], &index[c], *p >> 4);
+			}
+		}
+	}
+	return frames;
+}
+
+static bool_t sound_adpcm_next(struct sound_t * snd)
+{
+	struct sound_data_adpcm_t * dat = (struct sound_data_adpcm_t *)snd->priv;
+	u32_t start = dat->block * dat->align;
+	int len, frames;
+
+	if(start >= dat->size)
+		return FALSE;
+	len = dat->size - start;
+	if(len > dat->align)
+		len = dat->align;
+	if(read(dat->fd, dat->raw, len) != len)
+		return FALSE;
+
+	frames = ima_decode_block(dat->raw, len, snd->info.channel, dat->pcm);
+	dat->block++;
+	dat->len = frames * snd->info.channel * sizeof(s16_t);
+	dat->pos = 0;
+	return (frames > 0) ? TRUE : FALSE;
+}
+
+static int sound_seek_adpcm(struct sound_t * snd, int offset)
+{
+	struct sound_data_adpcm_t * dat = (struct sound_data_adpcm_t *)snd->priv;
+	int bsz = dat->spb * snd->info.channel * sizeof(s16_t);
+	int block;
+
+	if(offset < 0)
+		offset = 0;
+	if(offset > snd->info.length)
+		offset = snd->info.length;
+	offset -= offset % (snd->info.channel * sizeof(s16_t));
+
+	block = offset / bsz;
+	if(lseek(dat->fd, dat->offset + block * dat->align, SEEK_SET) < 0)
+		return snd->position;
+	dat->block = block;
+	dat->len = 0;
+	dat->pos = 0;
+	if((offset % bsz) && sound_adpcm_next(snd))
+		dat->pos = offset % bsz;
+	snd->position = offset;
+	return snd->position;
+}
+
+static int sound_read_adpcm(struct sound_t * snd, void * buf, int count)
+{
+	struct sound_data_adpcm_t * dat = (struct sound_data_adpcm_t *)snd->priv;
+	u8_t * p = buf;
+	int len = 0, n;
+
+	while(count > 0)
+	{
+		if((dat->pos >= dat->len) && !sound_adpcm_next(snd))
+			break;
+		n = dat->len - dat->pos;
+		if(n > count)
+			n = count;
+		memcpy(p, (u8_t *)dat->pcm + dat->pos, n);
+		dat->pos += n;
+		p += n;
+		len += n;
+		count -= n;
+	}
+	snd->position += len;
+	return len;
+}
+
+static void sound_close_adpcm(struct sound_t * snd)
+{
+	struct sound_data_adpcm_t * dat = (struct sound_data_adpcm_t *)snd->priv;
+	free(snd->info.title);
+	free(snd->info.singer);
+	close(dat->fd);
+	free(dat->raw);
+	free(dat->pcm);
+	free(dat);
+}
+
+static bool_t sound_load_adpcm(struct sound_t * snd, const char * filename)
+{
+	struct sound_data_adpcm_t * dat;
+	struct wav_format_t fmt;
+	u32_t offset, size, rest;
+	int fd, spb;
+
+	if(!snd)
+		return FALSE;
+
+	fd = open(filename, O_RDONLY, (S_IRUSR|S_IRGRP|S_IROTH));
+	if(fd < 0)
+		return FALSE;
+
+	if(!wav_parse(fd, &fmt, &offset, &size) || (fmt.tag != WAV_FORMAT_IMA_ADPCM) ||
+		(fmt.bps != 4) || (fmt.channel < 1) || (fmt.channel > 8) ||
+		(fmt.align < 4 * fmt.channel) || (fmt.align % (4 * fmt.channel)) || (size < 4 * fmt.channel))
+	{
+		close(fd);
+		return FALSE;
+	}
+
+	spb = 1 + (fmt.align - 4 * fmt.channel) * 2 / fmt.channel;
+	if(fmt.spb && (fmt.spb != spb))
+	{
+		close(fd);
+		return FALSE;
+	}
+
+	dat = (struct sound_data_adpcm_t *)malloc(sizeof(struct sound_data_adpcm_t));
+	if(!dat)
+	{
+		close(fd);
+		return FALSE;
+	}
+	memset(dat, 0, sizeof(struct sound_data_adpcm_t));
+	dat->raw = malloc(fmt.align);
+	dat->pcm = malloc(spb * fmt.channel * sizeof(s16_t));
+	if(!dat->raw || !dat->pcm)
+	{
+		free(dat->raw);
+		free(dat->pcm);
+		free(dat);
+		close(fd);
+		return FALSE;
+	}
+
+	dat->fd = fd;
+	dat->offset = offset;
+	dat->size = size;
+	dat->align = fmt.align;
+	dat->spb = spb;
+
+	/*
+	 * A short last block still decodes whole groups of eight samples
+	 */
+	rest = size % fmt.align;
+	snd->info.title = strdup(filename);
+	snd->info.singer = strdup("unknown");
+	snd->info.rate = (enum pcm_rate_t)fmt.rate;
+	snd->info.fmt = PCM_FORMAT_BIT16;
+	snd->info.channel = fmt.channel;
+	snd->info.length = (size / fmt.align) * spb * fmt.channel * sizeof(s16_t);
+	if(rest >= 4 * fmt.channel)
+		snd->info.length += (1 + ((rest - 4 * fmt.channel) / (4 * fmt.channel)) * 8) * fmt.channel * sizeof(s16_t);
+	snd->status = SOUND_STATUS_STOP;
+	snd->volume = 100;
+	snd->gain = 1 << 15;
+	snd->position = 0;
+	snd->seek = sound_seek_adpcm;
+	snd->read = sound_read_adpcm;
+	snd->close = sound_close_adpcm;
+	snd->priv = dat;
+
+	return TRUE;
+}
+
+static struct sound_decoder_t decoder_adpcm = {
+	.name	= "ima-adpcm",
+	.ext	= "wav",
+	.load	= sound_load_adpcm,
+};
+
+static __init void sound_decoder_adpcm_init(void)
+{
+	register_sound_decoder(&decoder_adpcm);
+}
+
+static __exit void sound_decoder_adpcm_exit(void)
+{
+	unregister_sound_decoder(&decoder_adpcm);
+}
+
+core_initcall(sound_decoder_adpcm_init);
+core_exitcall(sound_decoder_adpcm_exit);
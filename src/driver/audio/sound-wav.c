@@ -23,27 +23,82 @@
  */
 
 #include <audio/sound.h>
-
-struct wav_header_t {
-	uint8_t		riff[4];
-	uint32_t	riffsz;
-	uint8_t		wave[4];
-	uint8_t    	fmt[4];
-	uint32_t	fmtsz;
-	uint16_t   	fmttag;
-	uint16_t	channel;
-	uint32_t	samplerate;
-	uint32_t	byterate;
-	uint16_t	align;
-	uint16_t	bps;
-	uint8_t		data[4];
-	uint32_t	datasz;
-};
+#include <audio/wav.h>
 
 struct sound_data_wav_t {
 	int fd;
+	u32_t offset;
 };
 
+static inline u16_t wav_le16(const u8_t * p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static inline u32_t wav_le32(const u8_t * p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((u32_t)p[3] << 24);
+}
+
+/*
+ * Walk the riff chunks up to the data one, skipping fact, list and the
+ * like, and leave the file positioned at the first sample
+ */
+bool_t wav_parse(int fd, struct wav_format_t * fmt, u32_t * offset, u32_t * size)
+{
+	u8_t buf[20];
+	u32_t pos, len;
+	bool_t found = FALSE;
+
+	if((fd < 0) || !fmt)
+		return FALSE;
+
+	if(read(fd, buf, 12) != 12)
+		return FALSE;
+	if((memcmp(&buf[0], "RIFF", 4) != 0) || (memcmp(&buf[8], "WAVE", 4) != 0))
+		return FALSE;
+	pos = 12;
+
+	while(read(fd, buf, 8) == 8)
+	{
+		len = wav_le32(&buf[4]);
+		pos += 8;
+
+		if(memcmp(&buf[0], "fmt ", 4) == 0)
+		{
+			if((len < 16) || (len > 0x10000))
+				return FALSE;
+			memset(buf, 0, sizeof(buf));
+			if(read(fd, buf, (len < sizeof(buf)) ? len : sizeof(buf)) < 16)
+				return FALSE;
+			fmt->tag = wav_le16(&buf[0]);
+			fmt->channel = wav_le16(&buf[2]);
+			fmt->rate = wav_le32(&buf[4]);
+			fmt->byterate = wav_le32(&buf[8]);
+			fmt->align = wav_le16(&buf[12]);
+			fmt->bps = wav_le16(&buf[14]);
+			fmt->extra = (len >= 18) ? wav_le16(&buf[16]) : 0;
+			fmt->spb = (len >= 20) ? wav_le16(&buf[18]) : 0;
+			found = TRUE;
+		}
+		else if(memcmp(&buf[0], "data", 4) == 0)
+		{
+			if(!found)
+				return FALSE;
+			if(offset)
+				*offset = pos;
+			if(size)
+				*size = len;
+			return TRUE;
+		}
+
+		pos += len + (len & 0x1);
+		if(lseek(fd, pos, SEEK_SET) != pos)
+			return FALSE;
+	}
+	return FALSE;
+}
+
 static int sound_seek_wav(struct sound_t * snd, int offset)
 {
 	struct sound_data_wav_t * dat = (struct sound_data_wav_t *)snd->priv;
@@ -53,7 +108,7 @@ static int sound_seek_wav(struct sound_t * snd, int offset)
 	if(offset > snd->info.length)
 		offset = snd->info.length;
 
-	if(lseek(dat->fd, sizeof(struct wav_header_t) + offset, SEEK_SET) > 0)
+	if(lseek(dat->fd, dat->offset + offset, SEEK_SET) >= 0)
 		snd->position = offset;
 	return snd->position;
 }
@@ -63,8 +118,13 @@ static int sound_read_wav(struct sound_t * snd, void * buf, int count)
 	struct sound_data_wav_t * dat = (struct sound_data_wav_t *)snd->priv;
 	int len;
 
+	if(count > snd->info.length - snd->position)
+		count = snd->info.length - snd->position;
+	if(count <= 0)
+		return 0;
 	len = read(dat->fd, buf, count);
-	snd->position += len;
+	if(len > 0)
+		snd->position += len;
 	return len;
 }
 
@@ -77,10 +137,11 @@ static void sound_close_wav(struct sound_t * snd)
 	free(dat);
 }
 
-bool_t sound_load_wav(struct sound_t * snd, const char * filename)
+static bool_t sound_load_wav(struct sound_t * snd, const char * filename)
 {
 	struct sound_data_wav_t * dat;
-	struct wav_header_t header;
+	struct wav_format_t fmt;
+	u32_t offset, size;
 	int fd;
 
 	if(!snd)
@@ -90,27 +151,9 @@ bool_t sound_load_wav(struct sound_t * snd, const char * filename)
 	if(fd < 0)
 		return FALSE;
 
-	if(read(fd, &header, sizeof(struct wav_header_t)) != sizeof(struct wav_header_t))
-	{
-		close(fd);
-		return FALSE;
-	}
-
-	header.riffsz = be32_to_cpu(header.riffsz);
-	header.fmtsz = be32_to_cpu(header.fmtsz);
-	header.fmttag = be16_to_cpu(header.fmttag);
-	header.channel = be16_to_cpu(header.channel);
-	header.samplerate = be32_to_cpu(header.samplerate);
-	header.byterate = be32_to_cpu(header.byterate);
-	header.align = be16_to_cpu(header.align);
-	header.bps = be16_to_cpu(header.bps);
-	header.datasz = be32_to_cpu(header.datasz);
-
-	if(	(memcmp(header.riff, "RIFF", 4) != 0) ||
-		(memcmp(header.wave, "WAVE", 4) != 0) ||
-		(memcmp(header.fmt,  "fmt ", 4) != 0) ||
-		(memcmp(header.data, "data", 4) != 0) ||
-		(header.fmttag != 1) || (header.datasz < header.align) )
+	if(!wav_parse(fd, &fmt, &offset, &size) || (fmt.tag != WAV_FORMAT_PCM) ||
+		(fmt.channel < 1) || (fmt.align == 0) || (size < fmt.align) ||
+		((fmt.bps != 8) && (fmt.bps != 16) && (fmt.bps != 24) && (fmt.bps != 32)))
 	{
 		close(fd);
 		return FALSE;
@@ -124,15 +167,17 @@ bool_t sound_load_wav(struct sound_t * snd, const char * filename)
 	}
 
 	dat->fd = fd;
+	dat->offset = offset;
 
 	snd->info.title = strdup(filename);
 	snd->info.singer = strdup("unknown");
-	snd->info.rate = (enum pcm_rate_t)header.samplerate;
-	snd->info.fmt = (enum pcm_format_t)header.bps;
-	snd->info.channel = header.channel;
-	snd->info.length = header.datasz;
+	snd->info.rate = (enum pcm_rate_t)fmt.rate;
+	snd->info.fmt = (enum pcm_format_t)fmt.bps;
+	snd->info.channel = fmt.channel;
+	snd->info.length = size - (size % fmt.align);
 	snd->status = SOUND_STATUS_STOP;
 	snd->volume = 100;
+	snd->gain = 1 << 15;
 	snd->position = 0;
 	snd->seek = sound_seek_wav;
 	snd->read = sound_read_wav;
@@ -141,3 +186,22 @@ bool_t sound_load_wav(struct sound_t * snd, const char * filename)
 
 	return TRUE;
 }
+
+static struct sound_decoder_t decoder_wav = {
+	.name	= "wav",
+	.ext	= "wav",
+	.load	= sound_load_wav,
+};
+
+static __init void sound_decoder_wav_init(void)
+{
+	register_sound_decoder(&decoder_wav);
+}
+
+static __exit void sound_decoder_wav_exit(void)
+{
+	unregister_sound_decoder(&decoder_wav);
+}
+
+core_initcall(sound_decoder_wav_init);
+core_exitcall(sound_decoder_wav_exit);
@@ -22,22 +22,44 @@
  *
  */
 
-#include <audio/pool.h>
 #include <audio/audio.h>
+#include <audio/mixer.h>
 #include <audio/sound.h>
 
-extern bool_t sound_load_wav(struct sound_t * snd, const char * filename);
+static struct list_head __sound_decoder_list = {
+	.next = &__sound_decoder_list,
+	.prev = &__sound_decoder_list,
+};
+static spinlock_t __sound_decoder_lock = SPIN_LOCK_INIT();
 
-struct sound_loader_t
+bool_t register_sound_decoder(struct sound_decoder_t * dec)
 {
-	const char * ext;
-	bool_t (*load)(struct sound_t * snd, const char * filename);
-};
+	irq_flags_t flags;
 
-static struct sound_loader_t __sound_loader[] = {
-	{"wav",	sound_load_wav},
-	{NULL,	NULL},
-};
+	if(!dec || !dec->name || !dec->load)
+		return FALSE;
+
+	spin_lock_irqsave(&__sound_decoder_lock, flags);
+	init_list_head(&dec->list);
+	list_add_tail(&dec->list, &__sound_decoder_list);
+	spin_unlock_irqrestore(&__sound_decoder_lock, flags);
+
+	return TRUE;
+}
+
+bool_t unregister_sound_decoder(struct sound_decoder_t * dec)
+{
+	irq_flags_t flags;
+
+	if(!dec || !dec->name)
+		return FALSE;
+
+	spin_lock_irqsave(&__sound_decoder_lock, flags);
+	list_del(&dec->list);
+	spin_unlock_irqrestore(&__sound_decoder_lock, flags);
+
+	return TRUE;
+}
 
 static const char * fileext(const char * name)
 {
@@ -59,40 +81,57 @@ static const char * fileext(const char * name)
 	return ret;
 }
 
-static struct sound_loader_t * search_sound_loader(const char * filename)
+/*
+ * Several decoders may share an extension, the first one whose probe
+ * accepts the file wins
+ */
+static bool_t sound_decode(struct sound_t * snd, const char * filename)
 {
-	struct sound_loader_t * loader = &__sound_loader[0];
 	const char * ext = fileext(filename);
+	struct sound_decoder_t * pos, * n;
 
 	if(!ext)
-		return NULL;
+		return FALSE;
 
-	while(loader && loader->ext)
+	list_for_each_entry_safe(pos, n, &__sound_decoder_list, list)
 	{
-		if(strcasecmp(ext, loader->ext) == 0)
-			return loader;
-		loader++;
+		if(pos->ext && (strcasecmp(pos->ext, ext) == 0))
+		{
+			memset(snd, 0, sizeof(struct sound_t));
+			if(pos->load(snd, filename))
+				return TRUE;
+		}
 	}
-	return NULL;
+	return FALSE;
 }
 
 struct sound_t * sound_alloc(const char * filename)
 {
 	struct sound_t * snd;
-	struct sound_loader_t * loader = search_sound_loader(filename);
-
-	if(!loader)
-		return NULL;
 
 	snd = malloc(sizeof(struct sound_t));
 	if(!snd)
 		return NULL;
 
-	if(loader->load(snd, filename))
-		return snd;
+	if(!sound_decode(snd, filename))
+	{
+		free(snd);
+		return NULL;
+	}
 
-	free(snd);
-	return NULL;
+	snd->fifo = fifo_alloc(CONFIG_SOUND_PREFETCH_SIZE);
+	if(!snd->fifo)
+	{
+		if(snd->close)
+			snd->close(snd);
+		free(snd);
+		return NULL;
+	}
+	spin_lock_init(&snd->lock);
+	snd->pending = -1;
+	snd->eof = 0;
+
+	return snd;
 }
 
 void sound_free(struct sound_t * snd)
@@ -100,12 +139,78 @@ void sound_free(struct sound_t * snd)
 	if(snd)
 	{
 		sound_stop(snd);
+		mixer_sync(&__audio_mixer);
 		if(snd->close)
 			snd->close(snd);
+		fifo_free(snd->fifo);
 		free(snd);
 	}
 }
 
+/*
+ * Keep the ring of decoded pcm data full, from main loop context only. Seeks
+ * requested by the render side are applied here, and data read across a new
+ * request is dropped, so the audio callback never waits on the storage.
+ */
+void sound_prefetch(struct sound_t * snd)
+{
+	static u8_t buf[4096];
+	irq_flags_t flags;
+	int fsz, len, pending;
+	bool_t stale;
+
+	if(!snd || !snd->fifo || !snd->read)
+		return;
+
+	fsz = (snd->info.fmt >> 3) * snd->info.channel;
+	if(fsz <= 0)
+		return;
+
+	pending = snd->pending;
+	if(pending >= 0)
+	{
+		if(snd->seek)
+			snd->seek(snd, pending);
+		spin_lock_irqsave(&snd->lock, flags);
+		if(snd->pending == pending)
+		{
+			fifo_clear(snd->fifo);
+			snd->eof = 0;
+			snd->pending = -1;
+		}
+		spin_unlock_irqrestore(&snd->lock, flags);
+		if(snd->pending >= 0)
+			return;
+	}
+
+	while(!snd->eof)
+	{
+		len = snd->fifo->size - fifo_avail(snd->fifo);
+		if(len > sizeof(buf))
+			len = sizeof(buf);
+		len -= len % fsz;
+		if(len <= 0)
+			break;
+
+		len = snd->read(snd, buf, len);
+		spin_lock_irqsave(&snd->lock, flags);
+		stale = (snd->pending >= 0) ? TRUE : FALSE;
+		if(!stale)
+		{
+			if(len > 0)
+				fifo_put(snd->fifo, buf, len);
+			else
+			{
+				smp_wmb();
+				snd->eof = 1;
+			}
+		}
+		spin_unlock_irqrestore(&snd->lock, flags);
+		if(stale || (len <= 0))
+			break;
+	}
+}
+
 struct sound_info_t * sound_get_info(struct sound_t * snd)
 {
 	if(snd)
@@ -141,20 +246,39 @@ int sound_get_volume(struct sound_t * snd)
 
 void sound_set_position(struct sound_t * snd, int position)
 {
+	irq_flags_t flags;
+
 	if(snd && snd->seek)
 	{
 		if(position < 0)
 			position = 0;
 		if(position > snd->info.length)
 			position = snd->info.length;
-		snd->seek(snd, position);
+		if(snd->fifo)
+		{
+			spin_lock_irqsave(&snd->lock, flags);
+			snd->pending = position;
+			fifo_clear(snd->fifo);
+			spin_unlock_irqrestore(&snd->lock, flags);
+		}
+		else
+		{
+			snd->seek(snd, position);
+		}
 	}
 }
 
 int sound_get_position(struct sound_t * snd)
 {
+	int pending;
+
 	if(snd)
-		return snd->position;
+	{
+		pending = snd->pending;
+		if(snd->fifo && (pending >= 0))
+			return pending;
+		return snd->position - fifo_avail(snd->fifo);
+	}
 	return 0;
 }
 
@@ -162,8 +286,9 @@ void sound_play(struct sound_t * snd)
 {
 	if(snd)
 	{
+		sound_prefetch(snd);
 		snd->status = SOUND_STATUS_PLAY;
-		sound_pool_add(snd);
+		mixer_post(&__audio_mixer, MIXER_COMMAND_PLAY, snd, 0);
 		audio_playback(search_first_audio());
 	}
 }
@@ -173,6 +298,7 @@ void sound_pause(struct sound_t * snd)
 	if(snd)
 	{
 		snd->status = SOUND_STATUS_PAUSE;
+		mixer_post(&__audio_mixer, MIXER_COMMAND_PAUSE, snd, 0);
 	}
 }
 
@@ -181,7 +307,8 @@ void sound_stop(struct sound_t * snd)
 	if(snd)
 	{
 		snd->status = SOUND_STATUS_STOP;
-		sound_pool_del(snd);
-		sound_set_position(snd, 0);
+		mixer_post(&__audio_mixer, MIXER_COMMAND_STOP, snd, 0);
+		if(!__audio_mixer.running)
+			mixer_sync(&__audio_mixer);
 	}
 }
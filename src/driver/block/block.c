@@ -290,3 +290,22 @@ void block_sync(struct block_t * blk)
 	if(blk && blk->sync)
 		blk->sync(blk);
 }
+
+void * block_mmap(struct block_t * blk, u64_t offset, u64_t count)
+{
+	u64_t blksz, capacity;
+	u8_t * p;
+
+	if(!blk || !blk->mmap)
+		return NULL;
+
+	blksz = block_size(blk);
+	capacity = block_capacity(blk);
+	if(!blksz || (offset > capacity) || (count > capacity - offset))
+		return NULL;
+
+	p = blk->mmap(blk, offset / blksz);
+	if(!p)
+		return NULL;
+	return (void *)(p + (offset % blksz));
+}
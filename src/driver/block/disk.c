@@ -155,6 +155,7 @@ bool_t register_disk(struct device_t ** device, struct disk_t * disk)
 		blk->read = disk_block_read;
 		blk->write = disk_block_write;
 		blk->sync = disk_block_sync;
+		blk->mmap = NULL;
 		blk->priv	= dblk;
 
 		if(!register_block(NULL, blk))
@@ -232,6 +232,7 @@ bool_t register_loop(const char * file)
 	blk->blkcnt		= size;
 	blk->read		= loop_read;
 	blk->write		= loop_write;
+	blk->mmap		= NULL;
 	blk->priv		= loop;
 
 	list->loop 		= loop;
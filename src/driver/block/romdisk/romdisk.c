@@ -51,6 +51,12 @@ static void romdisk_sync(struct block_t * blk)
 {
 }
 
+static void * romdisk_mmap(struct block_t * blk, u64_t blkno)
+{
+	struct romdisk_pdata_t * pdat = (struct romdisk_pdata_t *)(blk->priv);
+	return (void *)(pdat->addr + block_offset(blk, blkno));
+}
+
 static struct device_t * romdisk_probe(struct driver_t * drv, struct dtnode_t * n)
 {
 	struct romdisk_pdata_t * pdat;
@@ -83,6 +89,7 @@ static struct device_t * romdisk_probe(struct driver_t * drv, struct dtnode_t *
 	blk->read = romdisk_read;
 	blk->write = romdisk_write;
 	blk->sync = romdisk_sync;
+	blk->mmap = romdisk_mmap;
 	blk->priv = pdat;
 
 	if(!register_block(&dev, blk))
@@ -329,6 +329,7 @@ static struct device_t * spi_flash_probe(struct driver_t * drv, struct dtnode_t
 	blk->read = spi_flash_read;
 	blk->write = spi_flash_write;
 	blk->sync = spi_flash_sync;
+	blk->mmap = NULL;
 	blk->priv = pdat;
 
 	spi_device_select(pdat->dev);
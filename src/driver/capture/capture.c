@@ -0,0 +1,317 @@
+/*
+ * driver/capture/capture.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <adc/adc.h>
+#include <gmeter/gmeter.h>
+#include <thermometer/thermometer.h>
+#include <capture/capture.h>
+
+static void capture_filter_free(struct capture_filter_t * f)
+{
+	switch(f->type)
+	{
+	case CAPTURE_FILTER_EWMA:
+		ewma_free(f->priv);
+		break;
+	case CAPTURE_FILTER_KALMAN:
+		kalman_free(f->priv);
+		break;
+	case CAPTURE_FILTER_MEAN:
+		mean_free(f->priv);
+		break;
+	case CAPTURE_FILTER_MEDIAN:
+		median_free(f->priv);
+		break;
+	default:
+		break;
+	}
+	f->type = CAPTURE_FILTER_NONE;
+	f->priv = NULL;
+}
+
+static s32_t capture_filter_update(struct capture_filter_t * f, s32_t value)
+{
+	switch(f->type)
+	{
+	case CAPTURE_FILTER_EWMA:
+		return (s32_t)ewma_update(f->priv, (float)value);
+	case CAPTURE_FILTER_KALMAN:
+		return (s32_t)kalman_update(f->priv, (float)value);
+	case CAPTURE_FILTER_MEAN:
+		return mean_update(f->priv, value);
+	case CAPTURE_FILTER_MEDIAN:
+		return median_update(f->priv, value);
+	default:
+		break;
+	}
+	return value;
+}
+
+/*
+ * Runs at the sampling rate, the timer is forwarded from its previous expiry
+ * so the rate does not drift, periods lost to a late callback are skipped
+ */
+static int capture_timer_function(struct timer_t * timer, void * data)
+{
+	struct capture_t * s = (struct capture_t *)data;
+	struct capture_sample_t sample;
+	ktime_t now = ktime_get();
+	int i;
+
+	memset(&sample, 0, sizeof(struct capture_sample_t));
+	sample.time = ktime_to_us(now);
+	if(s->read(s, sample.value))
+	{
+		spin_lock(&s->lock);
+		for(i = 0; i < s->nvalue; i++)
+			sample.value[i] = capture_filter_update(&s->filter[i], sample.value[i]);
+		if(s->fifo->size - fifo_avail(s->fifo) < sizeof(struct capture_sample_t))
+		{
+			struct capture_sample_t old;
+			fifo_get(s->fifo, (u8_t *)&old, sizeof(struct capture_sample_t));
+			s->overrun++;
+		}
+		fifo_put(s->fifo, (u8_t *)&sample, sizeof(struct capture_sample_t));
+		s->count++;
+		spin_unlock(&s->lock);
+	}
+
+	if(!s->running)
+		return 0;
+	timer_forward(timer, timer->expires, s->period);
+	if(ktime_before(timer->expires, now))
+	{
+		timer_forward(timer, now, s->period);
+		s->missed++;
+	}
+	return 1;
+}
+
+struct capture_t * capture_alloc(int rate, int nvalue, int depth, bool_t (*read)(struct capture_t *, s32_t *), void * source, int channel)
+{
+	struct capture_t * s;
+	int i;
+
+	if(rate <= 0 || rate > CAPTURE_MAX_RATE || nvalue <= 0 || nvalue > CAPTURE_MAX_VALUES || depth <= 0 || !read)
+		return NULL;
+
+	s = malloc(sizeof(struct capture_t));
+	if(!s)
+		return NULL;
+
+	s->fifo = fifo_alloc(sizeof(struct capture_sample_t) * depth);
+	if(!s->fifo)
+	{
+		free(s);
+		return NULL;
+	}
+
+	s->rate = rate;
+	s->nvalue = nvalue;
+	s->read = read;
+	s->source = source;
+	s->channel = channel;
+	s->period = ns_to_ktime(1000000000ULL / rate);
+	timer_init(&s->timer, capture_timer_function, s);
+	for(i = 0; i < CAPTURE_MAX_VALUES; i++)
+	{
+		s->filter[i].type = CAPTURE_FILTER_NONE;
+		s->filter[i].priv = NULL;
+	}
+	spin_lock_init(&s->lock);
+	s->running = FALSE;
+	s->count = 0;
+	s->overrun = 0;
+	s->missed = 0;
+
+	return s;
+}
+
+static bool_t capture_read_adc(struct capture_t * s, s32_t * value)
+{
+	value[0] = adc_read_voltage(s->source, s->channel);
+	return TRUE;
+}
+
+static bool_t capture_read_gmeter(struct capture_t * s, s32_t * value)
+{
+	int x, y, z;
+
+	if(!gmeter_get_acceleration(s->source, &x, &y, &z))
+		return FALSE;
+	value[0] = x;
+	value[1] = y;
+	value[2] = z;
+	return TRUE;
+}
+
+static bool_t capture_read_thermometer(struct capture_t * s, s32_t * value)
+{
+	value[0] = thermometer_get_temperature(s->source);
+	return TRUE;
+}
+
+struct capture_t * capture_alloc_adc(const char * name, int channel, int rate, int depth)
+{
+	struct adc_t * adc = search_adc(name);
+
+	if(!adc || channel < 0 || channel >= adc->nchannel)
+		return NULL;
+	return capture_alloc(rate, 1, depth, capture_read_adc, adc, channel);
+}
+
+struct capture_t * capture_alloc_gmeter(const char * name, int rate, int depth)
+{
+	struct gmeter_t * gmeter = name ? search_gmeter(name) : search_first_gmeter();
+
+	if(!gmeter)
+		return NULL;
+	return capture_alloc(rate, 3, depth, capture_read_gmeter, gmeter, 0);
+}
+
+struct capture_t * capture_alloc_thermometer(const char * name, int rate, int depth)
+{
+	struct thermometer_t * thermometer = name ? search_thermometer(name) : search_first_thermometer();
+
+	if(!thermometer)
+		return NULL;
+	return capture_alloc(rate, 1, depth, capture_read_thermometer, thermometer, 0);
+}
+
+void capture_free(struct capture_t * s)
+{
+	int i;
+
+	if(s)
+	{
+		capture_stop(s);
+		for(i = 0; i < CAPTURE_MAX_VALUES; i++)
+			capture_filter_free(&s->filter[i]);
+		fifo_free(s->fifo);
+		free(s);
+	}
+}
+
+/*
+ * Each value gets its own filter, the arguments are the weight of an ewma,
+ * a, h, q and r of a kalman or the length of a mean or median window
+ */
+bool_t capture_set_filter(struct capture_t * s, enum capture_filter_type_t type, float * args, int nargs)
+{
+	struct capture_filter_t f[CAPTURE_MAX_VALUES];
+	irq_flags_t flags;
+	int i;
+
+	if(!s)
+		return FALSE;
+
+	for(i = 0; i < s->nvalue; i++)
+	{
+		f[i].type = type;
+		switch(type)
+		{
+		case CAPTURE_FILTER_NONE:
+			f[i].priv = NULL;
+			break;
+		case CAPTURE_FILTER_EWMA:
+			f[i].priv = (nargs >= 1) ? ewma_alloc(args[0]) : NULL;
+			break;
+		case CAPTURE_FILTER_KALMAN:
+			f[i].priv = (nargs >= 4) ? kalman_alloc(args[0], args[1], args[2], args[3]) : NULL;
+			break;
+		case CAPTURE_FILTER_MEAN:
+			f[i].priv = ((nargs >= 1) && (args[0] >= 1)) ? mean_alloc((int)args[0]) : NULL;
+			break;
+		case CAPTURE_FILTER_MEDIAN:
+			f[i].priv = ((nargs >= 1) && (args[0] >= 1)) ? median_alloc((int)args[0]) : NULL;
+			break;
+		default:
+			f[i].type = CAPTURE_FILTER_NONE;
+			f[i].priv = NULL;
+			break;
+		}
+		if((type != CAPTURE_FILTER_NONE) && !f[i].priv)
+		{
+			while(--i >= 0)
+				capture_filter_free(&f[i]);
+			return FALSE;
+		}
+	}
+
+	spin_lock_irqsave(&s->lock, flags);
+	for(i = 0; i < s->nvalue; i++)
+	{
+		struct capture_filter_t t = s->filter[i];
+		s->filter[i] = f[i];
+		f[i] = t;
+	}
+	spin_unlock_irqrestore(&s->lock, flags);
+
+	for(i = 0; i < s->nvalue; i++)
+		capture_filter_free(&f[i]);
+	return TRUE;
+}
+
+void capture_start(struct capture_t * s)
+{
+	if(s && !s->running)
+	{
+		s->running = TRUE;
+		timer_start_now(&s->timer, s->period);
+	}
+}
+
+void capture_stop(struct capture_t * s)
+{
+	if(s && s->running)
+	{
+		s->running = FALSE;
+		timer_cancel(&s->timer);
+	}
+}
+
+int capture_available(struct capture_t * s)
+{
+	if(!s)
+		return 0;
+	return fifo_avail(s->fifo) / sizeof(struct capture_sample_t);
+}
+
+int capture_read(struct capture_t * s, struct capture_sample_t * buf, int count)
+{
+	irq_flags_t flags;
+	int n;
+
+	if(!s || !buf || count <= 0)
+		return 0;
+
+	spin_lock_irqsave(&s->lock, flags);
+	n = fifo_avail(s->fifo) / sizeof(struct capture_sample_t);
+	if(n > count)
+		n = count;
+	fifo_get(s->fifo, (u8_t *)buf, n * sizeof(struct capture_sample_t));
+	spin_unlock_irqrestore(&s->lock, flags);
+
+	return n;
+}
@@ -219,6 +219,14 @@ ktime_t clocksource_ktime_get(struct clocksource_t * cs)
 	return ns_to_ktime(0);
 }
 
+/*
+ * The dummy clocksource counts its reads, its time means nothing
+ */
+bool_t clocksource_ready(void)
+{
+	return (__clocksource != &__cs_dummy) ? TRUE : FALSE;
+}
+
 ktime_t ktime_get(void)
 {
 	return clocksource_keeper_read(__clocksource);
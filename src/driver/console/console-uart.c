@@ -33,13 +33,24 @@ struct console_uart_pdata_t {
 static ssize_t console_uart_read(struct console_t * console, unsigned char * buf, size_t count)
 {
 	struct console_uart_pdata_t * pdat = (struct console_uart_pdata_t *)console->priv;
-	return pdat->uart->read(pdat->uart, (u8_t *)buf, count);
+	return uart_read(pdat->uart, (u8_t *)buf, count);
 }
 
 static ssize_t console_uart_write(struct console_t * console, const unsigned char * buf, size_t count)
 {
 	struct console_uart_pdata_t * pdat = (struct console_uart_pdata_t *)console->priv;
-	return pdat->uart->write(pdat->uart, (const u8_t *)buf, count);
+	return uart_write(pdat->uart, (const u8_t *)buf, count);
+}
+
+static void console_uart_kick(struct console_t * console)
+{
+	struct console_uart_pdata_t * pdat = (struct console_uart_pdata_t *)console->priv;
+	uart_tx_kick(pdat->uart);
+}
+
+static size_t console_uart_refill(struct uart_t * uart, u8_t * buf, size_t count, void * data)
+{
+	return console_tx_pull((struct console_t *)data, (unsigned char *)buf, count);
 }
 
 static struct device_t * console_uart_probe(struct driver_t * drv, struct dtnode_t * n)
@@ -68,6 +79,7 @@ static struct device_t * console_uart_probe(struct driver_t * drv, struct dtnode
 	console->name = alloc_device_name(dt_read_name(n), dt_read_id(n));
 	console->read = console_uart_read,
 	console->write = console_uart_write,
+	console->kick = uart->txfifo ? console_uart_kick : NULL;
 	console->priv = pdat;
 
 	if(!register_console(&dev, console))
@@ -79,15 +91,28 @@ static struct device_t * console_uart_probe(struct driver_t * drv, struct dtnode
 	}
 	dev->driver = drv;
 
+	if(console->kick)
+	{
+		uart->txrefill_data = console;
+		uart->txrefill = console_uart_refill;
+	}
+
 	return dev;
 }
 
 static void console_uart_remove(struct device_t * dev)
 {
 	struct console_t * console = (struct console_t *)dev->priv;
+	struct console_uart_pdata_t * pdat;
 
 	if(console && unregister_console(console))
 	{
+		pdat = (struct console_uart_pdata_t *)console->priv;
+		if(pdat->uart->txrefill_data == console)
+		{
+			pdat->uart->txrefill = NULL;
+			pdat->uart->txrefill_data = NULL;
+		}
 		free_device_name(console->name);
 		free(console->priv);
 		free(console);
@@ -43,6 +43,17 @@ static struct console_t __console_dummy = {
 static struct console_t * __console = &__console_dummy;
 static spinlock_t __console_lock = SPIN_LOCK_INIT();
 
+/*
+ * Transmit ring shared by the consoles with a kick method, the active one
+ * drains it from its transmit interrupt. The indexes run free and are
+ * reset whenever the ring empties.
+ */
+static unsigned char * __console_txbuf = NULL;
+static size_t __console_txsize = 0;
+static size_t __console_txin = 0;
+static size_t __console_txout = 0;
+static spinlock_t __console_txlock = SPIN_LOCK_INIT();
+
 static ssize_t console_read_active(struct kobj_t * kobj, void * buf, size_t size)
 {
 	struct console_t * console = (struct console_t *)kobj->priv;
@@ -55,6 +66,7 @@ static ssize_t console_write_active(struct kobj_t * kobj, void * buf, size_t siz
 	struct console_t * console = (struct console_t *)kobj->priv;
 	irq_flags_t flags;
 
+	console_flush();
 	spin_lock_irqsave(&__console_lock, flags);
 	__console = console;
 	spin_unlock_irqrestore(&__console_lock, flags);
@@ -92,6 +104,13 @@ bool_t register_console(struct device_t ** device, struct console_t * console)
 	if(!console || !console->name)
 		return FALSE;
 
+	if(console->kick && !__console_txbuf)
+	{
+		__console_txbuf = malloc(CONFIG_CONSOLE_TX_RING_SIZE);
+		if(__console_txbuf)
+			__console_txsize = CONFIG_CONSOLE_TX_RING_SIZE;
+	}
+
 	dev = malloc(sizeof(struct device_t));
 	if(!dev)
 		return FALSE;
@@ -140,6 +159,7 @@ bool_t unregister_console(struct console_t * console)
 
 	if(__console == console)
 	{
+		console_flush();
 		if(!(c = search_first_console()))
 			c = &__console_dummy;
 
@@ -166,6 +186,7 @@ bool_t console_set(const char * name)
 
 	if(c)
 	{
+		console_flush();
 		spin_lock_irqsave(&__console_lock, flags);
 		__console = c;
 		spin_unlock_irqrestore(&__console_lock, flags);
@@ -181,8 +202,123 @@ ssize_t console_stdin_read(unsigned char * buf, size_t count)
 	return 0;
 }
 
+static inline bool_t console_buffered(struct console_t * console)
+{
+	return (console && console->kick && __console_txbuf) ? TRUE : FALSE;
+}
+
+static size_t console_tx_put(const unsigned char * buf, size_t count)
+{
+	irq_flags_t flags;
+	size_t n, l, o;
+
+	spin_lock_irqsave(&__console_txlock, flags);
+	n = __console_txsize - (__console_txin - __console_txout);
+	if(n > count)
+		n = count;
+	if(n > 0)
+	{
+		o = __console_txin % __console_txsize;
+		l = (n < __console_txsize - o) ? n : __console_txsize - o;
+		memcpy(__console_txbuf + o, buf, l);
+		memcpy(__console_txbuf, buf + l, n - l);
+		__console_txin += n;
+	}
+	spin_unlock_irqrestore(&__console_txlock, flags);
+
+	return n;
+}
+
+/*
+ * Kick the console until the tx ring has room for want bytes, giving up
+ * once the transmitter has taken nothing for CONFIG_CONSOLE_TX_TIMEOUT ms
+ */
+static bool_t console_tx_wait(struct console_t * console, size_t want)
+{
+	ktime_t timeout = ktime_add_ms(ktime_get(), CONFIG_CONSOLE_TX_TIMEOUT);
+	size_t out = __console_txout;
+
+	while(__console_txsize - (__console_txin - __console_txout) < want)
+	{
+		console->kick(console);
+		if(__console_txout != out)
+		{
+			out = __console_txout;
+			timeout = ktime_add_ms(ktime_get(), CONFIG_CONSOLE_TX_TIMEOUT);
+		}
+		else if(ktime_after(ktime_get(), timeout))
+		{
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/*
+ * Queue into the tx ring and kick the console, when the ring is full the
+ * writer waits for the transmitter to make room for the rest
+ */
+static ssize_t console_tx_write(struct console_t * console, const unsigned char * buf, size_t count)
+{
+	size_t len = 0;
+
+	while(len < count)
+	{
+		len += console_tx_put(buf + len, count - len);
+		console->kick(console);
+		if((len < count) && !console_tx_wait(console, 1))
+			break;
+	}
+	return len;
+}
+
+/*
+ * Called by console drivers from the transmit path, only the active
+ * console drains the ring
+ */
+size_t console_tx_pull(struct console_t * console, unsigned char * buf, size_t count)
+{
+	irq_flags_t flags;
+	size_t n, l, o;
+
+	if(!buf || (count == 0) || (console != __console) || !__console_txbuf)
+		return 0;
+
+	spin_lock_irqsave(&__console_txlock, flags);
+	n = __console_txin - __console_txout;
+	if(n > count)
+		n = count;
+	if(n > 0)
+	{
+		o = __console_txout % __console_txsize;
+		l = (n < __console_txsize - o) ? n : __console_txsize - o;
+		memcpy(buf, __console_txbuf + o, l);
+		memcpy(buf + l, __console_txbuf, n - l);
+		__console_txout += n;
+		if(__console_txout == __console_txin)
+			__console_txin = __console_txout = 0;
+	}
+	spin_unlock_irqrestore(&__console_txlock, flags);
+
+	return n;
+}
+
+/*
+ * Wait until the tx ring is sent, before switching consoles, rebooting or
+ * handing the machine over
+ */
+void console_flush(void)
+{
+	struct console_t * console = __console;
+
+	if(console_buffered(console))
+		console_tx_wait(console, __console_txsize);
+}
+
 ssize_t console_stdout_write(const unsigned char * buf, size_t count)
 {
+	if(console_buffered(__console))
+		return console_tx_write(__console, buf, count);
 	if(__console && __console->write)
 		return __console->write(__console, buf, count);
 	return 0;
@@ -190,7 +326,50 @@ ssize_t console_stdout_write(const unsigned char * buf, size_t count)
 
 ssize_t console_stderr_write(const unsigned char * buf, size_t count)
 {
+	ssize_t ret;
+
+	if(console_buffered(__console))
+	{
+		ret = console_tx_write(__console, buf, count);
+		console_flush();
+		return ret;
+	}
 	if(__console && __console->write)
 		return __console->write(__console, buf, count);
 	return 0;
 }
+
+/*
+ * Format into a stack buffer, or a heap one for longer output, and queue
+ * it with one copy. Formatting straight into the ring would hold the ring
+ * lock across vsnprintf. Returns the whole formatted length.
+ */
+int console_stdout_vprintf(const char * fmt, va_list ap)
+{
+	char buf[SZ_4K];
+	char * p = buf;
+	va_list aq;
+	int len, n;
+
+	va_copy(aq, ap);
+	len = vsnprintf(buf, sizeof(buf), fmt, aq);
+	va_end(aq);
+	if(len <= 0)
+		return len;
+
+	n = len;
+	if(len >= sizeof(buf))
+	{
+		if((p = malloc(len + 1)))
+			vsnprintf(p, len + 1, fmt, ap);
+		else
+		{
+			p = buf;
+			n = sizeof(buf) - 1;
+		}
+	}
+	console_stdout_write((const unsigned char *)p, n);
+	if(p != buf)
+		free(p);
+	return len;
+}
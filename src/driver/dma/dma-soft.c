@@ -0,0 +1,278 @@
+/*
+ * driver/dma/dma-soft.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <xboot.h>
+#include <dma/dma.h>
+
+/*
+ * Software DMA Controller - Emulated by cpu copies from a timer
+ *
+ * Optional properties:
+ * - dma-base: dma channel base number, default is 0
+ * - dma-count: dma channel count, default is 8
+ * - burst-size: bytes copied per channel and timer tick, default is 65536
+ * - interval-us: timer tick in microseconds, default is 1000
+ *
+ * Example:
+ *   "dma-soft@0": {
+ *       "dma-base": 0,
+ *       "dma-count": 8,
+ *       "burst-size": 65536,
+ *       "interval-us": 1000
+ *   }
+ */
+
+struct dma_soft_channel_t {
+	struct timer_t timer;
+	struct dmachip_t * chip;
+	int offset;
+	struct dma_desc_t * desc;
+	size_t pos;
+	spinlock_t lock;
+};
+
+struct dma_soft_pdata_t {
+	struct dma_soft_channel_t * channel;
+	size_t burst;
+	int interval;
+};
+
+static void dma_soft_copy(struct dma_desc_t * desc, size_t pos, size_t len)
+{
+	unsigned long src = desc->src + ((desc->flags & DMA_SRC_FIXED) ? 0 : pos);
+	unsigned long dst = desc->dst + ((desc->flags & DMA_DST_FIXED) ? 0 : pos);
+	int sinc = (desc->flags & DMA_SRC_FIXED) ? 0 : desc->width;
+	int dinc = (desc->flags & DMA_DST_FIXED) ? 0 : desc->width;
+	size_t i;
+
+	if(sinc && dinc)
+	{
+		memcpy((void *)dst, (const void *)src, len);
+		return;
+	}
+
+	for(i = 0; i < len; i += desc->width, src += sinc, dst += dinc)
+	{
+		switch(desc->width)
+		{
+		case 1:
+			write8(dst, read8(src));
+			break;
+		case 2:
+			write16(dst, read16(src));
+			break;
+		case 4:
+			write32(dst, read32(src));
+			break;
+		case 8:
+			write64(dst, read64(src));
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+static int dma_soft_timer_function(struct timer_t * timer, void * data)
+{
+	struct dma_soft_channel_t * c = (struct dma_soft_channel_t *)data;
+	struct dma_soft_pdata_t * pdat = (struct dma_soft_pdata_t *)c->chip->priv;
+	struct dma_desc_t * desc;
+	size_t budget = pdat->burst, len;
+	irq_flags_t flags;
+
+	spin_lock_irqsave(&c->lock, flags);
+	while(c->desc && budget > 0)
+	{
+		desc = c->desc;
+		len = desc->size - c->pos;
+		if(len > budget)
+			len = budget & ~(desc->width - 1);
+		if(len <= 0)
+			break;
+		dma_soft_copy(desc, c->pos, len);
+		c->pos += len;
+		budget -= len;
+		if(c->pos >= desc->size)
+		{
+			c->desc = desc->next;
+			c->pos = 0;
+			spin_unlock_irqrestore(&c->lock, flags);
+			dmachip_complete(c->chip, c->offset, desc);
+			spin_lock_irqsave(&c->lock, flags);
+		}
+	}
+	desc = c->desc;
+	spin_unlock_irqrestore(&c->lock, flags);
+
+	if(desc)
+	{
+		timer_forward_now(timer, us_to_ktime(pdat->interval));
+		return 1;
+	}
+	return 0;
+}
+
+static bool_t dma_soft_start(struct dmachip_t * chip, int offset, struct dma_desc_t * desc)
+{
+	struct dma_soft_pdata_t * pdat = (struct dma_soft_pdata_t *)chip->priv;
+	struct dma_soft_channel_t * c = &pdat->channel[offset];
+	irq_flags_t flags;
+
+	spin_lock_irqsave(&c->lock, flags);
+	c->desc = desc;
+	c->pos = 0;
+	spin_unlock_irqrestore(&c->lock, flags);
+
+	/*
+	 * Resubmitted from a completion callback, the running timer picks the
+	 * new chain up and restarts itself
+	 */
+	if(c->timer.state != TIMER_STATE_CALLBACK)
+		timer_start_now(&c->timer, us_to_ktime(pdat->interval));
+	return TRUE;
+}
+
+static void dma_soft_stop(struct dmachip_t * chip, int offset)
+{
+	struct dma_soft_pdata_t * pdat = (struct dma_soft_pdata_t *)chip->priv;
+	struct dma_soft_channel_t * c = &pdat->channel[offset];
+	irq_flags_t flags;
+
+	timer_cancel(&c->timer);
+	spin_lock_irqsave(&c->lock, flags);
+	c->desc = NULL;
+	c->pos = 0;
+	spin_unlock_irqrestore(&c->lock, flags);
+}
+
+static struct device_t * dma_soft_probe(struct driver_t * drv, struct dtnode_t * n)
+{
+	struct dma_soft_pdata_t * pdat;
+	struct dmachip_t * chip;
+	struct device_t * dev;
+	int base = dt_read_int(n, "dma-base", 0);
+	int ndma = dt_read_int(n, "dma-count", 8);
+	int i;
+
+	if(base < 0 || ndma <= 0)
+		return NULL;
+
+	pdat = malloc(sizeof(struct dma_soft_pdata_t));
+	if(!pdat)
+		return NULL;
+
+	chip = malloc(sizeof(struct dmachip_t));
+	if(!chip)
+	{
+		free(pdat);
+		return NULL;
+	}
+
+	pdat->channel = malloc(sizeof(struct dma_soft_channel_t) * ndma);
+	if(!pdat->channel)
+	{
+		free(chip);
+		free(pdat);
+		return NULL;
+	}
+	pdat->burst = dt_read_int(n, "burst-size", 65536);
+	pdat->interval = dt_read_int(n, "interval-us", 1000);
+	if(pdat->burst < 8)
+		pdat->burst = 8;
+	if(pdat->interval <= 0)
+		pdat->interval = 1000;
+
+	chip->name = alloc_device_name(dt_read_name(n), -1);
+	chip->base = base;
+	chip->ndma = ndma;
+	chip->start = dma_soft_start;
+	chip->stop = dma_soft_stop;
+	chip->priv = pdat;
+
+	for(i = 0; i < ndma; i++)
+	{
+		timer_init(&pdat->channel[i].timer, dma_soft_timer_function, &pdat->channel[i]);
+		pdat->channel[i].chip = chip;
+		pdat->channel[i].offset = i;
+		pdat->channel[i].desc = NULL;
+		pdat->channel[i].pos = 0;
+		spin_lock_init(&pdat->channel[i].lock);
+	}
+
+	if(!register_dmachip(&dev, chip))
+	{
+		free_device_name(chip->name);
+		free(pdat->channel);
+		free(chip->priv);
+		free(chip);
+		return NULL;
+	}
+	dev->driver = drv;
+
+	return dev;
+}
+
+static void dma_soft_remove(struct device_t * dev)
+{
+	struct dmachip_t * chip = (struct dmachip_t *)dev->priv;
+	struct dma_soft_pdata_t * pdat = (struct dma_soft_pdata_t *)chip->priv;
+
+	if(chip && unregister_dmachip(chip))
+	{
+		free_device_name(chip->name);
+		free(pdat->channel);
+		free(chip->priv);
+		free(chip);
+	}
+}
+
+static void dma_soft_suspend(struct device_t * dev)
+{
+}
+
+static void dma_soft_resume(struct device_t * dev)
+{
+}
+
+static struct driver_t dma_soft = {
+	.name		= "dma-soft",
+	.probe		= dma_soft_probe,
+	.remove		= dma_soft_remove,
+	.suspend	= dma_soft_suspend,
+	.resume		= dma_soft_resume,
+};
+
+static __init void dma_soft_driver_init(void)
+{
+	register_driver(&dma_soft);
+}
+
+static __exit void dma_soft_driver_exit(void)
+{
+	unregister_driver(&dma_soft);
+}
+
+driver_initcall(dma_soft_driver_init);
+driver_exitcall(dma_soft_driver_exit);
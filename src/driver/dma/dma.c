@@ -25,6 +25,672 @@
 #include <xboot.h>
 #include <dma/dma.h>
 
+static ssize_t dmachip_read_base(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct dmachip_t * chip = (struct dmachip_t *)kobj->priv;
+	return sprintf(buf, "%d", chip->base);
+}
+
+static ssize_t dmachip_read_ndma(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct dmachip_t * chip = (struct dmachip_t *)kobj->priv;
+	return sprintf(buf, "%d", chip->ndma);
+}
+
+static ssize_t dmachip_read_status(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct dmachip_t * chip = (struct dmachip_t *)kobj->priv;
+	struct dma_channel_t * ch;
+	int len = 0, i;
+
+	for(i = 0; i < chip->ndma; i++)
+	{
+		ch = &chip->channel[i];
+		len += sprintf((char *)(buf + len), "%d: %s%s %llu %llu\r\n", ch->dma,
+			ch->used ? (ch->busy ? "busy" : "idle") : "free", ch->cyclic ? " cyclic" : "",
+			(unsigned long long)ch->transfers, (unsigned long long)ch->bytes);
+	}
+	return len;
+}
+
+struct dmachip_t * search_dmachip(int dma)
+{
+	struct device_t * pos, * n;
+	struct dmachip_t * chip;
+
+	list_for_each_entry_safe(pos, n, &__device_head[DEVICE_TYPE_DMACHIP], head)
+	{
+		chip = (struct dmachip_t *)(pos->priv);
+		if((dma >= chip->base) && (dma < (chip->base + chip->ndma)))
+			return chip;
+	}
+	return NULL;
+}
+
+bool_t register_dmachip(struct device_t ** device, struct dmachip_t * chip)
+{
+	struct device_t * dev;
+	int i;
+
+	if(!chip || !chip->name || !chip->start)
+		return FALSE;
+
+	if(chip->base < 0 || chip->ndma <= 0)
+		return FALSE;
+
+	dev = malloc(sizeof(struct device_t));
+	if(!dev)
+		return FALSE;
+
+	chip->channel = malloc(sizeof(struct dma_channel_t) * chip->ndma);
+	if(!chip->channel)
+	{
+		free(dev);
+		return FALSE;
+	}
+	memset(chip->channel, 0, sizeof(struct dma_channel_t) * chip->ndma);
+	for(i = 0; i < chip->ndma; i++)
+	{
+		chip->channel[i].chip = chip;
+		chip->channel[i].offset = i;
+		chip->channel[i].dma = chip->base + i;
+	}
+	spin_lock_init(&chip->lock);
+
+	dev->name = strdup(chip->name);
+	dev->type = DEVICE_TYPE_DMACHIP;
+	dev->priv = chip;
+	dev->kobj = kobj_alloc_directory(dev->name);
+	kobj_add_regular(dev->kobj, "base", dmachip_read_base, NULL, chip);
+	kobj_add_regular(dev->kobj, "ndma", dmachip_read_ndma, NULL, chip);
+	kobj_add_regular(dev->kobj, "status", dmachip_read_status, NULL, chip);
+
+	if(!register_device(dev))
+	{
+		kobj_remove_self(dev->kobj);
+		free(chip->channel);
+		free(dev->name);
+		free(dev);
+		return FALSE;
+	}
+
+	if(device)
+		*device = dev;
+	return TRUE;
+}
+
+bool_t unregister_dmachip(struct dmachip_t * chip)
+{
+	struct device_t * dev;
+	int i;
+
+	if(!chip || !chip->name)
+		return FALSE;
+
+	if(chip->base < 0 || chip->ndma <= 0)
+		return FALSE;
+
+	dev = search_device(chip->name, DEVICE_TYPE_DMACHIP);
+	if(!dev)
+		return FALSE;
+
+	for(i = 0; i < chip->ndma; i++)
+	{
+		if(chip->channel[i].busy && chip->stop)
+			chip->stop(chip, i);
+	}
+
+	if(!unregister_device(dev))
+		return FALSE;
+
+	kobj_remove_self(dev->kobj);
+	free(chip->channel);
+	free(dev->name);
+	free(dev);
+	return TRUE;
+}
+
+/*
+ * Called by the chip driver, usually from its interrupt handler, each time
+ * a descriptor has been fully transferred
+ */
+void dmachip_complete(struct dmachip_t * chip, int offset, struct dma_desc_t * desc)
+{
+	struct dma_channel_t * ch;
+
+	if(!chip || offset < 0 || offset >= chip->ndma || !desc)
+		return;
+
+	ch = &chip->channel[offset];
+	ch->bytes += desc->size;
+	if(ch->cyclic)
+	{
+		if(ch->complete)
+			ch->complete(ch, ch->data);
+	}
+	else if(!desc->next)
+	{
+		ch->transfers++;
+		ch->desc = NULL;
+		smp_wmb();
+		ch->busy = FALSE;
+		if(ch->complete)
+			ch->complete(ch, ch->data);
+	}
+}
+
+struct dma_desc_t * dma_desc_alloc(unsigned long dst, unsigned long src, size_t size, int width, int flags)
+{
+	struct dma_desc_t * desc;
+
+	if(size <= 0)
+		return NULL;
+
+	if(width != 1 && width != 2 && width != 4 && width != 8)
+		return NULL;
+
+	if(size & (width - 1))
+		return NULL;
+
+	desc = malloc(sizeof(struct dma_desc_t));
+	if(!desc)
+		return NULL;
+
+	desc->next = NULL;
+	desc->src = src;
+	desc->dst = dst;
+	desc->size = size;
+	desc->width = width;
+	desc->flags = flags;
+	return desc;
+}
+
+struct dma_desc_t * dma_desc_chain(struct dma_desc_t * head, struct dma_desc_t * desc)
+{
+	struct dma_desc_t * d;
+
+	if(!head)
+		return desc;
+
+	for(d = head; d->next; d = d->next);
+	d->next = desc;
+	return head;
+}
+
+void dma_desc_free(struct dma_desc_t * desc)
+{
+	struct dma_desc_t * head = desc, * next;
+
+	while(desc)
+	{
+		next = desc->next;
+		free(desc);
+		if(next == head)
+			break;
+		desc = next;
+	}
+}
+
+struct dma_desc_t * dma_prep_memcpy(void * dst, const void * src, size_t size)
+{
+	unsigned long a = (unsigned long)dst | (unsigned long)src | size;
+	int width;
+
+	if(!(a & 0x7))
+		width = 8;
+	else if(!(a & 0x3))
+		width = 4;
+	else if(!(a & 0x1))
+		width = 2;
+	else
+		width = 1;
+	return dma_desc_alloc((unsigned long)dst, (unsigned long)src, size, width, 0);
+}
+
+struct dma_desc_t * dma_prep_slave(unsigned long addr, void * buf, size_t size, int dir, int width)
+{
+	struct dma_sg_t sg = { buf, size };
+	return dma_prep_slave_sg(addr, &sg, 1, dir, width);
+}
+
+struct dma_desc_t * dma_prep_slave_sg(unsigned long addr, struct dma_sg_t * sg, int nsg, int dir, int width)
+{
+	struct dma_desc_t * head = NULL, * desc;
+	int i;
+
+	if(!sg || nsg <= 0)
+		return NULL;
+
+	for(i = 0; i < nsg; i++)
+	{
+		if(dir == DMA_TO_DEVICE)
+			desc = dma_desc_alloc(addr, (unsigned long)sg[i].buf, sg[i].size, width, DMA_DST_FIXED);
+		else if(dir == DMA_FROM_DEVICE)
+			desc = dma_desc_alloc((unsigned long)sg[i].buf, addr, sg[i].size, width, DMA_SRC_FIXED);
+		else
+			desc = NULL;
+		if(!desc)
+		{
+			dma_desc_free(head);
+			return NULL;
+		}
+		head = dma_desc_chain(head, desc);
+	}
+	return head;
+}
+
+struct dma_desc_t * dma_prep_cyclic(unsigned long addr, void * buf, size_t size, size_t period, int dir, int width)
+{
+	struct dma_desc_t * head, * d;
+	struct dma_sg_t * sg;
+	int nsg, i;
+
+	if(period <= 0 || size < period || (size % period))
+		return NULL;
+
+	nsg = size / period;
+	sg = malloc(sizeof(struct dma_sg_t) * nsg);
+	if(!sg)
+		return NULL;
+	for(i = 0; i < nsg; i++)
+	{
+		sg[i].buf = (char *)buf + i * period;
+		sg[i].size = period;
+	}
+	head = dma_prep_slave_sg(addr, sg, nsg, dir, width);
+	free(sg);
+
+	if(head)
+	{
+		for(d = head; d->next; d = d->next);
+		d->next = head;
+	}
+	return head;
+}
+
+int dma_is_valid(int dma)
+{
+	return search_dmachip(dma) ? 1 : 0;
+}
+
+struct dma_channel_t * dma_request(int dma)
+{
+	struct dmachip_t * chip = search_dmachip(dma);
+	struct dma_channel_t * ch = NULL;
+	irq_flags_t flags;
+
+	if(chip)
+	{
+		spin_lock_irqsave(&chip->lock, flags);
+		if(!chip->channel[dma - chip->base].used)
+		{
+			ch = &chip->channel[dma - chip->base];
+			ch->used = TRUE;
+		}
+		spin_unlock_irqrestore(&chip->lock, flags);
+	}
+	return ch;
+}
+
+/*
+ * The name is a dmachip device name, optionally followed by ':' and the
+ * channel offset, without an offset the first free channel is taken
+ */
+struct dma_channel_t * dma_request_by_name(const char * name)
+{
+	struct dmachip_t * chip;
+	struct device_t * dev;
+	char buf[64];
+	char * p;
+	int i;
+
+	if(!name)
+		return NULL;
+
+	strlcpy(buf, name, sizeof(buf));
+	p = strchr(buf, ':');
+	if(p)
+		*p++ = '\0';
+
+	dev = search_device(buf, DEVICE_TYPE_DMACHIP);
+	if(!dev)
+		return NULL;
+	chip = (struct dmachip_t *)dev->priv;
+
+	if(p)
+	{
+		i = strtol(p, NULL, 0);
+		if(i < 0 || i >= chip->ndma)
+			return NULL;
+		return dma_request(chip->base + i);
+	}
+
+	for(i = 0; i < chip->ndma; i++)
+	{
+		if(!chip->channel[i].used)
+		{
+			if(dma_request(chip->base + i))
+				return &chip->channel[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+ * A device tree property names the channel either by its global number or
+ * by a dmachip name, like "dma-tx": 3 or "dma-tx": "dma-soft.0:3"
+ */
+struct dma_channel_t * dma_request_dt(struct dtnode_t * n, const char * name)
+{
+	char * s = dt_read_string(n, name, NULL);
+
+	if(s)
+		return dma_request_by_name(s);
+	return dma_request(dt_read_int(n, name, -1));
+}
+
+void dma_release(struct dma_channel_t * ch)
+{
+	irq_flags_t flags;
+
+	if(ch && ch->used)
+	{
+		dma_stop(ch);
+		spin_lock_irqsave(&ch->chip->lock, flags);
+		ch->used = FALSE;
+		ch->complete = NULL;
+		ch->data = NULL;
+		spin_unlock_irqrestore(&ch->chip->lock, flags);
+	}
+}
+
+/*
+ * A chain either ends or loops back to its head, a loop is found with
+ * Floyd's walk so a chain looping anywhere else can not hang the scan.
+ * Returns 0 for a chain which ends, 1 for a loop to the head, otherwise -1
+ */
+static int dma_desc_loop(struct dma_desc_t * desc)
+{
+	struct dma_desc_t * slow = desc, * fast = desc, * d;
+
+	while(fast && fast->next)
+	{
+		slow = slow->next;
+		fast = fast->next->next;
+		if(slow == fast)
+		{
+			d = slow;
+			do {
+				if(d == desc)
+					return 1;
+				d = d->next;
+			} while(d != slow);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+bool_t dma_submit(struct dma_channel_t * ch, struct dma_desc_t * desc, void (*complete)(struct dma_channel_t *, void *), void * data)
+{
+	struct dmachip_t * chip;
+	irq_flags_t flags;
+	bool_t cyclic;
+	int loop;
+
+	if(!ch || !ch->used || !desc)
+		return FALSE;
+
+	loop = dma_desc_loop(desc);
+	if(loop < 0)
+		return FALSE;
+	cyclic = (loop > 0) ? TRUE : FALSE;
+
+	chip = ch->chip;
+	spin_lock_irqsave(&chip->lock, flags);
+	if(ch->busy)
+	{
+		spin_unlock_irqrestore(&chip->lock, flags);
+		return FALSE;
+	}
+	ch->busy = TRUE;
+	ch->cyclic = cyclic;
+	ch->desc = desc;
+	ch->complete = complete;
+	ch->data = data;
+	spin_unlock_irqrestore(&chip->lock, flags);
+
+	if(!chip->start(chip, ch->offset, desc))
+	{
+		ch->desc = NULL;
+		ch->busy = FALSE;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+void dma_stop(struct dma_channel_t * ch)
+{
+	if(ch && ch->busy)
+	{
+		if(ch->chip->stop)
+			ch->chip->stop(ch->chip, ch->offset);
+		ch->desc = NULL;
+		ch->cyclic = FALSE;
+		smp_wmb();
+		ch->busy = FALSE;
+	}
+}
+
+bool_t dma_is_busy(struct dma_channel_t * ch)
+{
+	return (ch && ch->busy) ? TRUE : FALSE;
+}
+
+bool_t dma_wait(struct dma_channel_t * ch, int timeout)
+{
+	ktime_t t = ktime_add_ms(ktime_get(), timeout);
+
+	if(!ch)
+		return FALSE;
+
+	while(ch->busy && !ch->cyclic)
+	{
+		if(ktime_after(ktime_get(), t))
+			return FALSE;
+	}
+	smp_rmb();
+	return ch->busy ? FALSE : TRUE;
+}
+
+static struct dma_channel_t * dma_request_memcpy(void)
+{
+	struct device_t * pos, * n;
+	struct dmachip_t * chip;
+	int i;
+
+	list_for_each_entry_safe(pos, n, &__device_head[DEVICE_TYPE_DMACHIP], head)
+	{
+		chip = (struct dmachip_t *)(pos->priv);
+		for(i = 0; i < chip->ndma; i++)
+		{
+			if(!chip->channel[i].used && dma_request(chip->base + i))
+				return &chip->channel[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Build the descriptor for a copy or a fill, a fill repeats the pattern
+ * word from a fixed source address
+ */
+static struct dma_desc_t * dma_prep_copy(void * dst, const void * src, u64_t * pattern, size_t size)
+{
+	struct dma_desc_t * desc;
+
+	if(pattern)
+	{
+		dma_cache_sync(pattern, sizeof(u64_t), DMA_TO_DEVICE);
+		desc = dma_desc_alloc((unsigned long)dst, (unsigned long)pattern, size, 8, DMA_SRC_FIXED);
+	}
+	else
+	{
+		dma_cache_sync((void *)src, size, DMA_TO_DEVICE);
+		desc = dma_prep_memcpy(dst, src, size);
+	}
+	if(desc)
+		dma_cache_sync(dst, size, DMA_BIDIRECTIONAL);
+	return desc;
+}
+
+static bool_t dma_copy_sync(void * dst, const void * src, u64_t * pattern, size_t size)
+{
+	struct dma_channel_t * ch;
+	struct dma_desc_t * desc;
+	bool_t ret = FALSE;
+
+	ch = dma_request_memcpy();
+	if(!ch)
+		return FALSE;
+
+	desc = dma_prep_copy(dst, src, pattern, size);
+	if(desc)
+	{
+		if(dma_submit(ch, desc, NULL, NULL))
+		{
+			if(dma_wait(ch, 1000))
+				ret = TRUE;
+			else
+				dma_stop(ch);
+		}
+		dma_cache_sync(dst, size, DMA_FROM_DEVICE);
+		dma_desc_free(desc);
+	}
+	dma_release(ch);
+	return ret;
+}
+
+void * dma_memcpy(void * dst, const void * src, size_t size)
+{
+	if((size < CONFIG_DMA_MEMCPY_THRESHOLD) || !dma_copy_sync(dst, src, NULL, size))
+		memcpy(dst, src, size);
+	return dst;
+}
+
+/*
+ * The unaligned head and tail are filled by the cpu, the dma engine fills
+ * the aligned middle with 64 bits writes
+ */
+void * dma_memset(void * dst, int c, size_t size)
+{
+	unsigned long s = (unsigned long)dst;
+	unsigned long a = (s + 7) & ~0x7UL;
+	unsigned long e = (s + size) & ~0x7UL;
+	u64_t pattern;
+
+	if((size < CONFIG_DMA_MEMCPY_THRESHOLD) || (e <= a))
+		return memset(dst, c, size);
+
+	pattern = (u8_t)c * 0x0101010101010101ULL;
+	if(!dma_copy_sync((void *)a, NULL, &pattern, e - a))
+		return memset(dst, c, size);
+	memset(dst, c, a - s);
+	memset((void *)e, c, s + size - e);
+	return dst;
+}
+
+struct dma_copy_t {
+	struct dma_desc_t * desc;
+	void * dst;
+	size_t size;
+	u64_t pattern;
+	void (*complete)(void * data);
+	void * data;
+};
+
+static void dma_copy_complete(struct dma_channel_t * ch, void * data)
+{
+	struct dma_copy_t * cp = (struct dma_copy_t *)data;
+
+	dma_cache_sync(cp->dst, cp->size, DMA_FROM_DEVICE);
+	dma_desc_free(cp->desc);
+	dma_release(ch);
+	if(cp->complete)
+		cp->complete(cp->data);
+	free(cp);
+}
+
+static bool_t dma_copy_async(void * dst, const void * src, bool_t fill, u64_t pattern, size_t size, void (*complete)(void *), void * data)
+{
+	struct dma_channel_t * ch;
+	struct dma_copy_t * cp;
+
+	cp = malloc(sizeof(struct dma_copy_t));
+	if(!cp)
+		return FALSE;
+
+	ch = dma_request_memcpy();
+	if(!ch)
+	{
+		free(cp);
+		return FALSE;
+	}
+
+	cp->dst = dst;
+	cp->size = size;
+	cp->pattern = pattern;
+	cp->complete = complete;
+	cp->data = data;
+	cp->desc = dma_prep_copy(dst, src, fill ? &cp->pattern : NULL, size);
+	if(!cp->desc || !dma_submit(ch, cp->desc, dma_copy_complete, cp))
+	{
+		dma_desc_free(cp->desc);
+		dma_release(ch);
+		free(cp);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * Returns TRUE if the copy has been queued to a dma channel, otherwise it
+ * has already been done by the cpu. The completion is called either way
+ */
+bool_t dma_memcpy_async(void * dst, const void * src, size_t size, void (*complete)(void *), void * data)
+{
+	if((size >= CONFIG_DMA_MEMCPY_THRESHOLD) && dma_copy_async(dst, src, FALSE, 0, size, complete, data))
+		return TRUE;
+
+	memcpy(dst, src, size);
+	if(complete)
+		complete(data);
+	return FALSE;
+}
+
+bool_t dma_memset_async(void * dst, int c, size_t size, void (*complete)(void *), void * data)
+{
+	unsigned long s = (unsigned long)dst;
+	unsigned long a = (s + 7) & ~0x7UL;
+	unsigned long e = (s + size) & ~0x7UL;
+
+	if((size >= CONFIG_DMA_MEMCPY_THRESHOLD) && (e > a))
+	{
+		memset(dst, c, a - s);
+		memset((void *)e, c, s + size - e);
+		if(dma_copy_async((void *)a, NULL, TRUE, (u8_t)c * 0x0101010101010101ULL, e - a, complete, data))
+			return TRUE;
+		memset((void *)a, c, e - a);
+	}
+	else
+	{
+		memset(dst, c, size);
+	}
+	if(complete)
+		complete(data);
+	return FALSE;
+}
+
 static void * __dma_pool = NULL;
 
 void * dma_alloc_coherent(unsigned long size)
@@ -180,3 +180,75 @@ int i2c_master_recv(const struct i2c_device_t * dev, void * buf, int count)
 	ret = i2c_transfer(dev->i2c, &msg, 1);
 	return (ret == 1) ? count : ret;
 }
+
+/*
+ * A register read, the write and the read share one transfer with a
+ * repeated start, returning zero or negative like the spi one
+ */
+int i2c_device_write_then_read(const struct i2c_device_t * dev, void * txbuf, int txlen, void * rxbuf, int rxlen)
+{
+	struct i2c_xfer_t x;
+
+	i2c_xfer_init(&x, dev);
+	if(txlen > 0)
+		i2c_xfer_write(&x, txbuf, txlen);
+	if(rxlen > 0)
+		i2c_xfer_read(&x, rxbuf, rxlen);
+	return (i2c_xfer_commit(&x) < 0) ? -1 : 0;
+}
+
+void i2c_xfer_init(struct i2c_xfer_t * x, const struct i2c_device_t * dev)
+{
+	if(x)
+	{
+		x->dev = dev;
+		x->num = 0;
+		x->len = 0;
+	}
+}
+
+static bool_t i2c_xfer_add(struct i2c_xfer_t * x, void * buf, int len, int flags)
+{
+	struct i2c_msg_t * msg;
+
+	if(!x || !x->dev || (len <= 0) || (x->num >= I2C_XFER_MAX_MSGS))
+		return FALSE;
+
+	msg = &x->msgs[x->num++];
+	msg->addr = x->dev->addr;
+	msg->flags = (x->dev->flags & I2C_M_TEN) | flags;
+	msg->len = len;
+	msg->buf = buf;
+	x->len += len;
+	return TRUE;
+}
+
+bool_t i2c_xfer_write(struct i2c_xfer_t * x, void * buf, int len)
+{
+	return i2c_xfer_add(x, buf, len, 0);
+}
+
+bool_t i2c_xfer_read(struct i2c_xfer_t * x, void * buf, int len)
+{
+	return i2c_xfer_add(x, buf, len, I2C_M_RD);
+}
+
+/*
+ * Issue the queued messages as one bus transaction, returning the total
+ * length or negative, the queue is emptied either way
+ */
+int i2c_xfer_commit(struct i2c_xfer_t * x)
+{
+	int ret;
+
+	if(!x || !x->dev)
+		return -1;
+	if(x->num == 0)
+		return 0;
+
+	ret = i2c_transfer(x->dev->i2c, x->msgs, x->num);
+	ret = (ret == x->num) ? x->len : -1;
+	x->num = 0;
+	x->len = 0;
+	return ret;
+}
@@ -27,6 +27,32 @@
 #include <gpio/gpio.h>
 #include <input/input.h>
 #include <input/keyboard.h>
+#include <input/scan.h>
+
+/*
+ * Adc Keys - A resistor ladder sampled by the shared input scan engine
+ *
+ * Required properties:
+ * - adc-name: adc device name
+ * - keys: array of { min-voltage, max-voltage, key-code }
+ *
+ * Optional properties:
+ * - adc-channel: adc channel, default is 0
+ * - poll-interval-ms: scan interval, default is 100
+ * - debounce-ms: time a key must be stable before reported, default is 0
+ *
+ * Example:
+ *   "key-adc@0": {
+ *       "adc-name": "adc-rk3128.0",
+ *       "adc-channel": 1,
+ *       "poll-interval-ms": 20,
+ *       "debounce-ms": 40,
+ *       "keys": [
+ *           { "min-voltage": 0, "max-voltage": 100000, "key-code": 11 },
+ *           { "min-voltage": 200000, "max-voltage": 400000, "key-code": 10 }
+ *       ]
+ *   }
+ */
 
 struct adc_key_t {
 	int min;
@@ -35,13 +61,13 @@ struct adc_key_t {
 };
 
 struct key_adc_pdata_t {
-	struct timer_t timer;
+	struct input_scan_t scan;
 	struct adc_t * adc;
 	struct adc_key_t * keys;
 	int nkeys;
 	int channel;
-	int interval;
-	int keyold;
+	int samples;
+	struct input_debounce_t debounce;
 };
 
 static int key_adc_get_keycode(struct key_adc_pdata_t * pdat)
@@ -49,7 +75,7 @@ static int key_adc_get_keycode(struct key_adc_pdata_t * pdat)
 	int voltage;
 	int i;
 
-	voltage = adc_read_voltage(pdat->adc, pdat->channel);
+	voltage = input_scan_adc_voltage(pdat->adc, pdat->channel);
 	for(i = 0; i < pdat->nkeys; i++)
 	{
 		if((voltage >= pdat->keys[i].min) && (voltage < pdat->keys[i].max))
@@ -58,37 +84,24 @@ static int key_adc_get_keycode(struct key_adc_pdata_t * pdat)
 	return 0;
 }
 
-static int key_adc_timer_function(struct timer_t * timer, void * data)
+/*
+ * The ladder only reports one key at a time, a direct change from one key
+ * to another is reported as a release followed by a press
+ */
+static int key_adc_scan(struct input_scan_t * s)
 {
-	struct input_t * input = (struct input_t *)(data);
+	struct input_t * input = (struct input_t *)(s->priv);
 	struct key_adc_pdata_t * pdat = (struct key_adc_pdata_t *)input->priv;
-	int keynew = key_adc_get_keycode(pdat);
+	int keyold = pdat->debounce.state;
 
-	if(keynew != pdat->keyold)
+	if(input_debounce(&pdat->debounce, key_adc_get_keycode(pdat), pdat->samples))
 	{
-		if(pdat->keyold == 0)
-		{
-			push_event_key_down(input, keynew);
-			pdat->keyold = keynew;
-		}
-		else if(keynew == 0)
-		{
-			push_event_key_up(input, pdat->keyold);
-			pdat->keyold = keynew;
-		}
-		else if((pdat->keyold != 0) && (keynew != 0))
-		{
-			push_event_key_up(input, pdat->keyold);
-			pdat->keyold = 0;
-		}
-		else
-		{
-			pdat->keyold = keynew;
-		}
+		if(keyold != 0)
+			push_event_key_up(input, keyold);
+		if(pdat->debounce.state != 0)
+			push_event_key_down(input, pdat->debounce.state);
 	}
-
-	timer_forward_now(timer, ms_to_ktime(pdat->interval));
-	return 1;
+	return pdat->debounce.state | pdat->debounce.count;
 }
 
 static int key_adc_ioctl(struct input_t * input, int cmd, void * arg)
@@ -139,24 +152,31 @@ static struct device_t * key_adc_probe(struct driver_t * drv, struct dtnode_t *
 		keys[i].keycode = dt_read_int(&o, "key-code", 0);
 	}
 
-	timer_init(&pdat->timer, key_adc_timer_function, input);
 	pdat->adc = adc;
 	pdat->keys = keys;
 	pdat->nkeys = nkeys;
 	pdat->channel = dt_read_int(n, "adc-channel", 0);
-	pdat->interval = dt_read_int(n, "poll-interval-ms", 100);
-	pdat->keyold = 0;
+	pdat->scan.interval = dt_read_int(n, "poll-interval-ms", 100);
+	if(pdat->scan.interval <= 0)
+		pdat->scan.interval = 1;
+	pdat->scan.wakeup = FALSE;
+	pdat->scan.scan = key_adc_scan;
+	pdat->scan.priv = input;
+	pdat->samples = dt_read_int(n, "debounce-ms", 0) / pdat->scan.interval + 1;
+	pdat->debounce.state = 0;
+	pdat->debounce.value = 0;
+	pdat->debounce.count = 0;
 
 	input->name = alloc_device_name(dt_read_name(n), dt_read_id(n));
 	input->type = INPUT_TYPE_KEYBOARD;
 	input->ioctl = key_adc_ioctl;
 	input->priv = pdat;
 
-	timer_start_now(&pdat->timer, ms_to_ktime(pdat->interval));
+	register_input_scan(&pdat->scan);
 
 	if(!register_input(&dev, input))
 	{
-		timer_cancel(&pdat->timer);
+		unregister_input_scan(&pdat->scan);
 		free(pdat->keys);
 
 		free_device_name(input->name);
@@ -176,7 +196,7 @@ static void key_adc_remove(struct device_t * dev)
 
 	if(input && unregister_input(input))
 	{
-		timer_cancel(&pdat->timer);
+		unregister_input_scan(&pdat->scan);
 		free(pdat->keys);
 
 		free_device_name(input->name);
@@ -190,7 +210,7 @@ static void key_adc_suspend(struct device_t * dev)
 	struct input_t * input = (struct input_t *)dev->priv;
 	struct key_adc_pdata_t * pdat = (struct key_adc_pdata_t *)input->priv;
 
-	timer_cancel(&pdat->timer);
+	unregister_input_scan(&pdat->scan);
 }
 
 static void key_adc_resume(struct device_t * dev)
@@ -198,7 +218,7 @@ static void key_adc_resume(struct device_t * dev)
 	struct input_t * input = (struct input_t *)dev->priv;
 	struct key_adc_pdata_t * pdat = (struct key_adc_pdata_t *)input->priv;
 
-	timer_start_now(&pdat->timer, ms_to_ktime(pdat->interval));
+	register_input_scan(&pdat->scan);
 }
 
 static struct driver_t key_adc = {
@@ -0,0 +1,334 @@
+/*
+ * driver/input/key-gpio-matrix.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <xboot.h>
+#include <gpio/gpio.h>
+#include <interrupt/interrupt.h>
+#include <input/input.h>
+#include <input/keyboard.h>
+#include <input/scan.h>
+
+/*
+ * Gpio Key Matrix - Rows selected one at a time, columns read back
+ *
+ * Required properties:
+ * - row-gpios: array of row gpios, a selected row is driven low
+ * - col-gpios: array of column gpios, at most 32, read low when a key is down
+ * - keys: array of { row, col, key-code }
+ *
+ * Optional properties:
+ * - poll-interval-ms: scan interval, default is 20
+ * - debounce-ms: time a key must be stable before reported, default is 20
+ * - settle-us: delay between selecting a row and reading the columns, default is 5
+ *
+ * When every column gpio has an interrupt, all rows are selected while the
+ * keypad is idle and a falling column wakes the scan up, otherwise the
+ * matrix is polled.
+ *
+ * Example:
+ *   "key-gpio-matrix@0": {
+ *       "row-gpios": [ 10, 11 ],
+ *       "col-gpios": [ 12, 13, 14 ],
+ *       "keys": [
+ *           { "row": 0, "col": 0, "key-code": 48 },
+ *           { "row": 0, "col": 1, "key-code": 49 },
+ *           { "row": 1, "col": 2, "key-code": 53 }
+ *       ],
+ *       "poll-interval-ms": 20,
+ *       "debounce-ms": 20
+ *   }
+ */
+
+struct matrix_key_t {
+	int row;
+	int col;
+	int keycode;
+	struct input_debounce_t debounce;
+};
+
+struct key_gpio_matrix_pdata_t {
+	struct input_scan_t scan;
+	int * rows;
+	int nrows;
+	int * cols;
+	int * irqs;
+	int ncols;
+	u32_t * state;
+	struct matrix_key_t * keys;
+	int nkeys;
+	int samples;
+	int settle;
+};
+
+static void key_gpio_matrix_select_all(struct key_gpio_matrix_pdata_t * pdat, int select)
+{
+	int i;
+
+	for(i = 0; i < pdat->nrows; i++)
+	{
+		if(select)
+			gpio_direction_output(pdat->rows[i], 0);
+		else
+			gpio_direction_input(pdat->rows[i]);
+	}
+}
+
+static int key_gpio_matrix_scan(struct input_scan_t * s)
+{
+	struct input_t * input = (struct input_t *)(s->priv);
+	struct key_gpio_matrix_pdata_t * pdat = (struct key_gpio_matrix_pdata_t *)input->priv;
+	struct matrix_key_t * key;
+	int r, c, down, active = 0;
+
+	/*
+	 * Unselected rows float, two keys down in one column never short a
+	 * driven row against another
+	 */
+	key_gpio_matrix_select_all(pdat, 0);
+	for(r = 0; r < pdat->nrows; r++)
+	{
+		gpio_direction_output(pdat->rows[r], 0);
+		udelay(pdat->settle);
+		pdat->state[r] = 0;
+		for(c = 0; c < pdat->ncols; c++)
+		{
+			if(!gpio_get_value(pdat->cols[c]))
+				pdat->state[r] |= (1U << c);
+		}
+		gpio_direction_input(pdat->rows[r]);
+	}
+
+	for(r = 0; r < pdat->nkeys; r++)
+	{
+		key = &pdat->keys[r];
+		down = (pdat->state[key->row] >> key->col) & 0x1;
+		if(input_debounce(&key->debounce, down, pdat->samples))
+		{
+			if(key->debounce.state)
+				push_event_key_down(input, key->keycode);
+			else
+				push_event_key_up(input, key->keycode);
+		}
+		active |= key->debounce.state | key->debounce.count;
+	}
+
+	if(!active && pdat->scan.wakeup)
+		key_gpio_matrix_select_all(pdat, 1);
+	return active;
+}
+
+static void key_gpio_matrix_interrupt(void * data)
+{
+	struct input_t * input = (struct input_t *)(data);
+	struct key_gpio_matrix_pdata_t * pdat = (struct key_gpio_matrix_pdata_t *)input->priv;
+
+	input_scan_kick(&pdat->scan);
+}
+
+static int key_gpio_matrix_ioctl(struct input_t * input, int cmd, void * arg)
+{
+	return -1;
+}
+
+static void key_gpio_matrix_free(struct key_gpio_matrix_pdata_t * pdat)
+{
+	free(pdat->rows);
+	free(pdat->cols);
+	free(pdat->irqs);
+	free(pdat->state);
+	free(pdat->keys);
+	free(pdat);
+}
+
+static struct device_t * key_gpio_matrix_probe(struct driver_t * drv, struct dtnode_t * n)
+{
+	struct key_gpio_matrix_pdata_t * pdat;
+	struct input_t * input;
+	struct device_t * dev;
+	struct dtnode_t o;
+	int nrows, ncols, nkeys, i;
+
+	nrows = dt_read_array_length(n, "row-gpios");
+	ncols = dt_read_array_length(n, "col-gpios");
+	nkeys = dt_read_array_length(n, "keys");
+	if(nrows <= 0 || ncols <= 0 || ncols > 32 || nkeys <= 0)
+		return NULL;
+
+	pdat = malloc(sizeof(struct key_gpio_matrix_pdata_t));
+	if(!pdat)
+		return NULL;
+	memset(pdat, 0, sizeof(struct key_gpio_matrix_pdata_t));
+
+	pdat->rows = malloc(sizeof(int) * nrows);
+	pdat->cols = malloc(sizeof(int) * ncols);
+	pdat->irqs = malloc(sizeof(int) * ncols);
+	pdat->state = malloc(sizeof(u32_t) * nrows);
+	pdat->keys = malloc(sizeof(struct matrix_key_t) * nkeys);
+	if(!pdat->rows || !pdat->cols || !pdat->irqs || !pdat->state || !pdat->keys)
+	{
+		key_gpio_matrix_free(pdat);
+		return NULL;
+	}
+
+	input = malloc(sizeof(struct input_t));
+	if(!input)
+	{
+		key_gpio_matrix_free(pdat);
+		return NULL;
+	}
+
+	pdat->nrows = nrows;
+	for(i = 0; i < nrows; i++)
+	{
+		pdat->rows[i] = dt_read_array_int(n, "row-gpios", i, -1);
+		gpio_set_pull(pdat->rows[i], GPIO_PULL_NONE);
+		gpio_direction_input(pdat->rows[i]);
+		pdat->state[i] = 0;
+	}
+
+	pdat->ncols = ncols;
+	pdat->scan.wakeup = TRUE;
+	for(i = 0; i < ncols; i++)
+	{
+		pdat->cols[i] = dt_read_array_int(n, "col-gpios", i, -1);
+		pdat->irqs[i] = gpio_to_irq(pdat->cols[i]);
+		gpio_set_pull(pdat->cols[i], GPIO_PULL_UP);
+		gpio_direction_input(pdat->cols[i]);
+		if(!irq_is_valid(pdat->irqs[i]))
+			pdat->scan.wakeup = FALSE;
+	}
+
+	pdat->nkeys = 0;
+	for(i = 0; i < nkeys; i++)
+	{
+		dt_read_array_object(n, "keys", i, &o);
+		pdat->keys[pdat->nkeys].row = dt_read_int(&o, "row", -1);
+		pdat->keys[pdat->nkeys].col = dt_read_int(&o, "col", -1);
+		pdat->keys[pdat->nkeys].keycode = dt_read_int(&o, "key-code", 0);
+		pdat->keys[pdat->nkeys].debounce.state = 0;
+		pdat->keys[pdat->nkeys].debounce.value = 0;
+		pdat->keys[pdat->nkeys].debounce.count = 0;
+		if((pdat->keys[pdat->nkeys].row >= 0) && (pdat->keys[pdat->nkeys].row < nrows)
+				&& (pdat->keys[pdat->nkeys].col >= 0) && (pdat->keys[pdat->nkeys].col < ncols))
+			pdat->nkeys++;
+	}
+
+	pdat->scan.interval = dt_read_int(n, "poll-interval-ms", 20);
+	if(pdat->scan.interval <= 0)
+		pdat->scan.interval = 1;
+	pdat->scan.scan = key_gpio_matrix_scan;
+	pdat->scan.priv = input;
+	pdat->samples = dt_read_int(n, "debounce-ms", 20) / pdat->scan.interval + 1;
+	pdat->settle = dt_read_int(n, "settle-us", 5);
+
+	input->name = alloc_device_name(dt_read_name(n), dt_read_id(n));
+	input->type = INPUT_TYPE_KEYBOARD;
+	input->ioctl = key_gpio_matrix_ioctl;
+	input->priv = pdat;
+
+	if(pdat->scan.wakeup)
+	{
+		for(i = 0; i < ncols; i++)
+			request_irq(pdat->irqs[i], key_gpio_matrix_interrupt, IRQ_TYPE_EDGE_FALLING, input);
+	}
+	register_input_scan(&pdat->scan);
+
+	if(!register_input(&dev, input))
+	{
+		unregister_input_scan(&pdat->scan);
+		if(pdat->scan.wakeup)
+		{
+			for(i = 0; i < ncols; i++)
+				free_irq(pdat->irqs[i]);
+		}
+		key_gpio_matrix_select_all(pdat, 0);
+
+		free_device_name(input->name);
+		key_gpio_matrix_free(input->priv);
+		free(input);
+		return NULL;
+	}
+	dev->driver = drv;
+
+	return dev;
+}
+
+static void key_gpio_matrix_remove(struct device_t * dev)
+{
+	struct input_t * input = (struct input_t *)dev->priv;
+	struct key_gpio_matrix_pdata_t * pdat = (struct key_gpio_matrix_pdata_t *)input->priv;
+	int i;
+
+	if(input && unregister_input(input))
+	{
+		unregister_input_scan(&pdat->scan);
+		if(pdat->scan.wakeup)
+		{
+			for(i = 0; i < pdat->ncols; i++)
+				free_irq(pdat->irqs[i]);
+		}
+		key_gpio_matrix_select_all(pdat, 0);
+
+		free_device_name(input->name);
+		key_gpio_matrix_free(input->priv);
+		free(input);
+	}
+}
+
+static void key_gpio_matrix_suspend(struct device_t * dev)
+{
+	struct input_t * input = (struct input_t *)dev->priv;
+	struct key_gpio_matrix_pdata_t * pdat = (struct key_gpio_matrix_pdata_t *)input->priv;
+
+	unregister_input_scan(&pdat->scan);
+}
+
+static void key_gpio_matrix_resume(struct device_t * dev)
+{
+	struct input_t * input = (struct input_t *)dev->priv;
+	struct key_gpio_matrix_pdata_t * pdat = (struct key_gpio_matrix_pdata_t *)input->priv;
+
+	register_input_scan(&pdat->scan);
+}
+
+static struct driver_t key_gpio_matrix = {
+	.name		= "key-gpio-matrix",
+	.probe		= key_gpio_matrix_probe,
+	.remove		= key_gpio_matrix_remove,
+	.suspend	= key_gpio_matrix_suspend,
+	.resume		= key_gpio_matrix_resume,
+};
+
+static __init void key_gpio_matrix_driver_init(void)
+{
+	register_driver(&key_gpio_matrix);
+}
+
+static __exit void key_gpio_matrix_driver_exit(void)
+{
+	unregister_driver(&key_gpio_matrix);
+}
+
+driver_initcall(key_gpio_matrix_driver_init);
+driver_exitcall(key_gpio_matrix_driver_exit);
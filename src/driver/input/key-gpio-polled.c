@@ -24,51 +24,80 @@
 
 #include <xboot.h>
 #include <gpio/gpio.h>
+#include <interrupt/interrupt.h>
 #include <input/input.h>
 #include <input/keyboard.h>
+#include <input/scan.h>
+
+/*
+ * Gpio Keys - Sampled by the shared input scan engine
+ *
+ * Required properties:
+ * - keys: array of { gpio, gpio-config, active-low, key-code }
+ *
+ * Optional properties:
+ * - poll-interval-ms: scan interval, default is 100
+ * - debounce-ms: time a key must be stable before reported, default is 0
+ *
+ * When every key gpio has an interrupt, scanning stops while all keys are
+ * released and an edge wakes it up again, otherwise the keys are polled.
+ *
+ * Example:
+ *   "key-gpio-polled@0": {
+ *       "keys": [
+ *           { "gpio": 5, "active-low": true, "key-code": 146 },
+ *           { "gpio": 6, "active-low": true, "key-code": 159 }
+ *       ],
+ *       "poll-interval-ms": 20,
+ *       "debounce-ms": 40
+ *   }
+ */
 
 struct gpio_key_t {
 	int gpio;
 	int gpiocfg;
+	int irq;
 	int active_low;
 	int keycode;
-	int state;
+	struct input_debounce_t debounce;
 };
 
 struct key_gpio_polled_pdata_t {
-	struct timer_t timer;
+	struct input_scan_t scan;
 	struct gpio_key_t * keys;
 	int nkeys;
-	int interval;
+	int samples;
 };
 
-static int key_gpio_polled_timer_function(struct timer_t * timer, void * data)
+static int key_gpio_polled_scan(struct input_scan_t * s)
 {
-	struct input_t * input = (struct input_t *)(data);
+	struct input_t * input = (struct input_t *)(s->priv);
 	struct key_gpio_polled_pdata_t * pdat = (struct key_gpio_polled_pdata_t *)input->priv;
-	enum event_type_t type;
-	int i, val;
+	struct gpio_key_t * key;
+	int i, down, active = 0;
 
 	for(i = 0; i < pdat->nkeys; i++)
 	{
-		val = gpio_get_value(pdat->keys[i].gpio);
-		if(val != pdat->keys[i].state)
+		key = &pdat->keys[i];
+		down = (gpio_get_value(key->gpio) ? 1 : 0) ^ (key->active_low ? 1 : 0);
+		if(input_debounce(&key->debounce, down, pdat->samples))
 		{
-			if(pdat->keys[i].active_low)
-				type = val ? EVENT_TYPE_KEY_UP : EVENT_TYPE_KEY_DOWN;
+			if(key->debounce.state)
+				push_event_key_down(input, key->keycode);
 			else
-				type = val ? EVENT_TYPE_KEY_DOWN : EVENT_TYPE_KEY_UP;
-
-			if(type == EVENT_TYPE_KEY_DOWN)
-				push_event_key_down(input, pdat->keys[i].keycode);
-			else if(type == EVENT_TYPE_KEY_UP)
-				push_event_key_up(input, pdat->keys[i].keycode);
+				push_event_key_up(input, key->keycode);
 		}
-		pdat->keys[i].state = val;
+		active |= key->debounce.state | key->debounce.count;
 	}
+	return active;
+}
 
-	timer_forward_now(timer, ms_to_ktime(pdat->interval));
-	return 1;
+static void key_gpio_polled_interrupt(void * data)
+{
+	struct input_t * input = (struct input_t *)(data);
+	struct key_gpio_polled_pdata_t * pdat = (struct key_gpio_polled_pdata_t *)input->priv;
+
+	input_scan_kick(&pdat->scan);
 }
 
 static int key_gpio_polled_ioctl(struct input_t * input, int cmd, void * arg)
@@ -107,11 +136,13 @@ static struct device_t * key_gpio_polled_probe(struct driver_t * drv, struct dtn
 		return NULL;
 	}
 
+	pdat->scan.wakeup = TRUE;
 	for(i = 0; i < nkeys; i++)
 	{
 		dt_read_array_object(n, "keys", i, &o);
 		keys[i].gpio = dt_read_int(&o, "gpio", -1);
 		keys[i].gpiocfg = dt_read_int(&o, "gpio-config", -1);
+		keys[i].irq = gpio_to_irq(keys[i].gpio);
 		keys[i].active_low = dt_read_bool(&o, "active-low", 0);
 		keys[i].keycode = dt_read_int(&o, "key-code", 0);
 
@@ -119,24 +150,42 @@ static struct device_t * key_gpio_polled_probe(struct driver_t * drv, struct dtn
 			gpio_set_cfg(keys[i].gpio, keys[i].gpiocfg);
 		gpio_set_pull(keys[i].gpio, keys[i].active_low ? GPIO_PULL_UP : GPIO_PULL_DOWN);
 		gpio_direction_input(keys[i].gpio);
-		keys[i].state = gpio_get_value(keys[i].gpio);
+		keys[i].debounce.state = (gpio_get_value(keys[i].gpio) ? 1 : 0) ^ (keys[i].active_low ? 1 : 0);
+		keys[i].debounce.value = keys[i].debounce.state;
+		keys[i].debounce.count = 0;
+		if(!irq_is_valid(keys[i].irq))
+			pdat->scan.wakeup = FALSE;
 	}
 
-	timer_init(&pdat->timer, key_gpio_polled_timer_function, input);
 	pdat->keys = keys;
 	pdat->nkeys = nkeys;
-	pdat->interval = dt_read_int(&o, "poll-interval-ms", 100);
+	pdat->scan.interval = dt_read_int(n, "poll-interval-ms", 100);
+	if(pdat->scan.interval <= 0)
+		pdat->scan.interval = 1;
+	pdat->samples = dt_read_int(n, "debounce-ms", 0) / pdat->scan.interval + 1;
+	pdat->scan.scan = key_gpio_polled_scan;
+	pdat->scan.priv = input;
 
 	input->name = alloc_device_name(dt_read_name(n), dt_read_id(n));
 	input->type = INPUT_TYPE_KEYBOARD;
 	input->ioctl = key_gpio_polled_ioctl;
 	input->priv = pdat;
 
-	timer_start_now(&pdat->timer, ms_to_ktime(pdat->interval));
+	if(pdat->scan.wakeup)
+	{
+		for(i = 0; i < nkeys; i++)
+			request_irq(keys[i].irq, key_gpio_polled_interrupt, IRQ_TYPE_EDGE_BOTH, input);
+	}
+	register_input_scan(&pdat->scan);
 
 	if(!register_input(&dev, input))
 	{
-		timer_cancel(&pdat->timer);
+		unregister_input_scan(&pdat->scan);
+		if(pdat->scan.wakeup)
+		{
+			for(i = 0; i < nkeys; i++)
+				free_irq(keys[i].irq);
+		}
 		free(pdat->keys);
 
 		free_device_name(input->name);
@@ -154,9 +203,16 @@ static void key_gpio_polled_remove(struct device_t * dev)
 	struct input_t * input = (struct input_t *)dev->priv;
 	struct key_gpio_polled_pdata_t * pdat = (struct key_gpio_polled_pdata_t *)input->priv;
 
+	int i;
+
 	if(input && unregister_input(input))
 	{
-		timer_cancel(&pdat->timer);
+		unregister_input_scan(&pdat->scan);
+		if(pdat->scan.wakeup)
+		{
+			for(i = 0; i < pdat->nkeys; i++)
+				free_irq(pdat->keys[i].irq);
+		}
 		free(pdat->keys);
 
 		free_device_name(input->name);
@@ -170,7 +226,7 @@ static void key_gpio_polled_suspend(struct device_t * dev)
 	struct input_t * input = (struct input_t *)dev->priv;
 	struct key_gpio_polled_pdata_t * pdat = (struct key_gpio_polled_pdata_t *)input->priv;
 
-	timer_cancel(&pdat->timer);
+	unregister_input_scan(&pdat->scan);
 }
 
 static void key_gpio_polled_resume(struct device_t * dev)
@@ -178,7 +234,7 @@ static void key_gpio_polled_resume(struct device_t * dev)
 	struct input_t * input = (struct input_t *)dev->priv;
 	struct key_gpio_polled_pdata_t * pdat = (struct key_gpio_polled_pdata_t *)input->priv;
 
-	timer_start_now(&pdat->timer, ms_to_ktime(pdat->interval));
+	register_input_scan(&pdat->scan);
 }
 
 static struct driver_t key_gpio_polled = {
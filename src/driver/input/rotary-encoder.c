@@ -47,6 +47,37 @@
 #include <interrupt/interrupt.h>
 #include <input/input.h>
 #include <input/keyboard.h>
+#include <input/scan.h>
+
+/*
+ * Rotary Encoder - Quadrature encoder with an optional push switch
+ *
+ * Required properties:
+ * - gpio-a: channel a gpio
+ * - gpio-b: channel b gpio
+ *
+ * Optional properties:
+ * - gpio-c: push switch gpio
+ * - inverted-a, inverted-b, inverted-c: invert the gpio level
+ * - step-per-period: 1, 2 or 4, default is 1
+ * - poll-interval-ms: scan interval when polled, default is 1
+ * - debounce-ms: time the switch must be stable before reported, default is 2
+ *
+ * The channels are decoded from their interrupts, without interrupts they
+ * are polled by the shared input scan engine, which also debounces the
+ * switch.
+ *
+ * Example:
+ *   "rotary-encoder@0": {
+ *       "gpio-a": 2,
+ *       "gpio-b": 3,
+ *       "gpio-c": 4,
+ *       "inverted-a": false,
+ *       "inverted-b": false,
+ *       "inverted-c": false,
+ *       "step-per-period": 1
+ *   }
+ */
 
 struct rotary_encoder_pdata_t {
 	int gpio_a;
@@ -60,6 +91,11 @@ struct rotary_encoder_pdata_t {
 	int inverted_c;
 	int state;
 	int dir;
+	int polled;
+	int samples;
+	void (*handler)(void * data);
+	struct input_scan_t scan;
+	struct input_debounce_t debounce;
 };
 
 static int rotary_encoder_get_state(struct rotary_encoder_pdata_t * pdat)
@@ -161,21 +197,34 @@ static void rotary_encoder_quarter_period_irq(void * data)
 	push_event_rotary_turn(input, pdat->dir ? 1 : -1);
 }
 
+static int rotary_encoder_get_switch(struct rotary_encoder_pdata_t * pdat)
+{
+	return ((!!gpio_get_value(pdat->gpio_c)) ^ pdat->inverted_c) ? 0 : 1;
+}
+
+static int rotary_encoder_scan(struct input_scan_t * s)
+{
+	struct input_t * input = (struct input_t *)s->priv;
+	struct rotary_encoder_pdata_t * pdat = (struct rotary_encoder_pdata_t *)input->priv;
+
+	if(pdat->polled)
+		pdat->handler(input);
+
+	if(gpio_is_valid(pdat->gpio_c))
+	{
+		if(input_debounce(&pdat->debounce, rotary_encoder_get_switch(pdat), pdat->samples))
+			push_event_rotary_switch(input, pdat->debounce.state);
+		return pdat->debounce.count;
+	}
+	return 0;
+}
+
 static void rotary_encoder_gpio_c_irq(void * data)
 {
 	struct input_t * input = (struct input_t *)data;
 	struct rotary_encoder_pdata_t * pdat = (struct rotary_encoder_pdata_t *)input->priv;
-	int c1, c2, c3;
 
-	do {
-		c1 = !!gpio_get_value(pdat->gpio_c);
-		mdelay(1);
-		c2 = !!gpio_get_value(pdat->gpio_c);
-		mdelay(1);
-		c3 = !!gpio_get_value(pdat->gpio_c);
-	} while((c1 != c2) || (c1 != c3));
-
-	push_event_rotary_switch(input, (c1 ^ pdat->inverted_c) ? 0 : 1);
+	input_scan_kick(&pdat->scan);
 }
 
 static int rotary_encoder_ioctl(struct input_t * input, int cmd, void * arg)
@@ -193,9 +242,7 @@ static struct device_t * rotary_encoder_probe(struct driver_t * drv, struct dtno
 	gpio_a = dt_read_int(n, "gpio-a", -1);
 	gpio_b = dt_read_int(n, "gpio-b", -1);
 
-	if(!gpio_is_valid(gpio_a) || !gpio_is_valid(gpio_b)
-			|| !irq_is_valid(gpio_to_irq(gpio_a))
-			|| !irq_is_valid(gpio_to_irq(gpio_b)))
+	if(!gpio_is_valid(gpio_a) || !gpio_is_valid(gpio_b))
 		return NULL;
 
 	pdat = malloc(sizeof(struct rotary_encoder_pdata_t));
@@ -218,6 +265,15 @@ static struct device_t * rotary_encoder_probe(struct driver_t * drv, struct dtno
 	pdat->inverted_a = dt_read_bool(n, "inverted-a", 0);
 	pdat->inverted_b = dt_read_bool(n, "inverted-b", 0);
 	pdat->inverted_c = dt_read_bool(n, "inverted-c", 0);
+	pdat->polled = (!irq_is_valid(pdat->irq_a) || !irq_is_valid(pdat->irq_b)) ? 1 : 0;
+	pdat->scan.interval = dt_read_int(n, "poll-interval-ms", 1);
+	if(pdat->scan.interval <= 0)
+		pdat->scan.interval = 1;
+	pdat->scan.wakeup = (!pdat->polled && (!gpio_is_valid(pdat->gpio_c) || irq_is_valid(pdat->irq_c))) ? TRUE : FALSE;
+	pdat->scan.scan = rotary_encoder_scan;
+	pdat->scan.priv = input;
+	init_list_head(&pdat->scan.list);
+	pdat->samples = dt_read_int(n, "debounce-ms", 2) / pdat->scan.interval + 1;
 
 	input->name = alloc_device_name(dt_read_name(n), dt_read_id(n));
 	input->type = INPUT_TYPE_ROTARY;
@@ -232,41 +288,54 @@ static struct device_t * rotary_encoder_probe(struct driver_t * drv, struct dtno
 	switch(dt_read_int(n, "step-per-period", 1))
 	{
 	case 4:
-		request_irq(pdat->irq_a, rotary_encoder_quarter_period_irq, IRQ_TYPE_EDGE_BOTH, input);
-		request_irq(pdat->irq_b, rotary_encoder_quarter_period_irq, IRQ_TYPE_EDGE_BOTH, input);
+		pdat->handler = rotary_encoder_quarter_period_irq;
 		pdat->state = rotary_encoder_get_state(pdat);
 		break;
 
 	case 2:
-		request_irq(pdat->irq_a, rotary_encoder_half_period_irq, IRQ_TYPE_EDGE_BOTH, input);
-		request_irq(pdat->irq_b, rotary_encoder_half_period_irq, IRQ_TYPE_EDGE_BOTH, input);
+		pdat->handler = rotary_encoder_half_period_irq;
 		pdat->state = rotary_encoder_get_state(pdat);
 		break;
 
 	case 1:
-		request_irq(pdat->irq_a, rotary_encoder_irq, IRQ_TYPE_EDGE_BOTH, input);
-		request_irq(pdat->irq_b, rotary_encoder_irq, IRQ_TYPE_EDGE_BOTH, input);
+		pdat->handler = rotary_encoder_irq;
 		pdat->state = 0;
 		break;
 
 	default:
-		request_irq(pdat->irq_a, rotary_encoder_irq, IRQ_TYPE_EDGE_BOTH, input);
-		request_irq(pdat->irq_b, rotary_encoder_irq, IRQ_TYPE_EDGE_BOTH, input);
+		pdat->handler = rotary_encoder_irq;
 		pdat->state = 0;
 		break;
 	}
 
-	if(gpio_is_valid(pdat->gpio_c) && irq_is_valid(pdat->irq_c))
+	if(!pdat->polled)
+	{
+		request_irq(pdat->irq_a, pdat->handler, IRQ_TYPE_EDGE_BOTH, input);
+		request_irq(pdat->irq_b, pdat->handler, IRQ_TYPE_EDGE_BOTH, input);
+	}
+
+	if(gpio_is_valid(pdat->gpio_c))
 	{
 		gpio_set_pull(pdat->gpio_c, pdat->inverted_c ? GPIO_PULL_DOWN : GPIO_PULL_UP);
 		gpio_direction_input(pdat->gpio_c);
-		request_irq(pdat->irq_c, rotary_encoder_gpio_c_irq, IRQ_TYPE_EDGE_BOTH, input);
+		pdat->debounce.state = rotary_encoder_get_switch(pdat);
+		pdat->debounce.value = pdat->debounce.state;
+		pdat->debounce.count = 0;
+		if(irq_is_valid(pdat->irq_c))
+			request_irq(pdat->irq_c, rotary_encoder_gpio_c_irq, IRQ_TYPE_EDGE_BOTH, input);
 	}
 
+	if(pdat->polled || gpio_is_valid(pdat->gpio_c))
+		register_input_scan(&pdat->scan);
+
 	if(!register_input(&dev, input))
 	{
-		free_irq(pdat->irq_a);
-		free_irq(pdat->irq_b);
+		unregister_input_scan(&pdat->scan);
+		if(!pdat->polled)
+		{
+			free_irq(pdat->irq_a);
+			free_irq(pdat->irq_b);
+		}
 		if(gpio_is_valid(pdat->gpio_c) && irq_is_valid(pdat->irq_c))
 			free_irq(pdat->irq_c);
 
@@ -287,8 +356,12 @@ static void rotary_encoder_remove(struct device_t * dev)
 
 	if(input && unregister_input(input))
 	{
-		free_irq(pdat->irq_a);
-		free_irq(pdat->irq_b);
+		unregister_input_scan(&pdat->scan);
+		if(!pdat->polled)
+		{
+			free_irq(pdat->irq_a);
+			free_irq(pdat->irq_b);
+		}
 		if(gpio_is_valid(pdat->gpio_c) && irq_is_valid(pdat->irq_c))
 			free_irq(pdat->irq_c);
 
@@ -303,8 +376,12 @@ static void rotary_encoder_suspend(struct device_t * dev)
 	struct input_t * input = (struct input_t *)dev->priv;
 	struct rotary_encoder_pdata_t * pdat = (struct rotary_encoder_pdata_t *)input->priv;
 
-	disable_irq(pdat->irq_a);
-	disable_irq(pdat->irq_b);
+	unregister_input_scan(&pdat->scan);
+	if(!pdat->polled)
+	{
+		disable_irq(pdat->irq_a);
+		disable_irq(pdat->irq_b);
+	}
 	if(gpio_is_valid(pdat->gpio_c) && irq_is_valid(pdat->irq_c))
 		disable_irq(pdat->irq_c);
 }
@@ -314,10 +391,15 @@ static void rotary_encoder_resume(struct device_t * dev)
 	struct input_t * input = (struct input_t *)dev->priv;
 	struct rotary_encoder_pdata_t * pdat = (struct rotary_encoder_pdata_t *)input->priv;
 
-	enable_irq(pdat->irq_a);
-	enable_irq(pdat->irq_b);
+	if(!pdat->polled)
+	{
+		enable_irq(pdat->irq_a);
+		enable_irq(pdat->irq_b);
+	}
 	if(gpio_is_valid(pdat->gpio_c) && irq_is_valid(pdat->irq_c))
 		enable_irq(pdat->irq_c);
+	if(pdat->polled || gpio_is_valid(pdat->gpio_c))
+		register_input_scan(&pdat->scan);
 }
 
 static struct driver_t rotary_encoder = {
@@ -0,0 +1,206 @@
+/*
+ * driver/input/scan.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <input/scan.h>
+
+struct input_scan_adc_t {
+	struct adc_t * adc;
+	int channel;
+	int tick;
+	int voltage;
+};
+
+static struct list_head __input_scan_list = {
+	.next = &__input_scan_list,
+	.prev = &__input_scan_list,
+};
+static spinlock_t __input_scan_lock = SPIN_LOCK_INIT();
+static struct timer_t __input_scan_timer;
+static struct input_scan_adc_t __input_scan_adc[8];
+static int __input_scan_tick = 0;
+
+/*
+ * One timer for all polled sources, the sources due are sampled in a single
+ * pass and the timer is rearmed for the earliest next one. Idle sources with
+ * an interrupt on change are parked until kicked, with nothing left to scan
+ * the timer stops.
+ */
+static int input_scan_timer_function(struct timer_t * timer, void * data)
+{
+	struct input_scan_t * pos, * n;
+	ktime_t now = ktime_get();
+	ktime_t next = now;
+	bool_t pending = FALSE;
+
+	__input_scan_tick++;
+	list_for_each_entry_safe(pos, n, &__input_scan_list, list)
+	{
+		if(pos->parked || ktime_before(now, pos->next))
+			continue;
+		if(!pos->scan(pos) && pos->wakeup)
+			pos->parked = TRUE;
+		else
+			pos->next = ktime_add_ms(now, pos->interval);
+	}
+
+	list_for_each_entry_safe(pos, n, &__input_scan_list, list)
+	{
+		if(pos->parked)
+			continue;
+		if(!pending || ktime_before(pos->next, next))
+			next = pos->next;
+		pending = TRUE;
+	}
+
+	if(pending)
+	{
+		timer_forward(timer, next, ms_to_ktime(0));
+		return 1;
+	}
+	return 0;
+}
+
+static void input_scan_start(void)
+{
+	if(__input_scan_timer.state != TIMER_STATE_CALLBACK)
+		timer_start_now(&__input_scan_timer, ms_to_ktime(0));
+}
+
+bool_t register_input_scan(struct input_scan_t * s)
+{
+	irq_flags_t flags;
+
+	if(!s || !s->scan)
+		return FALSE;
+
+	if(s->interval <= 0)
+		s->interval = 1;
+	s->next = ktime_get();
+	s->parked = FALSE;
+
+	spin_lock_irqsave(&__input_scan_lock, flags);
+	list_add_tail(&s->list, &__input_scan_list);
+	spin_unlock_irqrestore(&__input_scan_lock, flags);
+	input_scan_start();
+
+	return TRUE;
+}
+
+bool_t unregister_input_scan(struct input_scan_t * s)
+{
+	irq_flags_t flags;
+
+	if(!s || list_empty(&s->list))
+		return FALSE;
+
+	spin_lock_irqsave(&__input_scan_lock, flags);
+	list_del_init(&s->list);
+	spin_unlock_irqrestore(&__input_scan_lock, flags);
+	if(list_empty(&__input_scan_list))
+		timer_cancel(&__input_scan_timer);
+
+	return TRUE;
+}
+
+/*
+ * Called from the interrupt on change of a parked source
+ */
+void input_scan_kick(struct input_scan_t * s)
+{
+	if(s && s->parked)
+	{
+		s->next = ktime_get();
+		s->parked = FALSE;
+		input_scan_start();
+	}
+}
+
+/*
+ * Several sources on the same adc channel, like key ladders split across
+ * devices, share one conversion per scan pass
+ */
+int input_scan_adc_voltage(struct adc_t * adc, int channel)
+{
+	struct input_scan_adc_t * a;
+	int i;
+
+	for(i = 0; i < ARRAY_SIZE(__input_scan_adc); i++)
+	{
+		a = &__input_scan_adc[i];
+		if((a->adc == adc) && (a->channel == channel) && (a->tick == __input_scan_tick))
+			return a->voltage;
+	}
+
+	a = &__input_scan_adc[__input_scan_tick % ARRAY_SIZE(__input_scan_adc)];
+	for(i = 0; i < ARRAY_SIZE(__input_scan_adc); i++)
+	{
+		if(__input_scan_adc[i].tick != __input_scan_tick)
+		{
+			a = &__input_scan_adc[i];
+			break;
+		}
+	}
+	a->adc = adc;
+	a->channel = channel;
+	a->tick = __input_scan_tick;
+	a->voltage = adc_read_voltage(adc, channel);
+	return a->voltage;
+}
+
+/*
+ * A new value is accepted after it has been sampled the given number of
+ * times in a row, returns non zero when the debounced state changes
+ */
+int input_debounce(struct input_debounce_t * d, int value, int samples)
+{
+	if(value == d->state)
+	{
+		d->count = 0;
+		return 0;
+	}
+
+	if((d->count == 0) || (value != d->value))
+	{
+		d->value = value;
+		d->count = 1;
+	}
+	else
+	{
+		d->count++;
+	}
+
+	if(d->count >= samples)
+	{
+		d->state = value;
+		d->count = 0;
+		return 1;
+	}
+	return 0;
+}
+
+static __init void input_scan_init(void)
+{
+	timer_init(&__input_scan_timer, input_scan_timer_function, NULL);
+}
+core_initcall(input_scan_init);
@@ -24,6 +24,8 @@
 
 #include <interrupt/interrupt.h>
 
+static void * __interrupt_regs = NULL;
+
 static void null_interrupt_function(void * data)
 {
 }
@@ -242,15 +244,23 @@ void disable_irq(int irq)
 		chip->disable(chip, irq - chip->base);
 }
 
+void * interrupt_get_regs(void)
+{
+	return __interrupt_regs;
+}
+
 void interrupt_handle_exception(void * regs)
 {
 	struct device_t * pos, * n;
 	struct irqchip_t * chip;
+	void * saved = __interrupt_regs;
 
+	__interrupt_regs = regs;
 	list_for_each_entry_safe(pos, n, &__device_head[DEVICE_TYPE_IRQCHIP], head)
 	{
 		chip = (struct irqchip_t *)(pos->priv);
 		if(chip->dispatch)
 			chip->dispatch(chip);
 	}
+	__interrupt_regs = saved;
 }
@@ -92,6 +92,28 @@ int spi_transfer(struct spi_t * spi, struct spi_msg_t * msg)
 	return spi->transfer(spi, msg);
 }
 
+/*
+ * Run the messages back to back, returning the total length or negative
+ */
+int spi_transfer_msgs(struct spi_t * spi, struct spi_msg_t * msgs, int num)
+{
+	int i, len = 0;
+
+	if(!spi || !msgs || (num <= 0))
+		return 0;
+
+	if(spi->transfer_msgs)
+		return spi->transfer_msgs(spi, msgs, num);
+
+	for(i = 0; i < num; i++)
+	{
+		if(spi->transfer(spi, &msgs[i]) != msgs[i].len)
+			return -1;
+		len += msgs[i].len;
+	}
+	return len;
+}
+
 void spi_select(struct spi_t * spi, int cs)
 {
 	if(spi && spi->select)
@@ -133,31 +155,38 @@ void spi_device_free(struct spi_device_t * dev)
 
 int spi_device_write_then_read(struct spi_device_t * dev, void * txbuf, int txlen, void * rxbuf, int rxlen)
 {
-	struct spi_msg_t msg;
+	struct spi_msg_t msgs[2];
+	int num = 0, i;
 
 	if(!dev)
 		return -1;
 
-	msg.mode = dev->mode;
-	msg.bits = dev->bits;
-	msg.speed = dev->speed;
-
 	if(txlen > 0)
 	{
-		msg.txbuf = txbuf;
-		msg.rxbuf = NULL;
-		msg.len = txlen;
-		if(dev->spi->transfer(dev->spi, &msg) != txlen)
-			return -1;
+		msgs[num].txbuf = txbuf;
+		msgs[num].rxbuf = NULL;
+		msgs[num].len = txlen;
+		num++;
 	}
 	if(rxlen > 0)
 	{
-		msg.txbuf = NULL;
-		msg.rxbuf = rxbuf;
-		msg.len = rxlen;
-		if(dev->spi->transfer(dev->spi, &msg) != rxlen)
-			return -1;
+		msgs[num].txbuf = NULL;
+		msgs[num].rxbuf = rxbuf;
+		msgs[num].len = rxlen;
+		num++;
+	}
+	if(num == 0)
+		return 0;
+
+	for(i = 0; i < num; i++)
+	{
+		msgs[i].mode = dev->mode;
+		msgs[i].bits = dev->bits;
+		msgs[i].speed = dev->speed;
 	}
+
+	if(spi_transfer_msgs(dev->spi, msgs, num) != txlen + rxlen)
+		return -1;
 	return 0;
 }
 
@@ -172,3 +201,64 @@ void spi_device_deselect(struct spi_device_t * dev)
 	if(dev && dev->spi && dev->spi->deselect)
 		dev->spi->deselect(dev->spi, dev->cs);
 }
+
+void spi_xfer_init(struct spi_xfer_t * x, struct spi_device_t * dev)
+{
+	if(x)
+	{
+		x->dev = dev;
+		x->num = 0;
+		x->len = 0;
+	}
+}
+
+bool_t spi_xfer_duplex(struct spi_xfer_t * x, void * txbuf, void * rxbuf, int len)
+{
+	struct spi_msg_t * msg;
+
+	if(!x || !x->dev || (len <= 0) || (x->num >= SPI_XFER_MAX_MSGS))
+		return FALSE;
+
+	msg = &x->msgs[x->num++];
+	msg->txbuf = txbuf;
+	msg->rxbuf = rxbuf;
+	msg->len = len;
+	msg->mode = x->dev->mode;
+	msg->bits = x->dev->bits;
+	msg->speed = x->dev->speed;
+	x->len += len;
+	return TRUE;
+}
+
+bool_t spi_xfer_write(struct spi_xfer_t * x, void * buf, int len)
+{
+	return spi_xfer_duplex(x, buf, NULL, len);
+}
+
+bool_t spi_xfer_read(struct spi_xfer_t * x, void * buf, int len)
+{
+	return spi_xfer_duplex(x, NULL, buf, len);
+}
+
+/*
+ * Issue the queued segments in one go with the chip select held, returning
+ * the total length or negative, the queue is emptied either way
+ */
+int spi_xfer_commit(struct spi_xfer_t * x)
+{
+	int ret;
+
+	if(!x || !x->dev)
+		return -1;
+	if(x->num == 0)
+		return 0;
+
+	spi_device_select(x->dev);
+	ret = spi_transfer_msgs(x->dev->spi, x->msgs, x->num);
+	spi_device_deselect(x->dev);
+	if(ret != x->len)
+		ret = -1;
+	x->num = 0;
+	x->len = 0;
+	return ret;
+}
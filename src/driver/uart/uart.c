@@ -93,6 +93,67 @@ static ssize_t uart_write_stop(struct kobj_t * kobj, void * buf, size_t size)
 	return size;
 }
 
+static ssize_t uart_read_rxbytes(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct uart_t * uart = (struct uart_t *)kobj->priv;
+	return sprintf(buf, "%llu", uart->rxbytes);
+}
+
+static ssize_t uart_read_txbytes(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct uart_t * uart = (struct uart_t *)kobj->priv;
+	return sprintf(buf, "%llu", uart->txbytes);
+}
+
+static ssize_t uart_read_overrun(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct uart_t * uart = (struct uart_t *)kobj->priv;
+	return sprintf(buf, "%llu", uart->overrun);
+}
+
+static ssize_t uart_read_rxwm(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct uart_t * uart = (struct uart_t *)kobj->priv;
+	return sprintf(buf, "%d", uart->rxwm);
+}
+
+static ssize_t uart_write_rxwm(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct uart_t * uart = (struct uart_t *)kobj->priv;
+	int wm = strtol(buf, NULL, 0);
+	if(wm > 0)
+		uart->rxwm = wm;
+	return size;
+}
+
+static ssize_t uart_read_txwm(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct uart_t * uart = (struct uart_t *)kobj->priv;
+	return sprintf(buf, "%d", uart->txwm);
+}
+
+static ssize_t uart_write_txwm(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct uart_t * uart = (struct uart_t *)kobj->priv;
+	int wm = strtol(buf, NULL, 0);
+	if(wm > 0)
+		uart->txwm = wm;
+	return size;
+}
+
+static ssize_t uart_read_timeout(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct uart_t * uart = (struct uart_t *)kobj->priv;
+	return sprintf(buf, "%d", uart->timeout);
+}
+
+static ssize_t uart_write_timeout(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct uart_t * uart = (struct uart_t *)kobj->priv;
+	uart_set_mode(uart, uart->rxblock, uart->txblock, strtol(buf, NULL, 0));
+	return size;
+}
+
 struct uart_t * search_uart(const char * name)
 {
 	struct device_t * dev;
@@ -111,9 +172,38 @@ bool_t register_uart(struct device_t ** device, struct uart_t * uart)
 	if(!uart || !uart->name)
 		return FALSE;
 
+	uart->rxfifo = NULL;
+	uart->txfifo = NULL;
+	uart->txrefill = NULL;
+	uart->txrefill_data = NULL;
+	uart->rxblock = FALSE;
+	uart->txblock = TRUE;
+	uart->timeout = 0;
+	uart->rxwm = 1;
+	uart->txwm = CONFIG_UART_TX_RING_SIZE / 4;
+	uart->rxbytes = 0;
+	uart->txbytes = 0;
+	uart->overrun = 0;
+
+	if(uart->poll)
+	{
+		uart->rxfifo = fifo_alloc(CONFIG_UART_RX_RING_SIZE);
+		uart->txfifo = fifo_alloc(CONFIG_UART_TX_RING_SIZE);
+		if(!uart->rxfifo || !uart->txfifo)
+		{
+			fifo_free(uart->rxfifo);
+			fifo_free(uart->txfifo);
+			return FALSE;
+		}
+	}
+
 	dev = malloc(sizeof(struct device_t));
 	if(!dev)
+	{
+		fifo_free(uart->rxfifo);
+		fifo_free(uart->txfifo);
 		return FALSE;
+	}
 
 	dev->name = strdup(uart->name);
 	dev->type = DEVICE_TYPE_UART;
@@ -123,12 +213,20 @@ bool_t register_uart(struct device_t ** device, struct uart_t * uart)
 	kobj_add_regular(dev->kobj, "data", uart_read_data, uart_write_data, uart);
 	kobj_add_regular(dev->kobj, "parity", uart_read_parity, uart_write_parity, uart);
 	kobj_add_regular(dev->kobj, "stop", uart_read_stop, uart_write_stop, uart);
+	kobj_add_regular(dev->kobj, "rxbytes", uart_read_rxbytes, NULL, uart);
+	kobj_add_regular(dev->kobj, "txbytes", uart_read_txbytes, NULL, uart);
+	kobj_add_regular(dev->kobj, "overrun", uart_read_overrun, NULL, uart);
+	kobj_add_regular(dev->kobj, "rxwm", uart_read_rxwm, uart_write_rxwm, uart);
+	kobj_add_regular(dev->kobj, "txwm", uart_read_txwm, uart_write_txwm, uart);
+	kobj_add_regular(dev->kobj, "timeout", uart_read_timeout, uart_write_timeout, uart);
 
 	if(!register_device(dev))
 	{
 		kobj_remove_self(dev->kobj);
 		free(dev->name);
 		free(dev);
+		fifo_free(uart->rxfifo);
+		fifo_free(uart->txfifo);
 		return FALSE;
 	}
 
@@ -154,6 +252,10 @@ bool_t unregister_uart(struct uart_t * uart)
 	kobj_remove_self(dev->kobj);
 	free(dev->name);
 	free(dev);
+	fifo_free(uart->rxfifo);
+	fifo_free(uart->txfifo);
+	uart->rxfifo = NULL;
+	uart->txfifo = NULL;
 	return TRUE;
 }
 
@@ -171,16 +273,140 @@ bool_t uart_get(struct uart_t * uart, int * baud, int * data, int * parity, int
 	return FALSE;
 }
 
+static inline bool_t uart_expired(struct uart_t * uart, ktime_t timeout)
+{
+	return ((uart->timeout > 0) && ktime_after(ktime_get(), timeout)) ? TRUE : FALSE;
+}
+
+/*
+ * Buffered uarts read from the rx ring, a blocking read waits until the
+ * watermark or the whole count is there, whichever is smaller
+ */
 ssize_t uart_read(struct uart_t * uart, u8_t * buf, size_t count)
 {
-	if(uart && uart->read)
-		return uart->read(uart, buf, count);
-	return 0;
+	ktime_t timeout;
+	size_t want, len = 0;
+	ssize_t n;
+
+	if(!uart || !buf || (count == 0))
+		return 0;
+
+	if(!uart->rxfifo)
+	{
+		if(!uart->read)
+			return 0;
+		timeout = ktime_add_ms(ktime_get(), uart->timeout);
+		do {
+			n = uart->read(uart, buf + len, count - len);
+			if(n > 0)
+			{
+				len += n;
+				uart->rxbytes += n;
+			}
+		} while(uart->rxblock && (len < count) && (len < uart->rxwm) && !uart_expired(uart, timeout));
+		return len;
+	}
+
+	want = (uart->rxwm < count) ? uart->rxwm : count;
+	timeout = ktime_add_ms(ktime_get(), uart->timeout);
+	for(;;)
+	{
+		uart->poll(uart);
+		len += fifo_get(uart->rxfifo, buf + len, count - len);
+		if((len >= want) || !uart->rxblock || uart_expired(uart, timeout))
+			break;
+	}
+	return len;
 }
 
+/*
+ * Buffered uarts queue into the tx ring and kick the hardware, a blocking
+ * write waits for room of the watermark or the rest, whichever is smaller
+ */
 ssize_t uart_write(struct uart_t * uart, const u8_t * buf, size_t count)
 {
-	if(uart && uart->write)
-		return uart->write(uart, buf, count);
-	return 0;
+	ktime_t timeout;
+	size_t want, len = 0;
+	ssize_t n;
+
+	if(!uart || !buf || (count == 0))
+		return 0;
+
+	if(!uart->txfifo)
+	{
+		if(!uart->write)
+			return 0;
+		n = uart->write(uart, buf, count);
+		if(n > 0)
+			uart->txbytes += n;
+		return n;
+	}
+
+	timeout = ktime_add_ms(ktime_get(), uart->timeout);
+	for(;;)
+	{
+		len += fifo_put(uart->txfifo, (u8_t *)buf + len, count - len);
+		uart->poll(uart);
+		if((len >= count) || !uart->txblock || uart_expired(uart, timeout))
+			break;
+		want = (uart->txwm < count - len) ? uart->txwm : count - len;
+		while((uart->txfifo->size - fifo_avail(uart->txfifo) < want) && !uart_expired(uart, timeout))
+			uart->poll(uart);
+	}
+	return len;
+}
+
+void uart_set_mode(struct uart_t * uart, bool_t rxblock, bool_t txblock, int timeout)
+{
+	if(uart)
+	{
+		uart->rxblock = rxblock;
+		uart->txblock = txblock;
+		uart->timeout = (timeout > 0) ? timeout : 0;
+	}
+}
+
+/*
+ * Called by drivers from interrupt or dma completion context with received
+ * data, whatever does not fit in the rx ring is counted as overrun
+ */
+void uart_rx_push(struct uart_t * uart, const u8_t * buf, size_t count)
+{
+	size_t n;
+
+	if(uart && buf && (count > 0))
+	{
+		n = uart->rxfifo ? fifo_put(uart->rxfifo, (u8_t *)buf, count) : 0;
+		uart->rxbytes += n;
+		uart->overrun += count - n;
+	}
+}
+
+/*
+ * Called by drivers to fetch the next bytes to send, the tx ring goes
+ * first and the refill source after it. Returns zero once both are empty so
+ * the transmit interrupt can be masked
+ */
+size_t uart_tx_pull(struct uart_t * uart, u8_t * buf, size_t count)
+{
+	size_t n = 0;
+
+	if(uart && uart->txfifo && buf && (count > 0))
+	{
+		n = fifo_get(uart->txfifo, buf, count);
+		if((n < count) && uart->txrefill)
+			n += uart->txrefill(uart, buf + n, count - n, uart->txrefill_data);
+		uart->txbytes += n;
+	}
+	return n;
+}
+
+/*
+ * Restart the transmitter of a buffered uart after its refill source got
+ * new data, without waiting for it to go out
+ */
+void uart_tx_kick(struct uart_t * uart)
+{
+	if(uart && uart->poll)
+		uart->poll(uart);
 }
@@ -1132,6 +1132,7 @@ void luaC_step (lua_State *L) {
     luaE_setdebt(g, -GCSTEPSIZE * 10);  /* avoid being called too often */
     return;
   }
+  luai_gcbegin(L);
   do {  /* repeat until pause or enough "credit" (negative debt) */
     lu_mem work = singlestep(L);  /* perform one single step */
     debt -= work;
@@ -1143,6 +1144,7 @@ void luaC_step (lua_State *L) {
     luaE_setdebt(g, debt);
     runafewfinalizers(L);
   }
+  luai_gcend(L);
 }
 
 
@@ -1158,6 +1160,7 @@ void luaC_step (lua_State *L) {
 void luaC_fullgc (lua_State *L, int isemergency) {
   global_State *g = G(L);
   lua_assert(g->gckind == KGC_NORMAL);
+  luai_gcbegin(L);
   if (isemergency) g->gckind = KGC_EMERGENCY;  /* set flag */
   if (keepinvariant(g)) {  /* black objects? */
     entersweep(L); /* sweep everything to turn them back to white */
@@ -1171,6 +1174,7 @@ void luaC_fullgc (lua_State *L, int isemergency) {
   luaC_runtilstate(L, bitmask(GCSpause));  /* finish collection */
   g->gckind = KGC_NORMAL;
   setpause(g);
+  luai_gcend(L);
 }
 
 /* }====================================================== */
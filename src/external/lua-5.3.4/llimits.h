@@ -229,6 +229,14 @@ typedef unsigned long Instruction;
 ** LUAI_EXTRASPACE and need to do something extra when a thread is
 ** created/deleted/resumed/yielded.
 */
+#if !defined(luai_gcbegin)
+#define luai_gcbegin(L)		((void)L)
+#endif
+
+#if !defined(luai_gcend)
+#define luai_gcend(L)		((void)L)
+#endif
+
 #if !defined(luai_userstateopen)
 #define luai_userstateopen(L)		((void)L)
 #endif
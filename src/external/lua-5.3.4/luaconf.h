@@ -778,5 +778,11 @@
 #define lua_writeline()		(lua_writestring("\r\n", 2), fflush(stdout))
 #define l_signalT			int
 
+struct lua_State;
+void lprofiler_gc_begin(struct lua_State * L);
+void lprofiler_gc_end(struct lua_State * L);
+#define luai_gcbegin(L)		lprofiler_gc_begin(L)
+#define luai_gcend(L)		lprofiler_gc_end(L)
+
 #endif
 
@@ -25,6 +25,7 @@
 #include <cairo.h>
 #include <cairo-xboot.h>
 #include <framework/display/l-display.h>
+#include <framework/profiler/l-profiler.h>
 
 extern cairo_scaled_font_t * luaL_checkudata_scaled_font(lua_State * L, int ud, const char * tname);
 
@@ -297,9 +298,11 @@ static int m_display_present(lua_State * L)
 {
 	struct ldisplay_t * display = luaL_checkudata(L, 1, MT_DISPLAY);
 	cairo_t * cr;
+	lprofiler_phase(LPROFILER_PHASE_PRESENT);
 	if(display->showfps)
 	{
-		char buf[32];
+		struct lprofiler_frame_t f;
+		char buf[64];
 		ktime_t now = ktime_get();
 		s64_t delta = ktime_ms_delta(now, display->stamp);
 		if(delta > 0)
@@ -313,6 +316,14 @@ static int m_display_present(lua_State * L)
 		cairo_move_to(cr, 0, 24);
 		snprintf(buf, sizeof(buf), "%.2f %d", display->fps, display->frame);
 		cairo_show_text(cr, buf);
+		lprofiler_frame_last(&f);
+		cairo_set_font_size(cr, 16);
+		cairo_move_to(cr, 0, 44);
+		snprintf(buf, sizeof(buf), "e%.1f t%.1f d%.1f p%.1f gc%.1f ms",
+			(double)f.phase[LPROFILER_PHASE_DISPATCH] / 1000000.0, (double)f.phase[LPROFILER_PHASE_TIMERS] / 1000000.0,
+			(double)f.phase[LPROFILER_PHASE_DRAW] / 1000000.0, (double)f.phase[LPROFILER_PHASE_PRESENT] / 1000000.0,
+			(double)f.gc / 1000000.0);
+		cairo_show_text(cr, buf);
 		cairo_restore(cr);
 	}
 	cairo_xboot_surface_present(display->cs[display->index]);
@@ -323,6 +334,7 @@ static int m_display_present(lua_State * L)
 	cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
 	cairo_paint(cr);
 	cairo_restore(cr);
+	lprofiler_frame_commit();
 	return 0;
 }
 
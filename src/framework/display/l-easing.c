@@ -21,7 +21,6 @@
  * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  */
-
 #include <framework/display/l-display.h>
 
 /*
@@ -32,533 +31,330 @@
  * c = change value (ending - beginning)
  * d = duration (total time)
  * func = easing function will be invoked in 'easing' method
+ * vfunc = optional batched form, works in single precision
  */
+struct leasing_t;
+
+struct easing_type_t {
+	const char * name;
+	double (*func)(struct leasing_t * e, double t);
+	void (*vfunc)(struct leasing_t * e, float * r, const float * t, int n);
+};
+
 struct leasing_t {
 	double b;
 	double c;
 	double d;
-	int (*func)(lua_State *L);
+	const struct easing_type_t * type;
 };
 
-static int m_linear(lua_State * L);
-static int m_in_sine(lua_State * L);
-static int m_out_sine(lua_State * L);
-static int m_in_out_sine(lua_State * L);
-static int m_in_quad(lua_State * L);
-static int m_out_quad(lua_State * L);
-static int m_in_out_quad(lua_State * L);
-static int m_in_cubic(lua_State * L);
-static int m_out_cubic(lua_State * L);
-static int m_in_out_cubic(lua_State * L);
-static int m_in_quart(lua_State * L);
-static int m_out_quart(lua_State * L);
-static int m_in_out_quart(lua_State * L);
-static int m_in_quint(lua_State * L);
-static int m_out_quint(lua_State * L);
-static int m_in_out_quint(lua_State * L);
-static int m_in_expo(lua_State * L);
-static int m_out_expo(lua_State * L);
-static int m_in_out_expo(lua_State * L);
-static int m_in_circ(lua_State * L);
-static int m_out_circ(lua_State * L);
-static int m_in_out_circ(lua_State * L);
-static int m_in_back(lua_State * L);
-static int m_out_back(lua_State * L);
-static int m_in_out_back(lua_State * L);
-static int m_in_elastic(lua_State * L);
-static int m_out_elastic(lua_State * L);
-static int m_in_out_elastic(lua_State * L);
-static int m_in_bounce(lua_State * L);
-static int m_out_bounce(lua_State * L);
-static int m_in_out_bounce(lua_State * L);
-
-static int l_new(lua_State * L)
+static double easing_linear(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = lua_newuserdata(L, sizeof(struct leasing_t));
-	const char * type = luaL_optstring(L, 4, "linear");
-	e->b = luaL_optnumber(L, 1, 0);
-	e->c = luaL_optnumber(L, 2, 1);
-	e->d = luaL_optnumber(L, 3, 1);
-	if(strcmp(type, "linear") == 0)
-		e->func = m_linear;
-	else if(strcmp(type, "inSine") == 0)
-		e->func = m_in_sine;
-	else if(strcmp(type, "outSine") == 0)
-		e->func = m_out_sine;
-	else if(strcmp(type, "inOutSine") == 0)
-		e->func = m_in_out_sine;
-	else if(strcmp(type, "inQuad") == 0)
-		e->func = m_in_quad;
-	else if(strcmp(type, "outQuad") == 0)
-		e->func = m_out_quad;
-	else if(strcmp(type, "inOutQuad") == 0)
-		e->func = m_in_out_quad;
-	else if(strcmp(type, "inCubic") == 0)
-		e->func = m_in_cubic;
-	else if(strcmp(type, "outCubic") == 0)
-		e->func = m_out_cubic;
-	else if(strcmp(type, "inOutCubic") == 0)
-		e->func = m_in_out_cubic;
-	else if(strcmp(type, "inQuart") == 0)
-		e->func = m_in_quart;
-	else if(strcmp(type, "outQuart") == 0)
-		e->func = m_out_quart;
-	else if(strcmp(type, "inOutQuart") == 0)
-		e->func = m_in_out_quart;
-	else if(strcmp(type, "inQuint") == 0)
-		e->func = m_in_quint;
-	else if(strcmp(type, "outQuint") == 0)
-		e->func = m_out_quint;
-	else if(strcmp(type, "inOutQuint") == 0)
-		e->func = m_in_out_quint;
-	else if(strcmp(type, "inExpo") == 0)
-		e->func = m_in_expo;
-	else if(strcmp(type, "outExpo") == 0)
-		e->func = m_out_expo;
-	else if(strcmp(type, "inOutExpo") == 0)
-		e->func = m_in_out_expo;
-	else if(strcmp(type, "inCirc") == 0)
-		e->func = m_in_circ;
-	else if(strcmp(type, "outCirc") == 0)
-		e->func = m_out_circ;
-	else if(strcmp(type, "inOutCirc") == 0)
-		e->func = m_in_out_circ;
-	else if(strcmp(type, "inBack") == 0)
-		e->func = m_in_back;
-	else if(strcmp(type, "outBack") == 0)
-		e->func = m_out_back;
-	else if(strcmp(type, "inOutBack") == 0)
-		e->func = m_in_out_back;
-	else if(strcmp(type, "inElastic") == 0)
-		e->func = m_in_elastic;
-	else if(strcmp(type, "outElastic") == 0)
-		e->func = m_out_elastic;
-	else if(strcmp(type, "inOutElastic") == 0)
-		e->func = m_in_out_elastic;
-	else if(strcmp(type, "inBounce") == 0)
-		e->func = m_in_bounce;
-	else if(strcmp(type, "outBounce") == 0)
-		e->func = m_out_bounce;
-	else if(strcmp(type, "inOutBounce") == 0)
-		e->func = m_in_out_bounce;
-	else
-		e->func = m_linear;
-	luaL_setmetatable(L, MT_EASING);
-	return 1;
+	return e->c * t / e->d + e->b;
 }
 
-static const luaL_Reg l_easing[] = {
-	{"new", l_new},
-	{NULL, NULL}
-};
+static double easing_in_sine(struct leasing_t * e, double t)
+{
+	return -e->c * cos(t / e->d * M_PI_2) + e->c + e->b;
+}
 
-static int m_invoke_easing(lua_State * L)
+static void veasing_in_sine(struct leasing_t * e, float * r, const float * t, int n)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	return e->func(L);
+	float k = M_PI_2 / e->d;
+	int i;
+
+	for(i = 0; i < n; i++)
+		r[i] = t[i] * k;
+	vcosf(r, r, n);
+	for(i = 0; i < n; i++)
+		r[i] = -e->c * r[i] + e->c + e->b;
 }
 
-static int m_linear(lua_State * L)
+static double easing_out_sine(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r = e->c * t / e->d + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return e->c * sin(t / e->d * M_PI_2) + e->b;
 }
 
-static int m_in_sine(lua_State * L)
+static void veasing_out_sine(struct leasing_t * e, float * r, const float * t, int n)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r = -e->c * cos(t / e->d * M_PI_2) + e->c + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	float k = M_PI_2 / e->d;
+	int i;
+
+	for(i = 0; i < n; i++)
+		r[i] = t[i] * k;
+	vsinf(r, r, n);
+	for(i = 0; i < n; i++)
+		r[i] = e->c * r[i] + e->b;
 }
 
-static int m_out_sine(lua_State * L)
+static double easing_in_out_sine(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r = e->c * sin(t / e->d * M_PI_2) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return -e->c / 2 * (cos(M_PI * t / e->d) - 1) + e->b;
 }
 
-static int m_in_out_sine(lua_State * L)
+static void veasing_in_out_sine(struct leasing_t * e, float * r, const float * t, int n)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r = -e->c / 2 * (cos(M_PI * t / e->d) - 1) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	float k = M_PI / e->d;
+	int i;
+
+	for(i = 0; i < n; i++)
+		r[i] = t[i] * k;
+	vcosf(r, r, n);
+	for(i = 0; i < n; i++)
+		r[i] = -e->c / 2 * (r[i] - 1) + e->b;
 }
 
-static int m_in_quad(lua_State * L)
+static double easing_in_quad(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d;
-	r = e->c * pow(t, 2) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return e->c * t * t + e->b;
 }
 
-static int m_out_quad(lua_State * L)
+static double easing_out_quad(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d;
-	r = -e->c * t * (t - 2) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return -e->c * t * (t - 2) + e->b;
 }
 
-static int m_in_out_quad(lua_State * L)
+static double easing_in_out_quad(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d * 2;
 	if(t < 1)
-		r =  e->c / 2 * pow(t, 2) + e->b;
-	else
-		r = -e->c / 2 * ((t - 1) * (t - 3) - 1) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+		return e->c / 2 * t * t + e->b;
+	return -e->c / 2 * ((t - 1) * (t - 3) - 1) + e->b;
 }
 
-static int m_in_cubic(lua_State * L)
+static double easing_in_cubic(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d;
-	r = e->c * pow(t, 3) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return e->c * t * t * t + e->b;
 }
 
-static int m_out_cubic(lua_State * L)
+static double easing_out_cubic(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d - 1;
-	r = e->c * (pow(t, 3) + 1) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return e->c * (t * t * t + 1) + e->b;
 }
 
-static int m_in_out_cubic(lua_State * L)
+static double easing_in_out_cubic(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d * 2;
 	if(t < 1)
-		r =  e->c / 2 * pow(t, 3) + e->b;
-	else
-	{
-		t = t - 2;
-		r = e->c / 2 * (pow(t, 3) + 2) + e->b;
-	}
-	lua_pushnumber(L, r);
-	return 1;
+		return e->c / 2 * t * t * t + e->b;
+	t = t - 2;
+	return e->c / 2 * (t * t * t + 2) + e->b;
 }
 
-static int m_in_quart(lua_State * L)
+static double easing_in_quart(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d;
-	r = e->c * pow(t, 4) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return e->c * t * t * t * t + e->b;
 }
 
-static int m_out_quart(lua_State * L)
+static double easing_out_quart(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d - 1;
-	r = -e->c * (pow(t, 4) - 1) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return -e->c * (t * t * t * t - 1) + e->b;
 }
 
-static int m_in_out_quart(lua_State * L)
+static double easing_in_out_quart(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d * 2;
 	if(t < 1)
-		r =  e->c / 2 * pow(t, 4) + e->b;
-	else
-	{
-		t = t - 2;
-		r = -e->c / 2 * (pow(t, 4) - 2) + e->b;
-	}
-	lua_pushnumber(L, r);
-	return 1;
+		return e->c / 2 * t * t * t * t + e->b;
+	t = t - 2;
+	return -e->c / 2 * (t * t * t * t - 2) + e->b;
 }
 
-static int m_in_quint(lua_State * L)
+static double easing_in_quint(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d;
-	r = e->c * pow(t, 5) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return e->c * t * t * t * t * t + e->b;
 }
 
-static int m_out_quint(lua_State * L)
+static double easing_out_quint(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d - 1;
-	r = e->c * (pow(t, 5) + 1) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return e->c * (t * t * t * t * t + 1) + e->b;
 }
 
-static int m_in_out_quint(lua_State * L)
+static double easing_in_out_quint(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d * 2;
 	if(t < 1)
-		r = e->c / 2 * pow(t, 5) + e->b;
-	else
-	{
-		t = t - 2;
-		r = e->c / 2 * (pow(t, 5) + 2) + e->b;
-	}
-	lua_pushnumber(L, r);
-	return 1;
+		return e->c / 2 * t * t * t * t * t + e->b;
+	t = t - 2;
+	return e->c / 2 * (t * t * t * t * t + 2) + e->b;
 }
 
-static int m_in_expo(lua_State * L)
+static double easing_in_expo(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	if(t == 0)
-		r = e->b;
-	else
-		r = e->c * pow(2, 10 * (t / e->d - 1)) + e->b - e->c * 0.001;
-	lua_pushnumber(L, r);
-	return 1;
+		return e->b;
+	return e->c * exp2(10 * (t / e->d - 1)) + e->b - e->c * 0.001;
 }
 
-static int m_out_expo(lua_State * L)
+static void veasing_in_expo(struct leasing_t * e, float * r, const float * t, int n)
+{
+	int i;
+
+	for(i = 0; i < n; i++)
+		r[i] = 10 * (t[i] / e->d - 1);
+	vexp2f(r, r, n);
+	for(i = 0; i < n; i++)
+		r[i] = (t[i] == 0) ? e->b : e->c * r[i] + e->b - e->c * 0.001;
+}
+
+static double easing_out_expo(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	if(t == e->d)
-		r = e->b + e->c;
-	else
-		r = e->c * 1.001 * (-pow(2, -10 * t / e->d) + 1) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+		return e->b + e->c;
+	return e->c * 1.001 * (-exp2(-10 * t / e->d) + 1) + e->b;
 }
 
-static int m_in_out_expo(lua_State * L)
+static void veasing_out_expo(struct leasing_t * e, float * r, const float * t, int n)
+{
+	int i;
+
+	for(i = 0; i < n; i++)
+		r[i] = -10 * t[i] / e->d;
+	vexp2f(r, r, n);
+	for(i = 0; i < n; i++)
+		r[i] = (t[i] == e->d) ? e->b + e->c : e->c * 1.001 * (-r[i] + 1) + e->b;
+}
+
+static double easing_in_out_expo(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	if(t == 0)
-		r = e->b;
-	else if(t == e->d)
-		r = e->b + e->c;
-	else
+		return e->b;
+	if(t == e->d)
+		return e->b + e->c;
+	t = t / e->d * 2;
+	if(t < 1)
+		return e->c / 2 * exp2(10 * (t - 1)) + e->b - e->c * 0.0005;
+	t = t - 1;
+	return e->c / 2 * 1.0005 * (-exp2(-10 * t) + 2) + e->b;
+}
+
+static void veasing_in_out_expo(struct leasing_t * e, float * r, const float * t, int n)
+{
+	float x;
+	int i;
+
+	for(i = 0; i < n; i++)
 	{
-		t = t / e->d * 2;
-		if(t < 1)
-			r = e->c / 2 * pow(2, 10 * (t - 1)) + e->b - e->c * 0.0005;
+		x = t[i] / e->d * 2;
+		r[i] = (x < 1) ? 10 * (x - 1) : -10 * (x - 1);
+	}
+	vexp2f(r, r, n);
+	for(i = 0; i < n; i++)
+	{
+		if(t[i] == 0)
+			r[i] = e->b;
+		else if(t[i] == e->d)
+			r[i] = e->b + e->c;
+		else if(t[i] / e->d * 2 < 1)
+			r[i] = e->c / 2 * r[i] + e->b - e->c * 0.0005;
 		else
-		{
-			t = t - 1;
-			r = e->c / 2 * 1.0005 * (-pow(2, -10 * t) + 2) + e->b;
-		}
+			r[i] = e->c / 2 * 1.0005 * (-r[i] + 2) + e->b;
 	}
-	lua_pushnumber(L, r);
-	return 1;
 }
 
-static int m_in_circ(lua_State * L)
+static double easing_in_circ(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d;
-	r = -e->c * (sqrt(1 - pow(t, 2)) - 1) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return -e->c * (sqrt(1 - t * t) - 1) + e->b;
 }
 
-static int m_out_circ(lua_State * L)
+static double easing_out_circ(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d - 1;
-	r = e->c * sqrt(1 - pow(t, 2)) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return e->c * sqrt(1 - t * t) + e->b;
 }
 
-static int m_in_out_circ(lua_State * L)
+static double easing_in_out_circ(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
 	t = t / e->d * 2;
 	if(t < 1)
-		r = -e->c / 2 * (sqrt(1 - t * t) - 1) + e->b;
-	else
-	{
-		t = t - 2;
-		r = e->c / 2 * (sqrt(1 - t * t) + 1) + e->b;
-	}
-	lua_pushnumber(L, r);
-	return 1;
+		return -e->c / 2 * (sqrt(1 - t * t) - 1) + e->b;
+	t = t - 2;
+	return e->c / 2 * (sqrt(1 - t * t) + 1) + e->b;
 }
 
-static int m_in_back(lua_State * L)
+static double easing_in_back(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
 	double s = 1.70158;
-	double r;
 	t = t / e->d;
-	r = e->c * t * t * ((s + 1) * t - s) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return e->c * t * t * ((s + 1) * t - s) + e->b;
 }
 
-static int m_out_back(lua_State * L)
+static double easing_out_back(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
 	double s = 1.70158;
-	double r;
 	t = t / e->d - 1;
-	r = e->c * (t * t * ((s + 1) * t + s) + 1) + e->b;
-	lua_pushnumber(L, r);
-	return 1;
+	return e->c * (t * t * ((s + 1) * t + s) + 1) + e->b;
 }
 
-static int m_in_out_back(lua_State * L)
+static double easing_in_out_back(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double s = 1.70158;
-	double r;
-	s = s * 1.525;
+	double s = 1.70158 * 1.525;
 	t = t / e->d * 2;
 	if(t < 1)
-		r = e->c / 2 * (t * t * ((s + 1) * t - s)) + e->b;
-	else
-	{
-		t = t - 2;
-		r = e->c / 2 * (t * t * ((s + 1) * t + s) + 2) + e->b;
-	}
-	lua_pushnumber(L, r);
-	return 1;
+		return e->c / 2 * (t * t * ((s + 1) * t - s)) + e->b;
+	t = t - 2;
+	return e->c / 2 * (t * t * ((s + 1) * t + s) + 2) + e->b;
 }
 
-static int m_in_elastic(lua_State * L)
+static double easing_in_elastic(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
+	double p, s, a;
+
 	if(t == 0)
-		r = e->b;
-	else
-	{
-		t = t / e->d;
-		if(t == 1)
-			r = e->b + e->c;
-		else
-		{
-			double p = e->d * 0.3;
-			double s = p / 4;
-			double a = e->c;
-			t = t - 1;
-			r = -(a * pow(2, 10 * t) * sin((t * e->d - s) * (2 * M_PI) / p)) + e->b;
-		}
-	}
-	lua_pushnumber(L, r);
-	return 1;
+		return e->b;
+	t = t / e->d;
+	if(t == 1)
+		return e->b + e->c;
+	p = e->d * 0.3;
+	s = p / 4;
+	a = e->c;
+	t = t - 1;
+	return -(a * exp2(10 * t) * sin((t * e->d - s) * (2 * M_PI) / p)) + e->b;
 }
 
-static int m_out_elastic(lua_State * L)
+static double easing_out_elastic(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
+	double p, s, a;
+
 	if(t == 0)
-		r = e->b;
-	else
-	{
-		t = t / e->d;
-		if(t == 1)
-			r = e->b + e->c;
-		else
-		{
-			double p = e->d * 0.3;
-			double s = p / 4;
-			double a = e->c;
-			r = a * pow(2, -10 * t) * sin((t * e->d - s) * (2 * M_PI) / p) + e->c + e->b;
-		}
-	}
-	lua_pushnumber(L, r);
-	return 1;
+		return e->b;
+	t = t / e->d;
+	if(t == 1)
+		return e->b + e->c;
+	p = e->d * 0.3;
+	s = p / 4;
+	a = e->c;
+	return a * exp2(-10 * t) * sin((t * e->d - s) * (2 * M_PI) / p) + e->c + e->b;
 }
 
-static int m_in_out_elastic(lua_State * L)
+static double easing_in_out_elastic(struct leasing_t * e, double t)
 {
-	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
+	double p, s, a;
+
 	if(t == 0)
-		r = e->b;
-	else
+		return e->b;
+	t = t / e->d * 2;
+	if(t == 2)
+		return e->b + e->c;
+	p = e->d * (0.3 * 1.5);
+	a = e->c;
+	s = p / 4;
+	if(t < 1)
 	{
-		t = t / e->d * 2;
-		if(t == 2)
-			r = e->b + e->c;
-		else
-		{
-			double p = e->d * (0.3 * 1.5);
-			double a = e->c;
-			double s = p / 4;
-			if(t < 1)
-			{
-				t = t - 1;
-				r = -0.5 * (a * pow(2, 10 * t) * sin((t * e->d - s) * (2 * M_PI) / p)) + e->b;
-			}
-			else
-			{
-				t = t - 1;
-				r = a * pow(2, -10 * t) * sin((t * e->d - s) * (2 * M_PI) / p) * 0.5 + e->c	+ e->b;
-			}
-		}
+		t = t - 1;
+		return -0.5 * (a * exp2(10 * t) * sin((t * e->d - s) * (2 * M_PI) / p)) + e->b;
 	}
-	lua_pushnumber(L, r);
-	return 1;
+	t = t - 1;
+	return a * exp2(-10 * t) * sin((t * e->d - s) * (2 * M_PI) / p) * 0.5 + e->c + e->b;
 }
 
 static double __out_bounce(double t, double b, double c, double d)
@@ -588,76 +384,165 @@ static double __in_bounce(double t, double b, double c, double d)
 	return c - __out_bounce(d - t, 0, c, d) + b;
 }
 
-static int m_in_bounce(lua_State * L)
+static double easing_in_bounce(struct leasing_t * e, double t)
+{
+	return __in_bounce(t, e->b, e->c, e->d);
+}
+
+static double easing_out_bounce(struct leasing_t * e, double t)
+{
+	return __out_bounce(t, e->b, e->c, e->d);
+}
+
+static double easing_in_out_bounce(struct leasing_t * e, double t)
+{
+	if(t < e->d / 2)
+		return __in_bounce(t * 2, 0, e->c, e->d) * 0.5 + e->b;
+	return __out_bounce(t * 2 - e->d, 0, e->c, e->d) * 0.5 + e->c * 0.5 + e->b;
+}
+
+static const struct easing_type_t easing_types[] = {
+	{ "linear",			easing_linear,			NULL },
+	{ "inSine",			easing_in_sine,			veasing_in_sine },
+	{ "outSine",		easing_out_sine,		veasing_out_sine },
+	{ "inOutSine",		easing_in_out_sine,		veasing_in_out_sine },
+	{ "inQuad",			easing_in_quad,			NULL },
+	{ "outQuad",		easing_out_quad,		NULL },
+	{ "inOutQuad",		easing_in_out_quad,		NULL },
+	{ "inCubic",		easing_in_cubic,		NULL },
+	{ "outCubic",		easing_out_cubic,		NULL },
+	{ "inOutCubic",		easing_in_out_cubic,	NULL },
+	{ "inQuart",		easing_in_quart,		NULL },
+	{ "outQuart",		easing_out_quart,		NULL },
+	{ "inOutQuart",		easing_in_out_quart,	NULL },
+	{ "inQuint",		easing_in_quint,		NULL },
+	{ "outQuint",		easing_out_quint,		NULL },
+	{ "inOutQuint",		easing_in_out_quint,	NULL },
+	{ "inExpo",			easing_in_expo,			veasing_in_expo },
+	{ "outExpo",		easing_out_expo,		veasing_out_expo },
+	{ "inOutExpo",		easing_in_out_expo,		veasing_in_out_expo },
+	{ "inCirc",			easing_in_circ,			NULL },
+	{ "outCirc",		easing_out_circ,		NULL },
+	{ "inOutCirc",		easing_in_out_circ,		NULL },
+	{ "inBack",			easing_in_back,			NULL },
+	{ "outBack",		easing_out_back,		NULL },
+	{ "inOutBack",		easing_in_out_back,		NULL },
+	{ "inElastic",		easing_in_elastic,		NULL },
+	{ "outElastic",		easing_out_elastic,		NULL },
+	{ "inOutElastic",	easing_in_out_elastic,	NULL },
+	{ "inBounce",		easing_in_bounce,		NULL },
+	{ "outBounce",		easing_out_bounce,		NULL },
+	{ "inOutBounce",	easing_in_out_bounce,	NULL },
+};
+
+static int l_new(lua_State * L)
+{
+	struct leasing_t * e = lua_newuserdata(L, sizeof(struct leasing_t));
+	const char * type = luaL_optstring(L, 4, "linear");
+	int i;
+	e->b = luaL_optnumber(L, 1, 0);
+	e->c = luaL_optnumber(L, 2, 1);
+	e->d = luaL_optnumber(L, 3, 1);
+	e->type = &easing_types[0];
+	for(i = 0; i < ARRAY_SIZE(easing_types); i++)
+	{
+		if(strcmp(type, easing_types[i].name) == 0)
+		{
+			e->type = &easing_types[i];
+			break;
+		}
+	}
+	luaL_setmetatable(L, MT_EASING);
+	return 1;
+}
+
+static const luaL_Reg l_easing[] = {
+	{"new", l_new},
+	{NULL, NULL}
+};
+
+static int m_invoke_easing(lua_State * L)
 {
 	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
 	double t = luaL_checknumber(L, 2);
-	double r = __in_bounce(t, e->b, e->c, e->d);
-	lua_pushnumber(L, r);
+	lua_pushnumber(L, e->type->func(e, t));
 	return 1;
 }
 
-static int m_out_bounce(lua_State * L)
+/*
+ * The named methods evaluate that curve with the begin, change and duration
+ * of the easing, the curve is the upvalue
+ */
+static int m_invoke_type(lua_State * L)
 {
 	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
+	const struct easing_type_t * type = lua_touserdata(L, lua_upvalueindex(1));
 	double t = luaL_checknumber(L, 2);
-	double r = __out_bounce(t, e->b, e->c, e->d);
-	lua_pushnumber(L, r);
+	lua_pushnumber(L, type->func(e, t));
 	return 1;
 }
 
-static int m_in_out_bounce(lua_State * L)
+/*
+ * Evaluate a table of times in one call, curves with a batched form go
+ * through the vector math library in single precision
+ */
+static int m_batch(lua_State * L)
 {
 	struct leasing_t * e = luaL_checkudata(L, 1, MT_EASING);
-	double t = luaL_checknumber(L, 2);
-	double r;
-	if (t < e->d / 2)
-		r = __in_bounce(t * 2, 0, e->c, e->d) * 0.5 + e->b;
+	float * t, * r;
+	int n, i;
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+	n = lua_rawlen(L, 2);
+	lua_createtable(L, n, 0);
+	if(n <= 0)
+		return 1;
+	t = malloc(sizeof(float) * n * 2);
+	if(!t)
+		return luaL_error(L, "out of memory");
+	r = t + n;
+
+	for(i = 0; i < n; i++)
+	{
+		lua_rawgeti(L, 2, i + 1);
+		t[i] = lua_tonumber(L, -1);
+		lua_pop(L, 1);
+	}
+	if(e->type->vfunc)
+		e->type->vfunc(e, r, t, n);
 	else
-		r = __out_bounce(t * 2 - e->d, 0, e->c, e->d) * 0.5 + e->c * 0.5 + e->b;
-	lua_pushnumber(L, r);
+	{
+		for(i = 0; i < n; i++)
+			r[i] = e->type->func(e, t[i]);
+	}
+	for(i = 0; i < n; i++)
+	{
+		lua_pushnumber(L, r[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+	free(t);
 	return 1;
 }
 
 static const luaL_Reg m_easing[] = {
 	{"easing",			m_invoke_easing},
-	{"linear",			m_linear},
-	{"inSine",			m_in_sine},
-	{"outSine",			m_out_sine},
-	{"inOutSine",		m_in_out_sine},
-	{"inQuad",			m_in_quad},
-	{"outQuad",			m_out_quad},
-	{"inOutQuad",		m_in_out_quad},
-	{"inCubic",			m_in_cubic},
-	{"outCubic",		m_out_cubic},
-	{"inOutCubic",		m_in_out_cubic},
-	{"inQuart",			m_in_quart},
-	{"outQuart",		m_out_quart},
-	{"inOutQuart",		m_in_out_quart},
-	{"inQuint",			m_in_quint},
-	{"outQuint",		m_out_quint},
-	{"inOutQuint",		m_in_out_quint},
-	{"inExpo",			m_in_expo},
-	{"outExpo",			m_out_expo},
-	{"inOutExpo",		m_in_out_expo},
-	{"inCirc",			m_in_circ},
-	{"outCirc",			m_out_circ},
-	{"inOutCirc",		m_in_out_circ},
-	{"inBack",			m_in_back},
-	{"outBack",			m_out_back},
-	{"inOutBack",		m_in_out_back},
-	{"inElastic",		m_in_elastic},
-	{"outElastic",		m_out_elastic},
-	{"inOutElastic",	m_in_out_elastic},
-	{"inBounce",		m_in_bounce},
-	{"outBounce",		m_out_bounce},
-	{"inOutBounce",		m_in_out_bounce},
+	{"batch",			m_batch},
 	{NULL,				NULL}
 };
 
 int luaopen_easing(lua_State * L)
 {
+	int i;
+
 	luaL_newlib(L, l_easing);
 	luahelper_create_metatable(L, MT_EASING, m_easing);
+	luaL_getmetatable(L, MT_EASING);
+	for(i = 0; i < ARRAY_SIZE(easing_types); i++)
+	{
+		lua_pushlightuserdata(L, (void *)&easing_types[i]);
+		lua_pushcclosure(L, m_invoke_type, 1);
+		lua_setfield(L, -2, easing_types[i].name);
+	}
+	lua_pop(L, 1);
 	return 1;
 }
@@ -82,6 +82,7 @@ static FT_Stream FT_New_Xfs_Stream(lua_State * L, const char * pathname)
 		return NULL;
 	}
 
+	memset(stream, 0, sizeof(*stream));
 	stream->size = xfs_length(file);
 	if(!stream->size)
 	{
@@ -93,7 +94,8 @@ static FT_Stream FT_New_Xfs_Stream(lua_State * L, const char * pathname)
 
 	stream->descriptor.pointer = file;
 	stream->pathname.pointer = (char *)pathname;
-	stream->read = ft_xfs_stream_io;
+	stream->base = xfs_mmap(file, NULL);
+	stream->read = stream->base ? NULL : ft_xfs_stream_io;
 	stream->close = ft_xfs_stream_close;
 
     return stream;
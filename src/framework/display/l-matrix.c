@@ -130,6 +130,48 @@ static int m_matrix_point(lua_State * L)
 	return 2;
 }
 
+/*
+ * Transform a flat table of x, y pairs in one call, the loop has no
+ * dependencies between points so the compiler can vectorize it
+ */
+static int m_matrix_points(lua_State * L)
+{
+	const cairo_matrix_t * m = luaL_checkudata(L, 1, MT_MATRIX);
+	double * p;
+	double x, y;
+	int n, i;
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+	n = lua_rawlen(L, 2) & ~0x1;
+	lua_createtable(L, n, 0);
+	if(n <= 0)
+		return 1;
+	p = malloc(sizeof(double) * n);
+	if(!p)
+		return luaL_error(L, "out of memory");
+
+	for(i = 0; i < n; i++)
+	{
+		lua_rawgeti(L, 2, i + 1);
+		p[i] = lua_tonumber(L, -1);
+		lua_pop(L, 1);
+	}
+	for(i = 0; i < n; i += 2)
+	{
+		x = p[i];
+		y = p[i + 1];
+		p[i] = m->xx * x + m->xy * y + m->x0;
+		p[i + 1] = m->yx * x + m->yy * y + m->y0;
+	}
+	for(i = 0; i < n; i++)
+	{
+		lua_pushnumber(L, p[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+	free(p);
+	return 1;
+}
+
 static int m_matrix_bounds(lua_State * L)
 {
 	const cairo_matrix_t * m = luaL_checkudata(L, 1, MT_MATRIX);
@@ -152,6 +194,7 @@ static const luaL_Reg m_matrix[] = {
 	{"scale",		m_matrix_scale},
 	{"distance",	m_matrix_distance},
 	{"point",		m_matrix_point},
+	{"points",		m_matrix_points},
 	{"bounds",		m_matrix_bounds},
 	{NULL,	NULL}
 };
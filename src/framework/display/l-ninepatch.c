@@ -46,16 +46,40 @@ static cairo_status_t xfs_read_func(void * closure, unsigned char * data, unsign
 	return _cairo_error(CAIRO_STATUS_READ_ERROR);
 }
 
+struct mmap_closure_t {
+	const unsigned char * data;
+	s64_t size;
+	s64_t offset;
+};
+
+static cairo_status_t mmap_read_func(void * closure, unsigned char * data, unsigned int size)
+{
+	struct mmap_closure_t * m = closure;
+
+	if(size > m->size - m->offset)
+		return _cairo_error(CAIRO_STATUS_READ_ERROR);
+	memcpy(data, m->data + m->offset, size);
+	m->offset += size;
+	return CAIRO_STATUS_SUCCESS;
+}
+
 static cairo_surface_t * cairo_image_surface_create_from_png_xfs(lua_State * L, const char * filename)
 {
 	struct xfs_context_t * ctx = luahelper_runtime(L)->__xfs_ctx;
+	struct mmap_closure_t m;
 	struct xfs_file_t * file;
 	cairo_surface_t * surface;
 
 	file = xfs_open_read(ctx, filename);
 	if(!file)
 		return _cairo_surface_create_in_error(_cairo_error(CAIRO_STATUS_FILE_NOT_FOUND));
-	surface = cairo_image_surface_create_from_png_stream(xfs_read_func, file);
+	if((m.data = xfs_mmap(file, &m.size)))
+	{
+		m.offset = 0;
+		surface = cairo_image_surface_create_from_png_stream(mmap_read_func, &m);
+	}
+	else
+		surface = cairo_image_surface_create_from_png_stream(xfs_read_func, file);
 	xfs_close(file);
     return surface;
 }
@@ -23,6 +23,7 @@
  */
 
 #include <input/input.h>
+#include <audio/mixer.h>
 #include <framework/event/l-event.h>
 
 #define EVT_KEY_DOWN				"KeyDown"
@@ -72,6 +73,7 @@ static int l_event_pump(lua_State * L)
 {
 	struct event_t event;
 
+	mixer_prefetch(&__audio_mixer);
 	if(!pump_event(runtime_get()->__event_base, &event))
 		return 0;
 
@@ -0,0 +1,225 @@
+/*
+ * framework/hardware/l-capture.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <capture/capture.h>
+#include <framework/hardware/l-hardware.h>
+
+struct lcapture_t {
+	struct capture_t * s;
+	struct capture_sample_t * buf;
+	int size;
+};
+
+/*
+ * The userdata comes first so an allocation error of lua can not leak the
+ * capture, its metatable is only set once the capture exists
+ */
+static struct lcapture_t * lcapture_new(lua_State * L)
+{
+	struct lcapture_t * ls = lua_newuserdata(L, sizeof(struct lcapture_t));
+
+	ls->s = NULL;
+	ls->buf = NULL;
+	ls->size = 0;
+	return ls;
+}
+
+static int lcapture_push(lua_State * L, struct lcapture_t * ls)
+{
+	if(!ls->s)
+		return 0;
+	luaL_setmetatable(L, MT_HARDWARE_CAPTURE);
+	return 1;
+}
+
+static int l_capture_adc(lua_State * L)
+{
+	const char * name = luaL_checkstring(L, 1);
+	int channel = luaL_checkinteger(L, 2);
+	int rate = luaL_checkinteger(L, 3);
+	int depth = luaL_optinteger(L, 4, rate);
+	struct lcapture_t * ls;
+	luaL_argcheck(L, (rate > 0) && (rate <= CAPTURE_MAX_RATE), 3, "bad rate");
+	ls = lcapture_new(L);
+	ls->s = capture_alloc_adc(name, channel, rate, depth);
+	return lcapture_push(L, ls);
+}
+
+static int l_capture_gmeter(lua_State * L)
+{
+	const char * name = luaL_optstring(L, 1, NULL);
+	int rate = luaL_checkinteger(L, 2);
+	int depth = luaL_optinteger(L, 3, rate);
+	struct lcapture_t * ls;
+	luaL_argcheck(L, (rate > 0) && (rate <= CAPTURE_MAX_RATE), 2, "bad rate");
+	ls = lcapture_new(L);
+	ls->s = capture_alloc_gmeter(name, rate, depth);
+	return lcapture_push(L, ls);
+}
+
+static int l_capture_thermometer(lua_State * L)
+{
+	const char * name = luaL_optstring(L, 1, NULL);
+	int rate = luaL_checkinteger(L, 2);
+	int depth = luaL_optinteger(L, 3, rate);
+	struct lcapture_t * ls;
+	luaL_argcheck(L, (rate > 0) && (rate <= CAPTURE_MAX_RATE), 2, "bad rate");
+	ls = lcapture_new(L);
+	ls->s = capture_alloc_thermometer(name, rate, depth);
+	return lcapture_push(L, ls);
+}
+
+static const luaL_Reg l_capture[] = {
+	{"adc",			l_capture_adc},
+	{"gmeter",		l_capture_gmeter},
+	{"thermometer",	l_capture_thermometer},
+	{NULL,	NULL}
+};
+
+static int m_capture_gc(lua_State * L)
+{
+	struct lcapture_t * ls = luaL_checkudata(L, 1, MT_HARDWARE_CAPTURE);
+	capture_free(ls->s);
+	free(ls->buf);
+	return 0;
+}
+
+static int m_capture_filter(lua_State * L)
+{
+	static const char * const names[] = { "none", "ewma", "kalman", "mean", "median", NULL };
+	struct lcapture_t * ls = luaL_checkudata(L, 1, MT_HARDWARE_CAPTURE);
+	int type = luaL_checkoption(L, 2, "none", names);
+	float args[4];
+	int nargs = 0;
+
+	while((nargs < 4) && lua_isnumber(L, 3 + nargs))
+	{
+		args[nargs] = lua_tonumber(L, 3 + nargs);
+		nargs++;
+	}
+	lua_pushboolean(L, capture_set_filter(ls->s, (enum capture_filter_type_t)type, args, nargs));
+	return 1;
+}
+
+static int m_capture_start(lua_State * L)
+{
+	struct lcapture_t * ls = luaL_checkudata(L, 1, MT_HARDWARE_CAPTURE);
+	capture_start(ls->s);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int m_capture_stop(lua_State * L)
+{
+	struct lcapture_t * ls = luaL_checkudata(L, 1, MT_HARDWARE_CAPTURE);
+	capture_stop(ls->s);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int m_capture_available(lua_State * L)
+{
+	struct lcapture_t * ls = luaL_checkudata(L, 1, MT_HARDWARE_CAPTURE);
+	lua_pushinteger(L, capture_available(ls->s));
+	return 1;
+}
+
+/*
+ * The samples come back packed in one string, a timestamp in microseconds
+ * followed by the values in the device units, see format for string.unpack
+ */
+static int m_capture_read(lua_State * L)
+{
+	struct lcapture_t * ls = luaL_checkudata(L, 1, MT_HARDWARE_CAPTURE);
+	int avail = capture_available(ls->s);
+	int max = luaL_optinteger(L, 2, avail);
+	struct capture_sample_t * buf;
+	luaL_Buffer b;
+	int n, i;
+
+	if(max > avail)
+		max = avail;
+	if(max <= 0)
+	{
+		lua_pushliteral(L, "");
+		lua_pushinteger(L, 0);
+		return 2;
+	}
+	if(max > ls->size)
+	{
+		buf = realloc(ls->buf, sizeof(struct capture_sample_t) * max);
+		if(!buf)
+			return luaL_error(L, "out of memory");
+		ls->buf = buf;
+		ls->size = max;
+	}
+
+	n = capture_read(ls->s, ls->buf, max);
+	luaL_buffinit(L, &b);
+	for(i = 0; i < n; i++)
+	{
+		luaL_addlstring(&b, (const char *)&ls->buf[i].time, sizeof(s64_t));
+		luaL_addlstring(&b, (const char *)&ls->buf[i].value[0], sizeof(s32_t) * ls->s->nvalue);
+	}
+	luaL_pushresult(&b);
+	lua_pushinteger(L, n);
+	return 2;
+}
+
+static int m_capture_format(lua_State * L)
+{
+	struct lcapture_t * ls = luaL_checkudata(L, 1, MT_HARDWARE_CAPTURE);
+	static const char * const formats[] = { "=i8i4", "=i8i4i4", "=i8i4i4i4" };
+	lua_pushstring(L, formats[ls->s->nvalue - 1]);
+	lua_pushinteger(L, sizeof(s64_t) + sizeof(s32_t) * ls->s->nvalue);
+	return 2;
+}
+
+static int m_capture_status(lua_State * L)
+{
+	struct lcapture_t * ls = luaL_checkudata(L, 1, MT_HARDWARE_CAPTURE);
+	lua_pushinteger(L, ls->s->count);
+	lua_pushinteger(L, ls->s->overrun);
+	lua_pushinteger(L, ls->s->missed);
+	return 3;
+}
+
+static const luaL_Reg m_capture[] = {
+	{"__gc",		m_capture_gc},
+	{"filter",		m_capture_filter},
+	{"start",		m_capture_start},
+	{"stop",		m_capture_stop},
+	{"available",	m_capture_available},
+	{"read",		m_capture_read},
+	{"format",		m_capture_format},
+	{"status",		m_capture_status},
+	{NULL,	NULL}
+};
+
+int luaopen_hardware_capture(lua_State * L)
+{
+	luaL_newlib(L, l_capture);
+	luahelper_create_metatable(L, MT_HARDWARE_CAPTURE, m_capture);
+	return 1;
+}
@@ -27,8 +27,28 @@
 
 struct li2c_t {
 	struct i2c_device_t * dev;
+	u8_t * buf;
+	int size;
 };
 
+/*
+ * A scratch buffer kept with the device, grown on demand and reused
+ */
+static u8_t * li2c_scratch(struct li2c_t * i2c, int size)
+{
+	u8_t * p;
+
+	if(size > i2c->size)
+	{
+		p = realloc(i2c->buf, size);
+		if(!p)
+			return NULL;
+		i2c->buf = p;
+		i2c->size = size;
+	}
+	return i2c->buf;
+}
+
 static int l_i2c_new(lua_State * L)
 {
 	const char * name = luaL_checkstring(L, 1);
@@ -39,6 +59,8 @@ static int l_i2c_new(lua_State * L)
 		return 0;
 	struct li2c_t * i2c = lua_newuserdata(L, sizeof(struct li2c_t));
 	i2c->dev = dev;
+	i2c->buf = NULL;
+	i2c->size = 0;
 	luaL_setmetatable(L, MT_HARDWARE_I2C);
 	return 1;
 }
@@ -52,6 +74,7 @@ static int m_i2c_gc(lua_State * L)
 {
 	struct li2c_t * i2c = luaL_checkudata(L, 1, MT_HARDWARE_I2C);
 	i2c_device_free(i2c->dev);
+	free(i2c->buf);
 	return 0;
 }
 
@@ -73,12 +96,11 @@ static int m_i2c_read(lua_State * L)
 	}
 	else
 	{
-		char * p = malloc(count);
+		u8_t * p = li2c_scratch(i2c, count);
 		if(p && i2c_master_recv(i2c->dev, p, count) == count)
-			lua_pushlstring(L, p, count);
+			lua_pushlstring(L, (const char *)p, count);
 		else
 			lua_pushnil(L);
-		free(p);
 	}
 	return 1;
 }
@@ -95,10 +117,82 @@ static int m_i2c_write(lua_State * L)
 	return 1;
 }
 
+/*
+ * Run a table of segments as one transaction, strings are written and
+ * integers are byte counts to read, returning the read data in order
+ */
+static int m_i2c_transfer(lua_State * L)
+{
+	struct li2c_t * i2c = luaL_checkudata(L, 1, MT_HARDWARE_I2C);
+	struct i2c_xfer_t x;
+	int rlen[I2C_XFER_MAX_MSGS];
+	const char * wbuf;
+	size_t wlen;
+	u8_t * p;
+	lua_Integer l;
+	int n, i, c, t, nread = 0, total = 0;
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+	n = lua_rawlen(L, 2);
+	luaL_argcheck(L, (n > 0) && (n <= I2C_XFER_MAX_MSGS), 2, "bad segment count");
+	for(i = 1; i <= n; i++)
+	{
+		t = lua_rawgeti(L, 2, i);
+		if(t == LUA_TNUMBER)
+		{
+			l = lua_tointeger(L, -1);
+			luaL_argcheck(L, (l > 0) && (l <= INT_MAX - total), 2, "bad read length");
+			total += l;
+		}
+		else if(t == LUA_TSTRING)
+		{
+			luaL_argcheck(L, lua_rawlen(L, -1) > 0, 2, "empty write");
+		}
+		lua_pop(L, 1);
+	}
+	p = li2c_scratch(i2c, total);
+	if(!p && (total > 0))
+		return 0;
+
+	i2c_xfer_init(&x, i2c->dev);
+	for(i = 1; i <= n; i++)
+	{
+		t = lua_rawgeti(L, 2, i);
+		if(t == LUA_TSTRING)
+		{
+			wbuf = lua_tolstring(L, -1, &wlen);
+			if(!i2c_xfer_write(&x, (void *)wbuf, wlen))
+				return 0;
+		}
+		else if(t == LUA_TNUMBER)
+		{
+			c = lua_tointeger(L, -1);
+			if(!i2c_xfer_read(&x, p, c))
+				return 0;
+			rlen[nread++] = c;
+			p += c;
+		}
+		lua_pop(L, 1);
+	}
+
+	if(i2c_xfer_commit(&x) < 0)
+		return 0;
+	if(nread == 0)
+	{
+		lua_pushboolean(L, 1);
+		return 1;
+	}
+	luaL_checkstack(L, nread, NULL);
+	for(i = 0, p = i2c->buf; i < nread; p += rlen[i++])
+		lua_pushlstring(L, (const char *)p, rlen[i]);
+	return nread;
+}
+
 static const luaL_Reg m_i2c[] = {
 	{"__gc",	m_i2c_gc},
 	{"read",	m_i2c_read},
 	{"write",	m_i2c_write},
+	{"transfer",	m_i2c_transfer},
 	{NULL,	NULL}
 };
 
@@ -27,8 +27,28 @@
 
 struct lspi_t {
 	struct spi_device_t * dev;
+	u8_t * buf;
+	int size;
 };
 
+/*
+ * A scratch buffer kept with the device, grown on demand and reused
+ */
+static u8_t * lspi_scratch(struct lspi_t * spi, int size)
+{
+	u8_t * p;
+
+	if(size > spi->size)
+	{
+		p = realloc(spi->buf, size);
+		if(!p)
+			return NULL;
+		spi->buf = p;
+		spi->size = size;
+	}
+	return spi->buf;
+}
+
 static int l_spi_new(lua_State * L)
 {
 	const char * name = luaL_checkstring(L, 1);
@@ -41,6 +61,8 @@ static int l_spi_new(lua_State * L)
 		return 0;
 	struct lspi_t * spi = lua_newuserdata(L, sizeof(struct lspi_t));
 	spi->dev = dev;
+	spi->buf = NULL;
+	spi->size = 0;
 	luaL_setmetatable(L, MT_HARDWARE_SPI);
 	return 1;
 }
@@ -54,6 +76,7 @@ static int m_spi_gc(lua_State * L)
 {
 	struct lspi_t * spi = luaL_checkudata(L, 1, MT_HARDWARE_SPI);
 	spi_device_free(spi->dev);
+	free(spi->buf);
 	return 0;
 }
 
@@ -75,12 +98,11 @@ static int m_spi_read(lua_State * L)
 	}
 	else
 	{
-		char * p = malloc(count);
+		u8_t * p = lspi_scratch(spi, count);
 		if(p && !(spi_device_write_then_read(spi->dev, 0, 0, p, count) < 0))
-			lua_pushlstring(L, p, count);
+			lua_pushlstring(L, (const char *)p, count);
 		else
 			lua_pushnil(L);
-		free(p);
 	}
 	return 1;
 }
@@ -113,10 +135,82 @@ static int m_spi_deselect(lua_State * L)
 	return 1;
 }
 
+/*
+ * Run a table of segments as one transaction, strings are written and
+ * integers are byte counts to read, returning the read data in order
+ */
+static int m_spi_transfer(lua_State * L)
+{
+	struct lspi_t * spi = luaL_checkudata(L, 1, MT_HARDWARE_SPI);
+	struct spi_xfer_t x;
+	int rlen[SPI_XFER_MAX_MSGS];
+	const char * wbuf;
+	size_t wlen;
+	u8_t * p;
+	lua_Integer l;
+	int n, i, c, t, nread = 0, total = 0;
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+	n = lua_rawlen(L, 2);
+	luaL_argcheck(L, (n > 0) && (n <= SPI_XFER_MAX_MSGS), 2, "bad segment count");
+	for(i = 1; i <= n; i++)
+	{
+		t = lua_rawgeti(L, 2, i);
+		if(t == LUA_TNUMBER)
+		{
+			l = lua_tointeger(L, -1);
+			luaL_argcheck(L, (l > 0) && (l <= INT_MAX - total), 2, "bad read length");
+			total += l;
+		}
+		else if(t == LUA_TSTRING)
+		{
+			luaL_argcheck(L, lua_rawlen(L, -1) > 0, 2, "empty write");
+		}
+		lua_pop(L, 1);
+	}
+	p = lspi_scratch(spi, total);
+	if(!p && (total > 0))
+		return 0;
+
+	spi_xfer_init(&x, spi->dev);
+	for(i = 1; i <= n; i++)
+	{
+		t = lua_rawgeti(L, 2, i);
+		if(t == LUA_TSTRING)
+		{
+			wbuf = lua_tolstring(L, -1, &wlen);
+			if(!spi_xfer_write(&x, (void *)wbuf, wlen))
+				return 0;
+		}
+		else if(t == LUA_TNUMBER)
+		{
+			c = lua_tointeger(L, -1);
+			if(!spi_xfer_read(&x, p, c))
+				return 0;
+			rlen[nread++] = c;
+			p += c;
+		}
+		lua_pop(L, 1);
+	}
+
+	if(spi_xfer_commit(&x) < 0)
+		return 0;
+	if(nread == 0)
+	{
+		lua_pushboolean(L, 1);
+		return 1;
+	}
+	luaL_checkstack(L, nread, NULL);
+	for(i = 0, p = spi->buf; i < nread; p += rlen[i++])
+		lua_pushlstring(L, (const char *)p, rlen[i]);
+	return nread;
+}
+
 static const luaL_Reg m_spi[] = {
 	{"__gc",		m_spi_gc},
 	{"read",		m_spi_read},
 	{"write",		m_spi_write},
+	{"transfer",	m_spi_transfer},
 	{"select",		m_spi_select},
 	{"deselect",	m_spi_deselect},
 	{NULL,	NULL}
@@ -0,0 +1,508 @@
+/*
+ * framework/profiler/l-profiler.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <framework/profiler/l-profiler.h>
+
+#define LPROFILER_HASH_SIZE		(257)
+#define LPROFILER_STACK_DEPTH	(64)
+
+enum lprofiler_mode_t {
+	LPROFILER_MODE_NONE			= 0,
+	LPROFILER_MODE_SAMPLE		= 1,
+	LPROFILER_MODE_EXACT		= 2,
+};
+
+struct lprofiler_entry_t {
+	struct hlist_node node;
+	const void * key;
+	char * name;
+	u64_t self;
+	u64_t total;
+	u64_t calls;
+	u64_t samples;
+	u64_t alloc;
+	u64_t mark;
+	int depth;
+};
+
+struct lprofiler_frame_state_t {
+	struct lprofiler_entry_t * entry;
+	u64_t start;
+	u64_t child;
+};
+
+struct lprofiler_t {
+	lua_State * L;
+	enum lprofiler_mode_t mode;
+	struct hlist_head hash[LPROFILER_HASH_SIZE];
+	struct lprofiler_frame_state_t stack[LPROFILER_STACK_DEPTH];
+	struct lprofiler_entry_t * current;
+	int sp;
+	u64_t mark;
+	u64_t last;
+	u64_t start;
+	u64_t elapsed;
+	u64_t alloc;
+	u64_t gc;
+	u64_t gcstart;
+	int gcdepth;
+
+	struct lprofiler_frame_t frame;
+	struct lprofiler_frame_t lframe;
+	int phase;
+	u64_t pstamp;
+};
+
+static struct lprofiler_t __lprofiler = {
+	.L = NULL,
+	.mode = LPROFILER_MODE_NONE,
+	.phase = LPROFILER_PHASE_DISPATCH,
+};
+
+static inline u64_t lprofiler_now(void)
+{
+	return ktime_to_ns(ktime_get());
+}
+
+static struct lprofiler_entry_t * lprofiler_entry(lua_State * L, lua_Debug * ar)
+{
+	struct lprofiler_t * p = &__lprofiler;
+	struct lprofiler_entry_t * e;
+	struct hlist_node * n;
+	const void * key;
+	char buf[128];
+	u32_t index;
+
+	if(!lua_getinfo(L, "Sf", ar))
+		return NULL;
+	key = lua_topointer(L, -1);
+	lua_pop(L, 1);
+
+	index = ((virtual_addr_t)key >> 3) % LPROFILER_HASH_SIZE;
+	hlist_for_each_entry_safe(e, n, &p->hash[index], node)
+	{
+		if(e->key == key)
+			return e;
+	}
+
+	e = malloc(sizeof(struct lprofiler_entry_t));
+	if(!e)
+		return NULL;
+	memset(e, 0, sizeof(struct lprofiler_entry_t));
+	lua_getinfo(L, "n", ar);
+	if(*ar->what == 'C')
+		snprintf(buf, sizeof(buf), "[C] %s", ar->name ? ar->name : "?");
+	else
+		snprintf(buf, sizeof(buf), "%s:%d %s", ar->short_src, ar->linedefined, ar->name ? ar->name : "?");
+	init_hlist_node(&e->node);
+	e->key = key;
+	e->name = strdup(buf);
+	hlist_add_head(&e->node, &p->hash[index]);
+	return e;
+}
+
+static void lprofiler_push(struct lprofiler_entry_t * e, u64_t now)
+{
+	struct lprofiler_t * p = &__lprofiler;
+
+	if(p->sp < LPROFILER_STACK_DEPTH)
+	{
+		p->stack[p->sp].entry = e;
+		p->stack[p->sp].start = now;
+		p->stack[p->sp].child = 0;
+	}
+	p->sp++;
+	if(e)
+	{
+		e->calls++;
+		e->depth++;
+		p->current = e;
+	}
+}
+
+static void lprofiler_pop(u64_t now)
+{
+	struct lprofiler_t * p = &__lprofiler;
+	struct lprofiler_frame_state_t * f;
+	struct lprofiler_entry_t * e;
+	u64_t elapsed;
+
+	if(p->sp <= 0)
+		return;
+	if(--p->sp < LPROFILER_STACK_DEPTH)
+	{
+		f = &p->stack[p->sp];
+		e = f->entry;
+		elapsed = now - f->start;
+		if(e)
+		{
+			e->self += (elapsed > f->child) ? (elapsed - f->child) : 0;
+			if(--e->depth == 0)
+				e->total += elapsed;
+		}
+		if((p->sp > 0) && (p->sp <= LPROFILER_STACK_DEPTH))
+			p->stack[p->sp - 1].child += elapsed;
+	}
+	p->current = ((p->sp > 0) && (p->sp <= LPROFILER_STACK_DEPTH)) ? p->stack[p->sp - 1].entry : NULL;
+}
+
+static void lprofiler_exact_hook(lua_State * L, lua_Debug * ar)
+{
+	u64_t now = lprofiler_now();
+
+	switch(ar->event)
+	{
+	case LUA_HOOKCALL:
+		lprofiler_push(lprofiler_entry(L, ar), now);
+		break;
+	case LUA_HOOKTAILCALL:
+		lprofiler_pop(now);
+		lprofiler_push(lprofiler_entry(L, ar), now);
+		break;
+	case LUA_HOOKRET:
+		lprofiler_pop(now);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * The count hook only fires while lua code runs, the wall time since the
+ * previous sample is charged to the function on top and to every distinct
+ * function below it, which keeps the time spent in c functions visible.
+ */
+static void lprofiler_sample_hook(lua_State * L, lua_Debug * ar)
+{
+	struct lprofiler_t * p = &__lprofiler;
+	struct lprofiler_entry_t * e;
+	lua_Debug d;
+	u64_t now = lprofiler_now();
+	u64_t delta = now - p->last;
+	int level;
+
+	p->last = now;
+	p->mark++;
+	for(level = 0; (level < LPROFILER_STACK_DEPTH) && lua_getstack(L, level, &d); level++)
+	{
+		e = lprofiler_entry(L, &d);
+		if(!e)
+			continue;
+		if(level == 0)
+		{
+			e->samples++;
+			e->self += delta;
+			p->current = e;
+		}
+		if(e->mark != p->mark)
+		{
+			e->mark = p->mark;
+			e->total += delta;
+		}
+	}
+}
+
+static void lprofiler_clear(void)
+{
+	struct lprofiler_t * p = &__lprofiler;
+	struct lprofiler_entry_t * e;
+	struct hlist_node * n;
+	int i;
+
+	for(i = 0; i < LPROFILER_HASH_SIZE; i++)
+	{
+		hlist_for_each_entry_safe(e, n, &p->hash[i], node)
+		{
+			hlist_del(&e->node);
+			free(e->name);
+			free(e);
+		}
+	}
+	p->current = NULL;
+	p->sp = 0;
+	p->mark = 0;
+	p->elapsed = 0;
+	p->alloc = 0;
+	p->gc = 0;
+}
+
+static int lprofiler_entry_cmp(const void * a, const void * b)
+{
+	const struct lprofiler_entry_t * ea = *(const struct lprofiler_entry_t **)a;
+	const struct lprofiler_entry_t * eb = *(const struct lprofiler_entry_t **)b;
+
+	if(ea->self != eb->self)
+		return (ea->self < eb->self) ? 1 : -1;
+	return (ea->total < eb->total) ? 1 : ((ea->total > eb->total) ? -1 : 0);
+}
+
+static struct lprofiler_entry_t ** lprofiler_sorted(int * count)
+{
+	struct lprofiler_t * p = &__lprofiler;
+	struct lprofiler_entry_t ** list;
+	struct lprofiler_entry_t * e;
+	struct hlist_node * n;
+	int i, c = 0;
+
+	for(i = 0; i < LPROFILER_HASH_SIZE; i++)
+	{
+		hlist_for_each_entry_safe(e, n, &p->hash[i], node)
+			c++;
+	}
+	list = malloc((c + 1) * sizeof(struct lprofiler_entry_t *));
+	if(!list)
+		return NULL;
+	c = 0;
+	for(i = 0; i < LPROFILER_HASH_SIZE; i++)
+	{
+		hlist_for_each_entry_safe(e, n, &p->hash[i], node)
+			list[c++] = e;
+	}
+	qsort(list, c, sizeof(struct lprofiler_entry_t *), lprofiler_entry_cmp);
+	*count = c;
+	return list;
+}
+
+void lprofiler_alloc(void * ptr, size_t osize, size_t nsize)
+{
+	struct lprofiler_t * p = &__lprofiler;
+	size_t size;
+
+	if(ptr)
+		size = (nsize > osize) ? nsize - osize : 0;
+	else
+		size = nsize;
+	p->frame.alloc += size;
+	if(p->mode != LPROFILER_MODE_NONE)
+	{
+		p->alloc += size;
+		if(p->current)
+			p->current->alloc += size;
+	}
+}
+
+void lprofiler_gc_begin(lua_State * L)
+{
+	struct lprofiler_t * p = &__lprofiler;
+
+	if(p->gcdepth++ == 0)
+		p->gcstart = lprofiler_now();
+}
+
+void lprofiler_gc_end(lua_State * L)
+{
+	struct lprofiler_t * p = &__lprofiler;
+	u64_t delta;
+
+	if((p->gcdepth > 0) && (--p->gcdepth == 0))
+	{
+		delta = lprofiler_now() - p->gcstart;
+		p->frame.gc += delta;
+		if(p->mode != LPROFILER_MODE_NONE)
+			p->gc += delta;
+	}
+}
+
+void lprofiler_phase(int phase)
+{
+	struct lprofiler_t * p = &__lprofiler;
+	u64_t now = lprofiler_now();
+
+	if((phase < 0) || (phase >= LPROFILER_PHASE_MAX))
+		return;
+	if(p->pstamp)
+		p->frame.phase[p->phase] += now - p->pstamp;
+	p->phase = phase;
+	p->pstamp = now;
+}
+
+void lprofiler_frame_commit(void)
+{
+	struct lprofiler_t * p = &__lprofiler;
+
+	lprofiler_phase(LPROFILER_PHASE_TIMERS);
+	memcpy(&p->lframe, &p->frame, sizeof(struct lprofiler_frame_t));
+	memset(&p->frame, 0, sizeof(struct lprofiler_frame_t));
+}
+
+void lprofiler_frame_last(struct lprofiler_frame_t * f)
+{
+	if(f)
+		memcpy(f, &__lprofiler.lframe, sizeof(struct lprofiler_frame_t));
+}
+
+static int l_profiler_start(lua_State * L)
+{
+	struct lprofiler_t * p = &__lprofiler;
+	const char * mode = luaL_optstring(L, 1, "sample");
+	int period = luaL_optinteger(L, 2, 1000);
+
+	if(p->mode != LPROFILER_MODE_NONE)
+		lua_sethook(p->L, NULL, 0, 0);
+	lprofiler_clear();
+	p->L = L;
+	p->start = p->last = lprofiler_now();
+	if(strcmp(mode, "exact") == 0)
+	{
+		p->mode = LPROFILER_MODE_EXACT;
+		lua_sethook(L, lprofiler_exact_hook, LUA_MASKCALL | LUA_MASKRET, 0);
+	}
+	else
+	{
+		p->mode = LPROFILER_MODE_SAMPLE;
+		lua_sethook(L, lprofiler_sample_hook, LUA_MASKCOUNT, period > 0 ? period : 1000);
+	}
+	return 0;
+}
+
+static int l_profiler_stop(lua_State * L)
+{
+	struct lprofiler_t * p = &__lprofiler;
+
+	if(p->mode != LPROFILER_MODE_NONE)
+	{
+		lua_sethook(p->L, NULL, 0, 0);
+		p->elapsed += lprofiler_now() - p->start;
+		p->mode = LPROFILER_MODE_NONE;
+		p->current = NULL;
+		p->sp = 0;
+	}
+	return 0;
+}
+
+static int l_profiler_reset(lua_State * L)
+{
+	l_profiler_stop(L);
+	lprofiler_clear();
+	return 0;
+}
+
+static int l_profiler_report(lua_State * L)
+{
+	struct lprofiler_t * p = &__lprofiler;
+	struct lprofiler_entry_t ** list;
+	int top = luaL_optinteger(L, 1, 0);
+	int count, i;
+
+	lua_newtable(L);
+	list = lprofiler_sorted(&count);
+	if(list)
+	{
+		if((top <= 0) || (top > count))
+			top = count;
+		for(i = 0; i < top; i++)
+		{
+			lua_newtable(L);
+			luahelper_set_strfield(L, "name", list[i]->name);
+			luahelper_set_numfield(L, "self", (lua_Number)list[i]->self / 1000000000.0);
+			luahelper_set_numfield(L, "total", (lua_Number)list[i]->total / 1000000000.0);
+			luahelper_set_intfield(L, "calls", list[i]->calls);
+			luahelper_set_intfield(L, "samples", list[i]->samples);
+			luahelper_set_intfield(L, "alloc", list[i]->alloc);
+			lua_rawseti(L, -2, i + 1);
+		}
+		free(list);
+	}
+	luahelper_set_numfield(L, "elapsed", (lua_Number)(p->elapsed + ((p->mode != LPROFILER_MODE_NONE) ? lprofiler_now() - p->start : 0)) / 1000000000.0);
+	luahelper_set_numfield(L, "gc", (lua_Number)p->gc / 1000000000.0);
+	luahelper_set_intfield(L, "alloc", p->alloc);
+	return 1;
+}
+
+static int l_profiler_dump(lua_State * L)
+{
+	struct lprofiler_t * p = &__lprofiler;
+	struct lprofiler_entry_t ** list;
+	int top = luaL_optinteger(L, 1, 20);
+	u64_t elapsed = p->elapsed + ((p->mode != LPROFILER_MODE_NONE) ? lprofiler_now() - p->start : 0);
+	int count, i;
+
+	printf("Lua profiler: %llu.%03llu s, gc %llu.%03llu ms, alloc %llu bytes\r\n",
+		elapsed / 1000000000ULL, (elapsed / 1000000ULL) % 1000,
+		p->gc / 1000000ULL, (p->gc / 1000ULL) % 1000, p->alloc);
+	list = lprofiler_sorted(&count);
+	if(list)
+	{
+		if((top <= 0) || (top > count))
+			top = count;
+		printf("%10s %10s %8s %8s %10s  %s\r\n", "self(ms)", "total(ms)", "calls", "samples", "alloc", "function");
+		for(i = 0; i < top; i++)
+		{
+			printf("%10.3f %10.3f %8llu %8llu %10llu  %s\r\n",
+				(double)list[i]->self / 1000000.0, (double)list[i]->total / 1000000.0,
+				list[i]->calls, list[i]->samples, list[i]->alloc, list[i]->name);
+		}
+		free(list);
+	}
+	return 0;
+}
+
+static int l_profiler_enabled(lua_State * L)
+{
+	lua_pushboolean(L, (__lprofiler.mode != LPROFILER_MODE_NONE) ? 1 : 0);
+	return 1;
+}
+
+static int l_profiler_phase(lua_State * L)
+{
+	lprofiler_phase(luaL_checkinteger(L, 1));
+	return 0;
+}
+
+static int l_profiler_frame(lua_State * L)
+{
+	struct lprofiler_frame_t f;
+
+	lprofiler_frame_last(&f);
+	lua_newtable(L);
+	luahelper_set_numfield(L, "dispatch", (lua_Number)f.phase[LPROFILER_PHASE_DISPATCH] / 1000000000.0);
+	luahelper_set_numfield(L, "timers", (lua_Number)f.phase[LPROFILER_PHASE_TIMERS] / 1000000000.0);
+	luahelper_set_numfield(L, "draw", (lua_Number)f.phase[LPROFILER_PHASE_DRAW] / 1000000000.0);
+	luahelper_set_numfield(L, "present", (lua_Number)f.phase[LPROFILER_PHASE_PRESENT] / 1000000000.0);
+	luahelper_set_numfield(L, "gc", (lua_Number)f.gc / 1000000000.0);
+	luahelper_set_intfield(L, "alloc", f.alloc);
+	return 1;
+}
+
+static const luaL_Reg l_profiler[] = {
+	{"start",	l_profiler_start},
+	{"stop",	l_profiler_stop},
+	{"reset",	l_profiler_reset},
+	{"report",	l_profiler_report},
+	{"dump",	l_profiler_dump},
+	{"enabled",	l_profiler_enabled},
+	{"phase",	l_profiler_phase},
+	{"frame",	l_profiler_frame},
+	{NULL,		NULL}
+};
+
+int luaopen_profiler(lua_State * L)
+{
+	luaL_newlib(L, l_profiler);
+	luahelper_set_intfield(L, "DISPATCH", LPROFILER_PHASE_DISPATCH);
+	luahelper_set_intfield(L, "TIMERS", LPROFILER_PHASE_TIMERS);
+	luahelper_set_intfield(L, "DRAW", LPROFILER_PHASE_DRAW);
+	luahelper_set_intfield(L, "PRESENT", LPROFILER_PHASE_PRESENT);
+	return 1;
+}
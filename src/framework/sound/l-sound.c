@@ -0,0 +1,102 @@
+/*
+ * framework/sound/l-sound.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <audio/bank.h>
+#include <framework/sound/l-sound.h>
+
+struct lsound_t {
+	struct sound_bank_t * bank;
+};
+
+static int l_sound_new(lua_State * L)
+{
+	const char * filename = luaL_checkstring(L, 1);
+	int voices = luaL_optinteger(L, 2, CONFIG_SOUND_BANK_VOICES);
+	struct lsound_t * sound = lua_newuserdata(L, sizeof(struct lsound_t));
+	sound->bank = sound_bank_alloc(filename, voices);
+	if(!sound->bank)
+		return 0;
+	luaL_setmetatable(L, MT_SOUND);
+	return 1;
+}
+
+static const luaL_Reg l_sound[] = {
+	{"new",	l_sound_new},
+	{NULL,	NULL}
+};
+
+static int m_sound_gc(lua_State * L)
+{
+	struct lsound_t * sound = luaL_checkudata(L, 1, MT_SOUND);
+	sound_bank_free(sound->bank);
+	return 0;
+}
+
+static int m_sound_play(lua_State * L)
+{
+	struct lsound_t * sound = luaL_checkudata(L, 1, MT_SOUND);
+	int volume = luaL_optinteger(L, 2, 100);
+	sound_bank_play(sound->bank, volume);
+	return 0;
+}
+
+static int m_sound_stop(lua_State * L)
+{
+	struct lsound_t * sound = luaL_checkudata(L, 1, MT_SOUND);
+	sound_bank_stop(sound->bank);
+	return 0;
+}
+
+static int m_sound_playing(lua_State * L)
+{
+	struct lsound_t * sound = luaL_checkudata(L, 1, MT_SOUND);
+	lua_pushinteger(L, sound_bank_playing(sound->bank));
+	return 1;
+}
+
+static int m_sound_info(lua_State * L)
+{
+	struct lsound_t * sound = luaL_checkudata(L, 1, MT_SOUND);
+	struct sound_info_t * info = &sound->bank->info;
+	lua_pushinteger(L, info->rate);
+	lua_pushinteger(L, info->channel);
+	lua_pushnumber(L, (lua_Number)info->length / (lua_Number)((info->fmt >> 3) * info->channel * info->rate));
+	return 3;
+}
+
+static const luaL_Reg m_sound[] = {
+	{"__gc",		m_sound_gc},
+	{"play",		m_sound_play},
+	{"stop",		m_sound_stop},
+	{"playing",		m_sound_playing},
+	{"info",		m_sound_info},
+	{NULL,			NULL}
+};
+
+int luaopen_sound(lua_State * L)
+{
+	luaL_newlib(L, l_sound);
+	luahelper_create_metatable(L, MT_SOUND, m_sound);
+	return 1;
+}
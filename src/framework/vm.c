@@ -23,6 +23,7 @@
  */
 
 #include <xfs/xfs.h>
+#include <crc32.h>
 #include <shell/readline.h>
 #include <framework/luahelper.h>
 #include <framework/lang/l-debugger.h>
@@ -30,8 +31,10 @@
 #include <framework/event/l-event.h>
 #include <framework/event/l-event-dispatcher.h>
 #include <framework/stopwatch/l-stopwatch.h>
+#include <framework/profiler/l-profiler.h>
 #include <framework/base64/l-base64.h>
 #include <framework/display/l-display.h>
+#include <framework/sound/l-sound.h>
 #include <framework/hardware/l-hardware.h>
 #include <framework/vm.h>
 
@@ -62,6 +65,7 @@ static void luaopen_prelibs(lua_State * L)
 		{ "builtin.base64",			luaopen_base64 },
 
 		{ "builtin.stopwatch",		luaopen_stopwatch },
+		{ "builtin.profiler",		luaopen_profiler },
 		{ "builtin.matrix",			luaopen_matrix },
 		{ "builtin.easing",			luaopen_easing },
 		{ "builtin.object",			luaopen_object },
@@ -71,10 +75,12 @@ static void luaopen_prelibs(lua_State * L)
 		{ "builtin.shape",			luaopen_shape },
 		{ "builtin.font",			luaopen_font },
 		{ "builtin.display",		luaopen_display },
+		{ "builtin.sound",			luaopen_sound },
 
 		{ "hardware.adc",			luaopen_hardware_adc },
 		{ "hardware.battery",		luaopen_hardware_battery },
 		{ "hardware.buzzer",		luaopen_hardware_buzzer },
+		{ "hardware.capture",		luaopen_hardware_capture },
 		{ "hardware.dac",			luaopen_hardware_dac },
 		{ "hardware.gmeter",		luaopen_hardware_gmeter },
 		{ "hardware.gpio",			luaopen_hardware_gpio },
@@ -114,6 +120,16 @@ struct __reader_data_t
 	char buffer[LUAL_BUFFERSIZE];
 };
 
+/*
+ * Module load statistics, for measuring the cold boot
+ */
+static struct {
+	ktime_t start;
+	int modules;
+	int bytecode;
+	s64_t load;
+} __loadstat;
+
 static const char * __reader(lua_State * L, void * data, size_t * size)
 {
 	struct __reader_data_t * rd = (struct __reader_data_t *)data;
@@ -135,6 +151,9 @@ static int __loadfile(lua_State * L)
 	struct xfs_context_t * ctx = luahelper_runtime(L)->__xfs_ctx;
 	const char * filename = luaL_checkstring(L, 1);
 	struct __reader_data_t * rd;
+	const char * p;
+	s64_t len;
+	int ret;
 
 	rd = malloc(sizeof(struct __reader_data_t));
 	if(!rd)
@@ -147,7 +166,11 @@ static int __loadfile(lua_State * L)
 		return lua_error(L);
 	}
 
-	if(lua_load(L, __reader, rd, filename, NULL))
+	if((p = xfs_mmap(rd->file, &len)))
+		ret = luaL_loadbufferx(L, p, len, filename, NULL);
+	else
+		ret = lua_load(L, __reader, rd, filename, NULL);
+	if(ret)
 	{
 		free(rd);
 		return lua_error(L);
@@ -159,10 +182,71 @@ static int __loadfile(lua_State * L)
 	return 1;
 }
 
+/*
+ * A precompiled 'foo.luac' starts with the crc32 and the length of its
+ * 'foo.lua' source, little endian, as found in a gzip trailer, followed by
+ * the stripped bytecode. Only bytecode mapped from the read-only romdisk is
+ * trusted, and it is used when the source is missing or matches, the source
+ * has to be mapped from the romdisk too so the check never copies it.
+ */
+static bool_t __source_match(struct xfs_context_t * ctx, const char * filename, const u8_t * header)
+{
+	struct xfs_file_t * file;
+	const u8_t * p;
+	bool_t ret = FALSE;
+	s64_t n;
+
+	if(!xfs_isfile(ctx, filename))
+		return TRUE;
+
+	file = xfs_open_read(ctx, filename);
+	if(!file)
+		return FALSE;
+	if((p = xfs_mmap(file, &n)) && (n == (s64_t)(((u32_t)header[7] << 24) | ((u32_t)header[6] << 16) | ((u32_t)header[5] << 8) | ((u32_t)header[4] << 0))))
+	{
+		if(crc32_sum(0, (const uint8_t *)p, n) == (((u32_t)header[3] << 24) | ((u32_t)header[2] << 16) | ((u32_t)header[1] << 8) | ((u32_t)header[0] << 0)))
+			ret = TRUE;
+	}
+	xfs_close(file);
+	return ret;
+}
+
+static bool_t __loadbytecode(lua_State * L, const char * filename)
+{
+	struct xfs_context_t * ctx = luahelper_runtime(L)->__xfs_ctx;
+	struct xfs_file_t * file;
+	const u8_t * p;
+	char * name;
+	bool_t ret = FALSE;
+	s64_t len;
+
+	name = malloc(strlen(filename) + 2);
+	if(!name)
+		return FALSE;
+	strcpy(name, filename);
+	strcat(name, "c");
+
+	if(xfs_isfile(ctx, name) && (file = xfs_open_read(ctx, name)))
+	{
+		if((p = xfs_mmap(file, &len)) && (len > 8) && __source_match(ctx, filename, p))
+		{
+			if(luaL_loadbufferx(L, (const char *)(p + 8), len - 8, filename, "b") == LUA_OK)
+				ret = TRUE;
+			else
+				lua_pop(L, 1);
+		}
+		xfs_close(file);
+	}
+	free(name);
+	return ret;
+}
+
 static int l_search_package_lua(lua_State * L)
 {
 	struct xfs_context_t * ctx = luahelper_runtime(L)->__xfs_ctx;
 	const char * filename = lua_tostring(L, -1);
+	ktime_t stamp;
+	bool_t found;
 	char * buf;
 	size_t len, i;
 
@@ -183,12 +267,27 @@ static int l_search_package_lua(lua_State * L)
 	else
 		strcat(buf, ".lua");
 
-	if(xfs_isfile(ctx, buf))
+	len = strlen(buf);
+	strcat(buf, "c");
+	found = xfs_isfile(ctx, buf);
+	buf[len] = 0;
+
+	if(found || xfs_isfile(ctx, buf))
 	{
+		stamp = ktime_get();
 		lua_pop(L, 1);
-		lua_pushcfunction(L, __loadfile);
-		lua_pushstring(L, buf);
-		lua_call(L, 1, 1);
+		if(__loadbytecode(L, buf))
+		{
+			__loadstat.bytecode++;
+		}
+		else
+		{
+			lua_pushcfunction(L, __loadfile);
+			lua_pushstring(L, buf);
+			lua_call(L, 1, 1);
+		}
+		__loadstat.modules++;
+		__loadstat.load += ktime_to_ns(ktime_sub(ktime_get(), stamp));
 	}
 	else
 	{
@@ -219,6 +318,16 @@ static int l_xboot_readline(lua_State * L)
 	return 1;
 }
 
+static int l_xboot_loadstat(lua_State * L)
+{
+	lua_newtable(L);
+	luahelper_set_intfield(L, "modules", __loadstat.modules);
+	luahelper_set_intfield(L, "bytecode", __loadstat.bytecode);
+	luahelper_set_numfield(L, "load", (lua_Number)__loadstat.load / 1000000000.0);
+	luahelper_set_numfield(L, "elapsed", (lua_Number)ktime_to_ns(ktime_sub(ktime_get(), __loadstat.start)) / 1000000000.0);
+	return 1;
+}
+
 static int pmain(lua_State * L)
 {
 	int argc = (int)lua_tointeger(L, 1);
@@ -247,6 +356,8 @@ static int pmain(lua_State * L)
 	lua_setfield(L, -2, "uniqueid");
 	lua_pushcfunction(L, l_xboot_readline);
 	lua_setfield(L, -2, "readline");
+	lua_pushcfunction(L, l_xboot_loadstat);
+	lua_setfield(L, -2, "loadstat");
 	lua_createtable(L, argc, 0);
 	for(i = 0; i < argc; i++)
 	{
@@ -269,6 +380,7 @@ static void * l_alloc(void * ud, void * ptr, size_t osize, size_t nsize)
 	}
 	else
 	{
+		lprofiler_alloc(ptr, osize, nsize);
 		return realloc(ptr, nsize);
 	}
 }
@@ -293,6 +405,8 @@ int vmexec(int argc, char ** argv)
 	lua_State * L;
 	int status = LUA_ERRRUN, result;
 
+	memset(&__loadstat, 0, sizeof(__loadstat));
+	__loadstat.start = ktime_get();
 	runtime_create_save(&rt, argv[0], &r);
 	L = l_newstate(&rt);
 	if(L)
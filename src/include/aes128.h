@@ -22,6 +22,8 @@ void aes128_cbc_encrypt(struct aes128_ctx_t * ctx, uint8_t * iv, uint8_t * in, u
 void aes128_cbc_decrypt(struct aes128_ctx_t * ctx, uint8_t * iv, uint8_t * in, uint8_t * out, int blks);
 void aes128_ctr_encrypt(struct aes128_ctx_t * ctx, uint64_t offset, uint8_t * in, uint8_t * out, int bytes);
 void aes128_ctr_decrypt(struct aes128_ctx_t * ctx, uint64_t offset, uint8_t * in, uint8_t * out, int bytes);
+int cpu_aes128_encrypt(const uint8_t * xkey, const uint8_t * in, uint8_t * out, int blks);
+int cpu_aes128_decrypt(const uint8_t * xkey, const uint8_t * in, uint8_t * out, int blks);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,40 @@
+#ifndef __BANK_H__
+#define __BANK_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <audio/sound.h>
+
+/*
+ * A short clip decoded once into memory, played by a fixed set of voices
+ * which all share the immutable pcm data
+ */
+struct sound_bank_t
+{
+	/* Clip information */
+	struct sound_info_t info;
+
+	/* Decoded pcm data */
+	void * pcm;
+
+	/* Voices referring to the pcm data */
+	struct sound_t * voice;
+	int nvoice;
+
+	/* Next voice to steal when all are busy */
+	int next;
+};
+
+struct sound_bank_t * sound_bank_alloc(const char * filename, int voices);
+void sound_bank_free(struct sound_bank_t * bank);
+struct sound_t * sound_bank_play(struct sound_bank_t * bank, int volume);
+void sound_bank_stop(struct sound_bank_t * bank);
+int sound_bank_playing(struct sound_bank_t * bank);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BANK_H__ */
@@ -0,0 +1,92 @@
+#ifndef __MIXER_H__
+#define __MIXER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <audio/sound.h>
+
+/*
+ * The mixer output, signed 16-bits native endian interleaved stereo
+ */
+#define MIXER_OUTPUT_FORMAT		(PCM_FORMAT_BIT16)
+#define MIXER_OUTPUT_CHANNEL	(2)
+#define MIXER_COMMAND_SIZE		(64)
+
+enum mixer_cmd_t {
+	MIXER_COMMAND_PLAY		= 0,
+	MIXER_COMMAND_PAUSE		= 1,
+	MIXER_COMMAND_STOP		= 2,
+	MIXER_COMMAND_VOLUME	= 3,
+};
+
+struct mixer_command_t
+{
+	enum mixer_cmd_t cmd;
+	struct sound_t * snd;
+	int arg;
+};
+
+struct mixer_stream_t
+{
+	/* The playing sound, NULL for a free stream */
+	struct sound_t * snd;
+
+	/* Input frames per output frame and the position between prev and cur, in q16 */
+	u32_t step;
+	u32_t phase;
+	s32_t prev[2];
+	s32_t cur[2];
+
+	/* Decoded input frames, in native stereo */
+	int index;
+	int count;
+	s16_t frame[CONFIG_AUDIO_MIXER_FRAMES * 2];
+
+	/* Raw input pcm */
+	u32_t raw[CONFIG_AUDIO_MIXER_FRAMES * 2];
+};
+
+struct mixer_t
+{
+	/* Output rate */
+	enum pcm_rate_t rate;
+
+	/* Master gain in q15, and the requested volume in percent */
+	s32_t gain;
+	int volume;
+
+	/* Running flag, cleared by the render side when it goes idle */
+	volatile int running;
+
+	/* Single consumer command ring, producers serialized by lock */
+	struct mixer_command_t command[MIXER_COMMAND_SIZE];
+	volatile unsigned int head;
+	volatile unsigned int tail;
+	spinlock_t lock;
+
+	/* Held while the streams are rendered or synchronized */
+	spinlock_t render;
+
+	struct mixer_stream_t stream[CONFIG_AUDIO_MIXER_STREAMS];
+	s32_t accum[CONFIG_AUDIO_MIXER_FRAMES * 2];
+};
+
+extern struct mixer_t __audio_mixer;
+
+void mixer_init(struct mixer_t * m, enum pcm_rate_t rate);
+bool_t mixer_post(struct mixer_t * m, enum mixer_cmd_t cmd, struct sound_t * snd, int arg);
+void mixer_prefetch(struct mixer_t * m);
+bool_t mixer_pending(struct mixer_t * m);
+void mixer_sync(struct mixer_t * m);
+int mixer_active(struct mixer_t * m);
+int mixer_render(struct mixer_t * m, void * buf, int count);
+void mixer_set_volume(struct mixer_t * m, int percent);
+int mixer_get_volume(struct mixer_t * m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MIXER_H__ */
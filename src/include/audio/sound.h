@@ -6,6 +6,7 @@ extern "C" {
 #endif
 
 #include <xboot.h>
+#include <fifo.h>
 
 enum pcm_format_t {
 	PCM_FORMAT_BIT8		= 8,
@@ -55,9 +56,24 @@ struct sound_t
 	/* Sound volume */
 	int volume;
 
-	/* Sound position */
+	/* Applied gain in q15, ramping toward the volume */
+	s32_t gain;
+
+	/* Sound position, where the decoder is */
 	int position;
 
+	/* Prefetched pcm data, filled in main loop context */
+	struct fifo_t * fifo;
+
+	/* Prefetch lock */
+	spinlock_t lock;
+
+	/* Pending seek for the prefetcher, negative if none */
+	volatile int pending;
+
+	/* Decoder reached the end of the sound */
+	volatile int eof;
+
 	/* Sound seek */
 	int (*seek)(struct sound_t * snd, int offset);
 
@@ -71,8 +87,29 @@ struct sound_t
 	void * priv;
 };
 
+struct sound_decoder_t
+{
+	/* The decoder name */
+	char * name;
+
+	/* The file extension */
+	char * ext;
+
+	/* Decoder list */
+	struct list_head list;
+
+	/* Probe the file and fill the sound, returning false if not handled */
+	bool_t (*load)(struct sound_t * snd, const char * filename);
+};
+
+bool_t register_sound_decoder(struct sound_decoder_t * dec);
+bool_t unregister_sound_decoder(struct sound_decoder_t * dec);
+
 struct sound_t * sound_alloc(const char * filename);
 void sound_free(struct sound_t * snd);
+int sound_read(struct sound_t * snd, void * buf, int count);
+void sound_prefetch(struct sound_t * snd);
+void sound_gain(void * buf, int len, enum pcm_format_t fmt, int ch, s32_t from, s32_t to);
 struct sound_info_t * sound_get_info(struct sound_t * snd);
 enum sound_status_t sound_get_status(struct sound_t * snd);
 void sound_set_volume(struct sound_t * snd, int percent);
@@ -0,0 +1,32 @@
+#ifndef __WAV_H__
+#define __WAV_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <xboot.h>
+
+enum wav_format_tag_t {
+	WAV_FORMAT_PCM			= 0x0001,
+	WAV_FORMAT_IMA_ADPCM	= 0x0011,
+};
+
+struct wav_format_t {
+	u16_t tag;
+	u16_t channel;
+	u32_t rate;
+	u32_t byterate;
+	u16_t align;
+	u16_t bps;
+	u16_t extra;
+	u16_t spb;
+};
+
+bool_t wav_parse(int fd, struct wav_format_t * fmt, u32_t * offset, u32_t * size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WAV_H__ */
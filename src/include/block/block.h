@@ -27,6 +27,9 @@ struct block_t
 	/* Sync cache to block device */
 	void (*sync)(struct block_t * blk);
 
+	/* Direct address of block, NULL if block device isn't memory mapped */
+	void * (*mmap)(struct block_t * blk, u64_t blkno);
+
 	/* Private data */
 	void * priv;
 };
@@ -76,6 +79,7 @@ bool_t unregister_block(struct block_t * blk);
 u64_t block_read(struct block_t * blk, u8_t * buf, u64_t offset, u64_t count);
 u64_t block_write(struct block_t * blk, u8_t * buf, u64_t offset, u64_t count);
 void block_sync(struct block_t * blk);
+void * block_mmap(struct block_t * blk, u64_t offset, u64_t count);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,74 @@
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <xboot.h>
+#include <ewma.h>
+#include <kalman.h>
+#include <mean.h>
+#include <median.h>
+
+#define CAPTURE_MAX_VALUES		(3)
+#define CAPTURE_MAX_RATE		(1000000)
+
+enum capture_filter_type_t {
+	CAPTURE_FILTER_NONE		= 0,
+	CAPTURE_FILTER_EWMA		= 1,
+	CAPTURE_FILTER_KALMAN	= 2,
+	CAPTURE_FILTER_MEAN		= 3,
+	CAPTURE_FILTER_MEDIAN	= 4,
+};
+
+struct capture_sample_t {
+	s64_t time;
+	s32_t value[CAPTURE_MAX_VALUES];
+};
+
+struct capture_filter_t {
+	enum capture_filter_type_t type;
+	void * priv;
+};
+
+struct capture_t
+{
+	/* Samples per second and values per sample */
+	int rate;
+	int nvalue;
+
+	/* Read one sample from the source */
+	bool_t (*read)(struct capture_t * s, s32_t * value);
+
+	/* Source and its channel */
+	void * source;
+	int channel;
+
+	struct timer_t timer;
+	ktime_t period;
+	struct fifo_t * fifo;
+	struct capture_filter_t filter[CAPTURE_MAX_VALUES];
+	spinlock_t lock;
+	bool_t running;
+	u64_t count;
+	u64_t overrun;
+	u64_t missed;
+};
+
+struct capture_t * capture_alloc(int rate, int nvalue, int depth, bool_t (*read)(struct capture_t *, s32_t *), void * source, int channel);
+struct capture_t * capture_alloc_adc(const char * name, int channel, int rate, int depth);
+struct capture_t * capture_alloc_gmeter(const char * name, int rate, int depth);
+struct capture_t * capture_alloc_thermometer(const char * name, int rate, int depth);
+void capture_free(struct capture_t * s);
+bool_t capture_set_filter(struct capture_t * s, enum capture_filter_type_t type, float * args, int nargs);
+void capture_start(struct capture_t * s);
+void capture_stop(struct capture_t * s);
+int capture_available(struct capture_t * s);
+int capture_read(struct capture_t * s, struct capture_sample_t * buf, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CAPTURE_H__ */
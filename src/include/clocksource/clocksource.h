@@ -175,6 +175,7 @@ bool_t register_clocksource(struct device_t ** device, struct clocksource_t * cs
 bool_t unregister_clocksource(struct clocksource_t * cs);
 
 ktime_t clocksource_ktime_get(struct clocksource_t * cs);
+bool_t clocksource_ready(void);
 ktime_t ktime_get(void);
 
 #ifdef __cplusplus
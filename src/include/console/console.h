@@ -18,6 +18,12 @@ struct console_t
 	/* Write console */
 	ssize_t (*write)(struct console_t * console, const unsigned char * buf, size_t count);
 
+	/*
+	 * Start sending the tx ring without waiting, the driver fetches the
+	 * data with console_tx_pull. Consoles without it are written directly.
+	 */
+	void (*kick)(struct console_t * console);
+
 	/* Private data */
 	void * priv;
 };
@@ -32,6 +38,9 @@ bool_t console_set(const char * name);
 ssize_t console_stdin_read(unsigned char * buf, size_t count);
 ssize_t console_stdout_write(const unsigned char * buf, size_t count);
 ssize_t console_stderr_write(const unsigned char * buf, size_t count);
+int console_stdout_vprintf(const char * fmt, va_list ap);
+size_t console_tx_pull(struct console_t * console, unsigned char * buf, size_t count);
+void console_flush(void);
 
 #ifdef __cplusplus
 }
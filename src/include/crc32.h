@@ -10,6 +10,7 @@ extern "C" {
 #include <string.h>
 
 uint32_t crc32_sum(uint32_t crc, const uint8_t * buf, int len);
+int cpu_crc32_sum(uint32_t * crc, const uint8_t * buf, int len);
 
 #ifdef __cplusplus
 }
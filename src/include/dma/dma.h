@@ -5,12 +5,100 @@
 extern "C" {
 #endif
 
+#include <xboot.h>
+
 enum {
 	DMA_BIDIRECTIONAL	= 0,
 	DMA_TO_DEVICE		= 1,
 	DMA_FROM_DEVICE		= 2,
 };
 
+enum {
+	DMA_SRC_FIXED		= (1 << 0),
+	DMA_DST_FIXED		= (1 << 1),
+};
+
+/*
+ * One contiguous transfer, chained through next. A cyclic chain links the
+ * last descriptor back to the first one.
+ */
+struct dma_desc_t
+{
+	struct dma_desc_t * next;
+	unsigned long src;
+	unsigned long dst;
+	size_t size;
+	int width;
+	int flags;
+};
+
+struct dma_sg_t
+{
+	void * buf;
+	size_t size;
+};
+
+struct dmachip_t;
+
+struct dma_channel_t
+{
+	struct dmachip_t * chip;
+	int offset;
+	int dma;
+
+	bool_t used;
+	volatile bool_t busy;
+	bool_t cyclic;
+	struct dma_desc_t * desc;
+	void (*complete)(struct dma_channel_t * ch, void * data);
+	void * data;
+
+	u64_t bytes;
+	u64_t transfers;
+};
+
+struct dmachip_t
+{
+	char * name;
+	int base;
+	int ndma;
+
+	bool_t (*start)(struct dmachip_t * chip, int offset, struct dma_desc_t * desc);
+	void (*stop)(struct dmachip_t * chip, int offset);
+
+	struct dma_channel_t * channel;
+	spinlock_t lock;
+	void * priv;
+};
+
+struct dmachip_t * search_dmachip(int dma);
+bool_t register_dmachip(struct device_t ** device, struct dmachip_t * chip);
+bool_t unregister_dmachip(struct dmachip_t * chip);
+void dmachip_complete(struct dmachip_t * chip, int offset, struct dma_desc_t * desc);
+
+struct dma_desc_t * dma_desc_alloc(unsigned long dst, unsigned long src, size_t size, int width, int flags);
+struct dma_desc_t * dma_desc_chain(struct dma_desc_t * head, struct dma_desc_t * desc);
+void dma_desc_free(struct dma_desc_t * desc);
+struct dma_desc_t * dma_prep_memcpy(void * dst, const void * src, size_t size);
+struct dma_desc_t * dma_prep_slave(unsigned long addr, void * buf, size_t size, int dir, int width);
+struct dma_desc_t * dma_prep_slave_sg(unsigned long addr, struct dma_sg_t * sg, int nsg, int dir, int width);
+struct dma_desc_t * dma_prep_cyclic(unsigned long addr, void * buf, size_t size, size_t period, int dir, int width);
+
+int dma_is_valid(int dma);
+struct dma_channel_t * dma_request(int dma);
+struct dma_channel_t * dma_request_by_name(const char * name);
+struct dma_channel_t * dma_request_dt(struct dtnode_t * n, const char * name);
+void dma_release(struct dma_channel_t * ch);
+bool_t dma_submit(struct dma_channel_t * ch, struct dma_desc_t * desc, void (*complete)(struct dma_channel_t *, void *), void * data);
+void dma_stop(struct dma_channel_t * ch);
+bool_t dma_is_busy(struct dma_channel_t * ch);
+bool_t dma_wait(struct dma_channel_t * ch, int timeout);
+
+void * dma_memcpy(void * dst, const void * src, size_t size);
+void * dma_memset(void * dst, int c, size_t size);
+bool_t dma_memcpy_async(void * dst, const void * src, size_t size, void (*complete)(void *), void * data);
+bool_t dma_memset_async(void * dst, int c, size_t size, void (*complete)(void *), void * data);
+
 void * dma_alloc_coherent(unsigned long size);
 void dma_free_coherent(void * addr);
 void * dma_alloc_noncoherent(unsigned long size);
@@ -0,0 +1,36 @@
+#ifndef __FRAMEWORK_L_PROFILER_H__
+#define __FRAMEWORK_L_PROFILER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <framework/luahelper.h>
+
+enum lprofiler_phase_t {
+	LPROFILER_PHASE_DISPATCH	= 0,
+	LPROFILER_PHASE_TIMERS		= 1,
+	LPROFILER_PHASE_DRAW		= 2,
+	LPROFILER_PHASE_PRESENT		= 3,
+	LPROFILER_PHASE_MAX,
+};
+
+struct lprofiler_frame_t {
+	u64_t phase[LPROFILER_PHASE_MAX];
+	u64_t gc;
+	u64_t alloc;
+};
+
+void lprofiler_alloc(void * ptr, size_t osize, size_t nsize);
+void lprofiler_gc_begin(lua_State * L);
+void lprofiler_gc_end(lua_State * L);
+void lprofiler_phase(int phase);
+void lprofiler_frame_commit(void);
+void lprofiler_frame_last(struct lprofiler_frame_t * f);
+int luaopen_profiler(lua_State * L);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAMEWORK_L_PROFILER_H__ */
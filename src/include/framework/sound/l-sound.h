@@ -0,0 +1,18 @@
+#ifndef __FRAMEWORK_L_SOUND_H__
+#define __FRAMEWORK_L_SOUND_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <framework/luahelper.h>
+
+#define	MT_SOUND	"mt_sound"
+
+int luaopen_sound(lua_State * L);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAMEWORK_L_SOUND_H__ */
@@ -23,6 +23,7 @@ loff_t read(int fd, void * buf, loff_t len);
 loff_t write(int fd, void * buf, loff_t len);
 loff_t lseek(int fd, loff_t offset, s32_t whence);
 int fstat(int fd, struct stat * st);
+void * mmap(int fd, loff_t * len);
 int ioctl(int fd, int cmd, void * arg);
 int fsync(int fd);
 int close(int fd);
@@ -128,6 +128,7 @@ struct vnops_t {
 	s32_t (*vop_setattr)(struct vnode_t *, struct vattr_t *);
 	s32_t (*vop_inactive)(struct vnode_t *);
 	s32_t (*vop_truncate)(struct vnode_t *, loff_t);
+	s32_t (*vop_mmap)(struct vnode_t *, struct file_t *, void **);
 };
 
 /*
@@ -249,6 +250,7 @@ s32_t sys_lseek(struct file_t * fp, loff_t off, u32_t type, loff_t * origin);
 s32_t sys_ioctl(struct file_t * fp, int cmd, void * arg);
 s32_t sys_fsync(struct file_t * fp);
 s32_t sys_fstat(struct file_t * fp, struct stat * st);
+s32_t sys_mmap(struct file_t * fp, void ** addr, loff_t * len);
 s32_t sys_opendir(char * path, struct file_t ** file);
 s32_t sys_closedir(struct file_t * fp);
 s32_t sys_readdir(struct file_t * fp, struct dirent_t * dir);
@@ -43,6 +43,18 @@ struct i2c_device_t {
 	int flags;
 };
 
+/*
+ * A transaction of several messages with repeated starts and one stop
+ */
+#define I2C_XFER_MAX_MSGS	(16)
+
+struct i2c_xfer_t {
+	const struct i2c_device_t * dev;
+	struct i2c_msg_t msgs[I2C_XFER_MAX_MSGS];
+	int num;
+	int len;
+};
+
 struct i2c_t * search_i2c(const char * name);
 bool_t register_i2c(struct device_t ** device, struct i2c_t * i2c);
 bool_t unregister_i2c(struct i2c_t * i2c);
@@ -52,6 +64,11 @@ void i2c_device_free(struct i2c_device_t * client);
 int i2c_transfer(struct i2c_t * i2c, struct i2c_msg_t * msgs, int num);
 int i2c_master_send(const struct i2c_device_t * dev, void * buf, int count);
 int i2c_master_recv(const struct i2c_device_t * dev, void * buf, int count);
+int i2c_device_write_then_read(const struct i2c_device_t * dev, void * txbuf, int txlen, void * rxbuf, int rxlen);
+void i2c_xfer_init(struct i2c_xfer_t * x, const struct i2c_device_t * dev);
+bool_t i2c_xfer_write(struct i2c_xfer_t * x, void * buf, int len);
+bool_t i2c_xfer_read(struct i2c_xfer_t * x, void * buf, int len);
+int i2c_xfer_commit(struct i2c_xfer_t * x);
 
 #ifdef __cplusplus
 }
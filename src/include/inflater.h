@@ -0,0 +1,31 @@
+#ifndef __INFLATER_H__
+#define __INFLATER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <xboot/module.h>
+#include <types.h>
+
+struct inflater_t {
+	void * stream;
+	u8_t * window;
+	size_t size;
+	size_t len;
+	u64_t total;
+	int status;
+	ssize_t (*output)(void * data, const u8_t * buf, size_t len);
+	void * data;
+};
+
+struct inflater_t * inflater_alloc(size_t size, ssize_t (*output)(void * data, const u8_t * buf, size_t len), void * data);
+void inflater_free(struct inflater_t * in);
+ssize_t inflater_write(struct inflater_t * in, const u8_t * buf, size_t len);
+bool_t inflater_finish(struct inflater_t * in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INFLATER_H__ */
@@ -0,0 +1,52 @@
+#ifndef __INPUT_SCAN_H__
+#define __INPUT_SCAN_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <xboot.h>
+#include <adc/adc.h>
+#include <input/input.h>
+
+/*
+ * A polled input source, all sources share the timer of the scan engine
+ */
+struct input_scan_t
+{
+	/* Scan interval in milliseconds */
+	int interval;
+
+	/* Can be parked when idle, input_scan_kick is called on change */
+	bool_t wakeup;
+
+	/* Sample the source, returns non zero while keys are down or bouncing */
+	int (*scan)(struct input_scan_t * s);
+
+	/* Private data */
+	void * priv;
+
+	/* Engine state */
+	struct list_head list;
+	ktime_t next;
+	bool_t parked;
+};
+
+struct input_debounce_t
+{
+	int state;
+	int value;
+	int count;
+};
+
+bool_t register_input_scan(struct input_scan_t * s);
+bool_t unregister_input_scan(struct input_scan_t * s);
+void input_scan_kick(struct input_scan_t * s);
+int input_scan_adc_voltage(struct adc_t * adc, int channel);
+int input_debounce(struct input_debounce_t * d, int value, int samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INPUT_SCAN_H__ */
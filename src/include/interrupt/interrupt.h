@@ -45,6 +45,7 @@ bool_t request_irq(int irq, void (*func)(void *), enum irq_type_t type, void * d
 bool_t free_irq(int irq);
 void enable_irq(int irq);
 void disable_irq(int irq);
+void * interrupt_get_regs(void);
 void interrupt_handle_exception(void * regs);
 
 #ifdef __cplusplus
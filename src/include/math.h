@@ -233,6 +233,7 @@ double	scalbln(double, long);
 float	scalblnf(float, long);
 double	sin(double);
 float	sinf(float);
+void	sincosf(float, float *, float *);
 double	sinh(double);
 float	sinhf(float);
 double	sqrt(double);
@@ -244,6 +245,19 @@ float	tanhf(float);
 double	trunc(double);
 float	truncf(float);
 
+/*
+ * Batched and approximate variants, see lib/libm/vmathf.c for error bounds
+ */
+float	fast_sinf(float);
+float	fast_cosf(float);
+float	fast_exp2f(float);
+float	fast_expf(float);
+void	vsinf(float *, const float *, int);
+void	vcosf(float *, const float *, int);
+void	vsincosf(float *, float *, const float *, int);
+void	vexp2f(float *, const float *, int);
+void	vexpf(float *, const float *, int);
+
 /*
  * libm kernel functions
  */
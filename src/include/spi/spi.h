@@ -24,6 +24,9 @@ struct spi_t
 	/* Master transfer */
 	int (*transfer)(struct spi_t * spi, struct spi_msg_t * msgs);
 
+	/* Master transfer of many messages at once, e.g. chained dma, optional */
+	int (*transfer_msgs)(struct spi_t * spi, struct spi_msg_t * msgs, int num);
+
 	/* Activate chip select */
 	void (*select)(struct spi_t * spi, int cs);
 
@@ -42,11 +45,24 @@ struct spi_device_t {
 	int speed;
 };
 
+/*
+ * A transaction of several segments under a single chip select
+ */
+#define SPI_XFER_MAX_MSGS	(16)
+
+struct spi_xfer_t {
+	struct spi_device_t * dev;
+	struct spi_msg_t msgs[SPI_XFER_MAX_MSGS];
+	int num;
+	int len;
+};
+
 struct spi_t * search_spi(const char * name);
 bool_t register_spi(struct device_t ** device, struct spi_t * spi);
 bool_t unregister_spi(struct spi_t * spi);
 
 int spi_transfer(struct spi_t * spi, struct spi_msg_t * msg);
+int spi_transfer_msgs(struct spi_t * spi, struct spi_msg_t * msgs, int num);
 void spi_select(struct spi_t * spi, int cs);
 void spi_deselect(struct spi_t * spi, int cs);
 struct spi_device_t * spi_device_alloc(const char * spibus, int cs, int mode, int bits, int speed);
@@ -54,6 +70,11 @@ void spi_device_free(struct spi_device_t * dev);
 int spi_device_write_then_read(struct spi_device_t * dev, void * txbuf, int txlen, void * rxbuf, int rxlen);
 void spi_device_select(struct spi_device_t * dev);
 void spi_device_deselect(struct spi_device_t * dev);
+void spi_xfer_init(struct spi_xfer_t * x, struct spi_device_t * dev);
+bool_t spi_xfer_write(struct spi_xfer_t * x, void * buf, int len);
+bool_t spi_xfer_read(struct spi_xfer_t * x, void * buf, int len);
+bool_t spi_xfer_duplex(struct spi_xfer_t * x, void * txbuf, void * rxbuf, int len);
+int spi_xfer_commit(struct spi_xfer_t * x);
 
 #ifdef __cplusplus
 }
@@ -6,6 +6,7 @@ extern "C" {
 #endif
 
 #include <xboot.h>
+#include <fifo.h>
 
 struct uart_t
 {
@@ -24,6 +25,38 @@ struct uart_t
 	/* Write uart */
 	ssize_t (*write)(struct uart_t * uart, const u8_t * buf, size_t count);
 
+	/*
+	 * Service an interrupt or dma driven uart with its interrupt masked,
+	 * moving received data into the rx ring and the tx ring out to the
+	 * hardware. Polled uarts leave it NULL and have no rings.
+	 */
+	void (*poll)(struct uart_t * uart);
+
+	/* Receive and transmit rings, owned by the uart core */
+	struct fifo_t * rxfifo;
+	struct fifo_t * txfifo;
+
+	/*
+	 * Optional source drained after the tx ring, called by uart_tx_pull
+	 * from the transmit path, which lets a console keep its own backlog
+	 */
+	size_t (*txrefill)(struct uart_t * uart, u8_t * buf, size_t count, void * data);
+	void * txrefill_data;
+
+	/* Blocking modes and timeout in ms, zero waits forever */
+	bool_t rxblock;
+	bool_t txblock;
+	int timeout;
+
+	/* Bytes a blocked reader waits for, and free space a blocked writer waits for */
+	int rxwm;
+	int txwm;
+
+	/* Counters */
+	u64_t rxbytes;
+	u64_t txbytes;
+	u64_t overrun;
+
 	/* Private data */
 	void * priv;
 };
@@ -36,6 +69,10 @@ bool_t uart_set(struct uart_t * uart, int baud, int data, int parity, int stop);
 bool_t uart_get(struct uart_t * uart, int * baud, int * data, int * parity, int * stop);
 ssize_t uart_read(struct uart_t * uart, u8_t * buf, size_t count);
 ssize_t uart_write(struct uart_t * uart, const u8_t * buf, size_t count);
+void uart_set_mode(struct uart_t * uart, bool_t rxblock, bool_t txblock, int timeout);
+void uart_rx_push(struct uart_t * uart, const u8_t * buf, size_t count);
+size_t uart_tx_pull(struct uart_t * uart, u8_t * buf, size_t count);
+void uart_tx_kick(struct uart_t * uart);
 
 #ifdef __cplusplus
 }
@@ -48,6 +48,9 @@ extern "C" {
 #include <xboot/seqlock.h>
 #include <xboot/event.h>
 #include <xboot/profiler.h>
+#include <xboot/sampler.h>
+#include <xboot/boottime.h>
+#include <xboot/kallsyms.h>
 #include <xboot/notifier.h>
 #include <xboot/initcall.h>
 #include <xboot/module.h>
@@ -0,0 +1,27 @@
+#ifndef __BOOTTIME_H__
+#define __BOOTTIME_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <types.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum boottime_type_t {
+	BOOTTIME_TYPE_INITCALL	= 0,
+	BOOTTIME_TYPE_PROBE		= 1,
+};
+
+s64_t boottime_now(void);
+void boottime_record(enum boottime_type_t type, const char * name, void * func, s64_t start);
+void boottime_finish(void);
+void boottime_report(int top);
+bool_t boottime_trace(const char * filename);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BOOTTIME_H__ */
@@ -19,36 +19,37 @@ enum device_type_t {
 	DEVICE_TYPE_CONSOLE			= 8,
 	DEVICE_TYPE_DAC				= 9,
 	DEVICE_TYPE_DISK			= 10,
-	DEVICE_TYPE_FRAMEBUFFER		= 11,
-	DEVICE_TYPE_GMETER			= 12,
-	DEVICE_TYPE_GPIOCHIP		= 13,
-	DEVICE_TYPE_GYROSCOPE		= 14,
-	DEVICE_TYPE_HYGROMETER		= 15,
-	DEVICE_TYPE_I2C				= 16,
-	DEVICE_TYPE_INPUT			= 17,
-	DEVICE_TYPE_IRQCHIP			= 18,
-	DEVICE_TYPE_LASERSCAN		= 19,
-	DEVICE_TYPE_LED				= 20,
-	DEVICE_TYPE_LEDTRIG			= 21,
-	DEVICE_TYPE_LIGHT			= 22,
-	DEVICE_TYPE_MAGNETOMETER	= 23,
-	DEVICE_TYPE_NVMEM			= 24,
-	DEVICE_TYPE_ORIENTATION		= 25,
-	DEVICE_TYPE_PRESSURE		= 26,
-	DEVICE_TYPE_PROXIMITY		= 27,
-	DEVICE_TYPE_PWM				= 28,
-	DEVICE_TYPE_REGULATOR		= 29,
-	DEVICE_TYPE_RESETCHIP		= 30,
-	DEVICE_TYPE_RNG				= 31,
-	DEVICE_TYPE_RTC				= 32,
-	DEVICE_TYPE_SDHCI			= 33,
-	DEVICE_TYPE_SPI				= 34,
-	DEVICE_TYPE_THERMOMETER		= 35,
-	DEVICE_TYPE_UART			= 36,
-	DEVICE_TYPE_VIBRATOR		= 37,
-	DEVICE_TYPE_WATCHDOG		= 38,
+	DEVICE_TYPE_DMACHIP			= 11,
+	DEVICE_TYPE_FRAMEBUFFER		= 12,
+	DEVICE_TYPE_GMETER			= 13,
+	DEVICE_TYPE_GPIOCHIP		= 14,
+	DEVICE_TYPE_GYROSCOPE		= 15,
+	DEVICE_TYPE_HYGROMETER		= 16,
+	DEVICE_TYPE_I2C				= 17,
+	DEVICE_TYPE_INPUT			= 18,
+	DEVICE_TYPE_IRQCHIP			= 19,
+	DEVICE_TYPE_LASERSCAN		= 20,
+	DEVICE_TYPE_LED				= 21,
+	DEVICE_TYPE_LEDTRIG			= 22,
+	DEVICE_TYPE_LIGHT			= 23,
+	DEVICE_TYPE_MAGNETOMETER	= 24,
+	DEVICE_TYPE_NVMEM			= 25,
+	DEVICE_TYPE_ORIENTATION		= 26,
+	DEVICE_TYPE_PRESSURE		= 27,
+	DEVICE_TYPE_PROXIMITY		= 28,
+	DEVICE_TYPE_PWM				= 29,
+	DEVICE_TYPE_REGULATOR		= 30,
+	DEVICE_TYPE_RESETCHIP		= 31,
+	DEVICE_TYPE_RNG				= 32,
+	DEVICE_TYPE_RTC				= 33,
+	DEVICE_TYPE_SDHCI			= 34,
+	DEVICE_TYPE_SPI				= 35,
+	DEVICE_TYPE_THERMOMETER		= 36,
+	DEVICE_TYPE_UART			= 37,
+	DEVICE_TYPE_VIBRATOR		= 38,
+	DEVICE_TYPE_WATCHDOG		= 39,
 
-	DEVICE_TYPE_MAX_COUNT		= 39,
+	DEVICE_TYPE_MAX_COUNT		= 40,
 };
 
 enum {
@@ -66,6 +67,7 @@ struct device_t
 	struct list_head list;
 	struct list_head head;
 	struct hlist_node node;
+	unsigned int hash;
 
 	char * name;
 	enum device_type_t type;
@@ -78,6 +80,7 @@ extern struct list_head __device_head[DEVICE_TYPE_MAX_COUNT];
 
 char * alloc_device_name(const char * name, int id);
 void free_device_name(char * name);
+bool_t device_exist(const char * name);
 struct device_t * search_device(const char * name, enum device_type_t type);
 struct device_t * search_first_device(enum device_type_t type);
 bool_t register_device(struct device_t * dev);
@@ -19,12 +19,16 @@ struct driver_t
 	void (*remove)(struct device_t * dev);
 	void (*suspend)(struct device_t * dev);
 	void (*resume)(struct device_t * dev);
+
+	int probes;
+	s64_t probe_us;
 };
 
 struct driver_t * search_driver(const char * name);
 bool_t register_driver(struct driver_t * drv);
 bool_t unregister_driver(struct driver_t * drv);
 void probe_device(const char * json, int length);
+void do_deferred_probe(void);
 
 #ifdef __cplusplus
 }
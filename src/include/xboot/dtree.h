@@ -10,12 +10,20 @@ extern "C" {
 #include <string.h>
 #include <json.h>
 
+struct dtindex_t;
+
 struct dtnode_t {
 	const char * name;
 	physical_addr_t addr;
 	json_value * value;
+	struct dtindex_t * index;
 };
 
+struct dtindex_t * dt_index_alloc(json_value * v);
+void dt_index_free(struct dtindex_t * idx);
+bool_t dt_binary_match(const void * buf, size_t len, const void * json, size_t jlen);
+json_value * dt_binary_parse(const void * buf, size_t len);
+
 const char * dt_read_name(struct dtnode_t * n);
 int dt_read_id(struct dtnode_t * n);
 physical_addr_t dt_read_address(struct dtnode_t * n);
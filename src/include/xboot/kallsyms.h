@@ -0,0 +1,17 @@
+#ifndef __KALLSYMS_H__
+#define __KALLSYMS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <types.h>
+
+const char * kallsyms_lookup(virtual_addr_t addr, virtual_addr_t * offset);
+int kallsyms_snprint(char * buf, size_t size, virtual_addr_t addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __KALLSYMS_H__ */
@@ -29,6 +29,17 @@ struct kobj_t
 	/* kobj's children */
 	struct list_head children;
 
+	/* hash of kobj name */
+	u32_t hash;
+
+	/* kobj's node in parent's hash table */
+	struct hlist_node node;
+
+	/* children hash table, only for large directory */
+	struct hlist_head * table;
+	u32_t tsize;
+	u32_t count;
+
 	/* kobj lock */
 	spinlock_t lock;
 
@@ -47,6 +58,7 @@ typedef ssize_t (*kobj_write_t)(struct kobj_t * kobj, void * buf, size_t size);
 
 struct kobj_t * kobj_get_root(void);
 struct kobj_t * kobj_search(struct kobj_t * parent, const char * name);
+struct kobj_t * kobj_lookup(const char * path);
 struct kobj_t * kobj_search_directory_with_create(struct kobj_t * parent, const char * name);
 struct kobj_t * kobj_alloc_directory(const char * name);
 struct kobj_t * kobj_alloc_regular(const char * name, kobj_read_t read, kobj_write_t write, void * priv);
@@ -56,6 +68,7 @@ bool_t kobj_remove(struct kobj_t * parent, struct kobj_t * kobj);
 bool_t kobj_add_directory(struct kobj_t * parent, const char * name);
 bool_t kobj_add_regular(struct kobj_t * parent, const char * name, kobj_read_t read, kobj_write_t write, void * priv);
 bool_t kobj_remove_self(struct kobj_t * kobj);
+u32_t kobj_generation(void);
 
 void do_init_kobj(void);
 
@@ -10,19 +10,38 @@ extern "C" {
 #include <stdint.h>
 #include <list.h>
 
+enum profiler_event_t {
+	PROFILER_EVENT_TIME				= 0,
+	PROFILER_EVENT_CYCLES			= 1,
+	PROFILER_EVENT_INSTRUCTIONS		= 2,
+	PROFILER_EVENT_CACHE_MISSES		= 3,
+	PROFILER_EVENT_BRANCH_MISSES	= 4,
+	PROFILER_EVENT_MAX,
+};
+
 struct profiler_t
 {
 	struct hlist_node node;
 	char * name;
 	int event;
-	int data;
 	uint64_t begin;
 	uint64_t end;
 	uint64_t count;
 };
 
+/*
+ * Architecture hooks, the counter is -1 for the fixed cycle counter
+ */
+int cpu_profiler_counters(void);
+void cpu_profiler_start(int event, int counter);
+void cpu_profiler_stop(int event, int counter);
+uint64_t cpu_profiler_read(int event, int counter);
+void cpu_profiler_reset(void);
+
+int profiler_event_lookup(const char * name);
+const char * profiler_event_name(int event);
 struct profiler_t * profiler_search(const char * name);
-void profiler_snap(const char * name, int event, int data);
+void profiler_snap(const char * name, int event);
 void profiler_dump(void);
 void profiler_reset(void);
 
@@ -0,0 +1,28 @@
+#ifndef __SAMPLER_H__
+#define __SAMPLER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <types.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Architecture hook, fill the interrupted pc and the frame pointer chain
+ */
+int cpu_sampler_backtrace(void * regs, virtual_addr_t * pc, int depth);
+
+bool_t sampler_start(int rate, int depth);
+void sampler_stop(void);
+void sampler_reset(void);
+int sampler_samples(void);
+void sampler_report(int top);
+bool_t sampler_folded(const char * filename);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SAMPLER_H__ */
@@ -28,10 +28,90 @@ extern "C" {
 #define CONFIG_DEVICE_HASH_SIZE				(257)
 #endif
 
+#if !defined(CONFIG_KOBJ_HASH_THRESHOLD)
+#define CONFIG_KOBJ_HASH_THRESHOLD			(16)
+#endif
+
+#if !defined(CONFIG_SYSFS_CACHE_SIZE)
+#define CONFIG_SYSFS_CACHE_SIZE				(32)
+#endif
+
 #if !defined(CONFIG_PROFILER_HASH_SIZE)
 #define CONFIG_PROFILER_HASH_SIZE			(257)
 #endif
 
+#if !defined(CONFIG_PROFILER_MULTIPLEX_INTERVAL)
+#define CONFIG_PROFILER_MULTIPLEX_INTERVAL	(10)
+#endif
+
+#if !defined(CONFIG_SAMPLER_BUFFER_SIZE)
+#define CONFIG_SAMPLER_BUFFER_SIZE			(65536)
+#endif
+
+#if !defined(CONFIG_SAMPLER_MAX_DEPTH)
+#define CONFIG_SAMPLER_MAX_DEPTH			(32)
+#endif
+
+#if !defined(CONFIG_BOOTTIME_ENTRIES)
+#define CONFIG_BOOTTIME_ENTRIES			(512)
+#endif
+
+#if !defined(CONFIG_BOOTTIME_BUDGET)
+#define CONFIG_BOOTTIME_BUDGET			(0)
+#endif
+
+#if !defined(CONFIG_AUDIO_MIXER_RATE)
+#define CONFIG_AUDIO_MIXER_RATE				(44100)
+#endif
+
+#if !defined(CONFIG_AUDIO_MIXER_STREAMS)
+#define CONFIG_AUDIO_MIXER_STREAMS			(8)
+#endif
+
+#if !defined(CONFIG_AUDIO_MIXER_FRAMES)
+#define CONFIG_AUDIO_MIXER_FRAMES			(256)
+#endif
+
+#if !defined(CONFIG_SOUND_PREFETCH_SIZE)
+#define CONFIG_SOUND_PREFETCH_SIZE			(32768)
+#endif
+
+#if !defined(CONFIG_SOUND_BANK_MAX_SIZE)
+#define CONFIG_SOUND_BANK_MAX_SIZE			(1048576)
+#endif
+
+#if !defined(CONFIG_SOUND_BANK_VOICES)
+#define CONFIG_SOUND_BANK_VOICES			(4)
+#endif
+
+#if !defined(CONFIG_UART_RX_RING_SIZE)
+#define CONFIG_UART_RX_RING_SIZE			(4096)
+#endif
+
+#if !defined(CONFIG_UART_TX_RING_SIZE)
+#define CONFIG_UART_TX_RING_SIZE			(4096)
+#endif
+
+#if !defined(CONFIG_CONSOLE_TX_RING_SIZE)
+#define CONFIG_CONSOLE_TX_RING_SIZE			(16384)
+#endif
+
+#if !defined(CONFIG_CONSOLE_TX_TIMEOUT)
+#define CONFIG_CONSOLE_TX_TIMEOUT			(100)
+#endif
+
+#if !defined(CONFIG_XSYNC_PACKET_SIZE)
+#define CONFIG_XSYNC_PACKET_SIZE			(16384)
+#endif
+
+#if !defined(CONFIG_XSYNC_WINDOW)
+#define CONFIG_XSYNC_WINDOW			(8)
+#endif
+
+#if !defined(CONFIG_DMA_MEMCPY_THRESHOLD)
+#define CONFIG_DMA_MEMCPY_THRESHOLD			(65536)
+#endif
+
 #if !defined(CONFIG_MAX_BRIGHTNESS)
 #define CONFIG_MAX_BRIGHTNESS				(1000)
 #endif
@@ -52,6 +52,12 @@ int xboot_main(int argc, char * argv[])
 	/* Do show logo */
 	do_showlogo();
 
+	/* Do boot time check */
+	boottime_finish();
+
+	/* Do deferred probe */
+	do_deferred_probe();
+
 	/* Do auto boot */
 	do_autoboot();
 
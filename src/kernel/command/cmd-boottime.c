@@ -0,0 +1,89 @@
+/*
+ * kernel/command/cmd-boottime.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <command/command.h>
+
+static void usage(void)
+{
+	printf("usage:\r\n");
+	printf("    boottime report [top]\r\n");
+	printf("    boottime trace <file>\r\n");
+}
+
+static int do_boottime(int argc, char ** argv)
+{
+	int top = 20;
+
+	if(argc < 2)
+	{
+		usage();
+		return -1;
+	}
+
+	if(!strcmp(argv[1], "report"))
+	{
+		if(argc > 2)
+			top = strtol(argv[2], NULL, 0);
+		boottime_report(top);
+	}
+	else if(!strcmp(argv[1], "trace"))
+	{
+		if(argc != 3)
+		{
+			usage();
+			return -1;
+		}
+		if(!boottime_trace(argv[2]))
+		{
+			printf("can not write the boot trace to '%s'\r\n", argv[2]);
+			return -1;
+		}
+	}
+	else
+	{
+		usage();
+		return -1;
+	}
+	return 0;
+}
+
+static struct command_t cmd_boottime = {
+	.name	= "boottime",
+	.desc	= "initcall and probe boot time report",
+	.usage	= usage,
+	.exec	= do_boottime,
+};
+
+static __init void boottime_cmd_init(void)
+{
+	register_command(&cmd_boottime);
+}
+
+static __exit void boottime_cmd_exit(void)
+{
+	unregister_command(&cmd_boottime);
+}
+
+command_initcall(boottime_cmd_init);
+command_exitcall(boottime_cmd_exit);
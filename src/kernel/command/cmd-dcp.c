@@ -22,6 +22,7 @@
  *
  */
 
+#include <inflater.h>
 #include <command/command.h>
 
 enum devtype_t {
@@ -30,24 +31,86 @@ enum devtype_t {
 	DEVTYPE_MEM		= 2,
 };
 
+struct dcp_output_t {
+	enum devtype_t type;
+	struct block_t * blk;
+	int fd;
+	u64_t offset;
+	u64_t size;
+	u64_t len;
+	bool_t full;
+	bool_t error;
+};
+
+/*
+ * Writes behind what is already there and returns the bytes actually
+ * written, anything beyond the size of the output is refused
+ */
+static ssize_t dcp_output(void * data, const u8_t * buf, size_t len)
+{
+	struct dcp_output_t * out = (struct dcp_output_t *)data;
+	ssize_t n = 0;
+
+	if(len > out->size - out->len)
+	{
+		len = out->size - out->len;
+		out->full = TRUE;
+	}
+
+	if(len > 0)
+	{
+		switch(out->type)
+		{
+		case DEVTYPE_BLOCK:
+			n = block_write(out->blk, (u8_t *)buf, out->offset + out->len, len);
+			break;
+		case DEVTYPE_FILE:
+			n = write(out->fd, (void *)buf, len);
+			break;
+		case DEVTYPE_MEM:
+			memcpy((void *)((virtual_addr_t)(out->offset + out->len)), buf, len);
+			n = len;
+			break;
+		default:
+			break;
+		}
+	}
+	if(n < 0)
+		n = 0;
+	if(n != len)
+		out->error = TRUE;
+	out->len += n;
+
+	return n;
+}
+
 static void usage(void)
 {
 	printf("usage:\r\n");
-	printf("    dcp <input@offset:size> <output@offset:size>\r\n");
+	printf("    dcp [-z] <input@offset:size> <output@offset:size>\r\n");
 }
 
 static int do_dcp(int argc, char ** argv)
 {
 	enum devtype_t itype, otype;
 	struct block_t * iblk = NULL, * oblk = NULL;
-	int ifd, ofd;
+	int ifd = -1, ofd = -1;
 	char * iname, * oname;
 	u64_t ioff, isize;
 	u64_t ooff, osize;
+	struct dcp_output_t out;
+	struct inflater_t * in = NULL;
+	bool_t z = FALSE;
 	s64_t n, s, l;
 	char * buf;
 	char * p, * offset, * size;
 
+	if((argc == 4) && !strcmp(argv[1], "-z"))
+	{
+		z = TRUE;
+		argc--;
+		argv++;
+	}
 	if(argc != 3)
 	{
 		usage();
@@ -160,7 +223,25 @@ static int do_dcp(int argc, char ** argv)
 		return -1;
 	}
 
-	s = isize < osize ? isize : osize;
+	out.type = otype;
+	out.blk = oblk;
+	out.fd = ofd;
+	out.offset = ooff;
+	out.size = osize;
+	out.len = 0;
+	out.full = FALSE;
+	out.error = FALSE;
+
+	/*
+	 * A compressed input is read up to its own size and expanded on the way
+	 * to the output, in windows of 64K
+	 */
+	s = z ? isize : (isize < osize ? isize : osize);
+	if(z && !(in = inflater_alloc(SZ_64K, dcp_output, &out)))
+	{
+		printf("can't setup the inflater\r\n");
+		s = 0;
+	}
 	l = 0;
 	if(itype == DEVTYPE_BLOCK)
 		block_sync(iblk);
@@ -183,25 +264,36 @@ static int do_dcp(int argc, char ** argv)
 		default:
 			break;
 		}
+		if(n <= 0)
+			break;
 
-		switch(otype)
+		if(in)
 		{
-		case DEVTYPE_BLOCK:
-			block_write(oblk, (u8_t *)buf, ooff + l, n);
-			break;
-		case DEVTYPE_FILE:
-			write(ofd, buf, n);
-			break;
-		case DEVTYPE_MEM:
-			memcpy((void *)((virtual_addr_t)(ooff + l)), buf, n);
-			break;
-		default:
+			if(inflater_write(in, (u8_t *)buf, n) != n)
+			{
+				l += n;
+				break;
+			}
+		}
+		else if(dcp_output(&out, (u8_t *)buf, n) != n)
+		{
+			l = out.len;
 			break;
 		}
 
 		l += n;
 	}
 
+	if(in)
+	{
+		if(!inflater_finish(in) && !out.full && !out.error)
+			printf("broken compressed stream at 0x%llx of input\r\n", ioff + l);
+		inflater_free(in);
+	}
+	if(out.full)
+		printf("output truncated, 0x%llx bytes written\r\n", out.len);
+	else if(out.error)
+		printf("can't write the output at 0x%llx\r\n", ooff + out.len);
 	if(itype == DEVTYPE_FILE)
 		close(ifd);
 	if(otype == DEVTYPE_FILE)
@@ -210,7 +302,7 @@ static int do_dcp(int argc, char ** argv)
 		block_sync(oblk);
 	free(buf);
 
-	printf("copyed %s@0x%llx:0x%llx -> %s@0x%llx:0x%llx\r\n", iname ? iname : "", ioff, s, oname ? oname : "", ooff, s);
+	printf("copyed %s@0x%llx:0x%llx -> %s@0x%llx:0x%llx\r\n", iname ? iname : "", ioff, l, oname ? oname : "", ooff, out.len);
 	return 0;
 }
 
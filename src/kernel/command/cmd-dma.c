@@ -0,0 +1,273 @@
+/*
+ * kernel/command/cmd-dma.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <dma/dma.h>
+#include <command/command.h>
+
+static void usage(void)
+{
+	printf("usage:\r\n");
+	printf("    dma status\r\n");
+	printf("    dma test [channel]\r\n");
+	printf("    dma bench [size] [count]\r\n");
+}
+
+static void dma_status(void)
+{
+	struct device_t * pos, * n;
+	struct dmachip_t * chip;
+	struct dma_channel_t * ch;
+	int i;
+
+	list_for_each_entry_safe(pos, n, &__device_head[DEVICE_TYPE_DMACHIP], head)
+	{
+		chip = (struct dmachip_t *)(pos->priv);
+		printf("%s: channel %d - %d\r\n", chip->name, chip->base, chip->base + chip->ndma - 1);
+		for(i = 0; i < chip->ndma; i++)
+		{
+			ch = &chip->channel[i];
+			printf("    %-4d %-6s %12llu %16llu\r\n", ch->dma,
+				ch->used ? (ch->busy ? "busy" : "idle") : "free", ch->transfers, ch->bytes);
+		}
+	}
+}
+
+static void test_complete(struct dma_channel_t * ch, void * data)
+{
+	(*(volatile int *)data)++;
+}
+
+static const char * test_result(bool_t ok)
+{
+	return ok ? "ok" : "fail";
+}
+
+static void dma_test(int dma)
+{
+	struct device_t * dev;
+	struct dma_channel_t * ch;
+	struct dma_desc_t * desc;
+	struct dma_sg_t sg[3];
+	volatile int count = 0;
+	u32_t fifo = 0x5a5a5a5a;
+	u8_t * src, * dst;
+	size_t size = SZ_64K;
+	ktime_t t;
+	int i;
+
+	if(dma < 0)
+	{
+		dev = search_first_device(DEVICE_TYPE_DMACHIP);
+		ch = dev ? dma_request_by_name(dev->name) : NULL;
+	}
+	else
+		ch = dma_request(dma);
+	if(!ch)
+	{
+		printf("no dma channel available\r\n");
+		return;
+	}
+
+	src = memalign(SZ_4K, size);
+	dst = memalign(SZ_4K, size);
+	if(!src || !dst)
+	{
+		free(src);
+		free(dst);
+		dma_release(ch);
+		return;
+	}
+	for(i = 0; i < size; i++)
+		src[i] = i * 7 + 3;
+
+	memset(dst, 0, size);
+	desc = dma_prep_memcpy(dst, src, size);
+	dma_submit(ch, desc, NULL, NULL);
+	printf("memcpy   : %s\r\n", test_result(dma_wait(ch, 1000) && !memcmp(dst, src, size)));
+	dma_desc_free(desc);
+
+	memset(dst, 0, size);
+	sg[0].buf = src;
+	sg[0].size = 4096;
+	sg[1].buf = src + 4096;
+	sg[1].size = 512;
+	sg[2].buf = src + 8192;
+	sg[2].size = size - 8192;
+	desc = dma_desc_chain(dma_prep_memcpy(dst, sg[0].buf, sg[0].size), dma_prep_memcpy(dst + 4096, sg[1].buf, sg[1].size));
+	desc = dma_desc_chain(desc, dma_prep_memcpy(dst + 8192, sg[2].buf, sg[2].size));
+	dma_submit(ch, desc, test_complete, (void *)&count);
+	printf("chain    : %s\r\n", test_result(dma_wait(ch, 1000) && (count == 1) && !memcmp(dst, src, 4096 + 512) && !memcmp(dst + 8192, src + 8192, size - 8192)));
+	dma_desc_free(desc);
+
+	memset(dst, 0, size);
+	desc = dma_prep_slave((unsigned long)&fifo, dst, 4096, DMA_FROM_DEVICE, 4);
+	dma_submit(ch, desc, NULL, NULL);
+	printf("slave rx : %s\r\n", test_result(dma_wait(ch, 1000) && (((u32_t *)dst)[0] == fifo) && (((u32_t *)dst)[1023] == fifo)));
+	dma_desc_free(desc);
+
+	desc = dma_prep_slave_sg((unsigned long)&fifo, sg, 3, DMA_TO_DEVICE, 4);
+	dma_submit(ch, desc, NULL, NULL);
+	printf("slave tx : %s\r\n", test_result(dma_wait(ch, 1000) && (fifo == ((u32_t *)(src + size))[-1])));
+	dma_desc_free(desc);
+
+	count = 0;
+	desc = dma_prep_cyclic((unsigned long)&fifo, src, 4096, 1024, DMA_TO_DEVICE, 4);
+	dma_submit(ch, desc, test_complete, (void *)&count);
+	t = ktime_add_ms(ktime_get(), 1000);
+	while((count < 8) && ktime_before(ktime_get(), t));
+	printf("cyclic   : %s\r\n", test_result(dma_is_busy(ch) && (count >= 8)));
+	dma_stop(ch);
+	dma_desc_free(desc);
+
+	free(src);
+	free(dst);
+	dma_release(ch);
+}
+
+static void bench_complete(void * data)
+{
+	*((volatile int *)data) = 1;
+}
+
+static void dma_bench(size_t size, int count)
+{
+	volatile int done;
+	u8_t * src, * dst;
+	ktime_t t;
+	s64_t us[5], submit = 0;
+	int i;
+
+	src = memalign(SZ_4K, size);
+	dst = memalign(SZ_4K, size);
+	if(!src || !dst)
+	{
+		printf("out of memory\r\n");
+		free(src);
+		free(dst);
+		return;
+	}
+	memset(src, 0x5a, size);
+
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+		memcpy(dst, src, size);
+	us[0] = ktime_us_delta(ktime_get(), t);
+
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+		dma_memcpy(dst, src, size);
+	us[1] = ktime_us_delta(ktime_get(), t);
+
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+	{
+		ktime_t s = ktime_get();
+		done = 0;
+		dma_memcpy_async(dst, src, size, bench_complete, (void *)&done);
+		submit += ktime_us_delta(ktime_get(), s);
+		while(!done);
+	}
+	us[2] = ktime_us_delta(ktime_get(), t);
+
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+		memset(dst, i, size);
+	us[3] = ktime_us_delta(ktime_get(), t);
+
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+		dma_memset(dst, i, size);
+	us[4] = ktime_us_delta(ktime_get(), t);
+
+	printf("%-16s %12s %12s\r\n", "method", "us", "MB/s");
+	printf("%-16s %12lld %12lld\r\n", "memcpy", us[0] / count, us[0] ? (s64_t)size * count / us[0] : 0);
+	printf("%-16s %12lld %12lld\r\n", "dma_memcpy", us[1] / count, us[1] ? (s64_t)size * count / us[1] : 0);
+	printf("%-16s %12lld %12lld\r\n", "dma_memcpy_async", us[2] / count, us[2] ? (s64_t)size * count / us[2] : 0);
+	printf("%-16s %12lld %12s\r\n", "  cpu busy", submit / count, "-");
+	printf("%-16s %12lld %12lld\r\n", "memset", us[3] / count, us[3] ? (s64_t)size * count / us[3] : 0);
+	printf("%-16s %12lld %12lld\r\n", "dma_memset", us[4] / count, us[4] ? (s64_t)size * count / us[4] : 0);
+
+	free(src);
+	free(dst);
+}
+
+static int do_dma(int argc, char ** argv)
+{
+	size_t size = SZ_1M;
+	int count = 16;
+
+	if(argc < 2)
+	{
+		usage();
+		return -1;
+	}
+
+	if(!strcmp(argv[1], "status"))
+	{
+		dma_status();
+	}
+	else if(!strcmp(argv[1], "test"))
+	{
+		dma_test((argc > 2) ? strtol(argv[2], NULL, 0) : -1);
+	}
+	else if(!strcmp(argv[1], "bench"))
+	{
+		if(argc > 2)
+			size = strtoul(argv[2], NULL, 0);
+		if(argc > 3)
+			count = strtol(argv[3], NULL, 0);
+		if(size < 64)
+			size = 64;
+		if(count < 1)
+			count = 1;
+		printf("copying %ld bytes %d times, threshold %d bytes\r\n", (long)size, count, CONFIG_DMA_MEMCPY_THRESHOLD);
+		dma_bench(size, count);
+	}
+	else
+	{
+		usage();
+		return -1;
+	}
+	return 0;
+}
+
+static struct command_t cmd_dma = {
+	.name	= "dma",
+	.desc	= "dma engine channels, self test and memcpy benchmark",
+	.usage	= usage,
+	.exec	= do_dma,
+};
+
+static __init void dma_cmd_init(void)
+{
+	register_command(&cmd_dma);
+}
+
+static __exit void dma_cmd_exit(void)
+{
+	unregister_command(&cmd_dma);
+}
+
+command_initcall(dma_cmd_init);
+command_exitcall(dma_cmd_exit);
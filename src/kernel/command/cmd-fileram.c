@@ -22,12 +22,39 @@
  *
  */
 
+#include <inflater.h>
 #include <command/command.h>
 
+struct fileram_output_t {
+	u32_t addr;
+	u32_t len;
+	u32_t size;
+	bool_t over;
+};
+
+/*
+ * Expanded data that would run past the maximum size is refused, which
+ * stops the inflater with an error
+ */
+static ssize_t fileram_output(void * data, const u8_t * buf, size_t len)
+{
+	struct fileram_output_t * out = (struct fileram_output_t *)data;
+
+	if(len > out->size - out->len)
+	{
+		out->over = TRUE;
+		return 0;
+	}
+	memcpy((void *)((virtual_addr_t)(out->addr + out->len)), buf, len);
+	out->len += len;
+	return len;
+}
+
 static void usage(void)
 {
 	printf("usage:\r\n");
 	printf("    fileram -f <file> <addr>\r\n");
+	printf("    fileram -z <file> <addr> [size]\r\n");
 	printf("    fileram -r <addr> <size> <file>\r\n");
 }
 
@@ -74,6 +101,59 @@ static int do_fileram(int argc, char ** argv)
 		close(fd);
 		printf("copy file %s to ram 0x%08lx ~ 0x%08lx.\r\n", filename, addr, addr + size);
 	}
+	else if( !strcmp((const char *)argv[1],"-z") )
+	{
+		struct fileram_output_t out;
+		struct inflater_t * in;
+		char * buf;
+
+		filename = (char *)argv[2];
+		addr = strtoul((const char *)argv[3], NULL, 0);
+		out.addr = addr;
+		out.len = 0;
+		out.size = (argc == 5) ? strtoul((const char *)argv[4], NULL, 0) : ~0UL;
+		out.over = FALSE;
+
+		fd = open(filename, O_RDONLY, (S_IRUSR|S_IRGRP|S_IROTH));
+		if(fd < 0)
+		{
+			printf("can not to open the file '%s'\r\n", filename);
+			return -1;
+		}
+
+		buf = malloc(SZ_64K);
+		in = inflater_alloc(SZ_64K, fileram_output, &out);
+		if(!buf || !in)
+		{
+			free(buf);
+			inflater_free(in);
+			close(fd);
+			return -1;
+		}
+
+		for(;;)
+		{
+			n = read(fd, buf, SZ_64K);
+			if((n <= 0) || (inflater_write(in, (u8_t *)buf, n) != n))
+				break;
+		}
+
+		if(!inflater_finish(in))
+		{
+			if(out.over)
+				printf("expanded file '%s' exceeds 0x%08lx bytes\r\n", filename, out.size);
+			else
+				printf("broken compressed file '%s'\r\n", filename);
+			inflater_free(in);
+			free(buf);
+			close(fd);
+			return -1;
+		}
+		inflater_free(in);
+		free(buf);
+		close(fd);
+		printf("expand file %s to ram 0x%08lx ~ 0x%08lx.\r\n", filename, addr, addr + out.len);
+	}
 	else if( !strcmp((const char *)argv[1], "-r") )
 	{
 		if(argc != 5)
@@ -0,0 +1,175 @@
+/*
+ * kernel/command/cmd-kobj.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <command/command.h>
+
+static void usage(void)
+{
+	printf("usage:\r\n");
+	printf("    kobj bench [path] [count]\r\n");
+}
+
+/*
+ * The first readable attribute in depth first order, its path below /sys
+ * written to buf
+ */
+static struct kobj_t * kobj_first_readable(struct kobj_t * kobj, char * buf, size_t len)
+{
+	struct kobj_t * pos, * found;
+	size_t l = strlen(buf);
+
+	list_for_each_entry(pos, &kobj->children, entry)
+	{
+		snprintf(buf + l, len - l, "/%s", pos->name);
+		if((pos->type == KOBJ_TYPE_REG) && pos->read)
+			return pos;
+		if(pos->type == KOBJ_TYPE_DIR)
+		{
+			found = kobj_first_readable(pos, buf, len);
+			if(found)
+				return found;
+		}
+		buf[l] = '\0';
+	}
+	return NULL;
+}
+
+static void kobj_bench(const char * path, int count)
+{
+	struct device_t * pos;
+	char file[256], buf[256], data[256];
+	ktime_t t;
+	s64_t us[3];
+	int i, fd, ndev = 0;
+
+	if(count <= 0)
+	{
+		printf("count must be positive\r\n");
+		return;
+	}
+	if(!path)
+	{
+		file[0] = '\0';
+		if(!kobj_first_readable(kobj_get_root(), file, sizeof(file)))
+		{
+			printf("no readable attribute\r\n");
+			return;
+		}
+		path = file;
+	}
+	else if(!strncmp(path, "/sys/", 5))
+	{
+		path += 4;
+	}
+	else if(*path != '/')
+	{
+		snprintf(file, sizeof(file), "/%s", path);
+		path = file;
+	}
+	if(!kobj_lookup(path))
+	{
+		printf("can't find '/sys%s'\r\n", path);
+		return;
+	}
+	snprintf(buf, sizeof(buf), "/sys%s", path);
+	printf("reading %s %d times\r\n", buf, count);
+
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+	{
+		fd = open(buf, O_RDONLY, 0);
+		if(fd < 0)
+			break;
+		read(fd, data, sizeof(data));
+		close(fd);
+	}
+	us[0] = ktime_us_delta(ktime_get(), t);
+	if(i < count)
+	{
+		printf("can't open '%s'\r\n", buf);
+		return;
+	}
+
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+		kobj_lookup(path);
+	us[1] = ktime_us_delta(ktime_get(), t);
+
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+	{
+		list_for_each_entry(pos, &__device_list, list)
+		{
+			search_device(pos->name, pos->type);
+			if(i == 0)
+				ndev++;
+		}
+	}
+	us[2] = ktime_us_delta(ktime_get(), t);
+
+	printf("%-16s %12s\r\n", "method", "ns");
+	printf("%-16s %12lld\r\n", "open+read+close", us[0] * 1000 / count);
+	printf("%-16s %12lld\r\n", "kobj path", us[1] * 1000 / count);
+	printf("%-16s %12lld\r\n", "search_device", ndev ? us[2] * 1000 / ((s64_t)count * ndev) : 0);
+}
+
+static int do_kobj(int argc, char ** argv)
+{
+	if(argc < 2)
+	{
+		usage();
+		return -1;
+	}
+
+	if(!strcmp(argv[1], "bench"))
+	{
+		kobj_bench((argc > 2) ? argv[2] : NULL, (argc > 3) ? strtol(argv[3], NULL, 0) : 1000);
+	}
+	else
+	{
+		usage();
+		return -1;
+	}
+	return 0;
+}
+
+static struct command_t cmd_kobj = {
+	.name	= "kobj",
+	.desc	= "kobj tree and sysfs lookup benchmark",
+	.usage	= usage,
+	.exec	= do_kobj,
+};
+
+static __init void kobj_cmd_init(void)
+{
+	register_command(&cmd_kobj);
+}
+
+static __exit void kobj_cmd_exit(void)
+{
+	unregister_command(&cmd_kobj);
+}
+
+command_initcall(kobj_cmd_init);
+command_exitcall(kobj_cmd_exit);
@@ -0,0 +1,445 @@
+/*
+ * kernel/command/cmd-libc.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <crc32.h>
+#include <sha256.h>
+#include <aes128.h>
+#include <command/command.h>
+
+struct libc_bench_t {
+	const char * name;
+	void (*run)(u8_t * dst, u8_t * src, size_t size);
+	void (*ref)(volatile u8_t * dst, volatile u8_t * src, size_t size);
+};
+
+static volatile size_t sink;
+
+static void usage(void)
+{
+	printf("usage:\r\n");
+	printf("    libc bench [size] [count]\r\n");
+	printf("    libc math [count]\r\n");
+	printf("    libc crypto [size] [count]\r\n");
+}
+
+static void run_memset(u8_t * dst, u8_t * src, size_t size)
+{
+	memset(dst, 0x5a, size);
+}
+
+static void run_memcpy(u8_t * dst, u8_t * src, size_t size)
+{
+	memcpy(dst, src, size);
+}
+
+static void run_memmove(u8_t * dst, u8_t * src, size_t size)
+{
+	memmove(dst, src, size);
+}
+
+static void run_memcmp(u8_t * dst, u8_t * src, size_t size)
+{
+	sink = memcmp(dst, src, size);
+}
+
+static void run_memchr(u8_t * dst, u8_t * src, size_t size)
+{
+	sink = (size_t)memchr(src, 0xff, size);
+}
+
+static void run_strlen(u8_t * dst, u8_t * src, size_t size)
+{
+	sink = strlen((const char *)src);
+}
+
+static void run_strchr(u8_t * dst, u8_t * src, size_t size)
+{
+	sink = (size_t)strchr((const char *)src, 0xff);
+}
+
+static void run_strcmp(u8_t * dst, u8_t * src, size_t size)
+{
+	sink = strcmp((const char *)dst, (const char *)src);
+}
+
+/*
+ * Byte at a time references, the volatile accesses keep the compiler from
+ * turning them back into library calls or vectorizing them
+ */
+static void ref_memset(volatile u8_t * dst, volatile u8_t * src, size_t size)
+{
+	while(size--)
+		*dst++ = 0x5a;
+}
+
+static void ref_memcpy(volatile u8_t * dst, volatile u8_t * src, size_t size)
+{
+	while(size--)
+		*dst++ = *src++;
+}
+
+static void ref_memcmp(volatile u8_t * dst, volatile u8_t * src, size_t size)
+{
+	int res = 0;
+
+	while(size-- && !(res = *dst++ - *src++));
+	sink = res;
+}
+
+static void ref_memchr(volatile u8_t * dst, volatile u8_t * src, size_t size)
+{
+	while(size-- && (*src != 0xff))
+		src++;
+	sink = (size_t)src;
+}
+
+static void ref_strlen(volatile u8_t * dst, volatile u8_t * src, size_t size)
+{
+	volatile u8_t * s = src;
+
+	while(*s)
+		s++;
+	sink = s - src;
+}
+
+static void ref_strcmp(volatile u8_t * dst, volatile u8_t * src, size_t size)
+{
+	int res;
+
+	while(!(res = *dst - *src) && *dst)
+	{
+		dst++;
+		src++;
+	}
+	sink = res;
+}
+
+static struct libc_bench_t benches[] = {
+	{ "memset",		run_memset,		ref_memset },
+	{ "memcpy",		run_memcpy,		ref_memcpy },
+	{ "memmove",	run_memmove,	ref_memcpy },
+	{ "memcmp",		run_memcmp,		ref_memcmp },
+	{ "memchr",		run_memchr,		ref_memchr },
+	{ "strlen",		run_strlen,		ref_strlen },
+	{ "strchr",		run_strchr,		ref_strlen },
+	{ "strcmp",		run_strcmp,		ref_strcmp },
+};
+
+/*
+ * Both buffers hold the same string without a 0xff byte, so every routine
+ * runs over the whole size
+ */
+static void libc_prepare(u8_t * dst, u8_t * src, size_t size)
+{
+	size_t i;
+
+	for(i = 0; i < size - 1; i++)
+		src[i] = 'a' + (i % 26);
+	src[size - 1] = 0;
+	for(i = 0; i < size; i++)
+		dst[i] = src[i];
+}
+
+static s64_t libc_rate(struct libc_bench_t * b, bool_t ref, u8_t * dst, u8_t * src, size_t size, int iter)
+{
+	ktime_t t;
+	s64_t us;
+	int i;
+
+	libc_prepare(dst, src, size);
+	t = ktime_get();
+	for(i = 0; i < iter; i++)
+	{
+		if(ref)
+			b->ref(dst, src, size);
+		else
+			b->run(dst, src, size);
+	}
+	us = ktime_us_delta(ktime_get(), t);
+	return us ? (s64_t)size * iter / us : 0;
+}
+
+static void libc_bench(size_t size, int count)
+{
+	size_t sizes[] = { 16, 256, SZ_4K, size };
+	struct libc_bench_t * b;
+	u8_t * dbuf, * sbuf;
+	size_t s;
+	int iter, i, j;
+
+	dbuf = malloc(size + 16);
+	sbuf = malloc(size + 16);
+	if(!dbuf || !sbuf)
+	{
+		printf("can not alloc %ld bytes\r\n", (long)size);
+		free(dbuf);
+		free(sbuf);
+		return;
+	}
+
+	printf("%-8s %8s %12s %12s %12s %12s\r\n", "MB/s", "size", "aligned", "unaligned", "byte", "byte-un");
+	for(i = 0; i < ARRAY_SIZE(benches); i++)
+	{
+		b = &benches[i];
+		for(j = 0; j < ARRAY_SIZE(sizes); j++)
+		{
+			s = sizes[j];
+			if((s > size) || ((j == ARRAY_SIZE(sizes) - 1) && (s <= SZ_4K)))
+				continue;
+			iter = (s64_t)size * count / s;
+			if(iter < 1)
+				iter = 1;
+			printf("%-8s %8ld %12lld %12lld %12lld %12lld\r\n", b->name, (long)s,
+				libc_rate(b, FALSE, dbuf, sbuf, s, iter),
+				libc_rate(b, FALSE, dbuf + 1, sbuf + 3, s, iter),
+				libc_rate(b, TRUE, dbuf, sbuf, s, iter),
+				libc_rate(b, TRUE, dbuf + 1, sbuf + 3, s, iter));
+		}
+	}
+
+	free(dbuf);
+	free(sbuf);
+}
+
+/*
+ * Compare the approximate and batched math functions with the double
+ * precision ones over their documented range, then time them
+ */
+static void libc_math(int count)
+{
+	float * x, * y;
+	double err[4] = { 0, 0, 0, 0 }, d;
+	s64_t us[4];
+	ktime_t t;
+	int n = 1024, i, j;
+
+	x = malloc(sizeof(float) * n);
+	y = malloc(sizeof(float) * n);
+	if(!x || !y)
+	{
+		printf("can not alloc %d floats\r\n", n);
+		free(x);
+		free(y);
+		return;
+	}
+
+	for(i = 0; i < n; i++)
+		x[i] = -8192.0f + 16384.0f * i / n + 0.123f;
+	vsinf(y, x, n);
+	for(i = 0; i < n; i++)
+	{
+		d = fabs(y[i] - sin(x[i]));
+		if(d > err[0])
+			err[0] = d;
+		d = fabs(fast_cosf(x[i]) - cos(x[i]));
+		if(d > err[1])
+			err[1] = d;
+	}
+	for(i = 0; i < n; i++)
+		x[i] = -126.0f + 253.0f * i / n;
+	vexp2f(y, x, n);
+	for(i = 0; i < n; i++)
+	{
+		d = fabs(y[i] / exp2(x[i]) - 1);
+		if(d > err[2])
+			err[2] = d;
+	}
+	for(i = 0; i < n; i++)
+		x[i] = -87.0f + 175.0f * i / n;
+	vexpf(y, x, n);
+	for(i = 0; i < n; i++)
+	{
+		d = fabs(y[i] / exp(x[i]) - 1);
+		if(d > err[3])
+			err[3] = d;
+	}
+
+	for(i = 0; i < n; i++)
+		x[i] = i * 0.01f;
+	t = ktime_get();
+	for(j = 0; j < count; j++)
+		for(i = 0; i < n; i++)
+			y[i] = sinf(x[i]);
+	us[0] = ktime_us_delta(ktime_get(), t);
+	t = ktime_get();
+	for(j = 0; j < count; j++)
+		vsinf(y, x, n);
+	us[1] = ktime_us_delta(ktime_get(), t);
+	t = ktime_get();
+	for(j = 0; j < count; j++)
+		for(i = 0; i < n; i++)
+			y[i] = expf(x[i]);
+	us[2] = ktime_us_delta(ktime_get(), t);
+	t = ktime_get();
+	for(j = 0; j < count; j++)
+		vexpf(y, x, n);
+	us[3] = ktime_us_delta(ktime_get(), t);
+
+	printf("%-8s %14s %14s %14s\r\n", "func", "max error", "libm ns/elem", "fast ns/elem");
+	printf("%-8s %14e %14lld %14lld\r\n", "sinf", err[0], us[0] * 1000 / ((s64_t)n * count), us[1] * 1000 / ((s64_t)n * count));
+	printf("%-8s %14e %14s %14s\r\n", "cosf", err[1], "-", "-");
+	printf("%-8s %14e %14s %14s\r\n", "exp2f", err[2], "-", "-");
+	printf("%-8s %14e %14lld %14lld\r\n", "expf", err[3], us[2] * 1000 / ((s64_t)n * count), us[3] * 1000 / ((s64_t)n * count));
+
+	free(x);
+	free(y);
+}
+
+static s64_t crypto_rate(size_t size, int count, ktime_t t)
+{
+	s64_t us = ktime_us_delta(ktime_get(), t);
+
+	return us ? (s64_t)size * count / us : 0;
+}
+
+/*
+ * Throughput of the checksum, hash and cipher routines, with whatever
+ * instructions the cpu hooks pick up
+ */
+static void libc_crypto(size_t size, int count)
+{
+	struct sha256_ctx_t sha;
+	struct aes128_ctx_t aes;
+	uint8_t key[16], iv[16];
+	u8_t * buf;
+	ktime_t t;
+	int i;
+
+	size &= ~(size_t)15;
+	buf = malloc(size);
+	if(!buf)
+	{
+		printf("can not alloc %ld bytes\r\n", (long)size);
+		return;
+	}
+	for(i = 0; i < size; i++)
+		buf[i] = i * 131 + 7;
+	for(i = 0; i < 16; i++)
+	{
+		key[i] = i;
+		iv[i] = 0xff - i;
+	}
+	aes128_set_key(&aes, key);
+
+	printf("%-12s %12s\r\n", "func", "MB/s");
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+		sink = crc32_sum(0, buf, size);
+	printf("%-12s %12lld\r\n", "crc32", crypto_rate(size, count, t));
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+	{
+		sha256_init(&sha);
+		sha256_update(&sha, buf, size);
+		sink = sha256_final(&sha)[0];
+	}
+	printf("%-12s %12lld\r\n", "sha256", crypto_rate(size, count, t));
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+		aes128_ecb_encrypt(&aes, buf, buf, size / 16);
+	printf("%-12s %12lld\r\n", "aes128-ecb", crypto_rate(size, count, t));
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+		aes128_cbc_encrypt(&aes, iv, buf, buf, size / 16);
+	printf("%-12s %12lld\r\n", "aes128-cbc-e", crypto_rate(size, count, t));
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+		aes128_cbc_decrypt(&aes, iv, buf, buf, size / 16);
+	printf("%-12s %12lld\r\n", "aes128-cbc-d", crypto_rate(size, count, t));
+	t = ktime_get();
+	for(i = 0; i < count; i++)
+		aes128_ctr_encrypt(&aes, 0, buf, buf, size);
+	printf("%-12s %12lld\r\n", "aes128-ctr", crypto_rate(size, count, t));
+
+	free(buf);
+}
+
+static int do_libc(int argc, char ** argv)
+{
+	size_t size = SZ_64K;
+	int count = 64;
+
+	if(argc < 2)
+	{
+		usage();
+		return -1;
+	}
+
+	if(!strcmp(argv[1], "bench"))
+	{
+		if(argc > 2)
+			size = strtoul(argv[2], NULL, 0);
+		if(argc > 3)
+			count = strtol(argv[3], NULL, 0);
+		if(size < 16)
+			size = 16;
+		if(count < 1)
+			count = 1;
+		libc_bench(size, count);
+	}
+	else if(!strcmp(argv[1], "math"))
+	{
+		count = (argc > 2) ? strtol(argv[2], NULL, 0) : 256;
+		if(count < 1)
+			count = 1;
+		libc_math(count);
+	}
+	else if(!strcmp(argv[1], "crypto"))
+	{
+		if(argc > 2)
+			size = strtoul(argv[2], NULL, 0);
+		count = (argc > 3) ? strtol(argv[3], NULL, 0) : 16;
+		if(size < 64)
+			size = 64;
+		if(count < 1)
+			count = 1;
+		libc_crypto(size, count);
+	}
+	else
+	{
+		usage();
+		return -1;
+	}
+	return 0;
+}
+
+static struct command_t cmd_libc = {
+	.name	= "libc",
+	.desc	= "benchmark the string, memory, math and crypto routines of libc",
+	.usage	= usage,
+	.exec	= do_libc,
+};
+
+static __init void libc_cmd_init(void)
+{
+	register_command(&cmd_libc);
+}
+
+static __exit void libc_cmd_exit(void)
+{
+	unregister_command(&cmd_libc);
+}
+
+command_initcall(libc_cmd_init);
+command_exitcall(libc_cmd_exit);
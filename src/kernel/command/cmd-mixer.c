@@ -0,0 +1,260 @@
+/*
+ * kernel/command/cmd-mixer.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <audio/mixer.h>
+#include <command/command.h>
+
+static void usage(void)
+{
+	printf("usage:\r\n");
+	printf("    mixer status\r\n");
+	printf("    mixer volume <percent>\r\n");
+	printf("    mixer bench [streams] [seconds]\r\n");
+	printf("    mixer gain [samples]\r\n");
+}
+
+/*
+ * An endless sawtooth, so the benchmark measures the mixer and not the storage
+ */
+static int tone_read(struct sound_t * snd, void * buf, int count)
+{
+	s16_t * p = buf;
+	int i, n = count / (snd->info.channel * sizeof(s16_t));
+
+	for(i = 0; i < n * snd->info.channel; i++)
+	{
+		p[i] = (s16_t)(snd->position << 4);
+		if(((i + 1) % snd->info.channel) == 0)
+			snd->position++;
+	}
+	return n * snd->info.channel * sizeof(s16_t);
+}
+
+static s64_t mixer_bench(enum pcm_rate_t rate, int ch, int streams, int seconds)
+{
+	struct mixer_t * m;
+	struct sound_t * snd;
+	ktime_t time;
+	s16_t * buf;
+	int frames, i;
+	s64_t us;
+
+	m = malloc(sizeof(struct mixer_t));
+	snd = malloc(sizeof(struct sound_t) * streams);
+	buf = malloc(CONFIG_AUDIO_MIXER_FRAMES * 4 * MIXER_OUTPUT_CHANNEL * sizeof(s16_t));
+	if(!m || !snd || !buf)
+	{
+		free(m);
+		free(snd);
+		free(buf);
+		return -1;
+	}
+
+	mixer_init(m, CONFIG_AUDIO_MIXER_RATE);
+	for(i = 0; i < streams; i++)
+	{
+		memset(&snd[i], 0, sizeof(struct sound_t));
+		snd[i].info.rate = rate;
+		snd[i].info.fmt = PCM_FORMAT_BIT16;
+		snd[i].info.channel = ch;
+		snd[i].info.length = INT_MAX;
+		snd[i].status = SOUND_STATUS_PLAY;
+		snd[i].volume = 100;
+		snd[i].gain = 1 << 15;
+		snd[i].read = tone_read;
+		mixer_post(m, MIXER_COMMAND_PLAY, &snd[i], 0);
+	}
+
+	frames = m->rate * seconds;
+	time = ktime_get();
+	while(frames > 0)
+	{
+		mixer_render(m, buf, CONFIG_AUDIO_MIXER_FRAMES * 4 * MIXER_OUTPUT_CHANNEL * sizeof(s16_t));
+		frames -= CONFIG_AUDIO_MIXER_FRAMES * 4;
+	}
+	us = ktime_us_delta(ktime_get(), time);
+
+	free(m);
+	free(snd);
+	free(buf);
+	return us;
+}
+
+/*
+ * Volume scaling of a pcm buffer, the per sample division sound_read used
+ * to do against the q15 kernels, steady and ramping
+ */
+static void gain_bench(enum pcm_format_t fmt, int samples)
+{
+	void * buf;
+	s16_t * p16;
+	s32_t * p32;
+	ktime_t time;
+	s64_t us[3];
+	int volume = 50;
+	int i, r, rounds = 64;
+
+	buf = malloc(samples * (fmt >> 3));
+	if(!buf)
+		return;
+	memset(buf, 0x5a, samples * (fmt >> 3));
+	p16 = buf;
+	p32 = buf;
+
+	time = ktime_get();
+	for(r = 0; r < rounds; r++)
+	{
+		if(fmt == PCM_FORMAT_BIT16)
+		{
+			for(i = 0; i < samples; i++)
+				p16[i] = ((s32_t)p16[i]) * volume / 100;
+		}
+		else
+		{
+			for(i = 0; i < samples; i++)
+				p32[i] = ((s32_t)p32[i]) * volume / 100;
+		}
+	}
+	us[0] = ktime_us_delta(ktime_get(), time);
+
+	time = ktime_get();
+	for(r = 0; r < rounds; r++)
+		sound_gain(buf, samples * (fmt >> 3), fmt, 2, (volume << 15) / 100, (volume << 15) / 100);
+	us[1] = ktime_us_delta(ktime_get(), time);
+
+	time = ktime_get();
+	for(r = 0; r < rounds; r++)
+		sound_gain(buf, samples * (fmt >> 3), fmt, 2, (r & 0x1) ? (1 << 14) : (1 << 15), (r & 0x1) ? (1 << 15) : (1 << 14));
+	us[2] = ktime_us_delta(ktime_get(), time);
+
+	printf("%-8d %12lld %12lld %12lld\r\n", fmt,
+		us[0] * 1000 / rounds, us[1] * 1000 / rounds, us[2] * 1000 / rounds);
+	free(buf);
+}
+
+static int do_mixer(int argc, char ** argv)
+{
+	static const struct {
+		enum pcm_rate_t rate;
+		int ch;
+	} cases[] = {
+		{ CONFIG_AUDIO_MIXER_RATE,	2 },
+		{ CONFIG_AUDIO_MIXER_RATE,	1 },
+		{ PCM_RATE_48000,			2 },
+		{ PCM_RATE_22050,			1 },
+	};
+	struct mixer_t * m = &__audio_mixer;
+	int streams = CONFIG_AUDIO_MIXER_STREAMS, seconds = 1, samples = 65536;
+	int i, n;
+	s64_t us;
+
+	if(argc < 2)
+	{
+		usage();
+		return -1;
+	}
+
+	if(!strcmp(argv[1], "status"))
+	{
+		printf("rate    : %d\r\n", m->rate);
+		printf("volume  : %d%%\r\n", mixer_get_volume(m));
+		printf("streams : %d/%d\r\n", mixer_active(m), CONFIG_AUDIO_MIXER_STREAMS);
+		printf("running : %s\r\n", m->running ? "yes" : "no");
+	}
+	else if(!strcmp(argv[1], "volume"))
+	{
+		if(argc != 3)
+		{
+			usage();
+			return -1;
+		}
+		mixer_set_volume(m, strtol(argv[2], NULL, 0));
+	}
+	else if(!strcmp(argv[1], "bench"))
+	{
+		if(argc > 2)
+			streams = strtol(argv[2], NULL, 0);
+		if(argc > 3)
+			seconds = strtol(argv[3], NULL, 0);
+		if(streams < 1 || streams > CONFIG_AUDIO_MIXER_STREAMS)
+			streams = CONFIG_AUDIO_MIXER_STREAMS;
+		if(seconds < 1)
+			seconds = 1;
+
+		printf("mixing %d second(s) of %dhz stereo output\r\n", seconds, CONFIG_AUDIO_MIXER_RATE);
+		printf("%-8s %-8s %-8s %12s %12s %8s\r\n", "source", "channel", "streams", "us/s", "us/s/stream", "cpu");
+		for(i = 0; i < ARRAY_SIZE(cases); i++)
+		{
+			for(n = 1; n <= streams; n <<= 1)
+			{
+				us = mixer_bench(cases[i].rate, cases[i].ch, n, seconds);
+				if(us < 0)
+				{
+					printf("out of memory\r\n");
+					return -1;
+				}
+				us /= seconds;
+				printf("%-8d %-8d %-8d %12lld %12lld %7lld%%\r\n", cases[i].rate, cases[i].ch, n, us, us / n, us / 10000);
+			}
+		}
+	}
+	else if(!strcmp(argv[1], "gain"))
+	{
+		if(argc > 2)
+			samples = strtol(argv[2], NULL, 0);
+		if(samples < 64)
+			samples = 64;
+
+		printf("scaling %d samples, ns per buffer\r\n", samples);
+		printf("%-8s %12s %12s %12s\r\n", "format", "division", "q15", "ramp");
+		gain_bench(PCM_FORMAT_BIT16, samples);
+		gain_bench(PCM_FORMAT_BIT32, samples);
+	}
+	else
+	{
+		usage();
+		return -1;
+	}
+	return 0;
+}
+
+static struct command_t cmd_mixer = {
+	.name	= "mixer",
+	.desc	= "software audio mixer status and benchmarks",
+	.usage	= usage,
+	.exec	= do_mixer,
+};
+
+static __init void mixer_cmd_init(void)
+{
+	register_command(&cmd_mixer);
+}
+
+static __exit void mixer_cmd_exit(void)
+{
+	unregister_command(&cmd_mixer);
+}
+
+command_initcall(mixer_cmd_init);
+command_exitcall(mixer_cmd_exit);
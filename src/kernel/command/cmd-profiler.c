@@ -0,0 +1,98 @@
+/*
+ * kernel/command/cmd-profiler.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <command/command.h>
+
+static void usage(void)
+{
+	int i;
+
+	printf("usage:\r\n");
+	printf("    profiler snap <name> [event]\r\n");
+	printf("    profiler dump\r\n");
+	printf("    profiler reset\r\n");
+	printf("events:\r\n");
+	for(i = 0; i < PROFILER_EVENT_MAX; i++)
+		printf("    %s\r\n", profiler_event_name(i));
+}
+
+static int do_profiler(int argc, char ** argv)
+{
+	int event = PROFILER_EVENT_TIME;
+
+	if(argc < 2)
+	{
+		usage();
+		return -1;
+	}
+
+	if(!strcmp(argv[1], "snap"))
+	{
+		if(argc != 3 && argc != 4)
+		{
+			usage();
+			return -1;
+		}
+		if((argc == 4) && ((event = profiler_event_lookup(argv[3])) < 0))
+		{
+			printf("unknown profiler event '%s'\r\n", argv[3]);
+			return -1;
+		}
+		profiler_snap(argv[2], event);
+	}
+	else if(!strcmp(argv[1], "dump"))
+	{
+		profiler_dump();
+	}
+	else if(!strcmp(argv[1], "reset"))
+	{
+		profiler_reset();
+	}
+	else
+	{
+		usage();
+		return -1;
+	}
+	return 0;
+}
+
+static struct command_t cmd_profiler = {
+	.name	= "profiler",
+	.desc	= "named time and hardware counter snapshots",
+	.usage	= usage,
+	.exec	= do_profiler,
+};
+
+static __init void profiler_cmd_init(void)
+{
+	register_command(&cmd_profiler);
+}
+
+static __exit void profiler_cmd_exit(void)
+{
+	unregister_command(&cmd_profiler);
+}
+
+command_initcall(profiler_cmd_init);
+command_exitcall(profiler_cmd_exit);
@@ -0,0 +1,112 @@
+/*
+ * kernel/command/cmd-sampler.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <command/command.h>
+
+static void usage(void)
+{
+	printf("usage:\r\n");
+	printf("    sampler start [rate] [depth]\r\n");
+	printf("    sampler stop\r\n");
+	printf("    sampler report [top]\r\n");
+	printf("    sampler folded <file>\r\n");
+	printf("    sampler reset\r\n");
+}
+
+static int do_sampler(int argc, char ** argv)
+{
+	int rate = 1000, depth = 1, top = 20;
+
+	if(argc < 2)
+	{
+		usage();
+		return -1;
+	}
+
+	if(!strcmp(argv[1], "start"))
+	{
+		if(argc > 2)
+			rate = strtol(argv[2], NULL, 0);
+		if(argc > 3)
+			depth = strtol(argv[3], NULL, 0);
+		if(!sampler_start(rate, depth))
+		{
+			printf("can not start the sampler at %d hz\r\n", rate);
+			return -1;
+		}
+	}
+	else if(!strcmp(argv[1], "stop"))
+	{
+		sampler_stop();
+	}
+	else if(!strcmp(argv[1], "report"))
+	{
+		if(argc > 2)
+			top = strtol(argv[2], NULL, 0);
+		sampler_report(top);
+	}
+	else if(!strcmp(argv[1], "folded"))
+	{
+		if(argc != 3)
+		{
+			usage();
+			return -1;
+		}
+		if(!sampler_folded(argv[2]))
+		{
+			printf("can not write the folded stacks to '%s'\r\n", argv[2]);
+			return -1;
+		}
+	}
+	else if(!strcmp(argv[1], "reset"))
+	{
+		sampler_reset();
+	}
+	else
+	{
+		usage();
+		return -1;
+	}
+	return 0;
+}
+
+static struct command_t cmd_sampler = {
+	.name	= "sampler",
+	.desc	= "statistical pc sampling profiler",
+	.usage	= usage,
+	.exec	= do_sampler,
+};
+
+static __init void sampler_cmd_init(void)
+{
+	register_command(&cmd_sampler);
+}
+
+static __exit void sampler_cmd_exit(void)
+{
+	unregister_command(&cmd_sampler);
+}
+
+command_initcall(sampler_cmd_init);
+command_exitcall(sampler_cmd_exit);
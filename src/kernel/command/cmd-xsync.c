@@ -22,11 +22,46 @@
  *
  */
 
+
 #include <crc32.h>
+#include <zlib.h>
 #include <shell/system.h>
+#include <inflater.h>
+#include <console/console.h>
 #include <command/command.h>
 
+/*
+ * Packets are 'X', 'x', a big endian length covering header, length,
+ * command and data, the command, the data and a big endian crc32.
+ *
+ * The first protocol is stop and wait: start, transfer packets of at most
+ * PACKET_DATA_MAX bytes, stop. The second one is negotiated with config and
+ * keeps a window of data packets in flight, each carrying its own offset and
+ * acknowledged on its own, so the host resends only what got lost:
+ *
+ *   config  u8 version, u8 flags, u16 window, u32 packet size
+ *           answered with the values the target accepts
+ *   open    u8 flags, u32 size, u32 crc, path
+ *           answered with u8 status and u32 size of the existing file,
+ *           status 1 means the file is already there, 2 opened
+ *           with the inflate flag the data is a zlib or gzip image which
+ *           is expanded into the file as it comes, in order of offset
+ *   sum     u32 block size, u32 first block, u16 count
+ *           answered with u32 first block, u16 count and a crc32 per block
+ *           of the existing file, so a resumed transfer skips them
+ *   data    u32 sequence, u32 offset, u8 flags, u32 length, payload
+ *           answered with u32 sequence and u8 status, the payload may be
+ *           zlib compressed down from length bytes, status 2 asks to send
+ *           it again later as it is ahead of the image being expanded
+ *   close   u32 size, u32 crc
+ *           answered with u8 status after truncating and checking the file,
+ *           for an image after checking it has been expanded to its end
+ *
+ * The window the target grants is cut down so the packets in flight fit in
+ * the receive ring of the console uart.
+ */
 #define PACKET_DATA_MAX		(1024)
+#define xsync_min(a, b)		((a) < (b) ? (a) : (b))
 
 enum xsync_command_t {
 	XSYNC_COMMAND_ALIVE		= 0x00,
@@ -34,9 +69,20 @@ enum xsync_command_t {
 	XSYNC_COMMAND_TRANSFER	= 0x02,
 	XSYNC_COMMAND_STOP		= 0x03,
 	XSYNC_COMMAND_SYSTEM	= 0x04,
+	XSYNC_COMMAND_CONFIG	= 0x05,
+	XSYNC_COMMAND_OPEN		= 0x06,
+	XSYNC_COMMAND_SUM		= 0x07,
+	XSYNC_COMMAND_DATA		= 0x08,
+	XSYNC_COMMAND_CLOSE		= 0x09,
 	XSYNC_COMMAND_UNKOWN	= 0xff,
 };
 
+enum xsync_flag_t {
+	XSYNC_FLAG_ZLIB			= (1 << 0),
+	XSYNC_FLAG_RESUME		= (1 << 1),
+	XSYNC_FLAG_INFLATE		= (1 << 2),
+};
+
 enum packet_state_t {
 	PACKET_STATE_HEADER0,
 	PACKET_STATE_HEADER1,
@@ -54,18 +100,36 @@ struct packet_t {
 	uint8_t header[2];
 	uint8_t length[2];
 	uint8_t command;
-	uint8_t data[4096];
+	uint8_t data[CONFIG_XSYNC_PACKET_SIZE];
 	uint8_t crc[4];
 };
 
 struct xsync_ctx_t {
 	struct packet_t packet;
+	struct packet_t reply;
 	enum packet_state_t state;
 	int index;
 	int fd;
 	int quit;
+	struct inflater_t * in;
+	uint32_t next;
+	uint8_t out[CONFIG_XSYNC_PACKET_SIZE];
+	uint8_t buf[CONFIG_XSYNC_PACKET_SIZE];
 };
 
+static inline uint32_t xsync_read32(const uint8_t * p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | ((uint32_t)p[3] << 0);
+}
+
+static inline void xsync_write32(uint8_t * p, uint32_t v)
+{
+	p[0] = (v >> 24) & 0xff;
+	p[1] = (v >> 16) & 0xff;
+	p[2] = (v >>  8) & 0xff;
+	p[3] = (v >>  0) & 0xff;
+}
+
 static inline uint16_t packet_length(struct packet_t * packet)
 {
 	return ((packet->length[0] << 8) | (packet->length[1] << 0));
@@ -92,8 +156,6 @@ static inline uint32_t packet_crc(struct packet_t * packet)
 
 static void packet_init(struct packet_t * packet, uint8_t command, uint8_t * data, size_t size)
 {
-	uint32_t crc;
-
 	if(!data)
 		size = 0;
 	packet->header[0] = 'X';
@@ -103,48 +165,31 @@ static void packet_init(struct packet_t * packet, uint8_t command, uint8_t * dat
 	packet->command = command;
 	if(size > 0)
 		memcpy(&(packet->data[0]), data, size);
-	crc = packet_crc(packet);
-	packet->crc[0] = (crc >> 24) & 0xff;
-	packet->crc[1] = (crc >> 16) & 0xff;
-	packet->crc[2] = (crc >>  8) & 0xff;
-	packet->crc[3] = (crc >>  0) & 0xff;
+	xsync_write32(&packet->crc[0], packet_crc(packet));
 }
 
+/*
+ * The header, command and data are contiguous in the packet, the whole
+ * frame goes to the console in two bulk writes
+ */
 static void packet_put(struct packet_t * packet)
 {
 	uint16_t dsize = packet_dsize(packet);
-	int i;
 
-	putchar(packet->header[0]);
-	putchar(packet->header[1]);
-	putchar(packet->length[0]);
-	putchar(packet->length[1]);
-	putchar(packet->command);
-	fflush(stdout);
-	for(i = 0; i < dsize; i++)
-	{
-		putchar(packet->data[i]);
-		fflush(stdout);
-	}
-	putchar(packet->crc[0]);
-	putchar(packet->crc[1]);
-	putchar(packet->crc[2]);
-	putchar(packet->crc[3]);
+	fwrite(&(packet->header[0]), 5 + dsize, 1, stdout);
+	fwrite(&(packet->crc[0]), 4, 1, stdout);
 	fflush(stdout);
 }
 
-static void xsync_put(uint8_t command, uint8_t * data, size_t size)
+static void xsync_put(struct xsync_ctx_t * ctx, uint8_t command, uint8_t * data, size_t size)
 {
-	struct packet_t packet;
-
-	packet_init(&packet, command, data, size);
-	packet_put(&packet);
+	packet_init(&ctx->reply, command, data, size);
+	packet_put(&ctx->reply);
 }
 
 static int xsync_get(struct xsync_ctx_t * ctx, uint8_t c)
 {
 	uint8_t * p = (uint8_t *)(&ctx->packet);
-	uint32_t crc;
 	uint16_t length;
 
 	p[ctx->index++] = c;
@@ -180,7 +225,16 @@ static int xsync_get(struct xsync_ctx_t * ctx, uint8_t c)
 		break;
 
 	case PACKET_STATE_LENGTH1:
-		ctx->state = PACKET_STATE_COMMAND;
+		length = (p[2] << 8) | (p[3] << 0);
+		if((length < 5) || (length > 5 + CONFIG_XSYNC_PACKET_SIZE))
+		{
+			ctx->index = 0;
+			ctx->state = PACKET_STATE_HEADER0;
+		}
+		else
+		{
+			ctx->state = PACKET_STATE_COMMAND;
+		}
 		break;
 
 	case PACKET_STATE_COMMAND:
@@ -215,11 +269,7 @@ static int xsync_get(struct xsync_ctx_t * ctx, uint8_t c)
 		ctx->packet.crc[3] = c;
 		ctx->index = 0;
 		ctx->state = PACKET_STATE_HEADER0;
-		crc  = (ctx->packet.crc[0] << 24) & 0xff000000;
-		crc |= (ctx->packet.crc[1] << 16) & 0x00ff0000;
-		crc |= (ctx->packet.crc[2] <<  8) & 0x0000ff00;
-		crc |= (ctx->packet.crc[3] <<  0) & 0x000000ff;
-		if(packet_crc(&ctx->packet) == crc)
+		if(packet_crc(&ctx->packet) == xsync_read32(&ctx->packet.crc[0]))
 			return 0;
 		break;
 
@@ -232,31 +282,66 @@ static int xsync_get(struct xsync_ctx_t * ctx, uint8_t c)
 	return -1;
 }
 
+/*
+ * Crc32 and size of what the file holds, FALSE when it can not be read
+ */
+static bool_t xsync_file_crc(struct xsync_ctx_t * ctx, int fd, uint32_t * crc, uint32_t * size)
+{
+	ssize_t n;
+
+	*crc = 0;
+	*size = 0;
+	if((fd < 0) || (lseek(fd, 0, SEEK_SET) != 0))
+		return FALSE;
+	while((n = read(fd, ctx->buf, sizeof(ctx->buf))) > 0)
+	{
+		*crc = crc32_sum(*crc, ctx->buf, n);
+		*size += n;
+	}
+	return TRUE;
+}
+
+static ssize_t xsync_file_output(void * data, const u8_t * buf, size_t len)
+{
+	struct xsync_ctx_t * ctx = (struct xsync_ctx_t *)data;
+
+	return write(ctx->fd, (void *)buf, len);
+}
+
+static void xsync_file_close(struct xsync_ctx_t * ctx)
+{
+	if(ctx->in)
+	{
+		inflater_free(ctx->in);
+		ctx->in = NULL;
+	}
+	if(ctx->fd >= 0)
+	{
+		close(ctx->fd);
+		ctx->fd = -1;
+	}
+}
+
 static uint8_t xsync_handle_start(struct xsync_ctx_t * ctx)
 {
 	char path[PACKET_DATA_MAX];
-	char buf[PACKET_DATA_MAX];
-	uint32_t crc1, crc2 = 0;
-	ssize_t n;
+	uint32_t crc1, crc2, size;
+	bool_t ok;
 
-	crc1  = (ctx->packet.data[0] << 24) & 0xff000000;
-	crc1 |= (ctx->packet.data[1] << 16) & 0x00ff0000;
-	crc1 |= (ctx->packet.data[2] <<  8) & 0x0000ff00;
-	crc1 |= (ctx->packet.data[3] <<  0) & 0x000000ff;
+	if(packet_dsize(&ctx->packet) < 4)
+		return 0;
+	crc1 = xsync_read32(&ctx->packet.data[0]);
 	memset(path, 0, sizeof(path));
-	memcpy(path, &ctx->packet.data[4], packet_dsize(&ctx->packet) - 4);
+	memcpy(path, &ctx->packet.data[4], xsync_min(packet_dsize(&ctx->packet) - 4, sizeof(path) - 1));
 
 	ctx->fd = open(path, O_RDONLY, (S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH));
 	if(ctx->fd > 0)
 	{
-		while((n = read(ctx->fd, buf, sizeof(buf))) > 0)
-		{
-			crc2 = crc32_sum(crc2, (const uint8_t *)buf, n);
-		}
+		ok = xsync_file_crc(ctx, ctx->fd, &crc2, &size);
 		close(ctx->fd);
 		ctx->fd = -1;
 
-		if((crc1 == crc2) && (crc2 != 0))
+		if(ok && (crc1 == crc2) && (crc2 != 0))
 			return 1;
 	}
 
@@ -266,52 +351,264 @@ static uint8_t xsync_handle_start(struct xsync_ctx_t * ctx)
 	return 2;
 }
 
+static size_t xsync_handle_config(struct xsync_ctx_t * ctx, uint8_t * buf)
+{
+	uint8_t * d = &ctx->packet.data[0];
+	uint32_t size = 0;
+	int window = 1, flags = 0;
+
+	if(packet_dsize(&ctx->packet) >= 8)
+	{
+		flags = d[1] & XSYNC_FLAG_ZLIB;
+		window = xsync_min((d[2] << 8) | d[3], CONFIG_XSYNC_WINDOW);
+		size = xsync_min(xsync_read32(&d[4]), CONFIG_XSYNC_PACKET_SIZE);
+		window = xsync_min(window, (int)(CONFIG_UART_RX_RING_SIZE / (size + sizeof(struct packet_t) - CONFIG_XSYNC_PACKET_SIZE)));
+		if(window < 1)
+			window = 1;
+	}
+	buf[0] = 2;
+	buf[1] = flags;
+	buf[2] = (window >> 8) & 0xff;
+	buf[3] = (window >> 0) & 0xff;
+	xsync_write32(&buf[4], size);
+	return 8;
+}
+
+static size_t xsync_handle_open(struct xsync_ctx_t * ctx, uint8_t * buf)
+{
+	uint8_t * d = &ctx->packet.data[0];
+	uint16_t dsize = packet_dsize(&ctx->packet);
+	char path[PACKET_DATA_MAX];
+	uint32_t crc = 0, size = 0;
+	bool_t ok = FALSE;
+	int flags;
+
+	buf[0] = 0;
+	xsync_write32(&buf[1], 0);
+	if(dsize < 10)
+		return 5;
+
+	xsync_file_close(ctx);
+	flags = d[0];
+	memset(path, 0, sizeof(path));
+	memcpy(path, &d[9], xsync_min(dsize - 9, sizeof(path) - 1));
+
+	if(flags & XSYNC_FLAG_INFLATE)
+	{
+		ctx->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, (S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH));
+		if(ctx->fd < 0)
+			return 5;
+		ctx->in = inflater_alloc(CONFIG_XSYNC_PACKET_SIZE, xsync_file_output, ctx);
+		if(!ctx->in)
+		{
+			xsync_file_close(ctx);
+			return 5;
+		}
+		ctx->next = 0;
+		buf[0] = 2;
+		return 5;
+	}
+
+	ctx->fd = open(path, O_RDONLY, 0);
+	if(ctx->fd >= 0)
+	{
+		ok = xsync_file_crc(ctx, ctx->fd, &crc, &size);
+		close(ctx->fd);
+		ctx->fd = -1;
+	}
+	xsync_write32(&buf[1], size);
+	if(ok && (size == xsync_read32(&d[1])) && (crc == xsync_read32(&d[5])))
+	{
+		buf[0] = 1;
+		return 5;
+	}
+
+	if(flags & XSYNC_FLAG_RESUME)
+		ctx->fd = open(path, O_RDWR | O_CREAT, (S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH));
+	else
+		ctx->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, (S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH));
+	if(ctx->fd >= 0)
+		buf[0] = 2;
+	if(!(flags & XSYNC_FLAG_RESUME))
+		xsync_write32(&buf[1], 0);
+	return 5;
+}
+
+static size_t xsync_handle_sum(struct xsync_ctx_t * ctx, uint8_t * buf)
+{
+	uint8_t * d = &ctx->packet.data[0];
+	uint32_t bsize, first, crc, left;
+	int count, i;
+	ssize_t n;
+
+	if((packet_dsize(&ctx->packet) < 10) || (ctx->fd < 0) || ctx->in)
+		return 0;
+	bsize = xsync_read32(&d[0]);
+	first = xsync_read32(&d[4]);
+	count = xsync_min((d[8] << 8) | d[9], (CONFIG_XSYNC_PACKET_SIZE - 6) / 4);
+
+	xsync_write32(&buf[0], first);
+	for(i = 0; i < count; i++)
+	{
+		crc = 0;
+		left = bsize;
+		if(lseek(ctx->fd, (loff_t)(first + i) * bsize, SEEK_SET) == (loff_t)(first + i) * bsize)
+		{
+			while((left > 0) && ((n = read(ctx->fd, ctx->buf, xsync_min(left, sizeof(ctx->buf)))) > 0))
+			{
+				crc = crc32_sum(crc, ctx->buf, n);
+				left -= n;
+			}
+		}
+		xsync_write32(&buf[6 + i * 4], crc);
+	}
+	buf[4] = (count >> 8) & 0xff;
+	buf[5] = (count >> 0) & 0xff;
+	return 6 + count * 4;
+}
+
+/*
+ * Data packets are written at their own offset, a duplicate after a lost
+ * acknowledge just writes the same bytes again
+ */
+static size_t xsync_handle_data(struct xsync_ctx_t * ctx, uint8_t * buf)
+{
+	uint8_t * d = &ctx->packet.data[0];
+	uint16_t dsize = packet_dsize(&ctx->packet);
+	uint32_t offset, length;
+	uLongf dlen;
+	uint8_t * p;
+	size_t n;
+
+	if(dsize < 13)
+		return 0;
+	memcpy(&buf[0], &d[0], 4);
+	buf[4] = 0;
+	if(ctx->fd < 0)
+		return 5;
+
+	offset = xsync_read32(&d[4]);
+	length = xsync_read32(&d[9]);
+	p = &d[13];
+	n = dsize - 13;
+	if(d[8] & XSYNC_FLAG_ZLIB)
+	{
+		dlen = sizeof(ctx->buf);
+		if((length > dlen) || (uncompress(ctx->buf, &dlen, p, n) != Z_OK) || (dlen != length))
+			return 5;
+		p = ctx->buf;
+		n = dlen;
+	}
+	else if(n != length)
+	{
+		return 5;
+	}
+
+	if(ctx->in)
+	{
+		if(offset + n <= ctx->next)
+			buf[4] = 1;
+		else if(offset > ctx->next)
+			buf[4] = 2;
+		else if(inflater_write(ctx->in, p + (ctx->next - offset), offset + n - ctx->next) >= 0)
+		{
+			ctx->next = offset + n;
+			buf[4] = 1;
+		}
+	}
+	else if((lseek(ctx->fd, offset, SEEK_SET) == offset) && (write(ctx->fd, p, n) == n))
+	{
+		buf[4] = 1;
+	}
+	return 5;
+}
+
+static size_t xsync_handle_close(struct xsync_ctx_t * ctx, uint8_t * buf)
+{
+	uint8_t * d = &ctx->packet.data[0];
+	uint32_t crc, size;
+
+	buf[0] = 0;
+	if((packet_dsize(&ctx->packet) < 8) || (ctx->fd < 0))
+		return 1;
+
+	if(ctx->in)
+	{
+		if((ctx->next == xsync_read32(&d[0])) && inflater_finish(ctx->in))
+			buf[0] = 1;
+	}
+	else if((ftruncate(ctx->fd, xsync_read32(&d[0])) == 0) && xsync_file_crc(ctx, ctx->fd, &crc, &size))
+	{
+		if((size == xsync_read32(&d[0])) && (crc == xsync_read32(&d[4])))
+			buf[0] = 1;
+	}
+	xsync_file_close(ctx);
+	return 1;
+}
+
 static void xsync_handle(struct xsync_ctx_t * ctx)
 {
-	uint8_t buf[PACKET_DATA_MAX];
+	uint8_t * buf = ctx->out;
 	size_t size;
 
 	switch(ctx->packet.command)
 	{
 	case XSYNC_COMMAND_ALIVE:
 		size = sprintf((char *)buf, "%s", machine_uniqueid());
-		xsync_put(XSYNC_COMMAND_ALIVE, buf, size);
+		xsync_put(ctx, XSYNC_COMMAND_ALIVE, buf, size);
 		break;
 
 	case XSYNC_COMMAND_START:
 		buf[0] = xsync_handle_start(ctx);
-		xsync_put(XSYNC_COMMAND_START, buf, 1);
+		xsync_put(ctx, XSYNC_COMMAND_START, buf, 1);
 		break;
 
 	case XSYNC_COMMAND_TRANSFER:
 		write(ctx->fd, (void *)ctx->packet.data, packet_dsize(&ctx->packet));
-		xsync_put(XSYNC_COMMAND_TRANSFER, 0, 0);
+		xsync_put(ctx, XSYNC_COMMAND_TRANSFER, 0, 0);
 		break;
 
 	case XSYNC_COMMAND_STOP:
-		if(ctx->fd > 0)
-		{
-			close(ctx->fd);
-			ctx->fd = -1;
-		}
-		xsync_put(XSYNC_COMMAND_STOP, 0, 0);
+		xsync_file_close(ctx);
+		xsync_put(ctx, XSYNC_COMMAND_STOP, 0, 0);
 		break;
 
 	case XSYNC_COMMAND_SYSTEM:
-		xsync_put(XSYNC_COMMAND_SYSTEM, 0, 0);
+		xsync_put(ctx, XSYNC_COMMAND_SYSTEM, 0, 0);
 		ctx->quit = 1;
-		if(ctx->fd > 0)
-		{
-			close(ctx->fd);
-			ctx->fd = -1;
-		}
-		memset(buf, 0, sizeof(buf));
-		memcpy(buf, &ctx->packet.data[0], packet_dsize(&ctx->packet));
+		xsync_file_close(ctx);
+		memset(buf, 0, CONFIG_XSYNC_PACKET_SIZE);
+		memcpy(buf, &ctx->packet.data[0], xsync_min(packet_dsize(&ctx->packet), CONFIG_XSYNC_PACKET_SIZE - 1));
 		system((const char *)buf);
 		break;
 
+	case XSYNC_COMMAND_CONFIG:
+		size = xsync_handle_config(ctx, buf);
+		xsync_put(ctx, XSYNC_COMMAND_CONFIG, buf, size);
+		break;
+
+	case XSYNC_COMMAND_OPEN:
+		size = xsync_handle_open(ctx, buf);
+		xsync_put(ctx, XSYNC_COMMAND_OPEN, buf, size);
+		break;
+
+	case XSYNC_COMMAND_SUM:
+		size = xsync_handle_sum(ctx, buf);
+		xsync_put(ctx, XSYNC_COMMAND_SUM, buf, size);
+		break;
+
+	case XSYNC_COMMAND_DATA:
+		size = xsync_handle_data(ctx, buf);
+		xsync_put(ctx, XSYNC_COMMAND_DATA, buf, size);
+		break;
+
+	case XSYNC_COMMAND_CLOSE:
+		size = xsync_handle_close(ctx, buf);
+		xsync_put(ctx, XSYNC_COMMAND_CLOSE, buf, size);
+		break;
+
 	default:
-		xsync_put(XSYNC_COMMAND_UNKOWN, 0, 0);
+		xsync_put(ctx, XSYNC_COMMAND_UNKOWN, 0, 0);
 		break;
 	}
 }
@@ -324,37 +621,41 @@ static void usage(void)
 
 static int do_xsync(int argc, char ** argv)
 {
-	struct xsync_ctx_t ctx;
+	struct xsync_ctx_t * ctx;
 	ktime_t timeout = ktime_add_ms(ktime_get(), 3000);
-	int c;
-
-	ctx.state = PACKET_STATE_HEADER0;
-	ctx.index = 0;
-	ctx.fd = -1;
-	ctx.quit = 0;
-
-	while(ctx.quit == 0)
+	uint8_t buf[256];
+	ssize_t n, i;
+
+	ctx = malloc(sizeof(struct xsync_ctx_t));
+	if(!ctx)
+		return -1;
+	ctx->state = PACKET_STATE_HEADER0;
+	ctx->index = 0;
+	ctx->fd = -1;
+	ctx->quit = 0;
+	ctx->in = NULL;
+	ctx->next = 0;
+
+	while(ctx->quit == 0)
 	{
-		if((c = getchar()) < 0)
+		if((n = console_stdin_read(buf, sizeof(buf))) <= 0)
 		{
 			if(ktime_after(ktime_get(), timeout))
-			{
-				ctx.quit = 1;
-				if(ctx.fd > 0)
-				{
-					close(ctx.fd);
-					ctx.fd = -1;
-				}
-			}
+				ctx->quit = 1;
 			continue;
 		}
 
-		if(xsync_get(&ctx, c) < 0)
-			continue;
-
-		xsync_handle(&ctx);
-		timeout = ktime_add_ms(ktime_get(), 3000);
+		for(i = 0; (i < n) && (ctx->quit == 0); i++)
+		{
+			if(xsync_get(ctx, buf[i]) < 0)
+				continue;
+			xsync_handle(ctx);
+			timeout = ktime_add_ms(ktime_get(), 3000);
+		}
 	}
+
+	xsync_file_close(ctx);
+	free(ctx);
 	return 0;
 }
 
@@ -0,0 +1,217 @@
+/*
+ * kernel/core/boottime.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <xboot.h>
+#include <clocksource/clocksource.h>
+#include <xboot/boottime.h>
+
+/*
+ * Initcalls and probes are recorded into a static buffer with their start
+ * and duration in nanoseconds of the clocksource. Until a real clocksource
+ * is registered there is no time to take, those are only counted.
+ */
+struct boottime_entry_t
+{
+	s64_t start;
+	s64_t duration;
+	void * func;
+	char name[32];
+	enum boottime_type_t type;
+};
+
+struct boottime_t
+{
+	struct boottime_entry_t entry[CONFIG_BOOTTIME_ENTRIES];
+	int count;
+	int dropped;
+	int early;
+	s64_t finish;
+};
+
+static struct boottime_t __boottime = { .finish = -1 };
+
+static const char * boottime_type_name(enum boottime_type_t type)
+{
+	switch(type)
+	{
+	case BOOTTIME_TYPE_INITCALL:
+		return "initcall";
+	case BOOTTIME_TYPE_PROBE:
+		return "probe";
+	default:
+		break;
+	}
+	return "unknown";
+}
+
+static void boottime_entry_name(struct boottime_entry_t * e, char * buf, size_t size)
+{
+	virtual_addr_t offset;
+	const char * name;
+
+	if(e->name[0])
+		snprintf(buf, size, "%s", e->name);
+	else if((name = kallsyms_lookup((virtual_addr_t)e->func, &offset)))
+		snprintf(buf, size, "%s", name);
+	else
+		snprintf(buf, size, "0x%lx", (unsigned long)e->func);
+}
+
+static int boottime_entry_cmp(const void * a, const void * b)
+{
+	const struct boottime_entry_t * ea = *(const struct boottime_entry_t **)a;
+	const struct boottime_entry_t * eb = *(const struct boottime_entry_t **)b;
+
+	if(ea->duration != eb->duration)
+		return (ea->duration < eb->duration) ? 1 : -1;
+	return (ea->start < eb->start) ? -1 : 1;
+}
+
+s64_t boottime_now(void)
+{
+	if(!clocksource_ready())
+		return -1;
+	return ktime_to_ns(ktime_get());
+}
+
+void boottime_record(enum boottime_type_t type, const char * name, void * func, s64_t start)
+{
+	struct boottime_entry_t * e;
+	s64_t end = boottime_now();
+
+	if((start < 0) || (end < 0))
+	{
+		__boottime.early++;
+		return;
+	}
+	if(__boottime.count >= ARRAY_SIZE(__boottime.entry))
+	{
+		__boottime.dropped++;
+		return;
+	}
+
+	e = &__boottime.entry[__boottime.count++];
+	e->start = start;
+	e->duration = end - start;
+	e->func = func;
+	e->type = type;
+	if(name)
+		snprintf(e->name, sizeof(e->name), "%s", name);
+	else
+		e->name[0] = '\0';
+}
+
+/*
+ * The boot is over once the logo is on screen, a CONFIG_BOOTTIME_BUDGET in
+ * milliseconds other than zero is checked against it
+ */
+void boottime_finish(void)
+{
+	if(__boottime.finish >= 0)
+		return;
+
+	__boottime.finish = boottime_now();
+	if((CONFIG_BOOTTIME_BUDGET > 0) && (__boottime.finish > (s64_t)CONFIG_BOOTTIME_BUDGET * 1000000))
+	{
+		LOG("Boot took %lldms, over the budget of %dms", __boottime.finish / 1000000, CONFIG_BOOTTIME_BUDGET);
+		boottime_report(10);
+	}
+}
+
+void boottime_report(int top)
+{
+	struct boottime_entry_t ** t;
+	char name[64];
+	int count = __boottime.count;
+	int i;
+
+	printf("Boot time report: %d entries, %d before the clocksource, %d dropped\r\n", count, __boottime.early, __boottime.dropped);
+	if(__boottime.finish >= 0)
+		printf("Logo on screen at %lld.%03lldms\r\n", __boottime.finish / 1000000, (__boottime.finish / 1000) % 1000);
+	if(count <= 0)
+		return;
+
+	t = malloc(count * sizeof(struct boottime_entry_t *));
+	if(!t)
+		return;
+	for(i = 0; i < count; i++)
+		t[i] = &__boottime.entry[i];
+	qsort(t, count, sizeof(struct boottime_entry_t *), boottime_entry_cmp);
+
+	if((top <= 0) || (top > count))
+		top = count;
+	printf("%12s %12s  %-8s  %s\r\n", "start(us)", "time(us)", "type", "name");
+	for(i = 0; i < top; i++)
+	{
+		boottime_entry_name(t[i], name, sizeof(name));
+		printf("%12lld %12lld  %-8s  %s\r\n", t[i]->start / 1000, t[i]->duration / 1000, boottime_type_name(t[i]->type), name);
+	}
+	free(t);
+}
+
+/*
+ * Chrome trace event format, complete events with microsecond times, for
+ * chrome://tracing or perfetto
+ */
+bool_t boottime_trace(const char * filename)
+{
+	struct boottime_entry_t * e;
+	char name[64], buf[192];
+	int count = __boottime.count;
+	int i, l, fd;
+
+	if(!filename)
+		return FALSE;
+
+	fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, (S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH));
+	if(fd < 0)
+		return FALSE;
+
+	if(write(fd, "{\"traceEvents\":[\n", 17) != 17)
+	{
+		close(fd);
+		return FALSE;
+	}
+	for(i = 0; i < count; i++)
+	{
+		e = &__boottime.entry[i];
+		boottime_entry_name(e, name, sizeof(name));
+		l = snprintf(buf, sizeof(buf), "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld.%03lld,\"dur\":%lld.%03lld,\"pid\":0,\"tid\":0}%s\n",
+			name, boottime_type_name(e->type), e->start / 1000, e->start % 1000, e->duration / 1000, e->duration % 1000, (i < count - 1) ? "," : "");
+		if(l >= sizeof(buf))
+			l = sizeof(buf) - 1;
+		if(write(fd, buf, l) != l)
+		{
+			close(fd);
+			return FALSE;
+		}
+	}
+	if(write(fd, "]}\n", 3) != 3)
+	{
+		close(fd);
+		return FALSE;
+	}
+	close(fd);
+	return TRUE;
+}
@@ -31,7 +31,7 @@ static struct hlist_head __device_hash[CONFIG_DEVICE_HASH_SIZE];
 static spinlock_t __device_lock = SPIN_LOCK_INIT();
 static struct notifier_chain_t __device_nc = NOTIFIER_CHAIN_INIT();
 
-static struct hlist_head * device_hash(const char * name)
+static unsigned int device_hash(const char * name)
 {
 	unsigned char * p = (unsigned char *)name;
 	unsigned int seed = 131;
@@ -41,6 +41,11 @@ static struct hlist_head * device_hash(const char * name)
 	{
 		hash = hash * seed + (*p++);
 	}
+	return hash;
+}
+
+static struct hlist_head * device_bucket(unsigned int hash)
+{
 	return &__device_hash[hash % ARRAY_SIZE(__device_hash)];
 }
 
@@ -91,6 +96,9 @@ static struct kobj_t * search_device_kobj(struct device_t * dev)
 	case DEVICE_TYPE_DISK:
 		name = "disk";
 		break;
+	case DEVICE_TYPE_DMACHIP:
+		name = "dmachip";
+		break;
 	case DEVICE_TYPE_FRAMEBUFFER:
 		name = "framebuffer";
 		break;
@@ -200,14 +208,15 @@ static ssize_t device_write_resume(struct kobj_t * kobj, void * buf, size_t size
 	return size;
 }
 
-static bool_t device_exist(const char * name)
+bool_t device_exist(const char * name)
 {
 	struct device_t * pos;
 	struct hlist_node * n;
+	unsigned int hash = device_hash(name);
 
-	hlist_for_each_entry_safe(pos, n, device_hash(name), node)
+	hlist_for_each_entry_safe(pos, n, device_bucket(hash), node)
 	{
-		if(strcmp(pos->name, name) == 0)
+		if((pos->hash == hash) && (strcmp(pos->name, name) == 0))
 			return TRUE;
 	}
 	return FALSE;
@@ -232,17 +241,24 @@ void free_device_name(char * name)
 		free(name);
 }
 
+/*
+ * Device names are unique over all types, the name hash finds the device
+ * and the type only has to agree. The hash kept in each device saves the
+ * string compare for the others in the chain.
+ */
 struct device_t * search_device(const char * name, enum device_type_t type)
 {
 	struct device_t * pos;
 	struct hlist_node * n;
+	unsigned int hash;
 
 	if(!name)
 		return NULL;
 
-	hlist_for_each_entry_safe(pos, n, device_hash(name), node)
+	hash = device_hash(name);
+	hlist_for_each_entry_safe(pos, n, device_bucket(hash), node)
 	{
-		if((pos->type == type) && (strcmp(pos->name, name) == 0))
+		if((pos->hash == hash) && (pos->type == type) && (strcmp(pos->name, name) == 0))
 			return pos;
 	}
 	return NULL;
@@ -277,8 +293,9 @@ bool_t register_device(struct device_t * dev)
 	list_add_tail(&dev->list, &__device_list);
 	init_list_head(&dev->head);
 	list_add_tail(&dev->head, &__device_head[dev->type]);
+	dev->hash = device_hash(dev->name);
 	init_hlist_node(&dev->node);
-	hlist_add_head(&dev->node, device_hash(dev->name));
+	hlist_add_head(&dev->node, device_bucket(dev->hash));
 	spin_unlock_irqrestore(&__device_lock, flags);
 	notifier_chain_call(&__device_nc, NOTIFIER_DEVICE_ADD, dev);
 
@@ -23,9 +23,35 @@
  */
 
 #include <xboot/driver.h>
+#include <gpio/gpio.h>
+#include <interrupt/interrupt.h>
+#include <reset/reset.h>
+#include <dma/dma.h>
+
+enum probe_state_t {
+	PROBE_STATE_DONE		= 0,
+	PROBE_STATE_PENDING		= 1,
+	PROBE_STATE_DEFERRED	= 2,
+};
+
+struct probe_node_t {
+	struct dtnode_t n;
+	enum probe_state_t state;
+};
+
+struct probe_tree_t {
+	struct list_head list;
+	json_value * value;
+	struct dtindex_t * index;
+	bool_t binary;
+	struct probe_node_t * nodes;
+	int count;
+};
 
 static struct hlist_head __driver_hash[CONFIG_DRIVER_HASH_SIZE];
 static spinlock_t __driver_lock = SPIN_LOCK_INIT();
+static struct list_head __probe_deferred_list;
+static bool_t __probe_deferred_done = FALSE;
 
 static struct hlist_head * driver_hash(const char * name)
 {
@@ -65,6 +91,7 @@ static ssize_t driver_write_probe(struct kobj_t * kobj, void * buf, size_t size)
 				n.name = strsep(&p, "@");
 				n.addr = p ? strtoull(p, NULL, 0) : 0;
 				n.value = (json_value *)(v->u.object.values[i].value);
+				n.index = NULL;
 
 				if(strcmp(drv->name, n.name) == 0)
 					drv->probe(drv, &n);
@@ -75,6 +102,12 @@ static ssize_t driver_write_probe(struct kobj_t * kobj, void * buf, size_t size)
 	return size;
 }
 
+static ssize_t driver_read_time(struct kobj_t * kobj, void * buf, size_t size)
+{
+	struct driver_t * drv = (struct driver_t *)kobj->priv;
+	return sprintf(buf, "%d probes in %lldus", drv->probes, drv->probe_us);
+}
+
 struct driver_t * search_driver(const char * name)
 {
 	struct driver_t * pos;
@@ -109,6 +142,7 @@ bool_t register_driver(struct driver_t * drv)
 
 	drv->kobj = kobj_alloc_directory(drv->name);
 	kobj_add_regular(drv->kobj, "probe", NULL, driver_write_probe, drv);
+	kobj_add_regular(drv->kobj, "time", driver_read_time, NULL, drv);
 	kobj_add(search_class_driver_kobj(), drv->kobj);
 
 	spin_lock_irqsave(&__driver_lock, flags);
@@ -137,35 +171,231 @@ bool_t unregister_driver(struct driver_t * drv)
 	return TRUE;
 }
 
-void probe_device(const char * json, int length)
+/*
+ * A node waits for the providers its properties refer to. The keys checked,
+ * as used by the drivers in this tree, are:
+ *
+ *   "parent", "backlight", "*-name", "*-bus"    device name
+ *   "dma-*" as a string                          dmachip name before ':'
+ *   "interrupt", "interrupt-parent"              irq number
+ *   "gpio", "*-gpio"                             gpio number
+ *   "reset"                                      reset number
+ *   "dma-*" as a number                          dma channel number
+ *
+ * Keys ending in "-base" or "-count" describe what the node itself provides
+ * and "channel" or "*-channel" pick a unit inside the node's own hardware,
+ * so neither is waited on. Any other key is not a dependency.
+ */
+static bool_t probe_key_suffix(const char * k, int l, const char * suffix)
+{
+	int sl = strlen(suffix);
+
+	return ((l > sl) && (strcmp(k + l - sl, suffix) == 0)) ? TRUE : FALSE;
+}
+
+static bool_t probe_node_ready(struct dtnode_t * n)
 {
-	struct driver_t * drv;
-	struct device_t * dev;
-	struct dtnode_t n;
 	json_value * v;
+	const char * k;
+	char buf[64];
 	char * p;
-	int i;
+	bool_t dma;
+	int i, l;
 
-	if(json && (length > 0))
+	if(!n->value || (n->value->type != json_object))
+		return TRUE;
+
+	for(i = 0; i < n->value->u.object.length; i++)
 	{
-		v = json_parse(json, length);
-		if(v && (v->type == json_object))
+		k = n->value->u.object.values[i].name;
+		v = n->value->u.object.values[i].value;
+		l = strlen(k);
+
+		if(probe_key_suffix(k, l, "-base") || probe_key_suffix(k, l, "-count"))
+			continue;
+		dma = (strncmp(k, "dma-", 4) == 0) ? TRUE : FALSE;
+
+		if(v->type == json_string)
 		{
-			for(i = 0; i < v->u.object.length; i++)
+			if(dma)
 			{
-				p = (char *)(v->u.object.values[i].name);
-				n.name = strsep(&p, "@");
-				n.addr = p ? strtoull(p, NULL, 0) : 0;
-				n.value = (json_value *)(v->u.object.values[i].value);
+				strlcpy(buf, v->u.string.ptr, sizeof(buf));
+				p = strchr(buf, ':');
+				if(p)
+					*p = '\0';
+				if(!device_exist(buf))
+					return FALSE;
+			}
+			else if((strcmp(k, "parent") == 0) || (strcmp(k, "backlight") == 0) || strstr(k, "-name") || probe_key_suffix(k, l, "-bus"))
+			{
+				if(!device_exist(v->u.string.ptr))
+					return FALSE;
+			}
+		}
+		else if((v->type == json_integer) && (v->u.integer >= 0))
+		{
+			if(((strcmp(k, "interrupt") == 0) || (strcmp(k, "interrupt-parent") == 0)) && !irq_is_valid(v->u.integer))
+				return FALSE;
+			if(((strcmp(k, "gpio") == 0) || probe_key_suffix(k, l, "-gpio")) && !gpio_is_valid(v->u.integer))
+				return FALSE;
+			if((strcmp(k, "reset") == 0) && !reset_is_valid(v->u.integer))
+				return FALSE;
+			if(dma && !dma_is_valid(v->u.integer))
+				return FALSE;
+		}
+	}
+	return TRUE;
+}
 
-				drv = search_driver(n.name);
-				if(drv && (dev = drv->probe(drv, &n)))
-					LOG("Probe device '%s' with %s", dev->name, drv->name);
-				else
-					LOG("Fail to probe device with %s", n.name);
+static void probe_node(struct dtnode_t * n)
+{
+	struct driver_t * drv;
+	struct device_t * dev;
+	ktime_t t;
+	s64_t us, b;
+
+	drv = search_driver(n->name);
+	if(drv)
+	{
+		b = boottime_now();
+		t = ktime_get();
+		dev = drv->probe(drv, n);
+		us = ktime_us_delta(ktime_get(), t);
+		boottime_record(BOOTTIME_TYPE_PROBE, dev ? dev->name : n->name, drv->probe, b);
+		drv->probes++;
+		drv->probe_us += us;
+		if(dev)
+		{
+			LOG("Probe device '%s' with %s (%lldus)", dev->name, drv->name, us);
+			return;
+		}
+	}
+	LOG("Fail to probe device with %s", n->name);
+}
+
+/*
+ * Sweeps the nodes in the given state in tree order, probing those whose
+ * dependencies are there. When a sweep probes nothing, the first waiting
+ * node is probed anyway, as its dependencies will not show up.
+ */
+static void probe_tree(struct probe_tree_t * t, enum probe_state_t state)
+{
+	bool_t progress;
+	int i, left;
+
+	do {
+		progress = FALSE;
+		left = 0;
+		for(i = 0; i < t->count; i++)
+		{
+			if(t->nodes[i].state != state)
+				continue;
+			if(probe_node_ready(&t->nodes[i].n))
+			{
+				t->nodes[i].state = PROBE_STATE_DONE;
+				probe_node(&t->nodes[i].n);
+				progress = TRUE;
+			}
+			else
+			{
+				left++;
 			}
 		}
-		json_value_free(v);
+		if(!progress && (left > 0))
+		{
+			for(i = 0; i < t->count; i++)
+			{
+				if(t->nodes[i].state == state)
+				{
+					t->nodes[i].state = PROBE_STATE_DONE;
+					probe_node(&t->nodes[i].n);
+					left--;
+					break;
+				}
+			}
+		}
+	} while(left > 0);
+}
+
+static void probe_tree_free(struct probe_tree_t * t)
+{
+	dt_index_free(t->index);
+	if(t->binary)
+		free(t->value);
+	else
+		json_value_free(t->value);
+	free(t->nodes);
+	free(t);
+}
+
+/*
+ * The device tree is either json or the binary form generated from it at
+ * build time, which needs no parsing. Nodes with "probe-defer" are kept
+ * until do_deferred_probe, after the logo is on screen.
+ */
+void probe_device(const char * json, int length)
+{
+	struct probe_tree_t * t;
+	bool_t deferred = FALSE;
+	char * p;
+	int i;
+
+	if(!json || (length <= 0))
+		return;
+
+	t = malloc(sizeof(struct probe_tree_t));
+	if(!t)
+		return;
+	memset(t, 0, sizeof(struct probe_tree_t));
+
+	t->value = dt_binary_parse(json, length);
+	t->binary = t->value ? TRUE : FALSE;
+	if(!t->binary)
+		t->value = json_parse(json, length);
+	if(t->value && (t->value->type == json_object) && (t->value->u.object.length > 0))
+	{
+		t->index = dt_index_alloc(t->value);
+		t->count = t->value->u.object.length;
+		t->nodes = malloc(sizeof(struct probe_node_t) * t->count);
+	}
+	if(!t->nodes)
+	{
+		probe_tree_free(t);
+		return;
+	}
+
+	for(i = 0; i < t->count; i++)
+	{
+		p = (char *)(t->value->u.object.values[i].name);
+		t->nodes[i].n.name = strsep(&p, "@");
+		t->nodes[i].n.addr = p ? strtoull(p, NULL, 0) : 0;
+		t->nodes[i].n.value = (json_value *)(t->value->u.object.values[i].value);
+		t->nodes[i].n.index = t->index;
+		t->nodes[i].state = PROBE_STATE_PENDING;
+		if(!__probe_deferred_done && dt_read_bool(&t->nodes[i].n, "probe-defer", 0))
+		{
+			t->nodes[i].state = PROBE_STATE_DEFERRED;
+			deferred = TRUE;
+		}
+	}
+	probe_tree(t, PROBE_STATE_PENDING);
+
+	if(deferred)
+		list_add_tail(&t->list, &__probe_deferred_list);
+	else
+		probe_tree_free(t);
+}
+
+void do_deferred_probe(void)
+{
+	struct probe_tree_t * pos, * n;
+
+	__probe_deferred_done = TRUE;
+	list_for_each_entry_safe(pos, n, &__probe_deferred_list, list)
+	{
+		list_del(&pos->list);
+		probe_tree(pos, PROBE_STATE_DEFERRED);
+		probe_tree_free(pos);
 	}
 }
 
@@ -175,5 +405,6 @@ static __init void driver_pure_init(void)
 
 	for(i = 0; i < ARRAY_SIZE(__driver_hash); i++)
 		init_hlist_head(&__driver_hash[i]);
+	init_list_head(&__probe_deferred_list);
 }
 pure_initcall(driver_pure_init);
@@ -23,519 +23,538 @@
  */
 
 #include <xboot.h>
+#include <crc32.h>
 #include <xboot/dtree.h>
 
-const char * dt_read_name(struct dtnode_t * n)
+/*
+ * Property index, one open addressing table for all the objects of a tree,
+ * keyed by the object and the name of the member
+ */
+struct dtindex_slot_t {
+	json_value * object;
+	json_value * value;
+	const char * name;
+	u32_t hash;
+};
+
+struct dtindex_t {
+	u32_t size;
+	struct dtindex_slot_t * slots;
+};
+
+static u32_t dt_hash(json_value * object, const char * name)
 {
-	return n ? n->name : NULL;
-}
+	unsigned char * p = (unsigned char *)name;
+	u32_t seed = 131;
+	u32_t hash = 0;
 
-int dt_read_id(struct dtnode_t * n)
-{
-	return n ? (int)n->addr : 0;
+	while(*p)
+	{
+		hash = hash * seed + (*p++);
+	}
+	return hash ^ ((u32_t)((unsigned long)object >> 4) * 0x9e3779b1);
 }
 
-physical_addr_t dt_read_address(struct dtnode_t * n)
+static u32_t dt_index_count(json_value * v)
 {
-	return n ? n->addr : 0;
+	u32_t count = 0;
+	int i;
+
+	if(v && (v->type == json_object))
+	{
+		for(i = 0; i < v->u.object.length; i++)
+			count += 1 + dt_index_count(v->u.object.values[i].value);
+	}
+	else if(v && (v->type == json_array))
+	{
+		for(i = 0; i < v->u.array.length; i++)
+			count += dt_index_count(v->u.array.values[i]);
+	}
+	return count;
 }
 
-int dt_read_bool(struct dtnode_t * n, const char * name, int def)
+static void dt_index_insert(struct dtindex_t * idx, json_value * v)
 {
-	json_value * v;
-	int i;
+	struct dtindex_slot_t * s;
+	u32_t hash, i;
+	int k;
 
-	if(n && n->value && (n->value->type == json_object))
+	if(v && (v->type == json_object))
 	{
-		for(i = 0; i < n->value->u.object.length; i++)
+		for(k = 0; k < v->u.object.length; k++)
 		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
+			hash = dt_hash(v, v->u.object.values[k].name);
+			for(i = hash & (idx->size - 1); ; i = (i + 1) & (idx->size - 1))
 			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_boolean))
-					return v->u.boolean ? 1 : 0;
+				s = &idx->slots[i];
+				if(!s->object)
+				{
+					s->object = v;
+					s->value = v->u.object.values[k].value;
+					s->name = v->u.object.values[k].name;
+					s->hash = hash;
+					break;
+				}
+				if((s->object == v) && (s->hash == hash) && (strcmp(s->name, v->u.object.values[k].name) == 0))
+					break;
 			}
+			dt_index_insert(idx, v->u.object.values[k].value);
 		}
 	}
-	return def;
+	else if(v && (v->type == json_array))
+	{
+		for(k = 0; k < v->u.array.length; k++)
+			dt_index_insert(idx, v->u.array.values[k]);
+	}
 }
 
-int dt_read_int(struct dtnode_t * n, const char * name, int def)
+struct dtindex_t * dt_index_alloc(json_value * v)
 {
-	json_value * v;
-	int i;
+	struct dtindex_t * idx;
+	u32_t count, size = 16;
+
+	if(!v)
+		return NULL;
+
+	count = dt_index_count(v);
+	while(size < count * 2)
+		size <<= 1;
+
+	idx = malloc(sizeof(struct dtindex_t) + sizeof(struct dtindex_slot_t) * size);
+	if(!idx)
+		return NULL;
+	idx->size = size;
+	idx->slots = (struct dtindex_slot_t *)(idx + 1);
+	memset(idx->slots, 0, sizeof(struct dtindex_slot_t) * size);
+	dt_index_insert(idx, v);
+
+	return idx;
+}
 
-	if(n && n->value && (n->value->type == json_object))
+void dt_index_free(struct dtindex_t * idx)
+{
+	if(idx)
+		free(idx);
+}
+
+static json_value * dt_lookup(struct dtnode_t * n, const char * name)
+{
+	struct dtindex_slot_t * s;
+	u32_t hash, i;
+
+	if(!n || !n->value || (n->value->type != json_object) || !name)
+		return NULL;
+
+	if(n->index)
 	{
-		for(i = 0; i < n->value->u.object.length; i++)
+		hash = dt_hash(n->value, name);
+		for(i = hash & (n->index->size - 1); ; i = (i + 1) & (n->index->size - 1))
 		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_integer))
-					return (int)v->u.integer;
-			}
+			s = &n->index->slots[i];
+			if(!s->object)
+				return NULL;
+			if((s->object == n->value) && (s->hash == hash) && (strcmp(s->name, name) == 0))
+				return s->value;
 		}
 	}
-	return def;
+
+	for(i = 0; i < n->value->u.object.length; i++)
+	{
+		if(strcmp(n->value->u.object.values[i].name, name) == 0)
+			return n->value->u.object.values[i].value;
+	}
+	return NULL;
 }
 
-long long dt_read_long(struct dtnode_t * n, const char * name, long long def)
+static json_value * dt_lookup_array(struct dtnode_t * n, const char * name, int idx)
 {
-	json_value * v;
-	int i;
+	json_value * v = dt_lookup(n, name);
 
-	if(n && n->value && (n->value->type == json_object))
+	if(v && (v->type == json_array) && (idx >= 0) && (idx < v->u.array.length))
+		return v->u.array.values[idx];
+	return NULL;
+}
+
+/*
+ * Binary device tree, generated from the json at build time. All numbers are
+ * little endian, a header of seven words
+ *
+ *   magic, values, members, elements, strings size, crc32, source crc32
+ *
+ * is followed by a record of four words for each value in pre order
+ *
+ *   type, name, low, high
+ *
+ * and by the nul terminated strings. The type is a json_type, the name the
+ * offset of the member name for the values of an object. The low and high
+ * words hold the integer, the bits of the double, the boolean, the offset
+ * and length of a string, or the number of values of an object or array
+ * which follow it. The crc32 covers the records and the strings, the source
+ * crc32 the json it was generated from.
+ */
+#define DT_BINARY_MAGIC		(0x31544458)
+#define DT_BINARY_DEPTH		(32)
+
+struct dtbinary_t {
+	const u8_t * record;
+	const char * strings;
+	u32_t nvalue, nentry, nelement, strsize;
+	u32_t ivalue, ientry, ielement;
+	json_value * values;
+	json_object_entry * entries;
+	json_value ** elements;
+};
+
+static inline u32_t dt_le32(const u8_t * p)
+{
+	return (u32_t)p[0] | ((u32_t)p[1] << 8) | ((u32_t)p[2] << 16) | ((u32_t)p[3] << 24);
+}
+
+static json_value * dt_binary_value(struct dtbinary_t * b, json_value * parent, int depth)
+{
+	json_value * v;
+	const u8_t * r;
+	u32_t lo, hi, name, i;
+	u64_t d;
+
+	if((b->ivalue >= b->nvalue) || (depth > DT_BINARY_DEPTH))
+		return NULL;
+	r = b->record + b->ivalue * 16;
+	v = &b->values[b->ivalue++];
+	v->parent = parent;
+	v->type = dt_le32(r);
+	lo = dt_le32(r + 8);
+	hi = dt_le32(r + 12);
+
+	switch(v->type)
 	{
-		for(i = 0; i < n->value->u.object.length; i++)
+	case json_object:
+		if(lo > b->nentry - b->ientry)
+			return NULL;
+		v->u.object.length = lo;
+		v->u.object.values = &b->entries[b->ientry];
+		b->ientry += lo;
+		for(i = 0; i < lo; i++)
 		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_integer))
-					return (long long)v->u.integer;
-			}
+			if(b->ivalue >= b->nvalue)
+				return NULL;
+			name = dt_le32(b->record + b->ivalue * 16 + 4);
+			if(name >= b->strsize)
+				return NULL;
+			v->u.object.values[i].name = (json_char *)&b->strings[name];
+			v->u.object.values[i].name_length = strlen(&b->strings[name]);
+			v->u.object.values[i].value = dt_binary_value(b, v, depth + 1);
+			if(!v->u.object.values[i].value)
+				return NULL;
 		}
+		break;
+	case json_array:
+		if(lo > b->nelement - b->ielement)
+			return NULL;
+		v->u.array.length = lo;
+		v->u.array.values = &b->elements[b->ielement];
+		b->ielement += lo;
+		for(i = 0; i < lo; i++)
+		{
+			v->u.array.values[i] = dt_binary_value(b, v, depth + 1);
+			if(!v->u.array.values[i])
+				return NULL;
+		}
+		break;
+	case json_integer:
+		v->u.integer = (json_int_t)(((u64_t)hi << 32) | lo);
+		break;
+	case json_double:
+		d = ((u64_t)hi << 32) | lo;
+		memcpy(&v->u.dbl, &d, sizeof(double));
+		break;
+	case json_string:
+		if((lo >= b->strsize) || (hi >= b->strsize - lo) || (b->strings[lo + hi] != '\0'))
+			return NULL;
+		v->u.string.length = hi;
+		v->u.string.ptr = (json_char *)&b->strings[lo];
+		break;
+	case json_boolean:
+		v->u.boolean = lo ? 1 : 0;
+		break;
+	case json_null:
+		break;
+	default:
+		return NULL;
 	}
-	return def;
+	return v;
 }
 
-double dt_read_double(struct dtnode_t * n, const char * name, double def)
+/*
+ * Tells whether a binary device tree was generated from the given json
+ */
+bool_t dt_binary_match(const void * buf, size_t len, const void * json, size_t jlen)
 {
-	json_value * v;
-	int i;
+	const u8_t * p = buf;
+
+	if(!p || !json || (len < 28) || (dt_le32(p) != DT_BINARY_MAGIC))
+		return FALSE;
+	return (crc32_sum(0, json, jlen) == dt_le32(p + 24)) ? TRUE : FALSE;
+}
 
-	if(n && n->value && (n->value->type == json_object))
+/*
+ * The whole tree lives in one block starting with the root value, which
+ * is released with free
+ */
+json_value * dt_binary_parse(const void * buf, size_t len)
+{
+	const u8_t * p = buf;
+	struct dtbinary_t b;
+	json_value * v;
+	char * s;
+
+	if(!p || (len < 28) || (dt_le32(p) != DT_BINARY_MAGIC))
+		return NULL;
+
+	b.nvalue = dt_le32(p + 4);
+	b.nentry = dt_le32(p + 8);
+	b.nelement = dt_le32(p + 12);
+	b.strsize = dt_le32(p + 16);
+	if((b.nvalue == 0) || (b.nvalue > (len - 28) / 16) || (b.strsize != len - 28 - b.nvalue * 16))
+		return NULL;
+	if((b.nentry > b.nvalue) || (b.nelement > b.nvalue) || (b.strsize == 0) || (p[len - 1] != '\0'))
+		return NULL;
+	if(crc32_sum(0, p + 28, len - 28) != dt_le32(p + 20))
+		return NULL;
+
+	v = malloc(sizeof(json_value) * b.nvalue + sizeof(json_object_entry) * b.nentry + sizeof(json_value *) * b.nelement + b.strsize);
+	if(!v)
+		return NULL;
+	memset(v, 0, sizeof(json_value) * b.nvalue);
+	b.values = v;
+	b.entries = (json_object_entry *)&b.values[b.nvalue];
+	b.elements = (json_value **)&b.entries[b.nentry];
+	s = (char *)&b.elements[b.nelement];
+	memcpy(s, p + 28 + b.nvalue * 16, b.strsize);
+	b.strings = s;
+	b.record = p + 28;
+	b.ivalue = b.ientry = b.ielement = 0;
+
+	if(!dt_binary_value(&b, NULL, 0) || (b.ivalue != b.nvalue) || (v->type != json_object))
 	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_double))
-					return (double)v->u.dbl;
-			}
-		}
+		free(v);
+		return NULL;
 	}
+	return v;
+}
+
+const char * dt_read_name(struct dtnode_t * n)
+{
+	return n ? n->name : NULL;
+}
+
+int dt_read_id(struct dtnode_t * n)
+{
+	return n ? (int)n->addr : 0;
+}
+
+physical_addr_t dt_read_address(struct dtnode_t * n)
+{
+	return n ? n->addr : 0;
+}
+
+int dt_read_bool(struct dtnode_t * n, const char * name, int def)
+{
+	json_value * v = dt_lookup(n, name);
+
+	if(v && (v->type == json_boolean))
+		return v->u.boolean ? 1 : 0;
+	return def;
+}
+
+int dt_read_int(struct dtnode_t * n, const char * name, int def)
+{
+	json_value * v = dt_lookup(n, name);
+
+	if(v && (v->type == json_integer))
+		return (int)v->u.integer;
+	return def;
+}
+
+long long dt_read_long(struct dtnode_t * n, const char * name, long long def)
+{
+	json_value * v = dt_lookup(n, name);
+
+	if(v && (v->type == json_integer))
+		return (long long)v->u.integer;
+	return def;
+}
+
+double dt_read_double(struct dtnode_t * n, const char * name, double def)
+{
+	json_value * v = dt_lookup(n, name);
+
+	if(v && (v->type == json_double))
+		return (double)v->u.dbl;
 	return def;
 }
 
 char * dt_read_string(struct dtnode_t * n, const char * name, char * def)
 {
-	json_value * v;
-	int i;
+	json_value * v = dt_lookup(n, name);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_string))
-					return (char *)v->u.string.ptr;
-			}
-		}
-	}
+	if(v && (v->type == json_string))
+		return (char *)v->u.string.ptr;
 	return def;
 }
 
 u8_t dt_read_u8(struct dtnode_t * n, const char * name, u8_t def)
 {
-	json_value * v;
-	int i;
+	json_value * v = dt_lookup(n, name);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_integer))
-					return (u8_t)v->u.integer;
-			}
-		}
-	}
+	if(v && (v->type == json_integer))
+		return (u8_t)v->u.integer;
 	return def;
 }
 
 u16_t dt_read_u16(struct dtnode_t * n, const char * name, u16_t def)
 {
-	json_value * v;
-	int i;
+	json_value * v = dt_lookup(n, name);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_integer))
-					return (u16_t)v->u.integer;
-			}
-		}
-	}
+	if(v && (v->type == json_integer))
+		return (u16_t)v->u.integer;
 	return def;
 }
 
 u32_t dt_read_u32(struct dtnode_t * n, const char * name, u32_t def)
 {
-	json_value * v;
-	int i;
+	json_value * v = dt_lookup(n, name);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_integer))
-					return (u32_t)v->u.integer;
-			}
-		}
-	}
+	if(v && (v->type == json_integer))
+		return (u32_t)v->u.integer;
 	return def;
 }
 
 u64_t dt_read_u64(struct dtnode_t * n, const char * name, u64_t def)
 {
-	json_value * v;
-	int i;
+	json_value * v = dt_lookup(n, name);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_integer))
-					return (u64_t)v->u.integer;
-			}
-		}
-	}
+	if(v && (v->type == json_integer))
+		return (u64_t)v->u.integer;
 	return def;
 }
 
 struct dtnode_t * dt_read_object(struct dtnode_t * n, const char * name, struct dtnode_t * o)
 {
-	json_value * v;
-	int i;
+	json_value * v = dt_lookup(n, name);
 
-	if(o && n && n->value && (n->value->type == json_object))
+	if(o && v && (v->type == json_object))
 	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_object))
-				{
-					o->name = name;
-					o->addr = 0;
-					o->value = v;
-					return o;
-				}
-			}
-		}
+		o->name = name;
+		o->addr = 0;
+		o->value = v;
+		o->index = n->index;
+		return o;
 	}
 	return NULL;
 }
 
 int dt_read_array_length(struct dtnode_t * n, const char * name)
 {
-	json_value * v;
-	int i;
+	json_value * v = dt_lookup(n, name);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_array))
-					return v->u.array.length;
-			}
-		}
-	}
+	if(v && (v->type == json_array))
+		return v->u.array.length;
 	return 0;
 }
 
 int dt_read_array_bool(struct dtnode_t * n, const char * name, int idx, int def)
 {
-	json_value * v, * e;
-	int i;
+	json_value * e = dt_lookup_array(n, name, idx);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_array))
-				{
-					if(idx >= 0 && (idx < v->u.array.length))
-					{
-						e = v->u.array.values[idx];
-						if(e && (e->type == json_boolean))
-							return e->u.boolean ? 1 : 0;
-					}
-				}
-			}
-		}
-	}
+	if(e && (e->type == json_boolean))
+		return e->u.boolean ? 1 : 0;
 	return def;
 }
 
 int dt_read_array_int(struct dtnode_t * n, const char * name, int idx, int def)
 {
-	json_value * v, * e;
-	int i;
+	json_value * e = dt_lookup_array(n, name, idx);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_array))
-				{
-					if(idx >= 0 && (idx < v->u.array.length))
-					{
-						e = v->u.array.values[idx];
-						if(e && (e->type == json_integer))
-							return (int)e->u.integer;
-					}
-				}
-			}
-		}
-	}
+	if(e && (e->type == json_integer))
+		return (int)e->u.integer;
 	return def;
 }
 
 long long dt_read_array_long(struct dtnode_t * n, const char * name, int idx, long long def)
 {
-	json_value * v, * e;
-	int i;
+	json_value * e = dt_lookup_array(n, name, idx);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_array))
-				{
-					if(idx >= 0 && (idx < v->u.array.length))
-					{
-						e = v->u.array.values[idx];
-						if(e && (e->type == json_integer))
-							return (long long)e->u.integer;
-					}
-				}
-			}
-		}
-	}
+	if(e && (e->type == json_integer))
+		return (long long)e->u.integer;
 	return def;
 }
 
 double dt_read_array_double(struct dtnode_t * n, const char * name, int idx, double def)
 {
-	json_value * v, * e;
-	int i;
+	json_value * e = dt_lookup_array(n, name, idx);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_array))
-				{
-					if(idx >= 0 && (idx < v->u.array.length))
-					{
-						e = v->u.array.values[idx];
-						if(e && (e->type == json_double))
-							return (double)e->u.dbl;
-					}
-				}
-			}
-		}
-	}
+	if(e && (e->type == json_double))
+		return (double)e->u.dbl;
 	return def;
 }
 
 char * dt_read_array_string(struct dtnode_t * n, const char * name, int idx, char * def)
 {
-	json_value * v, * e;
-	int i;
+	json_value * e = dt_lookup_array(n, name, idx);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_array))
-				{
-					if(idx >= 0 && (idx < v->u.array.length))
-					{
-						e = v->u.array.values[idx];
-						if(e && (e->type == json_string))
-							return (char *)e->u.string.ptr;
-					}
-				}
-			}
-		}
-	}
+	if(e && (e->type == json_string))
+		return (char *)e->u.string.ptr;
 	return def;
 }
 
 u8_t dt_read_array_u8(struct dtnode_t * n, const char * name, int idx, u8_t def)
 {
-	json_value * v, * e;
-	int i;
+	json_value * e = dt_lookup_array(n, name, idx);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_array))
-				{
-					if(idx >= 0 && (idx < v->u.array.length))
-					{
-						e = v->u.array.values[idx];
-						if(e && (e->type == json_integer))
-							return (u8_t)e->u.integer;
-					}
-				}
-			}
-		}
-	}
+	if(e && (e->type == json_integer))
+		return (u8_t)e->u.integer;
 	return def;
 }
 
 u16_t dt_read_array_u16(struct dtnode_t * n, const char * name, int idx, u16_t def)
 {
-	json_value * v, * e;
-	int i;
+	json_value * e = dt_lookup_array(n, name, idx);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_array))
-				{
-					if(idx >= 0 && (idx < v->u.array.length))
-					{
-						e = v->u.array.values[idx];
-						if(e && (e->type == json_integer))
-							return (u16_t)e->u.integer;
-					}
-				}
-			}
-		}
-	}
+	if(e && (e->type == json_integer))
+		return (u16_t)e->u.integer;
 	return def;
 }
 
 u32_t dt_read_array_u32(struct dtnode_t * n, const char * name, int idx, u32_t def)
 {
-	json_value * v, * e;
-	int i;
+	json_value * e = dt_lookup_array(n, name, idx);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_array))
-				{
-					if(idx >= 0 && (idx < v->u.array.length))
-					{
-						e = v->u.array.values[idx];
-						if(e && (e->type == json_integer))
-							return (u32_t)e->u.integer;
-					}
-				}
-			}
-		}
-	}
+	if(e && (e->type == json_integer))
+		return (u32_t)e->u.integer;
 	return def;
 }
 
 u64_t dt_read_array_u64(struct dtnode_t * n, const char * name, int idx, u64_t def)
 {
-	json_value * v, * e;
-	int i;
+	json_value * e = dt_lookup_array(n, name, idx);
 
-	if(n && n->value && (n->value->type == json_object))
-	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_array))
-				{
-					if(idx >= 0 && (idx < v->u.array.length))
-					{
-						e = v->u.array.values[idx];
-						if(e && (e->type == json_integer))
-							return (u64_t)e->u.integer;
-					}
-				}
-			}
-		}
-	}
+	if(e && (e->type == json_integer))
+		return (u64_t)e->u.integer;
 	return def;
 }
 
 struct dtnode_t * dt_read_array_object(struct dtnode_t * n, const char * name, int idx, struct dtnode_t * o)
 {
-	json_value * v, * e;
-	int i;
+	json_value * e = dt_lookup_array(n, name, idx);
 
-	if(o && n && n->value && (n->value->type == json_object))
+	if(o && e && (e->type == json_object))
 	{
-		for(i = 0; i < n->value->u.object.length; i++)
-		{
-			if(strcmp(n->value->u.object.values[i].name, name) == 0)
-			{
-				v = n->value->u.object.values[i].value;
-				if(v && (v->type == json_array))
-				{
-					if(idx >= 0 && (idx < v->u.array.length))
-					{
-						e = v->u.array.values[idx];
-						if(e && (e->type == json_object))
-						{
-							o->name = 0;
-							o->addr = 0;
-							o->value = e;
-							return o;
-						}
-					}
-				}
-			}
-		}
+		o->name = 0;
+		o->addr = 0;
+		o->value = e;
+		o->index = n->index;
+		return o;
 	}
 	return NULL;
 }
@@ -659,13 +659,13 @@ extern __typeof(__arch_gdb_cpu) arch_gdb_cpu __attribute__((weak, alias("__arch_
 static int gdb_interface_uart_read(struct gdb_iterface_t * iface, char * buf, int count)
 {
 	struct uart_t * uart = (struct uart_t *)iface->priv;
-	return uart->read(uart, (u8_t *)buf, (size_t)count);
+	return uart_read(uart, (u8_t *)buf, (size_t)count);
 }
 
 static int gdb_interface_uart_write(struct gdb_iterface_t * iface, const char * buf, int count)
 {
 	struct uart_t * uart = (struct uart_t *)iface->priv;
-	return uart->write(uart, (u8_t *)buf, (size_t)count);
+	return uart_write(uart, (u8_t *)buf, (size_t)count);
 }
 
 static void gdb_interface_uart_flush(struct gdb_iterface_t * iface)
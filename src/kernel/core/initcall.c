@@ -33,11 +33,14 @@ extern exitcall_t __exitcall_end[];
 void do_initcalls(void)
 {
 	initcall_t * call;
+	s64_t t;
 
 	call =  &(*__initcall_start);
 	while(call < &(*__initcall_end))
 	{
+		t = boottime_now();
 		(*call)();
+		boottime_record(BOOTTIME_TYPE_INITCALL, NULL, (void *)(*call), t);
 		call++;
 	}
 }
@@ -0,0 +1,68 @@
+/*
+ * kernel/core/kallsyms.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <xboot.h>
+#include <xboot/kallsyms.h>
+
+/*
+ * The symbol table is generated from the first link of the image and
+ * linked in on the second pass, see the makefile. The text section comes
+ * first in all linker scripts, so function addresses do not move.
+ */
+extern const virtual_addr_t __kallsyms_addr[] __attribute__((weak));
+extern const char * const __kallsyms_name[] __attribute__((weak));
+extern const int __kallsyms_num __attribute__((weak));
+
+const char * kallsyms_lookup(virtual_addr_t addr, virtual_addr_t * offset)
+{
+	int l, r, m;
+
+	if(!&__kallsyms_num || (__kallsyms_num <= 0) || (addr < __kallsyms_addr[0]))
+		return NULL;
+
+	l = 0;
+	r = __kallsyms_num - 1;
+	while(l < r)
+	{
+		m = l + (r - l + 1) / 2;
+		if(__kallsyms_addr[m] <= addr)
+			l = m;
+		else
+			r = m - 1;
+	}
+	if(offset)
+		*offset = addr - __kallsyms_addr[l];
+	return __kallsyms_name[l];
+}
+
+int kallsyms_snprint(char * buf, size_t size, virtual_addr_t addr)
+{
+	virtual_addr_t offset;
+	const char * name;
+
+	name = kallsyms_lookup(addr, &offset);
+	if(name)
+		return snprintf(buf, size, "%s+0x%lx", name, (unsigned long)offset);
+	return snprintf(buf, size, "0x%lx", (unsigned long)addr);
+}
@@ -27,6 +27,54 @@
 #include <xboot/kobj.h>
 
 static struct kobj_t * __kobj_root;
+static u32_t __kobj_generation = 0;
+
+static u32_t kobj_hash(const char * name)
+{
+	unsigned char * p = (unsigned char *)name;
+	u32_t seed = 131;
+	u32_t hash = 0;
+
+	while(*p)
+	{
+		hash = hash * seed + (*p++);
+	}
+	return hash;
+}
+
+/*
+ * Directories with more than CONFIG_KOBJ_HASH_THRESHOLD children are also
+ * indexed by a hash table of their names, which doubles whenever it holds
+ * twice as many children as buckets. The children list keeps the order for
+ * readdir.
+ */
+static void kobj_rehash(struct kobj_t * parent, u32_t tsize)
+{
+	struct hlist_head * table, * old;
+	struct kobj_t * pos;
+	irq_flags_t flags;
+	u32_t i;
+
+	table = malloc(sizeof(struct hlist_head) * tsize);
+	if(!table)
+		return;
+	for(i = 0; i < tsize; i++)
+		init_hlist_head(&table[i]);
+
+	spin_lock_irqsave(&parent->lock, flags);
+	list_for_each_entry(pos, &(parent->children), entry)
+	{
+		init_hlist_node(&pos->node);
+		hlist_add_head(&pos->node, &table[pos->hash & (tsize - 1)]);
+	}
+	old = parent->table;
+	parent->table = table;
+	parent->tsize = tsize;
+	spin_unlock_irqrestore(&parent->lock, flags);
+
+	if(old)
+		free(old);
+}
 
 static struct kobj_t * __kobj_alloc(const char * name, enum kobj_type_t type, kobj_read_t read, kobj_write_t write, void * priv)
 {
@@ -44,6 +92,11 @@ static struct kobj_t * __kobj_alloc(const char * name, enum kobj_type_t type, ko
 	kobj->parent = kobj;
 	init_list_head(&kobj->entry);
 	init_list_head(&kobj->children);
+	kobj->hash = kobj_hash(name);
+	init_hlist_node(&kobj->node);
+	kobj->table = NULL;
+	kobj->tsize = 0;
+	kobj->count = 0;
 	spin_lock_init(&kobj->lock);
 	kobj->read = read;
 	kobj->write = write;
@@ -60,6 +113,8 @@ struct kobj_t * kobj_get_root(void)
 struct kobj_t * kobj_search(struct kobj_t * parent, const char * name)
 {
 	struct kobj_t * pos, * n;
+	struct hlist_node * t;
+	u32_t hash;
 
 	if(!parent)
 		return NULL;
@@ -70,15 +125,52 @@ struct kobj_t * kobj_search(struct kobj_t * parent, const char * name)
 	if(!name)
 		return NULL;
 
+	hash = kobj_hash(name);
+	if(parent->table)
+	{
+		hlist_for_each_entry_safe(pos, t, &parent->table[hash & (parent->tsize - 1)], node)
+		{
+			if((pos->hash == hash) && (strcmp(pos->name, name) == 0))
+				return pos;
+		}
+		return NULL;
+	}
+
 	list_for_each_entry_safe(pos, n, &(parent->children), entry)
 	{
-		if(strcmp(pos->name, name) == 0)
+		if((pos->hash == hash) && (strcmp(pos->name, name) == 0))
 			return pos;
 	}
 
 	return NULL;
 }
 
+/*
+ * Resolve a slash separated path below the kobj root, as seen under /sys
+ */
+struct kobj_t * kobj_lookup(const char * path)
+{
+	struct kobj_t * kobj = kobj_get_root();
+	char name[256];
+	int i;
+
+	if(!path)
+		return NULL;
+
+	while(kobj && *path)
+	{
+		while(*path == '/')
+			path++;
+		if(*path == '\0')
+			break;
+		for(i = 0; (i < sizeof(name) - 1) && *path && (*path != '/'); i++)
+			name[i] = *path++;
+		name[i] = '\0';
+		kobj = kobj_search(kobj, name);
+	}
+	return kobj;
+}
+
 struct kobj_t * kobj_search_directory_with_create(struct kobj_t * parent, const char * name)
 {
 	struct kobj_t * kobj;
@@ -128,6 +220,8 @@ bool_t kobj_free(struct kobj_t * kobj)
 	if(!kobj)
 		return FALSE;
 
+	if(kobj->table)
+		free(kobj->table);
 	free(kobj->name);
 	free(kobj);
 	return TRUE;
@@ -154,16 +248,28 @@ bool_t kobj_add(struct kobj_t * parent, struct kobj_t * kobj)
 
 	kobj->parent = parent;
 	list_add_tail(&kobj->entry, &parent->children);
+	if(parent->table)
+		hlist_add_head(&kobj->node, &parent->table[kobj->hash & (parent->tsize - 1)]);
+	parent->count++;
 
 	spin_unlock_irqrestore(&kobj->lock, flags);
 	spin_unlock_irqrestore(&parent->lock, pflags);
 
+	if(!parent->table)
+	{
+		if(parent->count > CONFIG_KOBJ_HASH_THRESHOLD)
+			kobj_rehash(parent, 32);
+	}
+	else if(parent->count > parent->tsize * 2)
+	{
+		kobj_rehash(parent, parent->tsize * 2);
+	}
+
 	return TRUE;
 }
 
 bool_t kobj_remove(struct kobj_t * parent, struct kobj_t * kobj)
 {
-	struct kobj_t * pos, * n;
 	irq_flags_t pflags, flags;
 
 	if(!parent)
@@ -175,24 +281,23 @@ bool_t kobj_remove(struct kobj_t * parent, struct kobj_t * kobj)
 	if(!kobj)
 		return FALSE;
 
-	list_for_each_entry_safe(pos, n, &(parent->children), entry)
-	{
-		if(pos == kobj)
-		{
-			spin_lock_irqsave(&parent->lock, pflags);
-			spin_lock_irqsave(&kobj->lock, flags);
+	if((kobj->parent != parent) || (kobj == parent))
+		return FALSE;
 
-			pos->parent = pos;
-			list_del(&(pos->entry));
+	spin_lock_irqsave(&parent->lock, pflags);
+	spin_lock_irqsave(&kobj->lock, flags);
 
-			spin_unlock_irqrestore(&kobj->lock, flags);
-			spin_unlock_irqrestore(&parent->lock, pflags);
+	kobj->parent = kobj;
+	list_del(&(kobj->entry));
+	if(parent->table)
+		hlist_del_init(&kobj->node);
+	parent->count--;
+	__kobj_generation++;
 
-			return TRUE;
-		}
-	}
+	spin_unlock_irqrestore(&kobj->lock, flags);
+	spin_unlock_irqrestore(&parent->lock, pflags);
 
-	return FALSE;
+	return TRUE;
 }
 
 bool_t kobj_add_directory(struct kobj_t * parent, const char * name)
@@ -277,6 +382,15 @@ bool_t kobj_remove_self(struct kobj_t * kobj)
 	return TRUE;
 }
 
+/*
+ * Bumped whenever a kobj leaves its directory, so that lookups cached
+ * elsewhere know they may point to a freed kobj
+ */
+u32_t kobj_generation(void)
+{
+	return __kobj_generation;
+}
+
 void do_init_kobj(void)
 {
 	__kobj_root = kobj_alloc_directory("kobj");
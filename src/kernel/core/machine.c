@@ -25,6 +25,7 @@
 #include <xboot.h>
 #include <sha256.h>
 #include <watchdog/watchdog.h>
+#include <console/console.h>
 #include <xboot/machine.h>
 
 static struct list_head __machine_list = {
@@ -164,6 +165,7 @@ void machine_shutdown(void)
 	struct machine_t * mach = get_machine();
 
 	sync();
+	console_flush();
 	if(mach && mach->shutdown)
 		mach->shutdown(mach);
 }
@@ -173,6 +175,7 @@ void machine_reboot(void)
 	struct machine_t * mach = get_machine();
 
 	sync();
+	console_flush();
 	if(mach && mach->reboot)
 		mach->reboot(mach);
 	watchdog_set_timeout(search_first_watchdog(), 1);
@@ -184,6 +187,7 @@ void machine_sleep(void)
 	struct device_t * pos, * n;
 
 	sync();
+	console_flush();
 	list_for_each_entry_safe_reverse(pos, n, &__device_list, list)
 	{
 		suspend_device(pos);
@@ -203,6 +207,7 @@ void machine_cleanup(void)
 	struct machine_t * mach = get_machine();
 
 	sync();
+	console_flush();
 	if(mach && mach->cleanup)
 		mach->cleanup(mach);
 }
@@ -25,20 +25,49 @@
 #include <xboot.h>
 #include <xboot/profiler.h>
 
+struct profiler_counter_t
+{
+	int users;
+	int counter;
+	uint64_t base;
+	uint64_t value;
+	uint64_t enabled;
+	uint64_t running;
+	uint64_t tenabled;
+	uint64_t trunning;
+};
+
+static const char * __profiler_event_name[PROFILER_EVENT_MAX] = {
+	[PROFILER_EVENT_TIME]			= "time",
+	[PROFILER_EVENT_CYCLES]			= "cycles",
+	[PROFILER_EVENT_INSTRUCTIONS]	= "instructions",
+	[PROFILER_EVENT_CACHE_MISSES]	= "cache-misses",
+	[PROFILER_EVENT_BRANCH_MISSES]	= "branch-misses",
+};
+static struct profiler_counter_t __profiler_counter[PROFILER_EVENT_MAX];
 static struct hlist_head __profiler_hash[CONFIG_PROFILER_HASH_SIZE];
+static struct timer_t __profiler_timer;
+static int __profiler_rotate = 0;
+static int __profiler_multiplex = 0;
 static spinlock_t __profiler_lock = SPIN_LOCK_INIT();
 
-static void __cpu_profiler_start(int event, int data)
+static int __cpu_profiler_counters(void)
+{
+	return 0;
+}
+extern __typeof(__cpu_profiler_counters) cpu_profiler_counters __attribute__((weak, alias("__cpu_profiler_counters")));
+
+static void __cpu_profiler_start(int event, int counter)
 {
 }
 extern __typeof(__cpu_profiler_start) cpu_profiler_start __attribute__((weak, alias("__cpu_profiler_start")));
 
-static void __cpu_profiler_stop(int event, int data)
+static void __cpu_profiler_stop(int event, int counter)
 {
 }
 extern __typeof(__cpu_profiler_stop) cpu_profiler_stop __attribute__((weak, alias("__cpu_profiler_stop")));
 
-static uint64_t __cpu_profiler_read(int event, int data)
+static uint64_t __cpu_profiler_read(int event, int counter)
 {
 	return 0;
 }
@@ -62,6 +91,150 @@ static inline uint32_t string_hash(const char * s)
 	return nr;
 }
 
+static void counter_sched_in(int event, int counter, uint64_t now)
+{
+	struct profiler_counter_t * c = &__profiler_counter[event];
+
+	c->counter = counter;
+	cpu_profiler_start(event, counter);
+	c->base = cpu_profiler_read(event, counter);
+	c->trunning = now;
+}
+
+static void counter_sched_out(int event, uint64_t now)
+{
+	struct profiler_counter_t * c = &__profiler_counter[event];
+
+	if(c->counter != -2)
+	{
+		c->value += cpu_profiler_read(event, c->counter) - c->base;
+		c->running += now - c->trunning;
+		cpu_profiler_stop(event, c->counter);
+		c->counter = -2;
+	}
+}
+
+/*
+ * Assign the programmable counters to the active events, rotating the
+ * window on every call when there are more events than counters.
+ */
+static void counter_schedule(uint64_t now)
+{
+	int active[PROFILER_EVENT_MAX];
+	int slots = cpu_profiler_counters();
+	int n = 0, i;
+
+	for(i = PROFILER_EVENT_CYCLES + 1; i < PROFILER_EVENT_MAX; i++)
+	{
+		counter_sched_out(i, now);
+		if(__profiler_counter[i].users > 0)
+			active[n++] = i;
+	}
+	if(n > 0)
+	{
+		if(slots > n)
+			slots = n;
+		for(i = 0; i < slots; i++)
+			counter_sched_in(active[(__profiler_rotate + i) % n], i, now);
+	}
+	__profiler_multiplex = (n > slots) ? 1 : 0;
+}
+
+static uint64_t counter_read(int event, uint64_t now)
+{
+	struct profiler_counter_t * c = &__profiler_counter[event];
+	uint64_t count = c->value;
+	uint64_t running = c->running;
+	uint64_t enabled = c->enabled + now - c->tenabled;
+
+	if(c->counter != -2)
+	{
+		count += cpu_profiler_read(event, c->counter) - c->base;
+		running += now - c->trunning;
+	}
+	if((running == 0) || (running >= enabled))
+		return count;
+	return (uint64_t)((double)count * (double)enabled / (double)running);
+}
+
+static void counter_get(int event, uint64_t now)
+{
+	struct profiler_counter_t * c = &__profiler_counter[event];
+	int i;
+
+	if(c->users++ == 0)
+	{
+		for(i = PROFILER_EVENT_CYCLES; i < PROFILER_EVENT_MAX; i++)
+		{
+			if((i != event) && (__profiler_counter[i].users > 0))
+				break;
+		}
+		if(i >= PROFILER_EVENT_MAX)
+			cpu_profiler_reset();
+
+		c->counter = -2;
+		c->value = 0;
+		c->enabled = 0;
+		c->running = 0;
+		c->tenabled = now;
+		if(event == PROFILER_EVENT_CYCLES)
+			counter_sched_in(event, -1, now);
+		else
+			counter_schedule(now);
+	}
+}
+
+static void counter_put(int event, uint64_t now)
+{
+	struct profiler_counter_t * c = &__profiler_counter[event];
+
+	if(c->users > 0 && --c->users == 0)
+	{
+		counter_sched_out(event, now);
+		if(event != PROFILER_EVENT_CYCLES)
+			counter_schedule(now);
+	}
+}
+
+static int profiler_timer_function(struct timer_t * timer, void * data)
+{
+	irq_flags_t flags;
+	int multiplex;
+
+	spin_lock_irqsave(&__profiler_lock, flags);
+	__profiler_rotate++;
+	counter_schedule(ktime_to_ns(ktime_get()));
+	multiplex = __profiler_multiplex;
+	spin_unlock_irqrestore(&__profiler_lock, flags);
+
+	if(!multiplex)
+		return 0;
+	timer_forward_now(timer, ms_to_ktime(CONFIG_PROFILER_MULTIPLEX_INTERVAL));
+	return 1;
+}
+
+int profiler_event_lookup(const char * name)
+{
+	int i;
+
+	if(name)
+	{
+		for(i = 0; i < PROFILER_EVENT_MAX; i++)
+		{
+			if(strcmp(__profiler_event_name[i], name) == 0)
+				return i;
+		}
+	}
+	return -1;
+}
+
+const char * profiler_event_name(int event)
+{
+	if((event >= 0) && (event < PROFILER_EVENT_MAX))
+		return __profiler_event_name[event];
+	return "unknown";
+}
+
 struct profiler_t * profiler_search(const char * name)
 {
 	struct profiler_t * p;
@@ -76,22 +249,30 @@ struct profiler_t * profiler_search(const char * name)
 	return NULL;
 }
 
-void profiler_snap(const char * name, int event, int data)
+void profiler_snap(const char * name, int event)
 {
 	struct profiler_t * p;
 	irq_flags_t flags;
+	uint64_t now;
 	uint32_t index;
+	int multiplex;
+
+	if((event < 0) || (event >= PROFILER_EVENT_MAX))
+		return;
 
 	p = profiler_search(name);
 	if(p)
 	{
-		if(event == 0)
+		now = ktime_to_ns(ktime_get());
+		if(p->event == PROFILER_EVENT_TIME)
 		{
-			p->end = ktime_to_ns(ktime_get());
+			p->end = now;
 		}
 		else
 		{
-			p->end = cpu_profiler_read(p->event, p->data);
+			spin_lock_irqsave(&__profiler_lock, flags);
+			p->end = counter_read(p->event, now);
+			spin_unlock_irqrestore(&__profiler_lock, flags);
 		}
 		p->count++;
 	}
@@ -105,20 +286,24 @@ void profiler_snap(const char * name, int event, int data)
 		init_hlist_node(&p->node);
 		p->name = strdup(name);
 		p->event = event;
-		p->data = data;
-		if(event == 0)
+		p->count = 1;
+		now = ktime_to_ns(ktime_get());
+		spin_lock_irqsave(&__profiler_lock, flags);
+		if(event == PROFILER_EVENT_TIME)
 		{
-			p->end = p->begin = ktime_to_ns(ktime_get());
+			p->end = p->begin = now;
 		}
 		else
 		{
-			cpu_profiler_start(p->event, p->data);
-			p->end = p->begin = cpu_profiler_read(p->event, p->data);
+			counter_get(p->event, now);
+			p->end = p->begin = counter_read(p->event, now);
 		}
-		p->count = 1;
-		spin_lock_irqsave(&__profiler_lock, flags);
 		hlist_add_head(&p->node, &__profiler_hash[index]);
+		multiplex = __profiler_multiplex;
 		spin_unlock_irqrestore(&__profiler_lock, flags);
+
+		if(multiplex && (__profiler_timer.state == TIMER_STATE_INACTIVE))
+			timer_start_now(&__profiler_timer, ms_to_ktime(CONFIG_PROFILER_MULTIPLEX_INTERVAL));
 	}
 }
 
@@ -133,14 +318,7 @@ void profiler_dump(void)
 	{
 		hlist_for_each_entry_safe(p, n, &__profiler_hash[i], node)
 		{
-			if(p->event == 0)
-			{
-				printf("[%s] %lld, %lld, [%lld ~ %lld]\r\n", p->name, p->count, (p->end - p->begin) / ((p->count > 1) ? (p->count - 1) : 1), p->begin, p->end);
-			}
-			else
-			{
-				printf("[%s] %lld, %lld, [%lld ~ %lld]\r\n", p->name, p->count, (p->end - p->begin) / ((p->count > 1) ? (p->count - 1) : 1), p->begin, p->end);
-			}
+			printf("[%s] %s, %lld, %lld, [%lld ~ %lld]\r\n", p->name, profiler_event_name(p->event), p->count, (p->end - p->begin) / ((p->count > 1) ? (p->count - 1) : 1), p->begin, p->end);
 		}
 	}
 }
@@ -150,21 +328,26 @@ void profiler_reset(void)
 	struct profiler_t * p;
 	struct hlist_node * n;
 	irq_flags_t flags;
+	uint64_t now;
 	int i;
 
+	timer_cancel(&__profiler_timer);
 	for(i = 0; i < ARRAY_SIZE(__profiler_hash); i++)
 	{
 		hlist_for_each_entry_safe(p, n, &__profiler_hash[i], node)
 		{
+			now = ktime_to_ns(ktime_get());
 			spin_lock_irqsave(&__profiler_lock, flags);
 			hlist_del(&p->node);
-			if(p->event != 0)
-				cpu_profiler_stop(p->event, p->data);
+			if(p->event != PROFILER_EVENT_TIME)
+				counter_put(p->event, now);
 			free(p->name);
 			free(p);
 			spin_unlock_irqrestore(&__profiler_lock, flags);
 		}
 	}
+	__profiler_rotate = 0;
+	__profiler_multiplex = 0;
 	cpu_profiler_reset();
 }
 
@@ -174,5 +357,8 @@ static __init void profiler_pure_init(void)
 
 	for(i = 0; i < ARRAY_SIZE(__profiler_hash); i++)
 		init_hlist_head(&__profiler_hash[i]);
+	for(i = 0; i < PROFILER_EVENT_MAX; i++)
+		__profiler_counter[i].counter = -2;
+	timer_init(&__profiler_timer, profiler_timer_function, NULL);
 }
 pure_initcall(profiler_pure_init);
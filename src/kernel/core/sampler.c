@@ -0,0 +1,272 @@
+/*
+ * kernel/core/sampler.c
+ *
+ * Copyright(c) 2007-2017 Jianjun Jiang <8192542@qq.com>
+ * Official site: http://xboot.org
+ * Mobile phone: +86-18665388956
+ * QQ: 8192542
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <xboot.h>
+#include <interrupt/interrupt.h>
+#include <xboot/sampler.h>
+
+/*
+ * Samples are packed into one word buffer, a frame count word followed by
+ * the program counters with the interrupted one first.
+ */
+struct sampler_t
+{
+	struct timer_t timer;
+	virtual_addr_t * buffer;
+	int used;
+	int samples;
+	int dropped;
+	int missed;
+	int running;
+	int interval;
+	int depth;
+};
+
+struct sampler_entry_t
+{
+	virtual_addr_t addr;
+	int self;
+	int total;
+	int mark;
+};
+
+static struct sampler_t __sampler = { 0 };
+static spinlock_t __sampler_lock = SPIN_LOCK_INIT();
+
+static int __cpu_sampler_backtrace(void * regs, virtual_addr_t * pc, int depth)
+{
+	return 0;
+}
+extern __typeof(__cpu_sampler_backtrace) cpu_sampler_backtrace __attribute__((weak, alias("__cpu_sampler_backtrace")));
+
+static int sampler_timer_function(struct timer_t * timer, void * data)
+{
+	struct sampler_t * s = (struct sampler_t *)data;
+	virtual_addr_t pc[CONFIG_SAMPLER_MAX_DEPTH];
+	void * regs = interrupt_get_regs();
+	int n;
+
+	if(!s->running)
+		return 0;
+
+	n = regs ? cpu_sampler_backtrace(regs, pc, s->depth) : 0;
+	if(n <= 0)
+	{
+		s->missed++;
+	}
+	else if(s->used + n + 1 > CONFIG_SAMPLER_BUFFER_SIZE)
+	{
+		s->dropped++;
+	}
+	else
+	{
+		s->buffer[s->used] = n;
+		memcpy(&s->buffer[s->used + 1], pc, n * sizeof(virtual_addr_t));
+		s->used += n + 1;
+		s->samples++;
+	}
+	timer_forward_now(timer, ns_to_ktime(s->interval));
+	return 1;
+}
+
+static inline virtual_addr_t sampler_symbol(virtual_addr_t addr)
+{
+	virtual_addr_t offset;
+
+	if(kallsyms_lookup(addr, &offset))
+		return addr - offset;
+	return addr;
+}
+
+static int sampler_entry_cmp(const void * a, const void * b)
+{
+	const struct sampler_entry_t * ea = a;
+	const struct sampler_entry_t * eb = b;
+
+	if(ea->self != eb->self)
+		return eb->self - ea->self;
+	return eb->total - ea->total;
+}
+
+bool_t sampler_start(int rate, int depth)
+{
+	irq_flags_t flags;
+
+	if(__sampler.running || (rate <= 0) || (rate > 100000))
+		return FALSE;
+	if(depth < 1)
+		depth = 1;
+	else if(depth > CONFIG_SAMPLER_MAX_DEPTH)
+		depth = CONFIG_SAMPLER_MAX_DEPTH;
+
+	if(!__sampler.buffer)
+	{
+		__sampler.buffer = malloc(CONFIG_SAMPLER_BUFFER_SIZE * sizeof(virtual_addr_t));
+		if(!__sampler.buffer)
+			return FALSE;
+	}
+
+	spin_lock_irqsave(&__sampler_lock, flags);
+	__sampler.interval = 1000000000 / rate;
+	__sampler.depth = depth;
+	__sampler.running = 1;
+	spin_unlock_irqrestore(&__sampler_lock, flags);
+
+	timer_init(&__sampler.timer, sampler_timer_function, &__sampler);
+	timer_start_now(&__sampler.timer, ns_to_ktime(__sampler.interval));
+	return TRUE;
+}
+
+void sampler_stop(void)
+{
+	if(__sampler.running)
+	{
+		__sampler.running = 0;
+		timer_cancel(&__sampler.timer);
+	}
+}
+
+void sampler_reset(void)
+{
+	irq_flags_t flags;
+
+	sampler_stop();
+	spin_lock_irqsave(&__sampler_lock, flags);
+	__sampler.used = 0;
+	__sampler.samples = 0;
+	__sampler.dropped = 0;
+	__sampler.missed = 0;
+	spin_unlock_irqrestore(&__sampler_lock, flags);
+	if(__sampler.buffer)
+	{
+		free(__sampler.buffer);
+		__sampler.buffer = NULL;
+	}
+}
+
+int sampler_samples(void)
+{
+	return __sampler.samples;
+}
+
+void sampler_report(int top)
+{
+	struct sampler_entry_t * e, * t;
+	virtual_addr_t addr;
+	char sym[128];
+	int size, used, samples;
+	int i, j, k, n, h, count = 0;
+
+	used = __sampler.used;
+	samples = __sampler.samples;
+	printf("Sampler report: %d samples, %d dropped, %d missed\r\n", samples, __sampler.dropped, __sampler.missed);
+	if(samples <= 0)
+		return;
+
+	for(size = 64; size < used * 2; size <<= 1);
+	e = calloc(size, sizeof(struct sampler_entry_t));
+	if(!e)
+		return;
+
+	for(i = 0, k = 1; i < used; i += n + 1, k++)
+	{
+		n = __sampler.buffer[i];
+		for(j = 0; j < n; j++)
+		{
+			addr = sampler_symbol(__sampler.buffer[i + 1 + j]);
+			for(h = (addr >> 2) & (size - 1); e[h].total && (e[h].addr != addr); h = (h + 1) & (size - 1));
+			if(!e[h].total)
+				count++;
+			e[h].addr = addr;
+			if(j == 0)
+				e[h].self++;
+			if(e[h].mark != k)
+			{
+				e[h].mark = k;
+				e[h].total++;
+			}
+		}
+	}
+
+	t = malloc(count * sizeof(struct sampler_entry_t));
+	if(t)
+	{
+		for(i = 0, j = 0; i < size; i++)
+		{
+			if(e[i].total)
+				t[j++] = e[i];
+		}
+		qsort(t, count, sizeof(struct sampler_entry_t), sampler_entry_cmp);
+
+		if((top <= 0) || (top > count))
+			top = count;
+		printf("%8s %8s %8s  %s\r\n", "self", "total", "samples", "symbol");
+		for(i = 0; i < top; i++)
+		{
+			kallsyms_snprint(sym, sizeof(sym), t[i].addr);
+			printf("%7d%% %7d%% %8d  %s\r\n", t[i].self * 100 / samples, t[i].total * 100 / samples, t[i].self, sym);
+		}
+		free(t);
+	}
+	free(e);
+}
+
+bool_t sampler_folded(const char * filename)
+{
+	virtual_addr_t offset;
+	const char * name;
+	char buf[128];
+	int used, i, j, n, l;
+	int fd;
+
+	if(!filename)
+		return FALSE;
+
+	fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, (S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH));
+	if(fd < 0)
+		return FALSE;
+
+	used = __sampler.used;
+	for(i = 0; i < used; i += n + 1)
+	{
+		n = __sampler.buffer[i];
+		for(j = n - 1; j >= 0; j--)
+		{
+			name = kallsyms_lookup(__sampler.buffer[i + 1 + j], &offset);
+			if(name)
+				l = snprintf(buf, sizeof(buf), "%s%s", name, j ? ";" : " 1\n");
+			else
+				l = snprintf(buf, sizeof(buf), "0x%lx%s", (unsigned long)__sampler.buffer[i + 1 + j], j ? ";" : " 1\n");
+			if(l >= sizeof(buf))
+				l = sizeof(buf) - 1;
+			if(write(fd, buf, l) != l)
+			{
+				close(fd);
+				return FALSE;
+			}
+		}
+	}
+	close(fd);
+	return TRUE;
+}
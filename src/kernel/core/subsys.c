@@ -49,31 +49,48 @@ static void subsys_init_rootfs(void)
 	mkdir("/private/userdata", S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
 }
 
+static int subsys_read_file(const char * path, char * buf, int size)
+{
+	int fd, n, len = 0;
+
+	if((fd = open(path, O_RDONLY, (S_IRUSR | S_IRGRP | S_IROTH))) < 0)
+		return -1;
+	while(len < size)
+	{
+		n = read(fd, (void *)(buf + len), size - len);
+		if(n <= 0)
+			break;
+		len += n;
+	}
+	close(fd);
+	return len;
+}
+
+/*
+ * The binary device tree is only used when it was generated from the json
+ * it sits next to, a stale one falls back to parsing the json
+ */
 static void subsys_init_dt(void)
 {
 	char path[64];
-	char * json;
-	int fd, n, len = 0;
+	char * json, * xdt;
+	int len, xlen;
 
 	json = malloc(SZ_1M);
-	if(!json)
-		return;
-
-	sprintf(path, "/boot/%s.json", get_machine()->name);
-	if((fd = open(path, O_RDONLY, (S_IRUSR | S_IRGRP | S_IROTH))) > 0)
+	xdt = malloc(SZ_1M);
+	if(json && xdt)
 	{
-	    for(;;)
-	    {
-	        n = read(fd, (void *)(json + len), SZ_512K);
-	        if(n <= 0)
-	        	break;
-			len += n;
-	    }
-	    close(fd);
-	    probe_device(json, len);
+		sprintf(path, "/boot/%s.json", get_machine()->name);
+		len = subsys_read_file(path, json, SZ_1M);
+		sprintf(path, "/boot/%s.xdt", get_machine()->name);
+		xlen = subsys_read_file(path, xdt, SZ_1M);
+		if((xlen > 0) && ((len < 0) || dt_binary_match(xdt, xlen, json, len)))
+			probe_device(xdt, xlen);
+		else if(len > 0)
+			probe_device(json, len);
 	}
-
 	free(json);
+	free(xdt);
 }
 
 static __init void subsys_init(void)
@@ -148,6 +148,19 @@ static s32_t arfs_read(struct vnode_t * node, struct file_t * fp, void * buf, lo
 	return 0;
 }
 
+static s32_t arfs_mmap(struct vnode_t * node, struct file_t * fp, void ** addr)
+{
+	struct block_t * dev = (struct block_t *)node->v_mount->m_dev;
+	loff_t off;
+
+	off = (loff_t)((s32_t)(node->v_data));
+	*addr = block_mmap(dev, off, node->v_size);
+	if(!*addr)
+		return EOPNOTSUPP;
+
+	return 0;
+}
+
 static s32_t arfs_write(struct vnode_t * node , struct file_t * fp, void * buf, loff_t size, loff_t * result)
 {
 	return -1;
@@ -329,6 +342,7 @@ static struct vnops_t arfs_vnops = {
 	.vop_setattr	= arfs_setattr,
 	.vop_inactive	= arfs_inactive,
 	.vop_truncate	= arfs_truncate,
+	.vop_mmap		= arfs_mmap,
 };
 
 /*
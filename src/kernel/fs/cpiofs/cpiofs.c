@@ -223,6 +223,19 @@ static s32_t cpiofs_read(struct vnode_t * node, struct file_t * fp, void * buf,
 	return 0;
 }
 
+static s32_t cpiofs_mmap(struct vnode_t * node, struct file_t * fp, void ** addr)
+{
+	struct block_t * dev = (struct block_t *)node->v_mount->m_dev;
+	loff_t off;
+
+	off = (loff_t)((s32_t)(node->v_data));
+	*addr = block_mmap(dev, off, node->v_size);
+	if(!*addr)
+		return EOPNOTSUPP;
+
+	return 0;
+}
+
 static s32_t cpiofs_write(struct vnode_t * node , struct file_t * fp, void * buf, loff_t size, loff_t * result)
 {
 	return -1;
@@ -468,6 +481,7 @@ static struct vnops_t cpiofs_vnops = {
 	.vop_setattr	= cpiofs_setattr,
 	.vop_inactive	= cpiofs_inactive,
 	.vop_truncate	= cpiofs_truncate,
+	.vop_mmap		= cpiofs_mmap,
 };
 
 /*
@@ -171,6 +171,29 @@ int fstat(int fd, struct stat * st)
 	return sys_fstat(fp, st);
 }
 
+/*
+ * map a read only file, return NULL if it isn't directly addressable
+ */
+void * mmap(int fd, loff_t * len)
+{
+	struct file_t * fp;
+	void * addr;
+	loff_t l;
+
+	if(fd < 0)
+		return NULL;
+
+	if((fp = get_fp(fd)) == NULL)
+		return NULL;
+
+	if(sys_mmap(fp, &addr, &l) != 0)
+		return NULL;
+
+	if(len)
+		*len = l;
+	return addr;
+}
+
 /*
  * input and output control
  */
@@ -25,6 +25,58 @@
 #include <xboot.h>
 #include <fs/fs.h>
 
+/*
+ * Vnodes of recently looked up attributes are kept referenced, so the vfs
+ * finds them by their full path at once instead of walking the directories
+ * again on the next open. When a kobj has left its directory since, the
+ * cached vnodes are released and the kobj of any still in use is looked up
+ * again from its path.
+ */
+static struct vnode_t * __sysfs_cache[CONFIG_SYSFS_CACHE_SIZE];
+static int __sysfs_cache_index = 0;
+static u32_t __sysfs_cache_generation = 0;
+
+static void sysfs_cache_flush(void)
+{
+	struct vnode_t * vp;
+	int i;
+
+	for(i = 0; i < ARRAY_SIZE(__sysfs_cache); i++)
+	{
+		vp = __sysfs_cache[i];
+		if(vp)
+		{
+			__sysfs_cache[i] = NULL;
+			vp->v_data = (vcount(vp) > 1) ? kobj_lookup(vp->v_path) : NULL;
+			vrele(vp);
+		}
+	}
+	__sysfs_cache_index = 0;
+}
+
+static void sysfs_cache_check(void)
+{
+	u32_t generation = kobj_generation();
+
+	if(__sysfs_cache_generation != generation)
+	{
+		sysfs_cache_flush();
+		__sysfs_cache_generation = generation;
+	}
+}
+
+static void sysfs_cache_add(struct vnode_t * vp)
+{
+	struct vnode_t * old;
+
+	old = __sysfs_cache[__sysfs_cache_index];
+	vref(vp);
+	__sysfs_cache[__sysfs_cache_index] = vp;
+	__sysfs_cache_index = (__sysfs_cache_index + 1) % ARRAY_SIZE(__sysfs_cache);
+	if(old)
+		vrele(old);
+}
+
 static s32_t sysfs_mount(struct mount_t * m, char * dev, s32_t flag)
 {
 	if(dev != NULL)
@@ -39,6 +91,7 @@ static s32_t sysfs_mount(struct mount_t * m, char * dev, s32_t flag)
 
 static s32_t sysfs_unmount(struct mount_t * m)
 {
+	sysfs_cache_flush();
 	m->m_data = NULL;
 
 	return 0;
@@ -61,6 +114,9 @@ static s32_t sysfs_statfs(struct mount_t * m, struct statfs * stat)
 
 static s32_t sysfs_open(struct vnode_t * node, s32_t flag)
 {
+	sysfs_cache_check();
+	if(!node->v_data)
+		return ENOENT;
 	return 0;
 }
 
@@ -80,6 +136,7 @@ static s32_t sysfs_read(struct vnode_t * node, struct file_t * fp, void * buf, l
 	if(node->v_type != VREG)
 		return EINVAL;
 
+	sysfs_cache_check();
 	kobj = node->v_data;
 	if(fp->f_offset == 0)
 	{
@@ -103,6 +160,7 @@ static s32_t sysfs_write(struct vnode_t * node , struct file_t * fp, void * buf,
 	if(node->v_type != VREG)
 		return EINVAL;
 
+	sysfs_cache_check();
 	kobj = node->v_data;
 	if(fp->f_offset == 0)
 	{
@@ -182,6 +240,7 @@ static s32_t sysfs_lookup(struct vnode_t * dnode, char * name, struct vnode_t *
 	if(*name == '\0')
 		return ENOENT;
 
+	sysfs_cache_check();
 	kobj = dnode->v_data;
 	obj = kobj_search(kobj, name);
 	if(!obj)
@@ -203,6 +262,7 @@ static s32_t sysfs_lookup(struct vnode_t * dnode, char * name, struct vnode_t *
 			node->v_mode |= (S_IWUSR | S_IWGRP | S_IWOTH);
 		node->v_type = VREG;
 		node->v_size = 0;
+		sysfs_cache_add(node);
 	}
 
 	return 0;
@@ -273,6 +273,19 @@ static s32_t tarfs_read(struct vnode_t * node, struct file_t * fp, void * buf, l
 	return 0;
 }
 
+static s32_t tarfs_mmap(struct vnode_t * node, struct file_t * fp, void ** addr)
+{
+	struct block_t * dev = (struct block_t *)node->v_mount->m_dev;
+	loff_t off;
+
+	off = (loff_t)((s32_t)(node->v_data));
+	*addr = block_mmap(dev, off, node->v_size);
+	if(!*addr)
+		return EOPNOTSUPP;
+
+	return 0;
+}
+
 static s32_t tarfs_write(struct vnode_t * node , struct file_t * fp, void * buf, loff_t size, loff_t * result)
 {
 	return -1;
@@ -519,6 +532,7 @@ static struct vnops_t tarfs_vnops = {
 	.vop_setattr	= tarfs_setattr,
 	.vop_inactive	= tarfs_inactive,
 	.vop_truncate	= tarfs_truncate,
+	.vop_mmap		= tarfs_mmap,
 };
 
 /*
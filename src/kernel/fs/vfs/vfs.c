@@ -526,6 +526,31 @@ s32_t sys_fstat(struct file_t * fp, struct stat * st)
 	return err;
 }
 
+/*
+ * system mmap, direct address of a whole file stored contiguously
+ */
+s32_t sys_mmap(struct file_t * fp, void ** addr, loff_t * len)
+{
+	struct vnode_t * vp;
+	s32_t err;
+
+	if((fp->f_flags & O_RDONLY) == 0)
+		return EBADF;
+
+	vp = fp->f_vnode;
+	if(vp->v_type != VREG)
+		return EINVAL;
+
+	if(!vp->v_op->vop_mmap)
+		return EOPNOTSUPP;
+
+	err = vp->v_op->vop_mmap(vp, fp, addr);
+	if(err == 0)
+		*len = vp->v_size;
+
+	return err;
+}
+
 /*
  * system opendir
  */
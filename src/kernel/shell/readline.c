@@ -24,6 +24,7 @@
 
 #include <xboot.h>
 #include <shell/readline.h>
+#include <audio/mixer.h>
 
 enum esc_state_t {
 	ESC_STATE_NORMAL,
@@ -643,6 +644,10 @@ char * readline(const char * prompt)
 				break;
 			}
 		}
+		else
+		{
+			mixer_prefetch(&__audio_mixer);
+		}
 	}
 
 	if(rl->len > 0)
@@ -233,6 +233,18 @@ static s64_t dir_length(void * f)
 	return 0;
 }
 
+static void * dir_mmap(void * f, s64_t * size)
+{
+	struct fhandle_dir_t * fh = (struct fhandle_dir_t *)f;
+	loff_t len;
+	void * p;
+
+	p = mmap(fh->fd, &len);
+	if(p && size)
+		*size = len;
+	return p;
+}
+
 static void dir_close(void * f)
 {
 	struct fhandle_dir_t * fh = (struct fhandle_dir_t *)f;
@@ -254,6 +266,7 @@ static struct xfs_archiver_t archiver_dir = {
 	.write		= dir_write,
 	.seek		= dir_seek,
 	.length		= dir_length,
+	.mmap		= dir_mmap,
 	.close		= dir_close,
 };
 
@@ -403,6 +403,20 @@ static s64_t tar_length(void * f)
 	return fh->size;
 }
 
+static void * tar_mmap(void * f, s64_t * size)
+{
+	struct fhandle_tar_t * fh = (struct fhandle_tar_t *)f;
+	loff_t len;
+	char * p;
+
+	p = mmap(fh->fd, &len);
+	if(!p || (fh->start + fh->size > len))
+		return NULL;
+	if(size)
+		*size = fh->size;
+	return (void *)(p + fh->start);
+}
+
 static void tar_close(void * f)
 {
 	struct fhandle_tar_t * fh = (struct fhandle_tar_t *)f;
@@ -423,6 +437,7 @@ static struct xfs_archiver_t archiver_tar = {
 	.write		= tar_write,
 	.seek		= tar_seek,
 	.length		= tar_length,
+	.mmap		= tar_mmap,
 	.close		= tar_close,
 };
 
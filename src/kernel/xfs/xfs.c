@@ -338,6 +338,13 @@ s64_t xfs_length(struct xfs_file_t * file)
 	return 0;
 }
 
+void * xfs_mmap(struct xfs_file_t * file, s64_t * size)
+{
+	if(file && file->path->archiver->mmap)
+		return file->path->archiver->mmap(file->fhandle, size);
+	return NULL;
+}
+
 void xfs_close(struct xfs_file_t * file)
 {
 	if(file)
@@ -479,6 +479,39 @@ static void aes128_decrypt(struct aes128_ctx_t * ctx, uint8_t * in, uint8_t * ou
 	memcpy(out, state, sizeof(state));
 }
 
+/*
+ * Architecture hooks, both take the expanded encryption key, may work in
+ * place and return the number of blocks they handled, zero when the cpu has
+ * no aes instructions
+ */
+static int __cpu_aes128_encrypt(const uint8_t * xkey, const uint8_t * in, uint8_t * out, int blks)
+{
+	return 0;
+}
+extern __typeof(__cpu_aes128_encrypt) cpu_aes128_encrypt __attribute__((weak, alias("__cpu_aes128_encrypt")));
+
+static int __cpu_aes128_decrypt(const uint8_t * xkey, const uint8_t * in, uint8_t * out, int blks)
+{
+	return 0;
+}
+extern __typeof(__cpu_aes128_decrypt) cpu_aes128_decrypt __attribute__((weak, alias("__cpu_aes128_decrypt")));
+
+static void aes128_encrypt_blocks(struct aes128_ctx_t * ctx, uint8_t * in, uint8_t * out, int blks)
+{
+	int n = cpu_aes128_encrypt(ctx->xkey, in, out, blks);
+
+	for(in += n * 16, out += n * 16; n < blks; n++, in += 16, out += 16)
+		aes128_encrypt(ctx, in, out);
+}
+
+static void aes128_decrypt_blocks(struct aes128_ctx_t * ctx, uint8_t * in, uint8_t * out, int blks)
+{
+	int n = cpu_aes128_decrypt(ctx->xkey, in, out, blks);
+
+	for(in += n * 16, out += n * 16; n < blks; n++, in += 16, out += 16)
+		aes128_decrypt(ctx, in, out);
+}
+
 void aes128_set_key(struct aes128_ctx_t * ctx, uint8_t * key)
 {
 	static const uint8_t rcon[11] = { 0x00, 0x01, 0x02, 0x04, 0x08,
@@ -512,26 +545,14 @@ void aes128_set_key(struct aes128_ctx_t * ctx, uint8_t * key)
 
 void aes128_ecb_encrypt(struct aes128_ctx_t * ctx, uint8_t * in, uint8_t * out, int blks)
 {
-	int i;
-
-	for(i = 0; i < blks; i++)
-	{
-		aes128_encrypt(ctx, in, out);
-		in  += 16;
-		out += 16;
-	}
+	if(blks > 0)
+		aes128_encrypt_blocks(ctx, in, out, blks);
 }
 
 void aes128_ecb_decrypt(struct aes128_ctx_t * ctx, uint8_t * in, uint8_t * out, int blks)
 {
-	int i;
-
-	for(i = 0; i < blks; i++)
-	{
-		aes128_decrypt(ctx, in, out);
-		in  += 16;
-		out += 16;
-	}
+	if(blks > 0)
+		aes128_decrypt_blocks(ctx, in, out, blks);
 }
 
 void aes128_cbc_encrypt(struct aes128_ctx_t * ctx, uint8_t * iv, uint8_t * in, uint8_t * out, int blks)
@@ -544,29 +565,37 @@ void aes128_cbc_encrypt(struct aes128_ctx_t * ctx, uint8_t * iv, uint8_t * in, u
 	for(i = 0; i < blks; i++)
 	{
 		xor_block(tmp, chain, in, 16);
-		aes128_encrypt(ctx, tmp, out);
+		aes128_encrypt_blocks(ctx, tmp, out, 1);
 		memcpy(chain, out, 16);
 		in  += 16;
 		out += 16;
 	}
 }
 
+/*
+ * Decryption has no chain dependency, up to eight blocks go to the cipher at
+ * once and are xored back to front so the output may be the input
+ */
 void aes128_cbc_decrypt(struct aes128_ctx_t * ctx, uint8_t * iv, uint8_t * in, uint8_t * out, int blks)
 {
 	uint8_t chain[16];
-	uint8_t block[16];
-	uint8_t tmp[16];
-	int i;
+	uint8_t next[16];
+	uint8_t tmp[16 * 8];
+	int n, i;
 
 	memcpy(chain, iv, 16);
-	for(i = 0; i < blks; i++)
+	while(blks > 0)
 	{
-		memcpy(block, in, 16);
-		aes128_decrypt(ctx, in, tmp);
-		xor_block(out, chain, tmp, 16);
-		memcpy(chain, block, 16);
-		in  += 16;
-		out += 16;
+		n = blks > 8 ? 8 : blks;
+		aes128_decrypt_blocks(ctx, in, tmp, n);
+		memcpy(next, in + (n - 1) * 16, 16);
+		for(i = n - 1; i > 0; i--)
+			xor_block(out + i * 16, tmp + i * 16, in + (i - 1) * 16, 16);
+		xor_block(out, tmp, chain, 16);
+		memcpy(chain, next, 16);
+		in  += n * 16;
+		out += n * 16;
+		blks -= n;
 	}
 }
 
@@ -585,9 +614,9 @@ static inline void add_counter(uint8_t * counter)
 void aes128_ctr_encrypt(struct aes128_ctx_t * ctx, uint64_t offset, uint8_t * in, uint8_t * out, int bytes)
 {
 	uint8_t counter[16];
-	uint8_t tmp[16];
+	uint8_t stream[16 * 8];
 	uint64_t o = offset / 16;
-	int pos, len;
+	int pos, len, n;
 	int i;
 
 	for(i = 0; i < 8; i++)
@@ -599,26 +628,25 @@ void aes128_ctr_encrypt(struct aes128_ctx_t * ctx, uint64_t offset, uint8_t * in
 	}
 
 	pos = (offset & 0x0f);
-	if(pos)
+	while(bytes > 0)
 	{
-		len = 16 - pos;
-		bytes -= len;
-		aes128_encrypt(ctx, counter, tmp);
-		xor_block(out, in, &tmp[pos], len);
+		n = (pos + bytes + 15) / 16;
+		if(n > 8)
+			n = 8;
+		for(i = 0; i < n; i++)
+		{
+			memcpy(&stream[i * 16], counter, 16);
+			add_counter(counter);
+		}
+		aes128_encrypt_blocks(ctx, stream, stream, n);
+		len = n * 16 - pos;
+		if(len > bytes)
+			len = bytes;
+		xor_block(out, in, &stream[pos], len);
 		in  += len;
 		out += len;
-		add_counter(counter);
-	}
-
-	while(bytes)
-	{
-		len = bytes > 16 ? 16 : bytes;
 		bytes -= len;
-		aes128_encrypt(ctx, counter, tmp);
-		xor_block(out, in, tmp, len);
-		in  += len;
-		out += len;
-		add_counter(counter);
+		pos = 0;
 	}
 }
 
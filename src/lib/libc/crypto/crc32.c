@@ -71,29 +71,75 @@ static const uint32_t crc32_table[256] = {
 	0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d,
 };
 
+/*
+ * Slicing by eight tables, crc32_slice[k][i] is the crc of byte i followed
+ * by k zero bytes. They are built from crc32_table on first use.
+ */
+static uint32_t crc32_slice[8][256];
+static volatile int crc32_slice_ready = 0;
+
+static void crc32_slice_init(void)
+{
+	uint32_t c;
+	int i, k;
+
+	for(i = 0; i < 256; i++)
+	{
+		c = crc32_table[i];
+		crc32_slice[0][i] = c;
+		for(k = 1; k < 8; k++)
+		{
+			c = crc32_table[c & 0xff] ^ (c >> 8);
+			crc32_slice[k][i] = c;
+		}
+	}
+	crc32_slice_ready = 1;
+}
+
+/*
+ * Architecture hook, works on the uninverted crc and returns the number of
+ * bytes it consumed from the head of the buffer, zero when the cpu has no
+ * crc instructions
+ */
+static int __cpu_crc32_sum(uint32_t * crc, const uint8_t * buf, int len)
+{
+	return 0;
+}
+extern __typeof(__cpu_crc32_sum) cpu_crc32_sum __attribute__((weak, alias("__cpu_crc32_sum")));
+
 uint32_t crc32_sum(uint32_t crc, const uint8_t * buf, int len)
 {
+	uint32_t a, b;
+	int n;
+
 	crc = crc ^ 0xffffffff;
 
-	while(len >= 8)
+	if(len >= 64)
 	{
-		crc = crc32_table[((int)crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
-		crc = crc32_table[((int)crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
-		crc = crc32_table[((int)crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
-		crc = crc32_table[((int)crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
-		crc = crc32_table[((int)crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
-		crc = crc32_table[((int)crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
-		crc = crc32_table[((int)crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
-		crc = crc32_table[((int)crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
-		len -= 8;
+		n = cpu_crc32_sum(&crc, buf, len);
+		buf += n;
+		len -= n;
 	}
 
-	if(len)
+	if(len >= 16)
 	{
-		do {
-			crc = crc32_table[((int)crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
-		} while(--len);
+		if(!crc32_slice_ready)
+			crc32_slice_init();
+		while(len >= 8)
+		{
+			a = crc ^ (buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t)buf[3] << 24));
+			b = buf[4] | (buf[5] << 8) | (buf[6] << 16) | ((uint32_t)buf[7] << 24);
+			crc = crc32_slice[7][a & 0xff] ^ crc32_slice[6][(a >> 8) & 0xff]
+				^ crc32_slice[5][(a >> 16) & 0xff] ^ crc32_slice[4][a >> 24]
+				^ crc32_slice[3][b & 0xff] ^ crc32_slice[2][(b >> 8) & 0xff]
+				^ crc32_slice[1][(b >> 16) & 0xff] ^ crc32_slice[0][b >> 24];
+			buf += 8;
+			len -= 8;
+		}
 	}
 
+	while(len-- > 0)
+		crc = crc32_table[(crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
+
 	return crc ^ 0xffffffff;
 }
@@ -27,11 +27,10 @@ static const uint32_t K[64] =
 	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
-static void sha256_transform(struct sha256_ctx_t * ctx)
+static void sha256_transform(uint32_t * state, const uint8_t * p)
 {
 	uint32_t W[64];
 	uint32_t A, B, C, D, E, F, G, H;
-	uint8_t * p = ctx->buf;
 	int t;
 
 	for(t = 0; t < 16; ++t)
@@ -50,14 +49,14 @@ static void sha256_transform(struct sha256_ctx_t * ctx)
 		W[t] = W[t-16] + s0 + W[t-7] + s1;
 	}
 
-	A = ctx->state[0];
-	B = ctx->state[1];
-	C = ctx->state[2];
-	D = ctx->state[3];
-	E = ctx->state[4];
-	F = ctx->state[5];
-	G = ctx->state[6];
-	H = ctx->state[7];
+	A = state[0];
+	B = state[1];
+	C = state[2];
+	D = state[3];
+	E = state[4];
+	F = state[5];
+	G = state[6];
+	H = state[7];
 
 	for(t = 0; t < 64; t++)
 	{
@@ -78,14 +77,14 @@ static void sha256_transform(struct sha256_ctx_t * ctx)
 		A = t1 + t2;
 	}
 
-	ctx->state[0] += A;
-	ctx->state[1] += B;
-	ctx->state[2] += C;
-	ctx->state[3] += D;
-	ctx->state[4] += E;
-	ctx->state[5] += F;
-	ctx->state[6] += G;
-	ctx->state[7] += H;
+	state[0] += A;
+	state[1] += B;
+	state[2] += C;
+	state[3] += D;
+	state[4] += E;
+	state[5] += F;
+	state[6] += G;
+	state[7] += H;
 }
 
 void sha256_init(struct sha256_ctx_t * ctx)
@@ -101,21 +100,61 @@ void sha256_init(struct sha256_ctx_t * ctx)
     ctx->count = 0;
 }
 
+/*
+ * Architecture hook, returns the number of 64 bytes blocks it hashed into
+ * the state, zero when the cpu has no sha2 instructions
+ */
+static int __cpu_sha256_transform(uint32_t * state, const uint8_t * data, int blocks)
+{
+	return 0;
+}
+extern __typeof(__cpu_sha256_transform) cpu_sha256_transform __attribute__((weak, alias("__cpu_sha256_transform")));
+
+static void sha256_blocks(uint32_t * state, const uint8_t * data, int blocks)
+{
+	int n = cpu_sha256_transform(state, data, blocks);
+
+	for(data += n * 64; n < blocks; n++, data += 64)
+		sha256_transform(state, data);
+}
+
 void sha256_update(struct sha256_ctx_t * ctx, const void * data, int len)
 {
 	int i = (int)(ctx->count & 63);
 	const uint8_t * p = (const uint8_t *)data;
+	int n;
 
+	if(len <= 0)
+		return;
 	ctx->count += len;
-	while(len--)
+
+	if(i)
 	{
-		ctx->buf[i++] = *p++;
-		if(i == 64)
+		n = 64 - i;
+		if(len < n)
 		{
-			sha256_transform(ctx);
-			i = 0;
+			memcpy(&ctx->buf[i], p, len);
+			return;
 		}
+		memcpy(&ctx->buf[i], p, n);
+		sha256_blocks(ctx->state, ctx->buf, 1);
+		p += n;
+		len -= n;
 	}
+
+	/*
+	 * Whole blocks are hashed straight from the caller's buffer
+	 */
+	if(len >= 64)
+	{
+		n = len >> 6;
+		sha256_blocks(ctx->state, p, n);
+		p += n << 6;
+		len &= 63;
+	}
+
+	if(len)
+		memcpy(ctx->buf, p, len);
 }
 
 const uint8_t * sha256_final(struct sha256_ctx_t * ctx)
@@ -3,20 +3,23 @@
  */
 
 #include <malloc.h>
+#include <console/console.h>
 #include <stdio.h>
 
+/*
+ * Stdout always ends at the console, whatever stdio still buffers goes
+ * first and the formatted output is then queued into the console ring
+ */
 int printf(const char * fmt, ...)
 {
 	va_list ap;
-	char buf[SZ_4K];
 	int rv;
 
+	fflush(stdout);
 	va_start(ap, fmt);
-	rv = vsnprintf(buf, SZ_4K, fmt, ap);
+	rv = console_stdout_vprintf(fmt, ap);
 	va_end(ap);
 
-	rv = (fputs(buf, stdout) < 0) ? 0 : rv;
-	fflush(stdout);
-	return rv;
+	return (rv < 0) ? 0 : rv;
 }
 EXPORT_SYMBOL(printf);
@@ -5,12 +5,30 @@
 #include <types.h>
 #include <string.h>
 
+typedef unsigned long __attribute__((__may_alias__)) word_t;
+
+#define WSIZE		(sizeof(word_t))
+#define WMASK		(WSIZE - 1)
+
 static int __memcmp(const void * s1, const void * s2, size_t n)
 {
-	const unsigned char *su1, *su2;
+	const unsigned char *su1 = s1, *su2 = s2;
 	int res = 0;
 
-	for (su1 = s1, su2 = s2; 0 < n; ++su1, ++su2, n--)
+	/*
+	 * Equal words are skipped, the first differing word is resolved by bytes
+	 */
+	if((((uintptr_t)su1 ^ (uintptr_t)su2) & WMASK) == 0)
+	{
+		for(; ((uintptr_t)su1 & WMASK) && n; ++su1, ++su2, n--)
+			if ((res = *su1 - *su2) != 0)
+				return res;
+		for(; n >= WSIZE; su1 += WSIZE, su2 += WSIZE, n -= WSIZE)
+			if (*(const word_t *)su1 != *(const word_t *)su2)
+				break;
+	}
+
+	for (; 0 < n; ++su1, ++su2, n--)
 		if ((res = *su1 - *su2) != 0)
 			break;
 	return res;
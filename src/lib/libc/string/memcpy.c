@@ -5,11 +5,35 @@
 #include <types.h>
 #include <string.h>
 
+typedef unsigned long __attribute__((__may_alias__)) word_t;
+
+#define WSIZE		(sizeof(word_t))
+#define WMASK		(WSIZE - 1)
+
 static void * __memcpy(void * dest, const void * src, size_t len)
 {
 	char * tmp = dest;
 	const char * s = src;
 
+	/*
+	 * Words are copied when both buffers can be aligned together, mismatched
+	 * buffers stay on bytes as an unaligned access may fault
+	 */
+	if((((uintptr_t)tmp ^ (uintptr_t)s) & WMASK) == 0)
+	{
+		for(; ((uintptr_t)tmp & WMASK) && len; len--)
+			*tmp++ = *s++;
+		for(; len >= WSIZE * 4; len -= WSIZE * 4, tmp += WSIZE * 4, s += WSIZE * 4)
+		{
+			((word_t *)tmp)[0] = ((const word_t *)s)[0];
+			((word_t *)tmp)[1] = ((const word_t *)s)[1];
+			((word_t *)tmp)[2] = ((const word_t *)s)[2];
+			((word_t *)tmp)[3] = ((const word_t *)s)[3];
+		}
+		for(; len >= WSIZE; len -= WSIZE, tmp += WSIZE, s += WSIZE)
+			*(word_t *)tmp = *(const word_t *)s;
+	}
+
 	while (len--)
 		*tmp++ = *s++;
 	return dest;
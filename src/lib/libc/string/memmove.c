@@ -5,15 +5,30 @@
 #include <types.h>
 #include <string.h>
 
+typedef unsigned long __attribute__((__may_alias__)) word_t;
+
+#define WSIZE		(sizeof(word_t))
+#define WMASK		(WSIZE - 1)
+
 static void * __memmove(void * dest, const void * src, size_t n)
 {
 	char * tmp;
 	const char * s;
 
-	if (dest <= src)
+	if (dest == src)
+		return dest;
+
+	if (dest < src)
 	{
 		tmp = dest;
 		s = src;
+		if((((uintptr_t)tmp ^ (uintptr_t)s) & WMASK) == 0)
+		{
+			for(; ((uintptr_t)tmp & WMASK) && n; n--)
+				*tmp++ = *s++;
+			for(; n >= WSIZE; n -= WSIZE, tmp += WSIZE, s += WSIZE)
+				*(word_t *)tmp = *(const word_t *)s;
+		}
 		while (n--)
 			*tmp++ = *s++;
 	}
@@ -23,6 +38,17 @@ static void * __memmove(void * dest, const void * src, size_t n)
 		tmp += n;
 		s = src;
 		s += n;
+		if((((uintptr_t)tmp ^ (uintptr_t)s) & WMASK) == 0)
+		{
+			for(; ((uintptr_t)tmp & WMASK) && n; n--)
+				*--tmp = *--s;
+			for(; n >= WSIZE; n -= WSIZE)
+			{
+				tmp -= WSIZE;
+				s -= WSIZE;
+				*(word_t *)tmp = *(const word_t *)s;
+			}
+		}
 		while (n--)
 			*--tmp = *--s;
 	}
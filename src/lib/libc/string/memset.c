@@ -5,9 +5,39 @@
 #include <types.h>
 #include <string.h>
 
+typedef unsigned long __attribute__((__may_alias__)) word_t;
+
+#define WSIZE		(sizeof(word_t))
+#define WMASK		(WSIZE - 1)
+
 static void * __memset(void * s, int c, size_t n)
 {
-	char * xs = s;
+	unsigned char * xs = s;
+	word_t w = (unsigned char)c;
+
+	/*
+	 * Only aligned words are stored, early boot runs this with the mmu off
+	 * where an unaligned access faults
+	 */
+	for(; ((uintptr_t)xs & WMASK) && n; n--)
+		*xs++ = c;
+
+	if(n >= WSIZE)
+	{
+		w |= w << 8;
+		w |= w << 16;
+		if(WSIZE > 4)
+			w |= (w << 16) << 16;
+		for(; n >= WSIZE * 4; n -= WSIZE * 4, xs += WSIZE * 4)
+		{
+			((word_t *)xs)[0] = w;
+			((word_t *)xs)[1] = w;
+			((word_t *)xs)[2] = w;
+			((word_t *)xs)[3] = w;
+		}
+		for(; n >= WSIZE; n -= WSIZE, xs += WSIZE)
+			*(word_t *)xs = w;
+	}
 
 	while (n--)
 		*xs++ = c;
@@ -6,14 +6,41 @@
 #include <stddef.h>
 #include <string.h>
 
-/*
- * Finds the first occurrence of a byte in a string
- */
-char * strchr(const char * s, int c)
+typedef unsigned long __attribute__((__may_alias__)) word_t;
+
+#define WSIZE		(sizeof(word_t))
+#define WMASK		(WSIZE - 1)
+#define ONES		((word_t)-1 / 0xff)
+#define HIGHS		(ONES * 0x80)
+#define HASZERO(x)	(((x) - ONES) & ~(x) & HIGHS)
+
+static char * __strchr(const char * s, int c)
 {
-	for (; *s != (char)c; ++s)
+	const word_t * w;
+	word_t k;
+
+	for (; (uintptr_t)s & WMASK; ++s)
+	{
+		if (*s == (char)c)
+			return (char *)s;
+		if (*s == '\0')
+			return NULL;
+	}
+
+	/*
+	 * Skip words holding neither the terminator nor the byte
+	 */
+	k = ONES * (unsigned char)c;
+	for (w = (const word_t *)s; !HASZERO(*w) && !HASZERO(*w ^ k); w++);
+
+	for (s = (const char *)w; *s != (char)c; ++s)
 		if (*s == '\0')
 			return NULL;
 	return (char *)s;
 }
+
+/*
+ * Finds the first occurrence of a byte in a string
+ */
+extern __typeof(__strchr) strchr __attribute__((weak, alias("__strchr")));
 EXPORT_SYMBOL(strchr);
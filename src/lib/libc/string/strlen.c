@@ -5,14 +5,34 @@
 #include <types.h>
 #include <string.h>
 
-/*
- * Calculate the length of a string
- */
-size_t strlen(const char * s)
+typedef unsigned long __attribute__((__may_alias__)) word_t;
+
+#define WSIZE		(sizeof(word_t))
+#define WMASK		(WSIZE - 1)
+#define ONES		((word_t)-1 / 0xff)
+#define HIGHS		(ONES * 0x80)
+#define HASZERO(x)	(((x) - ONES) & ~(x) & HIGHS)
+
+static size_t __strlen(const char * s)
 {
-	const char * sc;
+	const char * sc = s;
+	const word_t * w;
 
-	for (sc = s; *sc != '\0'; ++sc);
+	for (; (uintptr_t)sc & WMASK; ++sc)
+		if (*sc == '\0')
+			return sc - s;
+
+	/*
+	 * An aligned word never crosses a page, reading past the terminator
+	 * within the last word is safe
+	 */
+	for (w = (const word_t *)sc; !HASZERO(*w); w++);
+	for (sc = (const char *)w; *sc != '\0'; ++sc);
 	return sc - s;
 }
+
+/*
+ * Calculate the length of a string
+ */
+extern __typeof(__strlen) strlen __attribute__((weak, alias("__strlen")));
 EXPORT_SYMBOL(strlen);
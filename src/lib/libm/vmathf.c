@@ -0,0 +1,219 @@
+#include <stddef.h>
+#include <math.h>
+
+/*
+ * Batched and approximate single precision functions. The kernels work on
+ * four lanes with gcc vector extensions, which become sse2 on x64 and neon
+ * where the fpu has it, and plain scalar code elsewhere.
+ *
+ * Error bounds, measured against the double precision functions:
+ *   fast_sinf, fast_cosf, vsinf, vcosf, vsincosf
+ *     |x| <= 8192: absolute error below 1e-7
+ *   fast_exp2f, vexp2f
+ *     -126 <= x <= 127: relative error below 2.5e-7 (about 2 ulp)
+ *   fast_expf, vexpf
+ *     -87 <= x <= 88: relative error below 4e-6, growing with |x| as the
+ *     product x * log2(e) is rounded
+ *
+ * The array functions send lanes outside these ranges, nan and inf to the
+ * libm functions, the scalar fast variants do not. The output array may be
+ * the input array.
+ */
+
+typedef float vf4_t __attribute__((vector_size(16)));
+typedef int32_t vi4_t __attribute__((vector_size(16)));
+
+#define VEC4(x)		((vf4_t){ (x), (x), (x), (x) })
+
+/*
+ * Round to nearest for |x| < 2^22, the integer is taken from the low
+ * mantissa bits of x + 1.5 * 2^23
+ */
+static inline void vroundf4(const vf4_t * x, vf4_t * r, vi4_t * n)
+{
+	const vf4_t magic = VEC4(0x1.8p23f);
+	vf4_t t = *x + magic;
+
+	*n = (vi4_t)t - (vi4_t)magic;
+	*r = t - magic;
+}
+
+/*
+ * Reduce by pi/2 in three parts and evaluate the cephes polynomials on
+ * [-pi/4, pi/4], the quadrant picks and signs the results
+ */
+static inline void vsincosf4(const vf4_t * x, vf4_t * s, vf4_t * c)
+{
+	vi4_t q, odd, is, ic;
+	vf4_t n, r, z, ps, pc;
+
+	r = *x * VEC4((float)M_2_PI);
+	vroundf4(&r, &n, &q);
+	r = *x - n * VEC4(1.5703125f);
+	r = r - n * VEC4(4.837512969970703125e-4f);
+	r = r - n * VEC4(7.54978995489188216e-8f);
+	z = r * r;
+
+	ps = ((VEC4(-1.9515295891e-4f) * z + VEC4(8.3321608736e-3f)) * z - VEC4(1.6666654611e-1f)) * z * r + r;
+	pc = ((VEC4(2.443315711809948e-5f) * z - VEC4(1.388731625493765e-3f)) * z + VEC4(4.166664568298827e-2f)) * z * z - VEC4(0.5f) * z + VEC4(1.0f);
+
+	odd = -(q & 1);
+	is = (vi4_t)ps;
+	ic = (vi4_t)pc;
+	*s = (vf4_t)(((is & ~odd) | (ic & odd)) ^ ((q & 2) << 30));
+	*c = (vf4_t)(((ic & ~odd) | (is & odd)) ^ (((q + 1) & 2) << 30));
+}
+
+/*
+ * Split into an integer and a fraction in [-0.5, 0.5], the fraction goes
+ * through a degree six polynomial and the integer into the exponent
+ */
+static inline void vexp2f4(const vf4_t * x, vf4_t * y)
+{
+	vi4_t n;
+	vf4_t f, p;
+
+	vroundf4(x, &f, &n);
+	f = *x - f;
+	p = VEC4(1.5403530e-4f);
+	p = p * f + VEC4(1.3333558e-3f);
+	p = p * f + VEC4(9.6181291e-3f);
+	p = p * f + VEC4(5.5504109e-2f);
+	p = p * f + VEC4(2.4022651e-1f);
+	p = p * f + VEC4(6.9314718e-1f);
+	p = p * f + VEC4(1.0f);
+	*y = (vf4_t)((vi4_t)p + (n << 23));
+}
+
+static inline void vload4(vf4_t * v, const float * x, int n)
+{
+	int i;
+
+	if(n == 4)
+	{
+		__builtin_memcpy(v, x, sizeof(vf4_t));
+		return;
+	}
+	*v = VEC4(0.0f);
+	for(i = 0; i < n; i++)
+		(*v)[i] = x[i];
+}
+
+static inline void vstore4(float * y, const vf4_t * v, int n)
+{
+	int i;
+
+	if(n == 4)
+	{
+		__builtin_memcpy(y, v, sizeof(vf4_t));
+		return;
+	}
+	for(i = 0; i < n; i++)
+		y[i] = (*v)[i];
+}
+
+float fast_sinf(float x)
+{
+	vf4_t v = VEC4(x), s, c;
+
+	vsincosf4(&v, &s, &c);
+	return s[0];
+}
+
+float fast_cosf(float x)
+{
+	vf4_t v = VEC4(x), s, c;
+
+	vsincosf4(&v, &s, &c);
+	return c[0];
+}
+
+float fast_exp2f(float x)
+{
+	vf4_t v = VEC4(x), y;
+
+	vexp2f4(&v, &y);
+	return y[0];
+}
+
+float fast_expf(float x)
+{
+	vf4_t v = VEC4(x * (float)M_LOG2E), y;
+
+	vexp2f4(&v, &y);
+	return y[0];
+}
+
+void vsincosf(float * s, float * c, const float * x, int n)
+{
+	vf4_t vx, vs, vc;
+	int i, j, k;
+
+	for(i = 0; i < n; i += 4)
+	{
+		k = (n - i < 4) ? n - i : 4;
+		vload4(&vx, &x[i], k);
+		vsincosf4(&vx, &vs, &vc);
+		for(j = 0; j < k; j++)
+		{
+			if(!(fabsf(vx[j]) <= 8192.0f))
+			{
+				vs[j] = sinf(vx[j]);
+				vc[j] = cosf(vx[j]);
+			}
+		}
+		if(s)
+			vstore4(&s[i], &vs, k);
+		if(c)
+			vstore4(&c[i], &vc, k);
+	}
+}
+
+void vsinf(float * y, const float * x, int n)
+{
+	vsincosf(y, NULL, x, n);
+}
+
+void vcosf(float * y, const float * x, int n)
+{
+	vsincosf(NULL, y, x, n);
+}
+
+void vexp2f(float * y, const float * x, int n)
+{
+	vf4_t vx, vy;
+	int i, j, k;
+
+	for(i = 0; i < n; i += 4)
+	{
+		k = (n - i < 4) ? n - i : 4;
+		vload4(&vx, &x[i], k);
+		vexp2f4(&vx, &vy);
+		for(j = 0; j < k; j++)
+		{
+			if(!(vx[j] >= -126.0f && vx[j] <= 127.0f))
+				vy[j] = exp2f(vx[j]);
+		}
+		vstore4(&y[i], &vy, k);
+	}
+}
+
+void vexpf(float * y, const float * x, int n)
+{
+	vf4_t vx, vy;
+	int i, j, k;
+
+	for(i = 0; i < n; i += 4)
+	{
+		k = (n - i < 4) ? n - i : 4;
+		vload4(&vx, &x[i], k);
+		vy = vx * VEC4((float)M_LOG2E);
+		vexp2f4(&vy, &vy);
+		for(j = 0; j < k; j++)
+		{
+			if(!(vx[j] >= -87.0f && vx[j] <= 88.0f))
+				vy[j] = expf(vx[j]);
+		}
+		vstore4(&y[i], &vy, k);
+	}
+}
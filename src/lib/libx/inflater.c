@@ -0,0 +1,164 @@
+/*
+ * libx/inflater.c
+ */
+
+#include <types.h>
+#include <stddef.h>
+#include <malloc.h>
+#include <string.h>
+#include <zlib.h>
+#include <inflater.h>
+
+/*
+ * Expands a zlib or gzip stream fed in pieces of any size. The output is
+ * collected in a window of the given size and handed over only when the
+ * window is full, so a block device sees writes of whole windows whatever
+ * the compressed pieces look like. Memory is the window plus the 32K
+ * history of zlib, independent of the size of the image.
+ */
+enum {
+	INFLATER_STATUS_RUN		= 0,
+	INFLATER_STATUS_END		= 1,
+	INFLATER_STATUS_ERROR	= -1,
+};
+
+static bool_t inflater_flush(struct inflater_t * in)
+{
+	ssize_t n;
+
+	if(in->len > 0)
+	{
+		n = in->output(in->data, in->window, in->len);
+		if(n != in->len)
+		{
+			in->status = INFLATER_STATUS_ERROR;
+			return FALSE;
+		}
+		in->total += in->len;
+		in->len = 0;
+	}
+	return TRUE;
+}
+
+struct inflater_t * inflater_alloc(size_t size, ssize_t (*output)(void * data, const u8_t * buf, size_t len), void * data)
+{
+	struct inflater_t * in;
+	z_stream * zs;
+
+	if(!output || (size == 0))
+		return NULL;
+
+	in = malloc(sizeof(struct inflater_t));
+	if(!in)
+		return NULL;
+
+	zs = malloc(sizeof(z_stream));
+	if(!zs)
+	{
+		free(in);
+		return NULL;
+	}
+	memset(zs, 0, sizeof(z_stream));
+
+	/* Window bits plus 32 takes a zlib or a gzip header */
+	if(inflateInit2(zs, MAX_WBITS + 32) != Z_OK)
+	{
+		free(zs);
+		free(in);
+		return NULL;
+	}
+
+	in->window = malloc(size);
+	if(!in->window)
+	{
+		inflateEnd(zs);
+		free(zs);
+		free(in);
+		return NULL;
+	}
+	in->stream = zs;
+	in->size = size;
+	in->len = 0;
+	in->total = 0;
+	in->status = INFLATER_STATUS_RUN;
+	in->output = output;
+	in->data = data;
+	return in;
+}
+EXPORT_SYMBOL(inflater_alloc);
+
+void inflater_free(struct inflater_t * in)
+{
+	if(in)
+	{
+		inflateEnd((z_stream *)in->stream);
+		free(in->stream);
+		free(in->window);
+		free(in);
+	}
+}
+EXPORT_SYMBOL(inflater_free);
+
+/*
+ * Returns the bytes of compressed input consumed, which is all of them
+ * unless the stream ends inside the buffer, or -1 on a broken stream or
+ * a failed output
+ */
+ssize_t inflater_write(struct inflater_t * in, const u8_t * buf, size_t len)
+{
+	z_stream * zs;
+	int ret;
+
+	if(!in || (in->status == INFLATER_STATUS_ERROR))
+		return -1;
+	if(in->status == INFLATER_STATUS_END)
+		return 0;
+
+	zs = (z_stream *)in->stream;
+	zs->next_in = (Bytef *)buf;
+	zs->avail_in = len;
+	while(zs->avail_in > 0)
+	{
+		zs->next_out = in->window + in->len;
+		zs->avail_out = in->size - in->len;
+		ret = inflate(zs, Z_NO_FLUSH);
+		in->len = in->size - zs->avail_out;
+		if(ret == Z_STREAM_END)
+		{
+			in->status = INFLATER_STATUS_END;
+			if(!inflater_flush(in))
+				return -1;
+			break;
+		}
+		if((ret != Z_OK) && (ret != Z_BUF_ERROR))
+		{
+			in->status = INFLATER_STATUS_ERROR;
+			return -1;
+		}
+		if(in->len == in->size)
+		{
+			if(!inflater_flush(in))
+				return -1;
+		}
+		else if(ret == Z_BUF_ERROR)
+		{
+			break;
+		}
+	}
+	return len - zs->avail_in;
+}
+EXPORT_SYMBOL(inflater_write);
+
+/*
+ * Hands over what is left in the window, TRUE only when the whole stream,
+ * its checksum included, has been seen
+ */
+bool_t inflater_finish(struct inflater_t * in)
+{
+	if(!in || (in->status == INFLATER_STATUS_ERROR))
+		return FALSE;
+	if(!inflater_flush(in))
+		return FALSE;
+	return (in->status == INFLATER_STATUS_END) ? TRUE : FALSE;
+}
+EXPORT_SYMBOL(inflater_finish);
@@ -3,6 +3,7 @@
 --
 Json = require "builtin.json"
 Stopwatch = require "builtin.stopwatch"
+Profiler = require "builtin.profiler"
 Base64 = require "builtin.base64"
 Matrix = require "builtin.matrix"
 Easing = require "builtin.easing"
@@ -13,6 +14,7 @@ Ninepatch = require "builtin.ninepatch"
 Shape = require "builtin.shape"
 Font = require "builtin.font"
 Display = require "builtin.display"
+Sound = require "builtin.sound"
 
 ---
 -- External display module
@@ -12,6 +12,7 @@ end
 
 function M:showfps(value)
 	self.display:showfps(value)
+	self.fps = value and true or false
 	return self
 end
 
@@ -23,12 +24,16 @@ end
 function M:loop()
   local timermanager = timermanager
 	local Event = Event
+	local Profiler = Profiler
 	local display = self.display
 	local stopwatch = Stopwatch.new()
+	local profiling = self.fps or Profiler.enabled()
 
 	timermanager:addTimer(Timer.new(1 / 60, 0, function(t, i)
+		if profiling then Profiler.phase(Profiler.DRAW) end
 		self:render(display, Event.new(Event.ENTER_FRAME, i))
 		display:present()
+		profiling = self.fps or Profiler.enabled()
 	end))
 
 	self:addEventListener(Event.KEY_DOWN, function(d, e)
@@ -36,11 +41,13 @@ function M:loop()
 	end)
 
 	while not self.exiting do
+		if profiling then Profiler.phase(Profiler.DISPATCH) end
 		local e = Event.pump()
 		if e ~= nil then
 			self:dispatch(e)
 		end
 
+		if profiling then Profiler.phase(Profiler.TIMERS) end
 		local elapsed = stopwatch:elapsed()
 		if elapsed ~= 0 then
 			stopwatch:reset()